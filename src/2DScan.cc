@@ -424,7 +424,8 @@ void Scan2D::make_scan() {
     before << output << std::flush;
 
     // set constraints
-    if (Config::get().optimization.local.method == config::optimization_conf::lo_types::LBFGS) {
+    if (Config::get().optimization.local.method == config::optimization_conf::lo_types::LBFGS ||
+      Config::get().optimization.local.method == config::optimization_conf::lo_types::FIRE) {
       parser->fix_atoms(_coords);
     }
     else if (Config::get().optimization.local.method == config::optimization_conf::lo_types::OPTPP) {
@@ -544,7 +545,8 @@ void Scan2D::go_along_y_axis(coords::Coordinates coords, double const x_step) {
     set_to_pespoint(coords, x_step, y_step);
 
     // set constraints
-    if (Config::get().optimization.local.method == config::optimization_conf::lo_types::LBFGS) {
+    if (Config::get().optimization.local.method == config::optimization_conf::lo_types::LBFGS ||
+      Config::get().optimization.local.method == config::optimization_conf::lo_types::FIRE) {
       parser->fix_atoms(coords);
     }
     else if (Config::get().optimization.local.method == config::optimization_conf::lo_types::OPTPP) {
@@ -25,6 +25,14 @@ namespace internals {
     return P - P * C * CPC.pinv() * C * P;
   }
 
+  scon::mathmatrix<coords::float_type> ConstrainedInternalCoordinates::removeConstrainedComponents(scon::mathmatrix<coords::float_type> const& internalVector) const {
+    auto ret = internalVector;
+    for (std::size_t i = 0; i < primitive_internals.size(); ++i) {
+      if (primitive_internals.at(i)->is_constrained()) ret(i, 0) = 0.0;
+    }
+    return ret;
+  }
+
   scon::mathmatrix<coords::float_type> ConstrainedInternalCoordinates::constraintMatrix() const {
     auto s = primitive_internals.size();
     auto ret = scon::mathmatrix<coords::float_type>::zero(s, s);
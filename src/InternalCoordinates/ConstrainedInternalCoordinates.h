@@ -20,6 +20,7 @@ namespace internals {
 
     virtual scon::mathmatrix<coords::float_type> projectorMatrix(CartesianType const& cartesian) override;
     virtual scon::mathmatrix<coords::float_type> constraintMatrix() const;
+    virtual scon::mathmatrix<coords::float_type> removeConstrainedComponents(scon::mathmatrix<coords::float_type> const& internalVector) const override;
 
     virtual std::unique_ptr<AppropriateStepFinder> constructStepFinder(
       InternalToCartesianConverter const& converter,
@@ -83,6 +83,7 @@ namespace InternalCoordinates {
     std::pair<coords::float_type, coords::float_type> displacementRmsValAndMaxTwoStructures(CartesiansForInternalCoordinates const& other) const;
 
     coords::Representation_3D toAngstrom() const;
+    coords::Representation_3D const& getCoordinates() const { return coordinates; }
 
     void registerObserver(std::shared_ptr<RotatorObserver> const observer);
 
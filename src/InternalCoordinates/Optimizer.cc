@@ -15,11 +15,85 @@ struct Optimizer::SystemVariables {
 };
 
 
+LbfgsInverseHessian::LbfgsInverseHessian(std::size_t const memory)
+  : memory{ memory }, preconditioner{ std::make_unique<scon::mathmatrix<internals::float_type>>() }, steps{}, gradientChanges{}, rho{} {}
+
+LbfgsInverseHessian::~LbfgsInverseHessian() = default;
+
+void LbfgsInverseHessian::setPreconditioner(scon::mathmatrix<internals::float_type> const& diagonal) {
+  *preconditioner = diagonal;
+  // coordinates without a force constant in the model (e.g. frozen ones) must not get infinite steps
+  for (std::size_t i = 0; i < preconditioner->rows(); ++i) {
+    (*preconditioner)(i, 0) = std::max((*preconditioner)(i, 0), 1.e-4);
+  }
+}
+
+scon::mathmatrix<internals::float_type> LbfgsInverseHessian::direction(scon::mathmatrix<internals::float_type> const& gradients) const {
+  auto q = gradients;
+  std::vector<internals::float_type> alpha(rho.size());
+  for (std::size_t i = rho.size(); i-- > 0u;) {
+    alpha[i] = rho[i] * (steps[i].t() * q)(0, 0);
+    q = q - gradientChanges[i] * alpha[i];
+  }
+  for (std::size_t i = 0; i < q.rows(); ++i) {
+    q(i, 0) /= preconditioner->rows() == q.rows() ? (*preconditioner)(i, 0) : 1.0;
+  }
+  for (std::size_t i = 0; i < rho.size(); ++i) {
+    auto const beta = rho[i] * (gradientChanges[i].t() * q)(0, 0);
+    q = q + steps[i] * (alpha[i] - beta);
+  }
+  return q * -1.0;
+}
+
+scon::mathmatrix<internals::float_type> LbfgsInverseHessian::hessianTimes(scon::mathmatrix<internals::float_type> const& v) const {
+  using Mat = scon::mathmatrix<internals::float_type>;
+  // H_0 = diagonal preconditioner, H_k+1 = H_k - H_k * s_k * s_k^T * H_k / (s_k^T * H_k * s_k) + y_k * y_k^T / (y_k^T * s_k)
+  std::vector<Mat> hessianTimesSteps;
+  auto times = [&](Mat const& w, std::size_t const k) {
+    auto result = w;
+    for (std::size_t i = 0; i < result.rows(); ++i) {
+      result(i, 0) *= preconditioner->rows() == result.rows() ? (*preconditioner)(i, 0) : 1.0;
+    }
+    for (std::size_t i = 0; i < k; ++i) {
+      auto const& Hs = hessianTimesSteps[i];
+      result = result - Hs * ((Hs.t() * w)(0, 0) / (steps[i].t() * Hs)(0, 0))
+        + gradientChanges[i] * (rho[i] * (gradientChanges[i].t() * w)(0, 0));
+    }
+    return result;
+  };
+  for (std::size_t k = 0; k < rho.size(); ++k) hessianTimesSteps.emplace_back(times(steps[k], k));
+  return times(v, rho.size());
+}
+
+bool LbfgsInverseHessian::update(scon::mathmatrix<internals::float_type> const& step, scon::mathmatrix<internals::float_type> const& gradientChange) {
+  auto const curvature = (step.t() * gradientChange)(0, 0);
+  if (curvature <= 1.e-10 * step.norm() * gradientChange.norm()) return false;
+  if (rho.size() == memory) {
+    steps.erase(steps.begin());
+    gradientChanges.erase(gradientChanges.begin());
+    rho.erase(rho.begin());
+  }
+  steps.emplace_back(step);
+  gradientChanges.emplace_back(gradientChange);
+  rho.emplace_back(1.0 / curvature);
+  return true;
+}
+
+void LbfgsInverseHessian::clear() {
+  steps.clear();
+  gradientChanges.clear();
+  rho.clear();
+}
+
 Optimizer::Optimizer(internals::PrimitiveInternalCoordinates& internals, CartesianType const& cartesians)
   : internalCoordinateSystem{ internals }, cartesianCoordinates{ std::make_unique<CartesianType>(cartesians) },
-  converter{ internalCoordinateSystem, *cartesianCoordinates }, hessian{ std::make_unique<scon::mathmatrix<internals::float_type>>(internalCoordinateSystem.guess_hessian(*cartesianCoordinates)) },
-  trustRadius{ 0.1 }, expectedChangeInEnergy{ 0.0 }, stepSize{ std::make_unique<scon::mathmatrix<internals::float_type>>() },
-  currentVariables{ std::make_unique<SystemVariables>() }, oldVariables{} {}
+  converter{ internalCoordinateSystem, *cartesianCoordinates }, hessian{ std::make_unique<scon::mathmatrix<internals::float_type>>() },
+  lbfgs{}, trustRadius{ 0.1 }, expectedChangeInEnergy{ 0.0 }, stepSize{ std::make_unique<scon::mathmatrix<internals::float_type>>() },
+  currentVariables{ std::make_unique<SystemVariables>() }, oldVariables{} {
+  auto const lbfgsMemory = Config::get().optimization.local.internals.lbfgs_memory;
+  if (lbfgsMemory > 0u) lbfgs = std::make_unique<LbfgsInverseHessian>(lbfgsMemory);
+  else *hessian = internalCoordinateSystem.guess_hessian(*cartesianCoordinates);
+}
 
 Optimizer::~Optimizer() = default;
 
@@ -165,7 +239,7 @@ void Optimizer::optimize(coords::Coordinates & coords) {
 
     applyHessianChange();
 
-    auto projectedGradient = internalCoordinateSystem.projectorMatrix(*cartesianCoordinates) * (*currentVariables->systemGradients);
+    auto projectedGradient = projectedGradients();
     if (ConvergenceCheck{ i + 1, projectedGradient, *this }()) {
       std::cout << "Converged after " << i + 1 << " steps!\n";
       break;
@@ -206,6 +280,10 @@ void Optimizer::resetStep(coords::Coordinates & coords) {
 }
 
 void Optimizer::evaluateNewCartesianStructure(coords::Coordinates & coords) {
+  if (lbfgs) {
+    evaluateNewCartesianStructureLbfgs(coords);
+    return;
+  }
   auto stepFinder = internalCoordinateSystem.constructStepFinder(converter, *oldVariables->systemGradients, *hessian, *cartesianCoordinates);
 
   stepFinder->appropriateStep(trustRadius);
@@ -216,6 +294,39 @@ void Optimizer::evaluateNewCartesianStructure(coords::Coordinates & coords) {
   coords.set_xyz(cartesianCoordinates->toAngstrom());
 }
 
+void Optimizer::evaluateNewCartesianStructureLbfgs(coords::Coordinates & coords) {
+  auto const gradients = internalCoordinateSystem.removeConstrainedComponents(*oldVariables->systemGradients);
+  lbfgs->setPreconditioner(internalCoordinateSystem.diagonalOfHessianGuess(*cartesianCoordinates));
+  auto step = internalCoordinateSystem.removeConstrainedComponents(lbfgs->direction(gradients));
+  if (!((gradients.t() * step)(0, 0) < 0.0)) {
+    // no descent direction: forget the history and start again with the model Hessian
+    lbfgs->clear();
+    step = internalCoordinateSystem.removeConstrainedComponents(lbfgs->direction(gradients));
+  }
+
+  // shorten the step until the cartesian displacement is within the trust radius
+  auto scale = 1.0;
+  auto newCartesians = converter.applyInternalChange(step);
+  for (auto i = 0; i < 5; ++i) {
+    auto const cartesianNorm = converter.cartesianNormOfOtherStructureAndCurrent(newCartesians).first;
+    if (cartesianNorm <= 1.1 * trustRadius) break;
+    if (Config::get().general.verbosity > 3) std::cout << "Trust radius exceeded, scaling L-BFGS step.\n";
+    scale *= trustRadius / cartesianNorm;
+    newCartesians = converter.applyInternalChange(step * scale);
+  }
+
+  // the back-transformation only realizes the part of the step that lies in the range of B,
+  // so the quadratic model is evaluated for the internal displacement that was actually reached
+  auto const achievedStep = internalCoordinateSystem.removeConstrainedComponents(
+    internalCoordinateSystem.calc_diff(newCartesians, *cartesianCoordinates).t());
+  expectedChangeInEnergy = (gradients.t() * achievedStep)(0, 0)
+    + 0.5 * (achievedStep.t() * lbfgs->hessianTimes(achievedStep))(0, 0);
+  *stepSize = achievedStep;
+
+  cartesianCoordinates->setCartesianCoordnates(std::move(newCartesians));
+  coords.set_xyz(cartesianCoordinates->toAngstrom());
+}
+
 bool Optimizer::changeTrustStepIfNeccessary() {
   auto differenceInEnergy = currentVariables->systemEnergy - oldVariables->systemEnergy;
   auto quality = (differenceInEnergy) / expectedChangeInEnergy;
@@ -264,6 +375,12 @@ void Optimizer::applyHessianChange() {
   auto d_gq = (*currentVariables->systemGradients) - (*oldVariables->systemGradients);
   auto dq = *stepSize;//internalCoordinateSystem.calc_diff(cartesianCoordinates, oldVariables->systemCartesianRepresentation);
 
+  if (lbfgs) {
+    lbfgs->update(dq, internalCoordinateSystem.removeConstrainedComponents(d_gq));
+    ++i;
+    return;
+  }
+
   if (Config::get().general.verbosity > 3u)
   {
     std::stringstream hessianSS;
@@ -297,6 +414,12 @@ void Optimizer::applyHessianChange() {
   ++i;
 }
 
+scon::mathmatrix<internals::float_type> Optimizer::projectedGradients() {
+  // the dense projector needs the pseudo-inverse of G which is avoided in L-BFGS mode
+  if (lbfgs) return internalCoordinateSystem.removeConstrainedComponents(*currentVariables->systemGradients);
+  return internalCoordinateSystem.projectorMatrix(*cartesianCoordinates) * (*currentVariables->systemGradients);
+}
+
 void Optimizer::setNewToOldVariables() {
   oldVariables->systemEnergy = currentVariables->systemEnergy;
   oldVariables->systemCartesianRepresentation = *cartesianCoordinates;
@@ -20,6 +20,31 @@ namespace scon {
   template<typename T> class mathmatrix;
 }
 
+/**limited-memory BFGS approximation of the inverse Hessian in internal coordinates*/
+class LbfgsInverseHessian {
+public:
+  explicit LbfgsInverseHessian(std::size_t const memory);
+  ~LbfgsInverseHessian();
+
+  /**diagonal of the model Hessian (column vector) that is used as initial Hessian*/
+  void setPreconditioner(scon::mathmatrix<internals::float_type> const& diagonal);
+  /**-H^-1 * gradients by the two-loop recursion*/
+  scon::mathmatrix<internals::float_type> direction(scon::mathmatrix<internals::float_type> const& gradients) const;
+  /**H * v with the Hessian of the stored pairs (direct BFGS updates of the initial Hessian)*/
+  scon::mathmatrix<internals::float_type> hessianTimes(scon::mathmatrix<internals::float_type> const& v) const;
+  /**stores a step and the corresponding change of the gradients (skipped if the curvature is not positive)
+  @return true if the pair was stored*/
+  bool update(scon::mathmatrix<internals::float_type> const& step, scon::mathmatrix<internals::float_type> const& gradientChange);
+  void clear();
+  std::size_t size() const { return rho.size(); }
+
+private:
+  std::size_t memory;
+  std::unique_ptr<scon::mathmatrix<internals::float_type>> preconditioner;
+  std::vector<scon::mathmatrix<internals::float_type>> steps, gradientChanges;
+  std::vector<internals::float_type> rho;
+};
+
 class Optimizer {
 protected:
   using CartesianType = InternalCoordinates::CartesiansForInternalCoordinates;
@@ -46,17 +71,21 @@ protected:
   void setCartesianCoordinatesForGradientCalculation(coords::Coordinates& coords);
   void prepareOldVariablesPtr(coords::Coordinates& coords);
   void evaluateNewCartesianStructure(coords::Coordinates& coords);
+  void evaluateNewCartesianStructureLbfgs(coords::Coordinates& coords);
   bool changeTrustStepIfNeccessary();
   void applyHessianChange();
   void setNewToOldVariables();
   void resetStep(coords::Coordinates& coords);
   scon::mathmatrix<internals::float_type> getInternalGradientsButReturnCartesianOnes(coords::Coordinates& coords);
+  scon::mathmatrix<internals::float_type> projectedGradients();
 
 
   internals::PrimitiveInternalCoordinates& internalCoordinateSystem;
   std::unique_ptr<CartesianType> cartesianCoordinates;
   internals::InternalToCartesianConverter converter;
   std::unique_ptr<scon::mathmatrix<internals::float_type>> hessian;
+  /**replaces the dense hessian if L-BFGS is switched on (OPTlbfgsMemory)*/
+  std::unique_ptr<LbfgsInverseHessian> lbfgs;
   internals::float_type trustRadius;
   internals::float_type expectedChangeInEnergy;
 
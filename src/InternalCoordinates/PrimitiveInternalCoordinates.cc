@@ -7,6 +7,8 @@
 #include "InternalCoordinateUtilities.h"
 #include "InternalCoordinates.h"
 
+#include <algorithm>
+
 namespace internals {
 
   struct GradientsAndHessians {
@@ -33,6 +35,7 @@ namespace internals {
     primitive_internals.insert(primitive_internals.end(),
       std::make_move_iterator(pic.begin()),
       std::make_move_iterator(pic.end()));
+    requestNewBAndG();
   }
 
   void PrimitiveInternalCoordinates::appendRotators(
@@ -106,26 +109,136 @@ namespace internals {
     return Mat::col_from_vec(values).diagmat();
   }
 
-  scon::mathmatrix<coords::float_type>&
-    PrimitiveInternalCoordinates::Bmat(CartesianType const& cartesians) {
-    // TODO activate it again!!!!!
-    /*if (!new_B_matrix) {
-      return B_matrix;
-    }*/
-    using Mat = scon::mathmatrix<coords::float_type>;
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::diagonalOfHessianGuess(CartesianType const& cartesians) const {
+    std::vector<coords::float_type> values;
+    values.reserve(primitive_internals.size());
+    for (auto const& pic : primitive_internals) {
+      values.emplace_back(cartesians.getInternalHessianGuess(*pic));
+    }
+    return scon::mathmatrix<coords::float_type>::col_from_vec(values);
+  }
 
-    auto ders = deriv_vec(cartesians);
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::removeConstrainedComponents(scon::mathmatrix<coords::float_type> const& internalVector) const {
+    return internalVector;
+  }
+
+  bool PrimitiveInternalCoordinates::reuseCached(bool& new_matrix, coords::Representation_3D& cache_key, CartesianType const& cartesians) {
+    auto const& xyz = cartesians.getCoordinates();
+    if (!new_matrix && cache_key.size() == xyz.size() && std::equal(xyz.begin(), xyz.end(), cache_key.begin())) {
+      return true;
+    }
+    cache_key = xyz;
+    new_matrix = false;
+    return false;
+  }
+
+  PrimitiveInternalCoordinates::SparseBmat const&
+    PrimitiveInternalCoordinates::sparseBmat(CartesianType const& cartesians) {
+    if (reuseCached(new_sparse_B, sparse_B_cartesians, cartesians)) {
+      return sparse_B;
+    }
+
+    auto const n_rows = primitive_internals.size();
+    sparse_B.cols = 3u * cartesians.getCoordinates().size();
+    sparse_B.rows.assign(n_rows, {});
 
-    std::size_t n_rows = ders.size(), n_cols = ders.at(0).size();
-    *B_matrix = Mat(n_rows, n_cols);
+    auto compress = [this](std::size_t const i, std::vector<coords::float_type> const& der) {
+      auto& row = sparse_B.rows[i];
+      for (std::size_t j{ 0 }; j < der.size(); ++j) {
+        if (der[j] != 0.0) row.emplace_back(j, der[j]);
+      }
+    };
 
+    // rotations share the derivatives stored in their rotator, so they are calculated one after another
+    std::vector<std::ptrdiff_t> independent;
     for (std::size_t i{ 0 }; i < n_rows; ++i) {
-      B_matrix->set_row(i, Mat::row_from_vec(ders.at(i)));
+      if (dynamic_cast<InternalCoordinates::Rotation const*>(primitive_internals[i].get())) {
+        compress(i, cartesians.getInternalDerivativeVector(*primitive_internals[i]));
+      }
+      else independent.emplace_back(static_cast<std::ptrdiff_t>(i));
+    }
+    auto const n_independent = static_cast<std::ptrdiff_t>(independent.size());
+#pragma omp parallel for schedule(dynamic, 16)
+    for (std::ptrdiff_t k = 0; k < n_independent; ++k) {
+      auto const i = static_cast<std::size_t>(independent[k]);
+      compress(i, cartesians.getInternalDerivativeVector(*primitive_internals[i]));
     }
+    return sparse_B;
+  }
+
+  scon::mathmatrix<coords::float_type> PrimitiveInternalCoordinates::SparseBmat::toDense() const {
+    auto result = scon::mathmatrix<coords::float_type>::zero(rows.size(), cols);
+    for (std::size_t i{ 0 }; i < rows.size(); ++i) {
+      for (auto const& element : rows[i]) result(i, element.first) = element.second;
+    }
+    return result;
+  }
+
+  scon::mathmatrix<coords::float_type> PrimitiveInternalCoordinates::SparseBmat::timesTransposed() const {
+    // G_ij only gets contributions from columns (cartesian components) that are shared by primitive i and j
+    std::vector<std::vector<std::pair<std::size_t, coords::float_type>>> columns(cols);
+    for (std::size_t i{ 0 }; i < rows.size(); ++i) {
+      for (auto const& element : rows[i]) columns[element.first].emplace_back(i, element.second);
+    }
+    auto const n = static_cast<std::ptrdiff_t>(rows.size());
+    auto result = scon::mathmatrix<coords::float_type>::zero(rows.size(), rows.size());
+#pragma omp parallel for schedule(dynamic, 16)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      for (auto const& element : rows[i]) {
+        for (auto const& other : columns[element.first]) {
+          result(i, other.first) += element.second * other.second;
+        }
+      }
+    }
+    return result;
+  }
+
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::SparseBmat::leftMultiplied(scon::mathmatrix<coords::float_type> const& M) const {
+    auto const n = static_cast<std::ptrdiff_t>(M.cols());
+    auto result = scon::mathmatrix<coords::float_type>::zero(M.cols(), cols);
+#pragma omp parallel for schedule(static)
+    for (std::ptrdiff_t k = 0; k < n; ++k) {
+      for (std::size_t i{ 0 }; i < rows.size(); ++i) {
+        auto const factor = M(i, k);
+        if (factor == 0.0) continue;
+        for (auto const& element : rows[i]) result(k, element.first) += factor * element.second;
+      }
+    }
+    return result;
+  }
 
-    new_B_matrix = false;
-    // std::cout << "Bmat:\n" << std::fixed << std::setprecision(15) << B_matrix
-    // << "\n\n";
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::SparseBmat::times(scon::mathmatrix<coords::float_type> const& v) const {
+    auto const n = static_cast<std::ptrdiff_t>(rows.size());
+    auto result = scon::mathmatrix<coords::float_type>::zero(rows.size(), 1u);
+#pragma omp parallel for schedule(static)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      coords::float_type sum{ 0.0 };
+      for (auto const& element : rows[i]) sum += element.second * v(element.first, 0);
+      result(i, 0) = sum;
+    }
+    return result;
+  }
+
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::SparseBmat::transposedTimes(scon::mathmatrix<coords::float_type> const& v) const {
+    auto result = scon::mathmatrix<coords::float_type>::zero(cols, 1u);
+    for (std::size_t i{ 0 }; i < rows.size(); ++i) {
+      auto const factor = v(i, 0);
+      for (auto const& element : rows[i]) result(element.first, 0) += factor * element.second;
+    }
+    return result;
+  }
+
+  scon::mathmatrix<coords::float_type>&
+    PrimitiveInternalCoordinates::Bmat(CartesianType const& cartesians) {
+    if (reuseCached(new_B_matrix, B_cartesians, cartesians)) {
+      return *B_matrix;
+    }
+    *B_matrix = sparseBmat(cartesians).toDense();
     return *B_matrix;
   }
 
@@ -145,26 +258,32 @@ namespace internals {
     return Gmat(cartesian) * pseudoInverseOfGmat(cartesian);
   }
 
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::BmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) {
+    return sparseBmat(cartesian).times(v);
+  }
+
+  scon::mathmatrix<coords::float_type>
+    PrimitiveInternalCoordinates::transposeOfBmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) {
+    return sparseBmat(cartesian).transposedTimes(v);
+  }
+
   std::vector<std::vector<coords::float_type>>
     PrimitiveInternalCoordinates::deriv_vec(CartesianType const& cartesians) {
-    std::vector<std::vector<coords::float_type>> result;
-
-    for (auto const& pic : primitive_internals) {
-      result.emplace_back(cartesians.getInternalDerivativeVector(*pic));
+    auto const& sparse = sparseBmat(cartesians);
+    std::vector<std::vector<coords::float_type>> result(sparse.rows.size(), std::vector<coords::float_type>(sparse.cols, 0.0));
+    for (std::size_t i{ 0 }; i < sparse.rows.size(); ++i) {
+      for (auto const& element : sparse.rows[i]) result[i][element.first] = element.second;
     }
-
     return result;
   }
 
   scon::mathmatrix<coords::float_type>&
     PrimitiveInternalCoordinates::Gmat(CartesianType const& cartesians) {
-    // TODO activate it again!!!!!
-    /*if (!new_G_matrix) {
-      return G_matrix;
-    }*/
-    PrimitiveInternalCoordinates::Bmat(cartesians);
-    *G_matrix = *B_matrix * B_matrix->t();
-    new_G_matrix = false;
+    if (reuseCached(new_G_matrix, G_cartesians, cartesians)) {
+      return *G_matrix;
+    }
+    *G_matrix = sparseBmat(cartesians).timesTransposed();
     return *G_matrix;
   }
 
@@ -208,11 +327,62 @@ namespace internals {
 
   InternalToCartesianConverter::~InternalToCartesianConverter() = default;
 
+  namespace {
+    coords::float_type dot(scon::mathmatrix<coords::float_type> const& a, scon::mathmatrix<coords::float_type> const& b) {
+      coords::float_type result{ 0.0 };
+      for (std::size_t i{ 0 }; i < a.rows(); ++i) result += a(i, 0) * b(i, 0);
+      return result;
+    }
+
+    /**
+    * CGLS, i.e. conjugate gradients for A^T * A * x = A^T * rhs, starting at x
+    * (converges to the minimum norm least-squares solution if x starts in the range of A^T)
+    * @param A: returns A * v
+    * @param At: returns A^T * v
+    */
+    template<typename Product, typename TransposedProduct>
+    scon::mathmatrix<coords::float_type> cgls(Product const& A, TransposedProduct const& At,
+      scon::mathmatrix<coords::float_type> const& rhs, scon::mathmatrix<coords::float_type> x) {
+      auto r = rhs - A(x);
+      auto s = At(r);
+      auto p = s;
+      auto gamma = dot(s, s);
+      auto const tolerance = 1.e-20 * std::max(gamma, dot(rhs, rhs));
+      for (std::size_t iter{ 0 }; iter < 2u * x.rows() && gamma > tolerance; ++iter) {
+        auto const q = A(p);
+        auto const qq = dot(q, q);
+        if (qq <= 0.0) break;
+        auto const alpha = gamma / qq;
+        x = x + p * alpha;
+        r = r - q * alpha;
+        s = At(r);
+        auto const gamma_new = dot(s, s);
+        p = s + p * (gamma_new / gamma);
+        gamma = gamma_new;
+      }
+      return x;
+    }
+
+    bool useIterativeBacktransformation(std::size_t const numberOfInternals) {
+      auto const threshold = Config::get().optimization.local.internals.iterative_backtransformation;
+      return threshold > 0u && numberOfInternals >= threshold;
+    }
+  }
+
   scon::mathmatrix<coords::float_type>
     InternalToCartesianConverter::calculateInternalGradients(
       scon::mathmatrix<coords::float_type> const& gradients) {
-    return internalCoordinates.pseudoInverseOfGmat(cartesianCoordinates) *
-      internalCoordinates.Bmat(cartesianCoordinates) * gradients;
+    using Mat = scon::mathmatrix<coords::float_type>;
+    auto const numberOfInternals = internalCoordinates.numberOfInternals();
+    if (!useIterativeBacktransformation(numberOfInternals)) {
+      return internalCoordinates.pseudoInverseOfGmat(cartesianCoordinates) *
+        internalCoordinates.Bmat(cartesianCoordinates) * gradients;
+    }
+    // G^-1 * B * g is the minimum norm least-squares solution of B^T * g_int = g
+    return cgls(
+      [&](Mat const& v) { return internalCoordinates.transposeOfBmatTimes(cartesianCoordinates, v); },
+      [&](Mat const& v) { return internalCoordinates.BmatTimes(cartesianCoordinates, v); },
+      gradients, Mat::zero(numberOfInternals, 1u));
   }
 
   std::pair<coords::float_type, coords::float_type>
@@ -500,6 +670,26 @@ namespace internals {
     internalCoordinates.requestNewBAndG();
   }
 
+  scon::mathmatrix<coords::float_type> InternalToCartesianConverter::iterativeCartesianStep(
+    scon::mathmatrix<coords::float_type> const& internalStep, CartesianType const& cartesians,
+    scon::mathmatrix<coords::float_type>& previousStep) const {
+    using Mat = scon::mathmatrix<coords::float_type>;
+
+    // the last step, scaled to fit the new internal step as well as possible, is the starting guess
+    Mat x = Mat::zero(3u * cartesians.getCoordinates().size(), 1u);
+    if (previousStep.rows() == x.rows()) {
+      auto const Bp = internalCoordinates.BmatTimes(cartesians, previousStep);
+      auto const BpBp = dot(Bp, Bp);
+      if (BpBp > 0.0) x = previousStep * (dot(Bp, internalStep) / BpBp);
+    }
+
+    previousStep = cgls(
+      [&](Mat const& v) { return internalCoordinates.BmatTimes(cartesians, v); },
+      [&](Mat const& v) { return internalCoordinates.transposeOfBmatTimes(cartesians, v); },
+      internalStep, std::move(x));
+    return previousStep;
+  }
+
   coords::Representation_3D InternalToCartesianConverter::applyInternalChange(
     scon::mathmatrix<coords::float_type> d_int_left) const {
     using ic_util::flatten_c3_vec;
@@ -513,6 +703,8 @@ namespace internals {
     auto micro_iter{ 0 }, fail_count{ 0 };
     auto damp{ 1. };
     auto old_inorm{ 0.0 };
+    auto const iterative = useIterativeBacktransformation(internalCoordinates.numberOfInternals());
+    scon::mathmatrix<coords::float_type> last_cartesian_step;
 
     for (; micro_iter < 50; ++micro_iter) {
       /*std::cout << "Bmat MicroIteration " << micro_iter << "\n\n"
@@ -524,11 +716,16 @@ namespace internals {
       std::cout << "Cartesians in Microiteration " << micro_iter << ":\n\n"
               << actual_xyz.coordinates << "\n\n";*/
 
-      takeCartesianStep(
-        internalCoordinates.transposeOfBmat(actual_xyz.coordinates) *
-        internalCoordinates.pseudoInverseOfGmat(actual_xyz.coordinates) *
-        damp * d_int_left,
-        actual_xyz);
+      if (iterative) {
+        takeCartesianStep(iterativeCartesianStep(damp * d_int_left, actual_xyz.coordinates, last_cartesian_step), actual_xyz);
+      }
+      else {
+        takeCartesianStep(
+          internalCoordinates.transposeOfBmat(actual_xyz.coordinates) *
+          internalCoordinates.pseudoInverseOfGmat(actual_xyz.coordinates) *
+          damp * d_int_left,
+          actual_xyz);
+      }
 
       auto d_now = internalCoordinates
         .calc_diff(actual_xyz.coordinates, old_xyz.coordinates)
@@ -44,6 +44,7 @@ namespace internals {
     void requestNewBAndG() {
       new_B_matrix = true;
       new_G_matrix = true;
+      new_sparse_B = true;
     }
 
   protected:
@@ -55,19 +56,59 @@ namespace internals {
 
     std::vector<std::vector<coords::float_type>> deriv_vec(CartesianType const& cartesians);
 
+    /**
+    * Wilson B-matrix of the primitives with only the non-zero elements of every row
+    * (most primitives depend on two to four atoms)
+    */
+    struct SparseBmat {
+      std::size_t cols{ 0u };
+      std::vector<std::vector<std::pair<std::size_t, coords::float_type>>> rows;
+
+      scon::mathmatrix<coords::float_type> toDense() const;
+      /**B * B^T*/
+      scon::mathmatrix<coords::float_type> timesTransposed() const;
+      /**M^T * B for a dense matrix M with one row per primitive*/
+      scon::mathmatrix<coords::float_type> leftMultiplied(scon::mathmatrix<coords::float_type> const& M) const;
+      /**B * v for a column vector v with one element per cartesian component*/
+      scon::mathmatrix<coords::float_type> times(scon::mathmatrix<coords::float_type> const& v) const;
+      /**B^T * v for a column vector v with one element per primitive*/
+      scon::mathmatrix<coords::float_type> transposedTimes(scon::mathmatrix<coords::float_type> const& v) const;
+    };
+
+    /**B-matrix of the primitives, only recalculated if requested or if the cartesians have changed*/
+    SparseBmat const& sparseBmat(CartesianType const& cartesians);
+    /**
+    * true if a matrix calculated for the cartesians in cache_key (and not invalidated by the flag) can be reused,
+    * otherwise the key is updated and the flag is reset so the caller has to calculate the matrix
+    */
+    static bool reuseCached(bool& new_matrix, coords::Representation_3D& cache_key, CartesianType const& cartesians);
+
     bool new_B_matrix = true;
     bool new_G_matrix = true;
+    bool new_sparse_B = true;
+    SparseBmat sparse_B;
+    coords::Representation_3D B_cartesians, G_cartesians, sparse_B_cartesians;
 
   public:
     virtual scon::mathmatrix<coords::float_type> calc(CartesianType const& xyz) const;//F
     virtual scon::mathmatrix<coords::float_type> calc_diff(CartesianType const& lhs, CartesianType const& rhs) const;//F
 
     virtual scon::mathmatrix<coords::float_type> guess_hessian(CartesianType const&) const;//F
+    /**diagonal of guess_hessian as column vector (without forming the full matrix)*/
+    virtual scon::mathmatrix<coords::float_type> diagonalOfHessianGuess(CartesianType const&) const;
+    /**number of internal coordinates the optimizer works with (rows of the B-matrix)*/
+    virtual std::size_t numberOfInternals() const { return primitive_internals.size(); }
+    /**sets the components of constrained coordinates in a vector of internal coordinates to zero*/
+    virtual scon::mathmatrix<coords::float_type> removeConstrainedComponents(scon::mathmatrix<coords::float_type> const& internalVector) const;
     virtual scon::mathmatrix<coords::float_type>& Bmat(CartesianType const& cartesians);//F
     virtual scon::mathmatrix<coords::float_type>& Gmat(CartesianType const& cartesians);//F
     virtual scon::mathmatrix<coords::float_type> transposeOfBmat(CartesianType const& cartesian);
     virtual scon::mathmatrix<coords::float_type> pseudoInverseOfGmat(CartesianType const& cartesian);
     virtual scon::mathmatrix<coords::float_type> projectorMatrix(CartesianType const& cartesian);
+    /**B * v without forming the dense B-matrix (v is a column vector of cartesian components)*/
+    virtual scon::mathmatrix<coords::float_type> BmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v);
+    /**B^T * v without forming the dense B-matrix (v is a column vector of internal coordinates)*/
+    virtual scon::mathmatrix<coords::float_type> transposeOfBmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v);
 
   };
 
@@ -97,6 +138,13 @@ namespace internals {
   private:
     void takeCartesianStep(scon::mathmatrix<coords::float_type>&& d_cart);
     void takeCartesianStep(scon::mathmatrix <coords::float_type>&& cartesianChange, InternalCoordinates::temporaryCartesian& cartesians) const;
+    /**
+    * Cartesian step that solves B * dx = internalStep in the least-squares sense by CGLS with the sparse B-matrix
+    * (same as B^T * G^-1 * internalStep but without the pseudo-inverse of G)
+    * @param previousStep: cartesian step of the last micro-iteration, used as starting guess and replaced by the new step
+    */
+    scon::mathmatrix<coords::float_type> iterativeCartesianStep(scon::mathmatrix<coords::float_type> const& internalStep,
+      CartesianType const& cartesians, scon::mathmatrix<coords::float_type>& previousStep) const;
   };
 
   class RandomNumberForHessianAlteration {
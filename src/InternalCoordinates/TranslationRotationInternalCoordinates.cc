@@ -15,7 +15,7 @@ namespace internals {
     using Mat = scon::mathmatrix<coords::float_type>;
 
     Mat eigval, eigvec;
-    std::tie(eigval, eigvec) = PrimitiveInternalCoordinates::Gmat(cartesians).eigensym(false);
+    std::tie(eigval, eigvec) = sparseBmat(cartesians).timesTransposed().eigensym(false);
 
     auto row_index_vec = eigval.sort_idx();
     auto col_index_vec = eigval.find_idx([](coords::float_type const& a) {
@@ -29,12 +29,10 @@ namespace internals {
 
 
   scon::mathmatrix<coords::float_type>& TRIC::Bmat(CartesianType const& cartesians) {
-    //TODO activate it again!!!!!
-    /*if (!new_B_matrix) {
-      return B_matrix;
-    }*/
-    *B_matrix = del_mat->t() * PrimitiveInternalCoordinates::Bmat(cartesians);
-    new_B_matrix = false;
+    if (reuseCached(new_B_matrix, B_cartesians, cartesians)) {
+      return *B_matrix;
+    }
+    *B_matrix = sparseBmat(cartesians).leftMultiplied(*del_mat);
     return *B_matrix;
   }
 
@@ -46,14 +44,24 @@ namespace internals {
     return Gmat(cartesian).pinv();
   }
 
+  std::size_t TRIC::numberOfInternals() const {
+    return del_mat->cols();
+  }
+
+  scon::mathmatrix<coords::float_type> TRIC::BmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) {
+    return del_mat->t() * sparseBmat(cartesian).times(v);
+  }
+
+  scon::mathmatrix<coords::float_type> TRIC::transposeOfBmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) {
+    return sparseBmat(cartesian).transposedTimes(*del_mat * v);
+  }
+
   scon::mathmatrix<coords::float_type>& TRIC::Gmat(CartesianType const& cartesians) {
-    //TODO activate it again!!!!!
-    /*if (!new_G_matrix) {
-      return G_matrix;
-    }*/
-    Bmat(cartesians);
-    *G_matrix = *B_matrix * B_matrix->t();
-    new_G_matrix = false;
+    if (reuseCached(new_G_matrix, G_cartesians, cartesians)) {
+      return *G_matrix;
+    }
+    auto const& B = Bmat(cartesians);
+    *G_matrix = B * B.t();
     return *G_matrix;
   }
 
@@ -61,6 +69,18 @@ namespace internals {
     return del_mat->t() * PrimitiveInternalCoordinates::guess_hessian(cartesians) * (*del_mat);
   }
 
+  scon::mathmatrix<coords::float_type> TRIC::diagonalOfHessianGuess(CartesianType const& cartesians) const {
+    // diagonal of U^T * H * U for the diagonal primitive guess H
+    auto const primitiveDiagonal = PrimitiveInternalCoordinates::diagonalOfHessianGuess(cartesians);
+    auto result = scon::mathmatrix<coords::float_type>::zero(del_mat->cols(), 1u);
+    for (std::size_t k{ 0 }; k < del_mat->cols(); ++k) {
+      for (std::size_t i{ 0 }; i < del_mat->rows(); ++i) {
+        result(k, 0) += (*del_mat)(i, k) * (*del_mat)(i, k) * primitiveDiagonal(i, 0);
+      }
+    }
+    return result;
+  }
+
   scon::mathmatrix<coords::float_type> TRIC::calc(CartesianType const& xyz) const {
     auto prims = PrimitiveInternalCoordinates::calc(xyz);
     return (prims * (*del_mat)).t();
@@ -22,6 +22,10 @@ namespace internals {
     scon::mathmatrix<coords::float_type>& Bmat(CartesianType const& cartesians) override;//F
     scon::mathmatrix<coords::float_type> transposeOfBmat(CartesianType const& cartesian) override;
     scon::mathmatrix<coords::float_type> pseudoInverseOfGmat(CartesianType const& cartesian) override;
+    scon::mathmatrix<coords::float_type> diagonalOfHessianGuess(CartesianType const& cartesians) const override;
+    std::size_t numberOfInternals() const override;
+    scon::mathmatrix<coords::float_type> BmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) override;
+    scon::mathmatrix<coords::float_type> transposeOfBmatTimes(CartesianType const& cartesian, scon::mathmatrix<coords::float_type> const& v) override;
     scon::mathmatrix<coords::float_type>& Gmat(CartesianType const& cartesians) override;//F
     scon::mathmatrix<coords::float_type>& delocalize_ic_system(CartesianType const& cartesians);//F
     scon::mathmatrix<coords::float_type> guess_hessian(CartesianType const& cartesians) const override;
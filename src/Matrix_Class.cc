@@ -15,12 +15,16 @@ namespace matop
   /////////////////////////////////////
 
   Matrix_Class transfer_to_matr(coords::Coordinates const& in)
+  {
+    return transfer_to_matr(in.xyz());
+  }
+
+  Matrix_Class transfer_to_matr(coords::Representation_3D const& in)
   {
     Matrix_Class out_mat(in.size(), 3u);
     for (size_t l = 0; l < in.size(); l++)
     {
-      coords::cartesian_type tempcoord2;
-      tempcoord2 = in.xyz(l);
+      coords::cartesian_type const& tempcoord2 = in[l];
       out_mat(l, 0) = tempcoord2.x();
       out_mat(l, 1) = tempcoord2.y();
       out_mat(l, 2) = tempcoord2.z();
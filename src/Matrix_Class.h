@@ -69,6 +69,7 @@ namespace matop
    * mathmatrix(xyz, atom_nr)
    */
   Matrix_Class transfer_to_matr(coords::Coordinates const& in);
+  Matrix_Class transfer_to_matr(coords::Representation_3D const& in);
 
   /**
    * Converts a coords:Coordinates object to a mathmatrix object
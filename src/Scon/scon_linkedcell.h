@@ -805,6 +805,24 @@ namespace scon
 
     };
 
+    /**decides if linked cells with the given cutoff pay off for the positions
+    (they don't if the positions are spread over a huge empty space, e.g. after dissociation,
+    as the number of cells would exceed the number of positions by far)*/
+    template<class NV3D, class T>
+    bool pay_off(NV3D const& positions, T const cutoff)
+    {
+      using std::floor;
+      if (positions.empty() || !(cutoff > T(0))) return false;
+      auto min_p = positions.front(), max_p = positions.front();
+      for (auto const& p : positions)
+      {
+        min_p = scon::min(min_p, p);
+        max_p = scon::max(max_p, p);
+      }
+      auto const extension((max_p - min_p) / cutoff);
+      double const number_of_cells((floor(extension.x()) + 2.0) * (floor(extension.y()) + 2.0) * (floor(extension.z()) + 2.0));
+      return number_of_cells < 64.0 * static_cast<double>(positions.size());
+    }
 
   }
 
@@ -16,19 +16,15 @@ Purpose: Tests for forcefield (at the moment only OPLSAA)
 #include "../../coords_io.h"
 #include <gtest/gtest.h>
 
-/**the functions defined in this class are protected in base class so they can't be used directly*/
-class ClassToChangeExternalCharges : public energy::interface_base
+namespace
 {
-public:
-  /**function to set external charges*/
-  static void set_external_charges(std::vector<energy::PointCharge> const& new_ext_charges) {
-    interface_base::set_external_charges(new_ext_charges);
+  /**gives some random external charges to an interface, only scaled_charge is used during calculation*/
+  void set_test_external_charges(energy::interface_base* interface)
+  {
+    interface->set_external_charges(std::make_shared<std::vector<energy::PointCharge> const>(
+      std::vector<energy::PointCharge>{ { -4, 5, -2, 0.75, double() }, { 5, -4, 2, 0.5, double() } }));
   }
-  /**function that deletes all external charges*/
-  static void clear_external_charges() {
-    interface_base::clear_external_charges();
-  }
-};
+}
 
 TEST(forcefield, test_total_energy)
 {
@@ -278,13 +274,50 @@ TEST(forcefield, test_torsion_gradients)
   ASSERT_TRUE(is_nearly_equal(expected_grad, calculated_grad, 0.0001));
 }
 
-TEST(forcefield, test_total_energy_with_external_charges)
+TEST(forcefield, test_clones_share_topology)
+{
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+
+  energy::interfaces::aco::aco_ff y(&coords);
+  y.update();  // initialization of interface
+  std::unique_ptr<energy::interface_base> clone(y.clone(&coords));
+  auto& y_clone = dynamic_cast<energy::interfaces::aco::aco_ff&>(*clone);
+
+  ASSERT_EQ(&y.params(), &y_clone.params());
+  ASSERT_TRUE(y.refined.shares_topology(y_clone.refined));
+  ASSERT_DOUBLE_EQ(y.e(), y_clone.e());
+
+  // changing the terms of one clone doesn't change the other one
+  y_clone.refined.set_bonds().clear();
+  ASSERT_FALSE(y.refined.shares_topology(y_clone.refined));
+  ASSERT_EQ(y.refined.bonds().size(), 14);
+  ASSERT_EQ(y_clone.refined.bonds().size(), 0);
+}
+
+TEST(forcefield, test_clear_does_not_change_clones)
 {
-  // setting some random external charges, only scaled_charge is used during calculation
-  ClassToChangeExternalCharges::set_external_charges({ { -4, 5, -2, 0.75, double() }, { 5, -4, 2, 0.5, double() } });
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+
+  energy::interfaces::aco::aco_ff y(&coords);
+  y.update();  // initialization of interface
+  std::unique_ptr<energy::interface_base> clone(y.clone(&coords));
+  auto& y_clone = dynamic_cast<energy::interfaces::aco::aco_ff&>(*clone);
+
+  y_clone.refined.clear();
+  ASSERT_FALSE(y.refined.shares_topology(y_clone.refined));
+  ASSERT_EQ(y.refined.bonds().size(), 14);
+  ASSERT_EQ(y.refined.angles().size(), 25);
+  ASSERT_TRUE(y_clone.refined.bonds().empty());
+  ASSERT_TRUE(y_clone.refined.angles().empty());
+}
 
+TEST(forcefield, test_total_energy_with_external_charges)
+{
   std::unique_ptr<coords::input::format> ci(coords::input::new_format());
   coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+  set_test_external_charges(coords.energyinterface());
 
   tinker::parameter::parameters tp;
   tp.from_file("test_files/oplsaa.prm");
@@ -292,16 +325,13 @@ TEST(forcefield, test_total_energy_with_external_charges)
   double energy = coords.e();
 
   ASSERT_NEAR(energy, 7.3448092340770454, 0.00001);     // just taken from CAST hoping it is correct
-  ClassToChangeExternalCharges::clear_external_charges();
 }
 
 TEST(forcefield, test_total_gradients_with_external_charges)
 {
-  // setting some random external charges, only scaled_charge is used during calculation
-  ClassToChangeExternalCharges::set_external_charges( {{-4, 5, -2, 0.75, double()}, {5, -4, 2, 0.5, double()}});
-
   std::unique_ptr<coords::input::format> ci(coords::input::new_format());
   coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+  set_test_external_charges(coords.energyinterface());
 
   tinker::parameter::parameters tp;
   tp.from_file("test_files/oplsaa.prm");
@@ -329,7 +359,6 @@ TEST(forcefield, test_total_gradients_with_external_charges)
   };
 
   ASSERT_TRUE(is_nearly_equal(expected_grad, coords.g_xyz(), 0.0001));
-  ClassToChangeExternalCharges::clear_external_charges();
 }
 
 TEST(forcefield, test_total_energy_with_external_charges_is_sum)
@@ -343,10 +372,8 @@ TEST(forcefield, test_total_energy_with_external_charges_is_sum)
   double energy_without_extCharges = coords.e();     
   ASSERT_NEAR(energy_without_extCharges, 6.5344, 0.0001);     // from tinker, see above
 
-  // setting some random external charges, only scaled_charge is used during calculation
-  ClassToChangeExternalCharges::set_external_charges({ {-4, 5, -2, 0.75, double()}, {5, -4, 2, 0.5, double()} });
-
   energy::interfaces::aco::aco_ff y(&coords);
+  set_test_external_charges(&y);
   y.update();  // initialization of interface
   double energy_with_extCharges = y.e();   
   ASSERT_NEAR(energy_with_extCharges, 7.3448092340770454, 0.00001);     // see above
@@ -354,7 +381,6 @@ TEST(forcefield, test_total_energy_with_external_charges_is_sum)
   double energy_extCharges = y.part_energy[energy::interfaces::aco::aco_ff::types::EXTERNAL_CHARGES];
 
   ASSERT_NEAR(energy_without_extCharges + energy_extCharges, energy_with_extCharges, 0.0000000001);
-  ClassToChangeExternalCharges::clear_external_charges();
 }
 
 TEST(forcefield, test_total_gradients_with_external_charges_is_sum)
@@ -369,10 +395,8 @@ TEST(forcefield, test_total_gradients_with_external_charges_is_sum)
   ASSERT_NEAR(energy_without_extCharges, 6.5344, 0.0001);     // from tinker, see above
   auto gradients_without_extCharges = coords.g_xyz();
 
-  // setting some random external charges, only scaled_charge is used during calculation
-  ClassToChangeExternalCharges::set_external_charges({ {-4, 5, -2, 0.75, double()}, {5, -4, 2, 0.5, double()} });
-
   energy::interfaces::aco::aco_ff y(&coords);
+  set_test_external_charges(&y);
   y.update();  // initialization of interface
   double energy_with_extCharges = y.g();
   ASSERT_NEAR(energy_with_extCharges, 7.3448092340770454, 0.00001);     // see above
@@ -381,7 +405,6 @@ TEST(forcefield, test_total_gradients_with_external_charges_is_sum)
   auto gradients_extCharges = y.part_grad[energy::interfaces::aco::aco_ff::types::EXTERNAL_CHARGES];
 
   ASSERT_TRUE(is_nearly_equal(gradients_without_extCharges + gradients_extCharges, gradients_with_extCharges, 0.0000000001));
-  ClassToChangeExternalCharges::clear_external_charges();
 }
 
 #endif
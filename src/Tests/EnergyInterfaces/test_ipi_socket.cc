@@ -0,0 +1,185 @@
+/**
+CAST 3
+Purpose: Tests the i-PI socket server with a small mock client
+         (harmonic potential around the origin, E = 0.5 * k * x^2)
+
+@version 1.0
+*/
+
+#if defined(GOOGLE_MOCK) && !defined(_WIN32)
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../../energy_ipi.h"
+
+namespace
+{
+  /**mock of a program in i-PI driver mode*/
+  class mock_ipi_client
+  {
+  public:
+    explicit mock_ipi_client(double const force_constant) : k(force_constant), fd(-1) {}
+    ~mock_ipi_client() { if (fd >= 0) ::close(fd); }
+
+    /**connects to the socket and answers requests until EXIT is received
+    returns number of calculations*/
+    int run(std::string const& path)
+    {
+      sockaddr_un address;
+      std::memset(&address, 0, sizeof(address));
+      address.sun_family = AF_UNIX;
+      std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+      fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) return -1;
+
+      int calculations = 0;
+      bool initialized = false, have_data = false;
+      double energy = 0.0;
+      std::vector<double> forces;
+      for (;;)
+      {
+        auto const message = receive_header();
+        if (message == "STATUS")
+        {
+          send_header(!initialized ? "NEEDINIT" : (have_data ? "HAVEDATA" : "READY"));
+        }
+        else if (message == "INIT")
+        {
+          std::int32_t bead, length;
+          receive(&bead, sizeof(bead));
+          receive(&length, sizeof(length));
+          std::string init(static_cast<std::size_t>(length), ' ');
+          receive(&init[0], init.size());
+          initialized = true;
+        }
+        else if (message == "POSDATA")
+        {
+          std::array<double, 9> cell, inverse;
+          std::int32_t N;
+          receive(cell.data(), sizeof(double) * 9u);
+          receive(inverse.data(), sizeof(double) * 9u);
+          receive(&N, sizeof(N));
+          std::vector<double> positions(3u * static_cast<std::size_t>(N));
+          receive(positions.data(), sizeof(double) * positions.size());
+          energy = 0.0;
+          forces.resize(positions.size());
+          for (std::size_t i = 0u; i < positions.size(); ++i)
+          {
+            energy += 0.5 * k * positions[i] * positions[i];
+            forces[i] = -k * positions[i];
+          }
+          have_data = true;
+          ++calculations;
+        }
+        else if (message == "GETFORCE")
+        {
+          send_header("FORCEREADY");
+          std::int32_t const N = static_cast<std::int32_t>(forces.size() / 3u), extra = 0;
+          std::array<double, 9> const virial{};
+          send(&energy, sizeof(energy));
+          send(&N, sizeof(N));
+          send(forces.data(), sizeof(double) * forces.size());
+          send(virial.data(), sizeof(double) * 9u);
+          send(&extra, sizeof(extra));
+          have_data = false;
+        }
+        else return calculations;   // EXIT or lost connection
+      }
+    }
+
+  private:
+    void send(void const* data, std::size_t const n) { ::send(fd, data, n, 0); }
+    void receive(void* data, std::size_t const n)
+    {
+      auto* bytes = static_cast<char*>(data);
+      std::size_t received = 0u;
+      while (received < n)
+      {
+        auto const res = ::recv(fd, bytes + received, n - received, 0);
+        if (res <= 0) { std::memset(bytes, 0, n); return; }
+        received += static_cast<std::size_t>(res);
+      }
+    }
+    void send_header(std::string message)
+    {
+      message.resize(energy::ipi_server::header_length, ' ');
+      send(message.data(), message.size());
+    }
+    std::string receive_header()
+    {
+      std::string header(energy::ipi_server::header_length, '\0');
+      receive(&header[0], header.size());
+      auto const end = header.find_first_of(" \0", 0, 2);
+      return header.substr(0, end);
+    }
+
+    double k;
+    int fd;
+  };
+}
+
+TEST(ipi_socket, energiesAndForcesOfMockClient)
+{
+  int calculations = 0;
+  std::thread client_thread;
+  {
+    energy::ipi_server server("cast_test_" + std::to_string(::getpid()));
+    client_thread = std::thread([&calculations, &server]() {
+      mock_ipi_client client(2.0);
+      calculations = client.run(server.socket_path());
+    });
+    server.wait_for_client(10.0);
+    ASSERT_TRUE(server.connected());
+
+    std::array<double, 9> const cell = { 20.0, 0.0, 0.0, 0.0, 20.0, 0.0, 0.0, 0.0, 20.0 };
+    std::vector<double> forces;
+    std::vector<double> positions = { 1.0, 0.0, 0.0, 0.0, -2.0, 0.5 };
+    EXPECT_DOUBLE_EQ(server.calculate(positions, cell, forces), 0.5 * 2.0 * (1.0 + 4.0 + 0.25));
+    ASSERT_EQ(forces.size(), 6u);
+    EXPECT_DOUBLE_EQ(forces[0], -2.0);
+    EXPECT_DOUBLE_EQ(forces[4], 4.0);
+    EXPECT_DOUBLE_EQ(forces[5], -1.0);
+
+    // second step with the same (still running) client
+    positions = { 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+    EXPECT_DOUBLE_EQ(server.calculate(positions, cell, forces), 1.0);
+    EXPECT_DOUBLE_EQ(forces[5], -2.0);
+  }   // server sends EXIT
+  client_thread.join();
+  EXPECT_EQ(calculations, 2);
+}
+
+TEST(ipi_socket, timeoutIfNoClientConnects)
+{
+  energy::ipi_server server("cast_test_timeout_" + std::to_string(::getpid()));
+  EXPECT_THROW(server.wait_for_client(0.1), std::runtime_error);
+  EXPECT_FALSE(server.connected());
+}
+
+TEST(ipi_socket, clientProcessIsTerminatedAndReaped)
+{
+  int pid = -1;
+  {
+    energy::ipi_client_process client("sleep 60");   // client that never connects
+    pid = client.pid();
+    ASSERT_GT(pid, 0);
+    EXPECT_TRUE(client.running());
+  }   // destructor kills the process group
+  EXPECT_NE(::kill(pid, 0), 0);   // no zombie left either
+
+  energy::ipi_client_process finished("exit 0");
+  finished.terminate(5.0);   // exits by itself within the grace time
+  EXPECT_FALSE(finished.running());
+  EXPECT_EQ(finished.pid(), -1);
+}
+
+#endif
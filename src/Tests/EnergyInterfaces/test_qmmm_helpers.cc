@@ -12,6 +12,10 @@ Purpose: Tests stuff for QM/MM interfaces
 #include "../../qmmm_helperfunctions.h"
 #include "../../energy_int_aco.h"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
 
 // tests use the test system butanol.arc
 
@@ -268,4 +272,196 @@ TEST(qmmm, test_add_external_charges_onlySE)
   ASSERT_EQ(result.size(), 2);  // only charges for SE atoms (7 and 8)
 }
 
+TEST(qmmm, test_external_charges_drop_far_charges)
+{
+  Config::set().energy.qmmm.zerocharge_bonds = 1;    // default
+
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+
+  tinker::parameter::parameters tp;
+  tp.from_file("test_files/oplsaa.prm");
+
+  std::vector<size_t> qm_indizes = { 5,8,9,10,11,12,13,14 };
+  auto linkatoms = energy::interfaces::qmmm::create_link_atoms(qm_indizes, &coords, tp, { 85 });
+
+  auto charges = coords.energyinterface()->charges();
+  std::vector<size_t> all_indizes = range(coords.size());
+  energy::interfaces::qmmm::ExternalCharges external_charges(qm_indizes, all_indizes, linkatoms, &coords);
+  ASSERT_EQ(external_charges.size(), 6);
+
+  Config::set().energy.qmmm.cutoff = 3.0;
+  std::vector<int> result;
+  std::vector<energy::PointCharge> point_charges;
+  external_charges.add(charges, result, &coords, 8, point_charges);
+  ASSERT_EQ(result.size(), 6);    // charges outside of cutoff are zero
+  ASSERT_EQ(point_charges.size(), 6);
+
+  Config::set().energy.qmmm.drop_far_charges = true;
+  result.clear();
+  point_charges.clear();
+  external_charges.add(charges, result, &coords, 8, point_charges);
+  ASSERT_EQ(result.size(), 2);    // only atoms 5 and 8 are nearer than 3 angstrom to QM center
+  ASSERT_EQ(point_charges.size(), 2);
+
+  Config::set().energy.qmmm.drop_far_charges = false;
+  Config::set().energy.qmmm.cutoff = std::numeric_limits<double>::max();
+}
+
+TEST(qmmm, test_gradients_of_frozen_coulomb)
+{
+  Config::set().energy.qmmm.zerocharge_bonds = 1;    // default
+
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+
+  tinker::parameter::parameters tp;
+  tp.from_file("test_files/oplsaa.prm");
+
+  std::vector<size_t> qm_indizes = { 5,8,9,10,11,12,13,14 };
+  std::vector<double> qm_charges = { -0.6, 0.4, 0.1, -0.2, 0.05, 0.05, 0.1, 0.1 };
+  auto linkatoms = energy::interfaces::qmmm::create_link_atoms(qm_indizes, &coords, tp, { 85 });
+
+  auto charges = coords.energyinterface()->charges();
+  std::vector<size_t> all_indizes = range(coords.size());
+  energy::interfaces::qmmm::ExternalCharges external_charges(qm_indizes, all_indizes, linkatoms, &coords);
+
+  auto frozen_coulomb = [&](coords::Gradients_3D* gradients)
+  {
+    std::vector<int> charge_indizes;
+    std::vector<energy::PointCharge> point_charges;
+    external_charges.add(charges, charge_indizes, &coords, 8, point_charges);
+    return energy::interfaces::qmmm::frozen_coulomb(point_charges, charge_indizes, qm_indizes, qm_charges, &coords, 8, gradients);
+  };
+
+  for (double cutoff : { std::numeric_limits<double>::max(), 5.0 })   // without and with switching function
+  {
+    Config::set().energy.qmmm.cutoff = cutoff;
+
+    coords::Gradients_3D analytic(coords.size());
+    double const energy = frozen_coulomb(&analytic);
+    ASSERT_NE(energy, 0.0);
+    ASSERT_DOUBLE_EQ(frozen_coulomb(nullptr), energy);
+
+    double const h = 1e-5;
+    for (std::size_t i = 0u; i < coords.size(); ++i)
+    {
+      auto const original = coords.xyz(i);
+      std::vector<double> numerical;
+      for (auto const& shift : { coords::r3(h, 0.0, 0.0), coords::r3(0.0, h, 0.0), coords::r3(0.0, 0.0, h) })
+      {
+        coords.move_atom_to(i, original + shift, true);
+        double const e_plus = frozen_coulomb(nullptr);
+        coords.move_atom_to(i, original - shift, true);
+        double const e_minus = frozen_coulomb(nullptr);
+        coords.move_atom_to(i, original, true);
+        numerical.push_back((e_plus - e_minus) / (2.0 * h));
+      }
+      EXPECT_NEAR(analytic[i].x(), numerical[0], 1e-5);
+      EXPECT_NEAR(analytic[i].y(), numerical[1], 1e-5);
+      EXPECT_NEAR(analytic[i].z(), numerical[2], 1e-5);
+    }
+  }
+  Config::set().energy.qmmm.cutoff = std::numeric_limits<double>::max();
+}
+
+TEST(qmmm, test_find_mm_atoms_near_qm)
+{
+  coords::Representation_3D xyz;
+  xyz.emplace_back(0.0, 0.0, 0.0);    // QM atoms
+  xyz.emplace_back(1.5, 0.0, 0.0);
+  xyz.emplace_back(-4.0, 0.0, 0.0);   // MM atom within cutoff of first QM atom
+  xyz.emplace_back(6.0, 0.0, 0.0);    // MM atom within cutoff of second QM atom
+  xyz.emplace_back(1.0, 5.1, 0.0);    // MM atom just outside of cutoff
+  xyz.emplace_back(20.0, 20.0, 20.0); // MM atom far away
+  xyz.emplace_back(0.0, -3.0, 4.0);   // MM atom exactly at cutoff
+
+  std::vector<std::size_t> qm_indizes = { 0, 1 };
+  std::vector<std::size_t> mm_indizes = { 2, 3, 4, 5, 6 };
+
+  auto result = energy::interfaces::qmmm::find_mm_atoms_near_qm(qm_indizes, mm_indizes, xyz, 5.0);
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(result[0], 0);
+  EXPECT_EQ(result[1], 1);
+  EXPECT_EQ(result[2], 4);
+}
+
+
+TEST(qmmm, test_background_job_runs_concurrently)
+{
+  // the job can only finish if the calling thread goes on while it is running (as the QM programme does)
+  std::promise<void> qm_started;
+  auto qm_future = qm_started.get_future();
+  auto job = energy::interfaces::qmmm::run_in_background([&qm_future]() {
+    return qm_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+  });
+  qm_started.set_value();
+  EXPECT_TRUE(job.get());
+}
+
+TEST(qmmm, test_background_job_failure)
+{
+  auto failing = energy::interfaces::qmmm::run_in_background([]() -> bool { throw std::runtime_error("MM programme crashed"); });
+  EXPECT_FALSE(failing.get());
+  auto no_energy = energy::interfaces::qmmm::run_in_background([]() { return false; });
+  EXPECT_FALSE(no_energy.get());
+}
+
+TEST(qmmm, test_background_job_sees_local_scope)
+{
+  auto const cycles = Config::get().energy.qmmm.maxCycles;
+  std::size_t seen{ 0u };
+  {
+    Config::local_scope scope;   // e.g. microiterations
+    Config::set().energy.qmmm.maxCycles = cycles + 5u;
+    auto job = energy::interfaces::qmmm::run_in_background([&seen]() {
+      seen = Config::get().energy.qmmm.maxCycles;
+      return true;
+    });
+    EXPECT_TRUE(job.get());
+  }
+  EXPECT_EQ(seen, cycles + 5u);
+}
+
+TEST(qmmm, test_concurrent_mm_calculation_without_external_charges)
+{
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates qm_coords(ci->read("test_files/butanol.arc"));
+  coords::Coordinates mm_coords(qm_coords);
+
+  energy::interfaces::aco::aco_ff qm(&qm_coords);   // stands for the QM programme that gets the embedding charges
+  energy::interfaces::aco::aco_ff mm(&mm_coords);
+  qm.update();
+  mm.update();
+
+  auto point_charges = std::make_shared<std::vector<energy::PointCharge>>(1u);
+  point_charges->front().set_xyz(3.0, 3.0, 3.0);
+  point_charges->front().scaled_charge = point_charges->front().original_charge = 1.0;
+  qm.set_external_charges(point_charges);
+
+  // one after the other
+  double const qm_reference = qm.g();
+  double const mm_reference = mm.g();
+  auto const mm_gradients_reference = mm_coords.g_xyz();
+  ASSERT_NE(qm_reference, mm_reference);   // the charges make a difference
+
+  // MM calculation in a second thread while the "QM" calculation runs
+  double mm_energy{ 0.0 };
+  auto job = energy::interfaces::qmmm::run_in_background([&mm, &mm_energy]() {
+    mm_energy = mm.g();
+    return true;
+  });
+  double const qm_energy = qm.g();
+  ASSERT_TRUE(job.get());
+
+  EXPECT_DOUBLE_EQ(qm_energy, qm_reference);
+  EXPECT_DOUBLE_EQ(mm_energy, mm_reference);
+  for (std::size_t i = 0u; i < mm_coords.size(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(mm_coords.g_xyz(i).x(), mm_gradients_reference[i].x());
+    EXPECT_DOUBLE_EQ(mm_coords.g_xyz(i).y(), mm_gradients_reference[i].y());
+    EXPECT_DOUBLE_EQ(mm_coords.g_xyz(i).z(), mm_gradients_reference[i].z());
+  }
+}
+
 #endif
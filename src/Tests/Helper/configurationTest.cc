@@ -13,6 +13,7 @@ Purpose: Tests functions in configuration.cc
 #include "../../configuration.h"
 #include "../../configurationHelperfunctions.h"
 #include <gtest/gtest.h>
+#include <thread>
 
 TEST(sorted_indices_from_cs_string, withProperInput)
 {
@@ -161,4 +162,81 @@ TEST(ints_from_string, emtpyFieldThrowsError)
   ASSERT_THROW(config::doubles_from_string(input), std::runtime_error);
 }
 
+TEST(config_local_scope, changesAreDiscardedAtEndOfScope)
+{
+  auto const steps = Config::get().md.num_steps;
+  {
+    Config::local_scope scope;
+    Config::set().md.num_steps = steps + 10u;
+    EXPECT_EQ(Config::get().md.num_steps, steps + 10u);
+  }
+  EXPECT_EQ(Config::get().md.num_steps, steps);
+}
+
+TEST(config_local_scope, changesAreInvisibleForOtherThreads)
+{
+  bool const periodic = Config::get().periodics.periodic;
+  auto const snapshot = Config::snapshot();
+  bool seen_by_other_thread = !periodic;
+  {
+    Config::local_scope scope(*snapshot);
+    Config::set().periodics.periodic = !periodic;
+    std::thread other([&seen_by_other_thread]() { seen_by_other_thread = Config::get().periodics.periodic; });
+    other.join();
+    EXPECT_EQ(Config::get().periodics.periodic, !periodic);
+  }
+  EXPECT_EQ(seen_by_other_thread, periodic);
+  EXPECT_EQ(snapshot->periodics.periodic, periodic);
+}
+
+TEST(config_local_scope, workerScopeMakesScopedValueVisibleInParallelRegion)
+{
+  auto const steps = Config::get().md.num_steps;
+  std::size_t scoped_in_workers(0u), scoped_without_worker_scope(0u), threads(0u);
+  {
+    Config::local_scope scope;
+    Config::set().md.num_steps = steps + 10u;
+    Config const& active_config = Config::get();
+#pragma omp parallel num_threads(4) reduction(+: scoped_in_workers, scoped_without_worker_scope, threads)
+    {
+      threads += 1u;
+      if (Config::get().md.num_steps == steps + 10u) scoped_without_worker_scope += 1u;
+      Config::worker_scope config_scope(active_config);
+      if (Config::get().md.num_steps == steps + 10u) scoped_in_workers += 1u;
+    }
+  }
+  EXPECT_EQ(scoped_in_workers, threads);
+  EXPECT_EQ(scoped_without_worker_scope, 1u);   // only the thread that created the local_scope
+  EXPECT_EQ(Config::get().md.num_steps, steps);
+}
+
+TEST(config_affects_energy, taskOptionsAreNotPartOfTheCacheKey)
+{
+  for (auto const& option : { "name", "outname", "verbosity", "task", "outputtype", "PROFILEuse", "CACHEsize",
+    "QMSCRATCHuse", "QMGUESSuse", "OPTimizer", "OPT++maxIter", "OPTconstraint_dihedrals", "MDsteps", "MDtimestep",
+    "NEB-PATHOPT-IMAGES", "NEB-PATHOPT-NEB-IDPP", "DIMERmaxit", "SOtype", "Temperature", "SAopt", "GOerange",
+    "RSpopulation", "TSmc_first", "MCstep_size", "US_xi0", "USuse", "pca_ref_frame_num", "entropy_method",
+    "traj_align_translational", "proc_desired_start", "amber_mdcrd" })
+  {
+    EXPECT_FALSE(config::affects_energy(option)) << option;
+  }
+}
+
+TEST(config_affects_energy, newOptionsOfTaskSectionsAreCovered)
+{
+  EXPECT_FALSE(config::affects_energy("MDnew_option"));
+  EXPECT_FALSE(config::affects_energy("OPTnew_option"));
+  EXPECT_FALSE(config::affects_energy("NEB-PATHOPT-NEW"));
+}
+
+TEST(config_affects_energy, energyOptionsArePartOfTheCacheKey)
+{
+  for (auto const& option : { "interface", "paramfile", "cutoff", "Periodics", "Spackman", "QMMMcutoff",
+    "QMMMqmatoms", "ORCAmethod", "GAUSSIANmethod", "MOPACkey", "DFTB+path", "PSI4-method", "FIXrange", "FIXexclude", "BIASdist",
+    "unknown_option" })
+  {
+    EXPECT_TRUE(config::affects_energy(option)) << option;
+  }
+}
+
 #endif
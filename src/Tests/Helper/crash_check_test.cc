@@ -0,0 +1,120 @@
+/**
+CAST 3
+Purpose: Tests the search for crashing atoms and broken bonds in a box of water molecules
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include "../../coords.h"
+
+namespace
+{
+  using pair_list = std::vector<std::pair<std::size_t, std::size_t>>;
+
+  std::size_t constexpr waters_per_edge = 6u;
+  double constexpr spacing = 3.0;
+
+  /**n*n*n water molecules on a grid (O, H, H for every molecule),
+  big enough that crashes are searched with linked cells*/
+  coords::Coordinates waterBox()
+  {
+    coords::Atoms atoms;
+    coords::Representation_3D xyz;
+    for (std::size_t i = 0u; i < waters_per_edge * waters_per_edge * waters_per_edge; ++i)
+    {
+      coords::Cartesian_Point const O(spacing * double(i / (waters_per_edge * waters_per_edge)),
+        spacing * double((i / waters_per_edge) % waters_per_edge), spacing * double(i % waters_per_edge));
+      xyz.push_back(O);
+      xyz.push_back(O + coords::Cartesian_Point(0.96, 0.0, 0.0));
+      xyz.push_back(O + coords::Cartesian_Point(-0.24, 0.93, 0.0));
+
+      coords::Atom oxygen("O"), hydrogen1("H"), hydrogen2("H");
+      oxygen.bind_to(3u * i + 1u);
+      oxygen.bind_to(3u * i + 2u);
+      hydrogen1.bind_to(3u * i);
+      hydrogen2.bind_to(3u * i);
+      atoms.add(oxygen);
+      atoms.add(hydrogen1);
+      atoms.add(hydrogen2);
+    }
+    coords::PES_Point pes(xyz);
+    coords::Coordinates coords;
+    coords.init_swap_in(atoms, pes, false);
+    return coords;
+  }
+
+  /**index of oxygen of water molecule (ix, iy, iz)*/
+  std::size_t oxygen(std::size_t const ix, std::size_t const iy, std::size_t const iz)
+  {
+    return 3u * ((ix * waters_per_edge + iy) * waters_per_edge + iz);
+  }
+
+  /**moves first hydrogen of molecule (2, 3, 1) close to the oxygen of its neighbour in x direction*/
+  std::pair<std::size_t, std::size_t> createCrash(coords::Coordinates& coords)
+  {
+    auto const H = oxygen(2u, 3u, 1u) + 1u;
+    auto const O = oxygen(3u, 3u, 1u);
+    coords.move_atom_to(H, coords.xyz(O) - coords::Cartesian_Point(0.5, 0.0, 0.0));
+    return { O, H };
+  }
+
+  /**moves a whole water molecule far away, so that crashes are searched without linked cells*/
+  void moveFirstMoleculeAway(coords::Coordinates& coords)
+  {
+    coords::Cartesian_Point const shift(1.e4, 0.0, 0.0);
+    for (std::size_t i = 0u; i < 3u; ++i) coords.move_atom_to(i, coords.xyz(i) + shift);
+  }
+}
+
+TEST(crash_check, intactWaterBoxHasNoCrashesOrBrokenBonds)
+{
+  auto coords = waterBox();
+  EXPECT_TRUE(coords.find_crashes().empty());
+  EXPECT_TRUE(coords.find_broken_bonds().empty());
+  EXPECT_TRUE(coords.check_for_crashes());
+  EXPECT_TRUE(coords.check_bond_preservation());
+}
+
+TEST(crash_check, findsCrashBetweenMoleculesWithLinkedCells)
+{
+  auto coords = waterBox();
+  auto const crash = createCrash(coords);
+  EXPECT_EQ(coords.find_crashes(), pair_list{ crash });
+  EXPECT_EQ(coords.find_crashes(true), pair_list{ crash });
+  EXPECT_FALSE(coords.check_for_crashes());
+}
+
+TEST(crash_check, findsSameCrashWithoutLinkedCells)
+{
+  auto coords = waterBox();
+  moveFirstMoleculeAway(coords);
+  EXPECT_TRUE(coords.find_crashes().empty());
+  auto const crash = createCrash(coords);
+  EXPECT_EQ(coords.find_crashes(), pair_list{ crash });
+}
+
+TEST(crash_check, findsStretchedBond)
+{
+  auto coords = waterBox();
+  auto const O = oxygen(4u, 1u, 5u);
+  coords.move_atom_to(O + 2u, coords.xyz(O) + coords::Cartesian_Point(0.0, 0.0, 1.5));
+  EXPECT_EQ(coords.find_broken_bonds(), (pair_list{ { O + 2u, O } }));
+  EXPECT_FALSE(coords.check_bond_preservation());
+  EXPECT_TRUE(coords.find_crashes().empty());
+}
+
+TEST(crash_check, stopAtFirstReturnsSmallestPair)
+{
+  auto coords = waterBox();
+  auto const crash = createCrash(coords);   // also stretches the bond of the moved hydrogen
+  auto const O = oxygen(1u, 0u, 2u);
+  coords.move_atom_to(O + 2u, coords.xyz(O) + coords::Cartesian_Point(0.0, 0.0, 1.5));
+  pair_list const broken_bonds{ { O + 2u, O }, { crash.second, crash.second - 1u } };
+  EXPECT_EQ(coords.find_broken_bonds(), broken_bonds);
+  EXPECT_EQ(coords.find_broken_bonds(true), pair_list{ broken_bonds.front() });
+}
+
+#endif
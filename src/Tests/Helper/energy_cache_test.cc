@@ -0,0 +1,133 @@
+/**
+CAST 3
+Purpose: Tests the cache for results of energy interfaces (memory and file)
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "../../configuration.h"
+#include "../../energy_cache.h"
+
+namespace
+{
+  energy::cache_entry make_entry(double const x, double const e)
+  {
+    coords::Representation_3D xyz = { coords::Cartesian_Point(x, 0.0, 0.0), coords::Cartesian_Point(0.0, 1.0, 0.0) };
+    energy::cache_entry entry;
+    entry.geometry = energy::evaluation_cache::quantize(xyz);
+    entry.energy = e;
+    entry.has_gradients = true;
+    entry.gradients = { coords::Cartesian_Point(e, 0.0, 0.0), coords::Cartesian_Point(0.0, e, 0.0) };
+    entry.charges = { 0.5, -0.5 };
+    return entry;
+  }
+
+  std::uint64_t key_of(energy::cache_entry const& entry)
+  {
+    auto const& g = entry.geometry;
+    return energy::evaluation_cache::hash(energy::evaluation_cache::hash_seed, g.data(), sizeof(std::int64_t) * g.size());
+  }
+}
+
+TEST(evaluation_cache, findsStoredResultsAndCountsHits)
+{
+  auto& cache = energy::evaluation_cache::get();
+  cache.reset();
+  auto const entry = make_entry(1.0, -10.0);
+  energy::cache_entry result;
+  EXPECT_FALSE(cache.find(key_of(entry), entry.geometry, false, result));
+  cache.insert(key_of(entry), entry);
+  ASSERT_TRUE(cache.find(key_of(entry), entry.geometry, true, result));
+  EXPECT_DOUBLE_EQ(result.energy, -10.0);
+  ASSERT_EQ(result.gradients.size(), 2u);
+  EXPECT_DOUBLE_EQ(result.gradients[1].y(), -10.0);
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(cache.misses(), 1u);
+
+  // same key but other geometry (hash collision) must not be found
+  auto const other = make_entry(2.0, -20.0);
+  EXPECT_FALSE(cache.find(key_of(entry), other.geometry, false, result));
+  cache.reset();
+}
+
+TEST(evaluation_cache, energyOnlyResultsDoNotServeGradients)
+{
+  auto& cache = energy::evaluation_cache::get();
+  cache.reset();
+  auto entry = make_entry(1.0, -10.0);
+  entry.has_gradients = false;
+  entry.gradients.clear();
+  cache.insert(key_of(entry), entry);
+  energy::cache_entry result;
+  EXPECT_TRUE(cache.find(key_of(entry), entry.geometry, false, result));
+  EXPECT_FALSE(cache.find(key_of(entry), entry.geometry, true, result));
+  cache.reset();
+}
+
+TEST(evaluation_cache, failedCalculationsAreNotStored)
+{
+  std::string const filename = "cast_test_energy_cache_failed.bin";
+  std::remove(filename.c_str());
+  auto& cache = energy::evaluation_cache::get();
+  cache.reset();
+  auto entry = make_entry(1.0, 0.0);
+  entry.integrity = false;
+  cache.open(filename);
+  cache.insert(key_of(entry), entry);
+  EXPECT_EQ(cache.size(), 0u);
+  cache.reset();
+
+  energy::cache_entry result;
+  cache.open(filename);
+  EXPECT_FALSE(cache.find(key_of(entry), entry.geometry, false, result));
+  cache.reset();
+  std::remove(filename.c_str());
+}
+
+TEST(evaluation_cache, leastRecentlyUsedResultsAreRemoved)
+{
+  auto& cache = energy::evaluation_cache::get();
+  cache.reset();
+  Config::set().energy.cache.size = 2u;
+  auto const a = make_entry(1.0, -1.0), b = make_entry(2.0, -2.0), c = make_entry(3.0, -3.0);
+  energy::cache_entry result;
+  cache.insert(key_of(a), a);
+  cache.insert(key_of(b), b);
+  EXPECT_TRUE(cache.find(key_of(a), a.geometry, false, result));   // a is now more recent than b
+  cache.insert(key_of(c), c);
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_TRUE(cache.find(key_of(a), a.geometry, false, result));
+  EXPECT_FALSE(cache.find(key_of(b), b.geometry, false, result));
+  EXPECT_TRUE(cache.find(key_of(c), c.geometry, false, result));
+  Config::set().energy.cache.size = 1000u;
+  cache.reset();
+}
+
+TEST(evaluation_cache, resultsSurviveRestartViaFile)
+{
+  std::string const filename = "cast_test_energy_cache.bin";
+  std::remove(filename.c_str());
+  auto& cache = energy::evaluation_cache::get();
+  cache.reset();
+  auto const entry = make_entry(1.5, -15.0);
+  cache.open(filename);
+  cache.insert(key_of(entry), entry);
+  cache.reset();   // "restart"
+
+  energy::cache_entry result;
+  EXPECT_FALSE(cache.find(key_of(entry), entry.geometry, false, result));
+  cache.open(filename);
+  ASSERT_TRUE(cache.find(key_of(entry), entry.geometry, true, result));
+  EXPECT_DOUBLE_EQ(result.energy, -15.0);
+  EXPECT_DOUBLE_EQ(result.gradients[0].x(), -15.0);
+  ASSERT_EQ(result.charges.size(), 2u);
+  EXPECT_DOUBLE_EQ(result.charges[1], -0.5);
+  cache.reset();
+  std::remove(filename.c_str());
+}
+
+#endif
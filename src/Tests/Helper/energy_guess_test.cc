@@ -0,0 +1,84 @@
+/**
+CAST 3
+Purpose: Tests the decision whether the last wavefunction / density is used as initial guess
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "../../configuration.h"
+#include "../../energy_guess.h"
+
+namespace
+{
+  std::string const guess_file = "cast_test_guess.gbw";
+
+  coords::Representation_3D geometry(double const shift)
+  {
+    return { coords::Cartesian_Point(0.0, 0.0, 0.0), coords::Cartesian_Point(1.0 + shift, 0.0, 0.0) };
+  }
+}
+
+TEST(scf_guess, onlyUsedForSmallDisplacements)
+{
+  Config::set().energy.guess.use = true;
+  Config::set().energy.guess.threshold = 0.5;
+  std::ofstream(guess_file) << "orbitals\n";
+
+  energy::scf_guess guess;
+  EXPECT_FALSE(guess.request(geometry(0.0), guess_file));   // no calculation so far
+  guess.store(geometry(0.0), guess_file);
+  EXPECT_TRUE(guess.request(geometry(0.3), guess_file));
+  EXPECT_TRUE(guess.in_use());
+  EXPECT_FALSE(guess.request(geometry(0.7), guess_file));
+  EXPECT_FALSE(guess.in_use());
+  EXPECT_FALSE(guess.request(geometry(0.3), "not_existing_file.gbw"));
+
+  guess.invalidate();   // e.g. SCF failure
+  EXPECT_FALSE(guess.request(geometry(0.0), guess_file));
+
+  std::remove(guess_file.c_str());
+  Config::set().energy.guess.use = false;
+}
+
+TEST(scf_guess, neverUsedIfSwitchedOff)
+{
+  Config::set().energy.guess.use = false;
+  std::ofstream(guess_file) << "orbitals\n";
+  energy::scf_guess guess;
+  guess.store(geometry(0.0), guess_file);
+  EXPECT_FALSE(guess.request(geometry(0.0), guess_file));
+  std::remove(guess_file.c_str());
+}
+
+TEST(scf_guess, notSharedBetweenInstances)
+{
+  Config::set().energy.guess.use = true;
+  Config::set().energy.guess.threshold = 0.5;
+  std::ofstream(guess_file) << "orbitals\n";
+
+  // two interfaces with the same number of atoms writing into the same file (no scratch directories)
+  energy::scf_guess first, second;
+  first.store(geometry(0.0), guess_file);
+  EXPECT_FALSE(second.request(geometry(0.0), guess_file));   // result of the other system
+  second.store(geometry(0.1), guess_file);
+  EXPECT_FALSE(first.request(geometry(0.0), guess_file));    // file was overwritten by the other system
+  EXPECT_TRUE(second.request(geometry(0.1), guess_file));
+
+  energy::scf_guess copy(second);   // e.g. cloned interface
+  EXPECT_FALSE(copy.request(geometry(0.1), guess_file));
+
+  std::remove(guess_file.c_str());
+  Config::set().energy.guess.use = false;
+}
+
+TEST(scf_guess, maximumDisplacement)
+{
+  EXPECT_DOUBLE_EQ(energy::scf_guess::max_displacement(geometry(0.0), geometry(0.25)), 0.25);
+}
+
+#endif
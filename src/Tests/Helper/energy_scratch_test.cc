@@ -0,0 +1,73 @@
+/**
+CAST 3
+Purpose: Tests scratch directories of interfaces that call external programs
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include "../../configuration.h"
+#include "../../energy_scratch.h"
+#include "../../helperfunctions.h"
+
+TEST(scratch_directory, filenamesAreUnchangedIfSwitchedOff)
+{
+  Config::set().energy.scratch.use = false;
+  energy::scratch_directory scratch("test");
+  EXPECT_FALSE(scratch.active());
+  EXPECT_EQ(scratch.path("orca.inp"), "orca.inp");
+  EXPECT_EQ(scratch.command("orca orca.inp"), "orca orca.inp");
+  EXPECT_EQ(scratch.resolve("skfiles/"), "skfiles/");
+}
+
+TEST(scratch_directory, copiesGetOwnDirectoriesThatAreRemoved)
+{
+  Config::set().energy.scratch.use = true;
+  Config::set().energy.scratch.cleanup = config::energy::scratch_conf::cleanup_types::KEEP_FAILED;
+  std::string first_dir, second_dir;
+  {
+    energy::scratch_directory first("test");
+    energy::scratch_directory second(first);
+    ASSERT_TRUE(first.active());
+    ASSERT_TRUE(second.active());
+    first_dir = first.directory();
+    second_dir = second.directory();
+    EXPECT_NE(first_dir, second_dir);
+
+    std::ofstream(first.path("file.txt")) << "content\n";
+    EXPECT_TRUE(file_exists(first.path("file.txt")));
+    EXPECT_FALSE(file_exists(second.path("file.txt")));
+    EXPECT_EQ(second.command("prog"), "cd \"" + second_dir + "\" && prog");
+  }
+  EXPECT_FALSE(file_exists(first_dir + "/file.txt"));
+  Config::set().energy.scratch.use = false;
+}
+
+TEST(scratch_directory, failedJobsAreKept)
+{
+  Config::set().energy.scratch.use = true;
+  Config::set().energy.scratch.cleanup = config::energy::scratch_conf::cleanup_types::KEEP_FAILED;
+  std::string dir;
+  {
+    energy::scratch_directory scratch("test");
+    dir = scratch.directory();
+    std::ofstream(scratch.path("output.txt")) << "error\n";
+    scratch.mark_failed();
+  }
+  EXPECT_TRUE(file_exists(dir + "/output.txt"));
+  Config::set().energy.scratch.cleanup = config::energy::scratch_conf::cleanup_types::ALWAYS;
+  {
+    // a second object with the same directory is not possible, so remove the kept one by hand
+    energy::scratch_directory scratch("test");
+    EXPECT_NE(scratch.directory(), dir);
+  }
+  std::remove((dir + "/output.txt").c_str());
+  std::remove(dir.c_str());
+  Config::set().energy.scratch.use = false;
+  Config::set().energy.scratch.cleanup = config::energy::scratch_conf::cleanup_types::KEEP_FAILED;
+}
+
+#endif
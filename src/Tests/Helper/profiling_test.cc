@@ -0,0 +1,72 @@
+/**
+CAST 3
+Purpose: Tests timers and counters of the profiler
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include "../../configuration.h"
+#include "../../profiling.h"
+
+TEST(profiling, timersAreIgnoredIfProfilingIsOff)
+{
+  Config::set().profiling.use = false;
+  profiling::profiler::get().reset();
+  {
+    profiling::scoped_timer timer("test phase");
+  }
+  profiling::count("test phase");
+  ASSERT_TRUE(profiling::profiler::get().phases().empty());
+}
+
+TEST(profiling, scopedTimerAddsOneCallPerScope)
+{
+  Config::set().profiling.use = true;
+  profiling::profiler::get().reset();
+  for (auto i = 0u; i < 3u; ++i)
+  {
+    profiling::scoped_timer timer("test phase");
+  }
+  profiling::scoped_timer stopped_timer("test phase");
+  stopped_timer.stop();
+  stopped_timer.stop();   // second stop must not add another call
+  auto const phases = profiling::profiler::get().phases();
+  ASSERT_EQ(phases.at("test phase").calls, 4u);
+  EXPECT_GE(phases.at("test phase").total, 0.0);
+  EXPECT_LE(phases.at("test phase").min, phases.at("test phase").max);
+  Config::set().profiling.use = false;
+  profiling::profiler::get().reset();
+}
+
+TEST(profiling, countersAndCsvSummary)
+{
+  Config::set().profiling.use = true;
+  profiling::profiler::get().reset();
+  profiling::count("steps");
+  profiling::count("steps", 4u);
+  profiling::profiler::get().add_time("phase", 2.0);
+  profiling::profiler::get().add_time("phase", 4.0);
+
+  auto const phases = profiling::profiler::get().phases();
+  EXPECT_EQ(phases.at("steps").count, 5u);
+  EXPECT_EQ(phases.at("steps").calls, 0u);
+  EXPECT_DOUBLE_EQ(phases.at("phase").average(), 3.0);
+
+  std::stringstream csv;
+  profiling::profiler::get().write_csv(csv);
+  std::string line;
+  std::getline(csv, line);
+  EXPECT_EQ(line, "name,calls,total,average,min,max,count");
+  std::getline(csv, line);
+  EXPECT_EQ(line, "phase,2,6,3,2,4,0");
+  std::getline(csv, line);
+  EXPECT_EQ(line, "steps,0,0,0,0,0,5");
+  Config::set().profiling.use = false;
+  profiling::profiler::get().reset();
+}
+
+#endif
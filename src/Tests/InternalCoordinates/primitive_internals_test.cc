@@ -258,6 +258,28 @@ TEST_F(MatricesTest, gMatrixTest) {
   gMatrixTest();
 }
 
+TEST_F(MatricesTest, cachedMatricesFollowCartesians) {
+  auto const original = cartesians.getCoordinates();
+  auto moved = original;
+  moved.front().x() += 0.1;
+  cartesians.setCartesianCoordnates(moved);
+  EXPECT_FALSE(testSystem->Bmat(cartesians) == exampleBmatrixForTwoMethanols());
+  EXPECT_FALSE(testSystem->Gmat(cartesians) == exampleGmatrixForTwoMethanols());
+  cartesians.setCartesianCoordnates(original);
+  EXPECT_EQ(testSystem->Bmat(cartesians), exampleBmatrixForTwoMethanols());
+  EXPECT_EQ(testSystem->Gmat(cartesians), exampleGmatrixForTwoMethanols());
+}
+
+TEST_F(MatricesTest, productsWithBmatWithoutDenseMatrix) {
+  auto const& B = exampleBmatrixForTwoMethanols();
+  auto cartesianVector = scon::mathmatrix<coords::float_type>::zero(B.cols(), 1u);
+  for (auto i = 0u; i < B.cols(); ++i) cartesianVector(i, 0) = 0.1 * i - 1.;
+  auto internalVector = scon::mathmatrix<coords::float_type>::zero(B.rows(), 1u);
+  for (auto i = 0u; i < B.rows(); ++i) internalVector(i, 0) = 0.5 - 0.05 * i;
+  EXPECT_EQ(testSystem->BmatTimes(cartesians, cartesianVector), B * cartesianVector);
+  EXPECT_EQ(testSystem->transposeOfBmatTimes(cartesians, internalVector), B.t() * internalVector);
+}
+
 void MatricesTest::hessianGuessTest() {
   EXPECT_EQ(testSystem->guess_hessian(cartesians), exampleGuessHessianForTwoMethanols());
 }
@@ -372,4 +394,27 @@ void DelocalizedMatricesTest::internalValuesForTricTest() {
 TEST_F(DelocalizedMatricesTest, internalValuesForTricTest) {
   internalValuesForTricTest();
 }
+
+void DelocalizedMatricesTest::iterativeBacktransformationTest() {
+  internals::InternalToCartesianConverter converter{ *testSystem, cartesians };
+  auto& threshold = Config::set().optimization.local.internals.iterative_backtransformation;
+  auto const oldThreshold = threshold;
+
+  threshold = 0u;   // pseudo-inverse of the dense G-matrix
+  auto const denseCartesians = converter.applyInternalChange(internalInitialStepOfTwoMethanolMolecules());
+  threshold = 1u;   // CGLS with the sparse B-matrix
+  auto const iterativeCartesians = converter.applyInternalChange(internalInitialStepOfTwoMethanolMolecules());
+  threshold = oldThreshold;
+
+  ASSERT_EQ(denseCartesians.size(), iterativeCartesians.size());
+  for (auto i = 0u; i < denseCartesians.size(); ++i) {
+    EXPECT_NEAR(denseCartesians.at(i).x(), iterativeCartesians.at(i).x(), 1.e-6);
+    EXPECT_NEAR(denseCartesians.at(i).y(), iterativeCartesians.at(i).y(), 1.e-6);
+    EXPECT_NEAR(denseCartesians.at(i).z(), iterativeCartesians.at(i).z(), 1.e-6);
+  }
+}
+
+TEST_F(DelocalizedMatricesTest, iterativeBacktransformationTest) {
+  iterativeBacktransformationTest();
+}
 #endif
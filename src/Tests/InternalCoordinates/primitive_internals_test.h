@@ -74,6 +74,7 @@ public:
   void delocalizedInitialHessianTest();
   void internalDifferencesTest();
   void internalValuesForTricTest();
+  void iterativeBacktransformationTest();
 
 
   InternalCoordinates::CartesiansForInternalCoordinates cartesians;
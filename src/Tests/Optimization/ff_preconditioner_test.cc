@@ -0,0 +1,59 @@
+/**
+CAST 3
+Purpose: Tests the force field preconditioner for L-BFGS with a bent three-atom molecule
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include "../../ff_preconditioner.h"
+
+namespace
+{
+  coords::Representation_3D bentMolecule()
+  {
+    return { coords::r3(0.0, 0.0, 0.0), coords::r3(0.96, 0.0, 0.0), coords::r3(-0.24, 0.93, 0.0) };
+  }
+
+  std::vector<energy::model_hessian_term> bentMoleculeTerms()
+  {
+    using kind = energy::model_hessian_term::kind;
+    return { { kind::BOND, { 0u, 1u }, 1000.0 }, { kind::BOND, { 0u, 2u }, 1000.0 }, { kind::ANGLE, { 1u, 0u, 2u }, 100.0 } };
+  }
+}
+
+TEST(ff_preconditioner, stretchingABondNeedsTheBondCurvature)
+{
+  optimization::local::ff_preconditioner const P(bentMolecule(), bentMoleculeTerms(), 1.0);
+  // pulling atom 1 along the bond 0-1
+  std::vector<coords::float_type> v(9u, 0.0);
+  v[3] = 1.0;
+  auto const Pv = P.times(v);
+  EXPECT_NEAR(Pv[3], 1001.0, 1.e-6);
+  EXPECT_NEAR(Pv[0], -1000.0, 1.e-6);
+  EXPECT_NEAR(Pv[6], 0.0, 1.e-6);
+}
+
+TEST(ff_preconditioner, solveInvertsTimes)
+{
+  optimization::local::ff_preconditioner const P(bentMolecule(), bentMoleculeTerms(), 1.0);
+  std::vector<coords::float_type> const v{ 0.1, -0.3, 0.2, 0.5, 0.0, -0.1, -0.2, 0.4, 0.3 };
+  auto const z = P.solve(P.times(v));
+  for (std::size_t i = 0u; i < v.size(); ++i) EXPECT_NEAR(z[i], v[i], 1.e-6);
+}
+
+TEST(ff_preconditioner, fixedAtomsDoNotMove)
+{
+  optimization::local::ff_preconditioner const P(bentMolecule(), bentMoleculeTerms(), 1.0, { false, true, false });
+  scon::vector<scon::c3<float>> d(3u, scon::c3<float>(1.f, 1.f, 1.f));
+  d[1] = scon::c3<float>();
+  P(d);
+  EXPECT_FLOAT_EQ(d[1].x(), 0.f);
+  EXPECT_FLOAT_EQ(d[1].y(), 0.f);
+  EXPECT_FLOAT_EQ(d[1].z(), 0.f);
+  EXPECT_GT(d[0].x(), 0.f);
+}
+
+#endif
@@ -0,0 +1,81 @@
+/**
+CAST 3
+Purpose: Tests the FIRE minimizer with an anisotropic harmonic potential
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include "../../configuration.h"
+#include "../../fire.h"
+
+namespace
+{
+  /**E = sum k_i * (x_i - x0_i)^2 with different force constants, atom 1 is fixed*/
+  struct harmonic_callback
+  {
+    std::size_t* evaluations;
+    float operator() (scon::vector<scon::c3<float>> const& x,
+      scon::vector<scon::c3<float>>& g, std::size_t const, bool& go_on)
+    {
+      ++*evaluations;
+      float E = 0.f;
+      g.resize(x.size());
+      for (std::size_t i = 0u; i < x.size(); ++i)
+      {
+        scon::c3<float> const k(1.f + i, 10.f, 0.5f), x0(1.f, -2.f, 3.f);
+        auto const d = x[i] - x0;
+        E += k.x() * d.x() * d.x() + k.y() * d.y() * d.y() + k.z() * d.z() * d.z();
+        g[i] = i == 1u ? scon::c3<float>() : scon::c3<float>(2.f * k.x() * d.x(), 2.f * k.y() * d.y(), 2.f * k.z() * d.z());
+      }
+      go_on = true;
+      return E;
+    }
+  };
+}
+
+TEST(fire, relaxesHarmonicPotentialWithOneGradientPerStep)
+{
+  Config::set().optimization.local.bfgs.use_different_convergence_criterion = false;
+  std::size_t evaluations = 0u;
+  auto optimizer = optimization::local::make_fire(harmonic_callback{ &evaluations });
+  optimizer.config.max_iterations = 2000u;
+  optimizer.config.epsilon = 1.e-4f;
+
+  scon::vector<scon::c3<float>> start(3u, scon::c3<float>(0.f, 0.f, 0.f));
+  start[1] = scon::c3<float>(5.f, 5.f, 5.f);
+  optimizer(decltype(optimizer)::point_type(start));
+
+  EXPECT_EQ(optimizer.state(), optimization::local::status::SUCCESS);
+  EXPECT_EQ(evaluations, optimizer.iter() + 1u);
+  for (auto i : { 0u, 2u })
+  {
+    EXPECT_NEAR(optimizer.p().x[i].x(), 1.f, 1.e-3f);
+    EXPECT_NEAR(optimizer.p().x[i].y(), -2.f, 1.e-3f);
+    EXPECT_NEAR(optimizer.p().x[i].z(), 3.f, 1.e-3f);
+  }
+  // fixed atom did not move
+  EXPECT_FLOAT_EQ(optimizer.p().x[1].x(), 5.f);
+  EXPECT_FLOAT_EQ(optimizer.p().x[1].z(), 5.f);
+}
+
+TEST(fire, firstStepUsesStartTimeStep)
+{
+  Config::set().optimization.local.bfgs.use_different_convergence_criterion = false;
+  std::size_t evaluations = 0u;
+  auto optimizer = optimization::local::make_fire(harmonic_callback{ &evaluations });
+  optimizer.config.max_iterations = 1u;
+
+  scon::vector<scon::c3<float>> start(3u, scon::c3<float>(0.f, 0.f, 0.f));
+  optimizer(decltype(optimizer)::point_type(start));
+
+  // x = -g * dt_start^2 with g = (-2, 40, -3) for atom 0 at the origin
+  auto const dt = optimizer.config.dt_start;
+  EXPECT_FLOAT_EQ(optimizer.p().x[0].x(), 2.f * dt * dt);
+  EXPECT_FLOAT_EQ(optimizer.p().x[0].y(), -40.f * dt * dt);
+  EXPECT_FLOAT_EQ(optimizer.p().x[0].z(), 3.f * dt * dt);
+}
+
+#endif
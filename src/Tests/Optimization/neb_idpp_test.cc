@@ -0,0 +1,134 @@
+/**
+CAST 3
+Purpose: Tests the image dependent pair potential (IDPP) of the NEB for a simple path of a carbon chain
+
+@version 1.0
+*/
+
+#ifdef GOOGLE_MOCK
+
+#include <gtest/gtest.h>
+#include "../../configuration.h"
+#include "../../neb.h"
+#include "../../Scon/scon_linkedcell.h"
+
+namespace
+{
+  /**bent chain of four carbon atoms with bond length d*/
+  coords::Representation_3D chain(double const d)
+  {
+    return { coords::Cartesian_Point(0.0, 0.0, 0.0), coords::Cartesian_Point(d, 0.0, 0.0),
+      coords::Cartesian_Point(d, d, 0.0), coords::Cartesian_Point(2.0 * d, d, 0.5 * d) };
+  }
+
+  coords::Coordinates chainCoordinates()
+  {
+    coords::Atoms atoms;
+    for (std::size_t i = 0u; i < 4u; ++i)
+    {
+      coords::Atom carbon("C");
+      if (i > 0u) carbon.bind_to(i - 1u);
+      if (i < 3u) carbon.bind_to(i + 1u);
+      atoms.add(carbon);
+    }
+    coords::PES_Point pes(chain(1.0));
+    coords::Coordinates coords;
+    coords.init_swap_in(atoms, pes, false);
+    return coords;
+  }
+
+  /**IDPP between chain(1.0) and chain(1.5) with the given number of images*/
+  void prepareIdpp(neb& path, std::size_t const images)
+  {
+    path.num_images = images;
+    path.imagi.assign(images, chain(1.0));
+    path.imagi.back() = chain(1.5);
+    path.idpp_prep();
+  }
+
+  double const tolerance = 1.e-10;
+}
+
+TEST(neb_idpp, imagesAtTargetDistancesHaveNoGradient)
+{
+  Config::local_scope scope;
+  Config::set().neb.IDPP_CUTOFF = 0.0;
+  auto coords = chainCoordinates();
+  neb path(&coords);
+  prepareIdpp(path, 2u);
+
+  auto const g_start = path.idpp_gradients(chain(1.0), 0u);
+  auto const g_final = path.idpp_gradients(chain(1.5), 1u);
+  for (std::size_t i = 0u; i < 4u; ++i)
+  {
+    EXPECT_NEAR(geometric_length(g_start[i]), 0.0, tolerance);
+    EXPECT_NEAR(geometric_length(g_final[i]), 0.0, tolerance);
+  }
+}
+
+TEST(neb_idpp, gradientPullsImageTowardsTargetDistances)
+{
+  Config::local_scope scope;
+  Config::set().neb.IDPP_CUTOFF = 0.0;
+  auto coords = chainCoordinates();
+  neb path(&coords);
+  prepareIdpp(path, 2u);
+
+  // the start structure as last image is too short everywhere: the chain has to be stretched
+  auto const image = chain(1.0);
+  auto const g = path.idpp_gradients(image, 1u);
+  EXPECT_GT(g[0].x(), 0.0);
+  EXPECT_LT(g[3].x(), 0.0);
+
+  // a small step along the negative gradient brings every distance closer to its target
+  auto const target = chain(1.5);
+  auto moved = image;
+  for (std::size_t i = 0u; i < 4u; ++i) moved[i] -= g[i] * 1.e-3;
+  for (std::size_t i = 1u; i < 4u; ++i)
+  {
+    for (std::size_t j = 0u; j < i; ++j)
+    {
+      auto const target_distance = dist(target[i], target[j]);
+      EXPECT_LT(std::abs(dist(moved[i], moved[j]) - target_distance), std::abs(dist(image[i], image[j]) - target_distance));
+    }
+  }
+}
+
+TEST(neb_idpp, cutoffCoveringAllPairsGivesSameGradients)
+{
+  auto const image = chain(1.2);
+  coords::Representation_3D g_all, g_cutoff;
+  {
+    Config::local_scope scope;
+    Config::set().neb.IDPP_CUTOFF = 0.0;
+    auto coords = chainCoordinates();
+    neb path(&coords);
+    prepareIdpp(path, 3u);
+    g_all = path.idpp_gradients(image, 1u);
+  }
+  {
+    Config::local_scope scope;
+    Config::set().neb.IDPP_CUTOFF = 10.0;   // pairs are searched with linked cells
+    ASSERT_TRUE(scon::linked::pay_off(chain(1.0), 10.0));
+    auto coords = chainCoordinates();
+    neb path(&coords);
+    prepareIdpp(path, 3u);
+    g_cutoff = path.idpp_gradients(image, 1u);
+  }
+  for (std::size_t i = 0u; i < 4u; ++i)
+  {
+    EXPECT_NEAR(geometric_length(g_all[i] - g_cutoff[i]), 0.0, tolerance);
+    EXPECT_GT(geometric_length(g_all[i]), 0.0);
+  }
+}
+
+TEST(linked_cells_pay_off, notForAtomsSpreadOverHugeEmptySpace)
+{
+  EXPECT_TRUE(scon::linked::pay_off(chain(1.0), 2.0));
+  coords::Representation_3D dissociated{ coords::Cartesian_Point(0.0, 0.0, 0.0), coords::Cartesian_Point(1000.0, 1000.0, 1000.0) };
+  EXPECT_FALSE(scon::linked::pay_off(dissociated, 2.0));
+  EXPECT_FALSE(scon::linked::pay_off(chain(1.0), 0.0));
+  EXPECT_FALSE(scon::linked::pay_off(coords::Representation_3D(), 2.0));
+}
+
+#endif
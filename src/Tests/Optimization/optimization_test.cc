@@ -150,4 +150,22 @@ TEST_F(AppropriateStepFinderTest, appropriateStepTest) {
 
   EXPECT_EQ(finder.extractBestStep(), ExpectedValuesForTrustRadius::expectedTrustStep());
 }
+
+TEST(LbfgsInverseHessianTest, preconditionedStepAndSecantCondition) {
+  using Mat = scon::mathmatrix<coords::float_type>;
+  LbfgsInverseHessian lbfgs(2u);
+  lbfgs.setPreconditioner(Mat::col_from_vec({ 2., 4., 0. }));
+  auto const gradients = Mat::col_from_vec({ 1., -2., 1.e-4 });
+  EXPECT_EQ(lbfgs.direction(gradients), Mat::col_from_vec({ -0.5, 0.5, -1. }));
+
+  auto const step = Mat::col_from_vec({ 0.1, 0.2, -0.1 });
+  auto const gradientChange = Mat::col_from_vec({ 0.3, 0.5, -0.2 });
+  EXPECT_TRUE(lbfgs.update(step, gradientChange));
+  EXPECT_FALSE(lbfgs.update(step, gradientChange * -1.));
+  EXPECT_EQ(lbfgs.size(), 1u);
+  EXPECT_EQ(lbfgs.direction(gradientChange), step * -1.);
+
+  lbfgs.clear();
+  EXPECT_EQ(lbfgs.size(), 0u);
+}
 #endif
@@ -37,4 +37,53 @@ TEST(alignment, kabschAlignmentLeavesStructureUnchanged)
     ASSERT_NEAR(after.xyz().at(i).z(), com_aligned.xyz().at(i).z(), maxDiffAngstrom);
   }
 }
+
+TEST(alignment, snapshotAlignmentEqualsCoordinatesAlignment)
+{
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+  coords::Coordinates reference(coords);
+  auto moved = coords.xyz();
+  for (auto& p : moved) p = coords::Cartesian_Point(p.y() + 1.0, -p.x(), p.z() - 2.0);  // rotate and shift
+  coords.set_xyz(moved, true);
+  auto const original_xyz = coords.xyz();
+
+  coords::Snapshot snapshot(coords), snapshot_reference(reference);
+  align::centerOfGeometryAlignment(snapshot_reference);
+  align::kabschAlignment(snapshot, snapshot_reference);
+
+  align::centerOfGeometryAlignment(reference);
+  align::kabschAlignment(coords, reference);
+
+  constexpr double maxDiffAngstrom = 10e-5;
+  for (std::size_t i = 0u; i < coords.size(); i++)
+  {
+    ASSERT_NEAR(snapshot.xyz(i).x(), coords.xyz(i).x(), maxDiffAngstrom);
+    ASSERT_NEAR(snapshot.xyz(i).y(), coords.xyz(i).y(), maxDiffAngstrom);
+    ASSERT_NEAR(snapshot.xyz(i).z(), coords.xyz(i).z(), maxDiffAngstrom);
+    ASSERT_NEAR(snapshot.xyz(i).x(), reference.xyz(i).x(), maxDiffAngstrom);   // rotation is undone completely
+  }
+  ASSERT_NEAR(align::rmsd_aligned(coords::Snapshot(coords, coords::PES_Point(original_xyz)), coords::Snapshot(reference)), 0.0, maxDiffAngstrom);
+  ASSERT_NEAR(align::drmsd_calc(snapshot, snapshot_reference), 0.0, maxDiffAngstrom);
+}
+
+TEST(alignment, qcpRmsdEqualsKabschRmsd)
+{
+  std::unique_ptr<coords::input::format> ci(coords::input::new_format());
+  coords::Coordinates coords(ci->read("test_files/butanol.arc"));
+  coords::Coordinates const reference(coords);
+  auto moved = coords.xyz();
+  for (std::size_t i = 0u; i < moved.size(); ++i)   // rotate, shift and distort
+  {
+    auto const& p = moved[i];
+    moved[i] = coords::Cartesian_Point(p.y() + 1.0, -p.x() + 0.1 * static_cast<double>(i % 3u), p.z() - 2.0);
+  }
+  coords.set_xyz(moved, true);
+
+  constexpr double maxDiffAngstrom = 10e-5;
+  auto const kabsch_rmsd = align::rmsd_aligned(coords, reference);
+  EXPECT_GT(kabsch_rmsd, 0.01);
+  EXPECT_NEAR(align::rmsd_qcp(coords.xyz(), reference.xyz()), kabsch_rmsd, maxDiffAngstrom);
+  EXPECT_NEAR(align::rmsd_qcp(reference.xyz(), reference.xyz()), 0.0, maxDiffAngstrom);
+}
 #endif
\ No newline at end of file
@@ -1,49 +1,144 @@
 #include "alignment.h"
 
+namespace
+{
+  coords::Cartesian_Point center_of_geometry(coords::Representation_3D const& xyz)
+  {
+    coords::Cartesian_Point p(0);
+    for (auto const& position : xyz) p += position;
+    p /= coords::float_type(xyz.size());
+    return p;
+  }
+}
+
 namespace align
 {
   using namespace matop;
-  float_type drmsd_calc(coords::Coordinates const& input, coords::Coordinates const& ref)
+  float_type drmsd_calc(coords::Representation_3D const& input, coords::Representation_3D const& ref)
   {
-    if (input.atoms().size() != ref.atoms().size()) throw std::logic_error("Number of atoms of structures passed to drmsd_calc to not match.");
+    if (input.size() != ref.size()) throw std::logic_error("Number of atoms of structures passed to drmsd_calc to not match.");
 
     float_type value = 0;
-    for (size_t i = 0; i < input.atoms().size(); i++)
+    for (size_t i = 0; i < input.size(); i++)
     {
       for (size_t j = 0; j < i; j++)
       {
-        float_type holder = sqrt((ref.xyz(i).x() - ref.xyz(j).x()) * (ref.xyz(i).x() - ref.xyz(j).x()) + (ref.xyz(i).y() - ref.xyz(j).y()) * (ref.xyz(i).y() - ref.xyz(j).y()) + (ref.xyz(i).z() - ref.xyz(j).z()) * (ref.xyz(i).z() - ref.xyz(j).z()));
-        float_type holder2 = sqrt((input.xyz(i).x() - input.xyz(j).x()) * (input.xyz(i).x() - input.xyz(j).x()) + (input.xyz(i).y() - input.xyz(j).y()) * (input.xyz(i).y() - input.xyz(j).y()) + (input.xyz(i).z() - input.xyz(j).z()) * (input.xyz(i).z() - input.xyz(j).z()));
+        float_type holder = sqrt((ref[i].x() - ref[j].x()) * (ref[i].x() - ref[j].x()) + (ref[i].y() - ref[j].y()) * (ref[i].y() - ref[j].y()) + (ref[i].z() - ref[j].z()) * (ref[i].z() - ref[j].z()));
+        float_type holder2 = sqrt((input[i].x() - input[j].x()) * (input[i].x() - input[j].x()) + (input[i].y() - input[j].y()) * (input[i].y() - input[j].y()) + (input[i].z() - input[j].z()) * (input[i].z() - input[j].z()));
         value += (holder2 - holder) * (holder2 - holder);
       }
     }
-    return sqrt(value / (double)(input.atoms().size() * (input.atoms().size() + 1u)));
+    return sqrt(value / (double)(input.size() * (input.size() + 1u)));
+  }
+  float_type drmsd_calc(coords::Coordinates const& input, coords::Coordinates const& ref)
+  {
+    return drmsd_calc(input.xyz(), ref.xyz());
+  }
+  float_type drmsd_calc(coords::Snapshot const& input, coords::Snapshot const& ref)
+  {
+    return drmsd_calc(input.xyz(), ref.xyz());
   }
 
-  float_type holmsander_calc(coords::Coordinates const& input, coords::Coordinates const& ref, double holmAndSanderDistance)
+  float_type holmsander_calc(coords::Representation_3D const& input, coords::Representation_3D const& ref, double holmAndSanderDistance)
   {
-    if (input.atoms().size() != ref.atoms().size()) throw std::logic_error("Number of atoms of structures passed to drmsd_calc to not match.");
+    if (input.size() != ref.size()) throw std::logic_error("Number of atoms of structures passed to drmsd_calc to not match.");
 
     float_type value(0);
-    for (size_t i = 0; i < input.atoms().size(); i++) {
+    for (size_t i = 0; i < input.size(); i++) {
       for (size_t j = 0; j < i; j++)
       {
-        float_type holder = sqrt((ref.xyz(i).x() - ref.xyz(j).x()) * (ref.xyz(i).x() - ref.xyz(j).x()) + (ref.xyz(i).y() - ref.xyz(j).y()) * (ref.xyz(i).y() - ref.xyz(j).y()) + (ref.xyz(i).z() - ref.xyz(j).z()) * (ref.xyz(i).z() - ref.xyz(j).z()));
-        float_type holder2 = sqrt((input.xyz(i).x() - input.xyz(j).x()) * (input.xyz(i).x() - input.xyz(j).x()) + (input.xyz(i).y() - input.xyz(j).y()) * (input.xyz(i).y() - input.xyz(j).y()) + (input.xyz(i).z() - input.xyz(j).z()) * (input.xyz(i).z() - input.xyz(j).z()));
+        float_type holder = sqrt((ref[i].x() - ref[j].x()) * (ref[i].x() - ref[j].x()) + (ref[i].y() - ref[j].y()) * (ref[i].y() - ref[j].y()) + (ref[i].z() - ref[j].z()) * (ref[i].z() - ref[j].z()));
+        float_type holder2 = sqrt((input[i].x() - input[j].x()) * (input[i].x() - input[j].x()) + (input[i].y() - input[j].y()) * (input[i].y() - input[j].y()) + (input[i].z() - input[j].z()) * (input[i].z() - input[j].z()));
         value += abs(holder2 - holder) * exp(-1 * (holder2 + holder) * (holder2 + holder) / (4 * holmAndSanderDistance * holmAndSanderDistance)) / (holder2 + holder);
       }
     }
     return value;
   }
+  float_type holmsander_calc(coords::Coordinates const& input, coords::Coordinates const& ref, double holmAndSanderDistance)
+  {
+    return holmsander_calc(input.xyz(), ref.xyz(), holmAndSanderDistance);
+  }
+  float_type holmsander_calc(coords::Snapshot const& input, coords::Snapshot const& ref, double holmAndSanderDistance)
+  {
+    return holmsander_calc(input.xyz(), ref.xyz(), holmAndSanderDistance);
+  }
 
   float_type rmsd_aligned(coords::Coordinates const& coords1, coords::Coordinates const& coords2)
   {
-    coords::Coordinates c1(coords1);  // copy structures into non-const object so that they can be aligned
-    coords::Coordinates c2(coords2);
-    kabschAligned(c1, c2);            // align the two structures
+    return rmsd_aligned(coords::Snapshot(coords1), coords::Snapshot(coords2));
+  }
+  float_type rmsd_aligned(coords::Snapshot c1, coords::Snapshot c2)
+  {
+    centerOfGeometryAlignment(c1);    // align the two structures
+    centerOfGeometryAlignment(c2);
+    kabschAlignment(c1, c2);
     return scon::root_mean_square_deviation(c1.xyz(), c2.xyz());
   }
 
+  float_type rmsd_qcp(coords::Representation_3D const& input, coords::Representation_3D const& ref)
+  {
+    if (input.size() != ref.size()) throw std::logic_error("Number of atoms of structures passed to rmsd_qcp do not match.");
+    if (input.empty()) return 0.0;
+    auto const N = static_cast<float_type>(input.size());
+
+    // inner products of the centered structures
+    coords::Cartesian_Point cog_in, cog_ref;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+      cog_in += input[i];
+      cog_ref += ref[i];
+    }
+    cog_in /= N;
+    cog_ref /= N;
+    float_type G(0.0), Sxx(0.0), Sxy(0.0), Sxz(0.0), Syx(0.0), Syy(0.0), Syz(0.0), Szx(0.0), Szy(0.0), Szz(0.0);
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+      auto const a = input[i] - cog_in;
+      auto const b = ref[i] - cog_ref;
+      G += dot(a, a) + dot(b, b);
+      Sxx += a.x() * b.x(); Sxy += a.x() * b.y(); Sxz += a.x() * b.z();
+      Syx += a.y() * b.x(); Syy += a.y() * b.y(); Syz += a.y() * b.z();
+      Szx += a.z() * b.x(); Szy += a.z() * b.y(); Szz += a.z() * b.z();
+    }
+    float_type const E0 = 0.5 * G;
+
+    // coefficients of the characteristic polynomial of the key matrix (x^4 + C2 x^2 + C1 x + C0)
+    float_type const Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+    float_type const Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+    float_type const Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+    float_type const SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+    float_type const Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+    float_type const Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+    float_type const SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+    float_type const SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+    float_type const SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+
+    float_type const C2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+    float_type const C1 = 8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx
+      - Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+    float_type const C0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2
+      + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) * (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+      + (-SxzpSzx * SyzmSzy + SxymSyx * (SxxmSyy - Szz)) * (-SxzmSzx * SyzpSzy + SxymSyx * (SxxmSyy + Szz))
+      + (-SxzpSzx * SyzpSzy - SxypSyx * (SxxpSyy - Szz)) * (-SxzmSzx * SyzmSzy - SxypSyx * (SxxpSyy + Szz))
+      + (SxypSyx * SyzpSzy + SxzpSzx * (SxxmSyy + Szz)) * (-SxymSyx * SyzmSzy + SxzpSzx * (SxxpSyy + Szz))
+      + (SxypSyx * SyzmSzy + SxzmSzx * (SxxmSyy - Szz)) * (-SxymSyx * SyzpSzy + SxzmSzx * (SxxpSyy - Szz));
+
+    // largest eigenvalue by Newton-Raphson, starting from its upper bound E0
+    float_type lambda = E0;
+    for (std::size_t iter = 0; iter < 50u; ++iter)
+    {
+      float_type const old_lambda = lambda;
+      float_type const x2 = lambda * lambda;
+      float_type const b = (x2 + C2) * lambda;
+      float_type const a = b + C1;
+      float_type const denominator = 2.0 * x2 * lambda + b + a;
+      if (denominator == 0.0) break;
+      lambda -= (a * lambda + C0) / denominator;
+      if (std::abs(lambda - old_lambda) < std::abs(1e-11 * lambda)) break;
+    }
+    return std::sqrt(std::abs(2.0 * (E0 - lambda) / N));
+  }
+
   coords::Coordinates kabschAligned(coords::Coordinates const& inputCoords, coords::Coordinates const& reference)
   {
     coords::Coordinates output(inputCoords);
@@ -59,12 +154,10 @@ namespace align
     return inputCoords;
   }
 
-  void kabschAlignment(coords::Coordinates& inputCoords, coords::Coordinates const& reference_)
+  coords::Representation_3D kabschRotated(coords::Representation_3D const& inputCoords, coords::Representation_3D const& reference)
   {
     // NOTE: KABSCH ALIGNMENT IS ONLY VALID IF BOTH STRUCTURES HAVE BEEN CENTERED!!!!
-    coords::Coordinates reference(reference_);
-    centerOfGeometryAlignment(inputCoords);
-    const double cog_rmsd = root_mean_square_deviation(reference.center_of_geometry(), inputCoords.center_of_geometry());
+    const double cog_rmsd = root_mean_square_deviation(center_of_geometry(reference), center_of_geometry(inputCoords));
     if (cog_rmsd > 0.005)
     {
       if (Config::get().general.verbosity >= 3)
@@ -105,7 +198,19 @@ namespace align
     input = unit * input;
     //std::cout << "\n\n" << input << "\n\n" << std::endl;
 
-    inputCoords.set_xyz(transfer_to_3DRepressentation(input));
+    return transfer_to_3DRepressentation(input);
+  }
+
+  void kabschAlignment(coords::Coordinates& inputCoords, coords::Coordinates const& reference)
+  {
+    centerOfGeometryAlignment(inputCoords);
+    inputCoords.set_xyz(kabschRotated(inputCoords.xyz(), reference.xyz()));
+  }
+
+  void kabschAlignment(coords::Snapshot& inputCoords, coords::Snapshot const& reference)
+  {
+    centerOfGeometryAlignment(inputCoords);
+    inputCoords.set_xyz(kabschRotated(inputCoords.xyz(), reference.xyz()));
   }
 
   void centerOfMassAlignment(coords::Coordinates& coords_in)
@@ -113,6 +218,10 @@ namespace align
     coords::Cartesian_Point com_ref = coords_in.center_of_mass();
     coords_in.move_all_by(-com_ref, true);
   }
+  void centerOfMassAlignment(coords::Snapshot& coords_in)
+  {
+    coords_in.move_all_by(-coords_in.center_of_mass());
+  }
   coords::Coordinates centerOfMassAligned(coords::Coordinates const& coords_in)
   {
     coords::Coordinates out(coords_in);
@@ -125,6 +234,10 @@ namespace align
     coords::Cartesian_Point cog_ref = coords_in.center_of_geometry();
     coords_in.move_all_by(-cog_ref, true);
   }
+  void centerOfGeometryAlignment(coords::Snapshot& coords_in)
+  {
+    coords_in.move_all_by(-coords_in.center_of_geometry());
+  }
   coords::Coordinates centerOfGeometryAligned(coords::Coordinates const& coords_in)
   {
     coords::Coordinates out(coords_in);
@@ -140,7 +253,8 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
   using namespace matop;
   using namespace align;
 
-  coords::Coordinates coordsReferenceStructure(coords), coordsTemporaryStructure(coords);
+  // snapshots only hold positions, so the private copies of the OpenMP threads are cheap
+  coords::Snapshot coordsReferenceStructure(coords), coordsTemporaryStructure(coords);
 
   // Check if reference structure is in range
   if (Config::get().alignment.reference_frame_num >= ci->size()) throw std::runtime_error("Reference frame number in ALIGN task is bigger than number of frames in the input structure ensemble.");
@@ -158,15 +272,14 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
     }
     temporaryPESpoint = externalReferenceStructurePtr->PES()[Config::get().alignment.reference_frame_num].structure.cartesian;
   }
-  //Constructs two coordinate objects and sets reference frame according to INPUTFILE
+  //Sets reference frame according to INPUTFILE
   coordsReferenceStructure.set_xyz(temporaryPESpoint);
-  const coords::Coordinates coordsOriginalReferenceStructure(coordsReferenceStructure);
+  coords::Cartesian_Point const cogOriginalReferenceStructure(coordsReferenceStructure.center_of_geometry());
 
-  //Construct and Allocate arrays for stringoutput (necessary for OpenMP)
+  //Construct and Allocate arrays for output (necessary for OpenMP)
   double mean_value = 0;
-  std::string* hold_str, * hold_coords_str;
-  hold_str = new std::string[ci->size()];
-  hold_coords_str = new std::string[ci->size()];
+  std::vector<std::string> hold_str(ci->size());
+  std::vector<coords::Representation_3D> hold_xyz(ci->size());
 
   //Perform translational alignment for reference frame
   if (Config::get().alignment.traj_align_translational)
@@ -180,7 +293,7 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
 #ifdef _OPENMP
   if (Config::get().general.verbosity > 3U) std::cout << "Using openMP for alignment.\n";
   auto const n_omp = static_cast<std::ptrdiff_t>(ci->size());
-#pragma omp parallel for firstprivate(coordsReferenceStructure, coordsTemporaryStructure, coordsOriginalReferenceStructure) reduction(+:mean_value) shared(hold_coords_str, hold_str)
+#pragma omp parallel for firstprivate(coordsTemporaryStructure) reduction(+:mean_value) shared(hold_xyz, hold_str, coordsReferenceStructure)
   for (std::ptrdiff_t i = 0; i < n_omp; ++i)
 #else
   for (std::size_t i = 0; i < ci->size(); ++i)
@@ -188,8 +301,7 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
   {
     if (i != static_cast<std::ptrdiff_t>(Config::get().alignment.reference_frame_num) || !Config::get().alignment.align_external_file.empty())
     {
-      auto temporaryPESpoint2 = ci->PES()[i].structure.cartesian;
-      coordsTemporaryStructure.set_xyz(temporaryPESpoint2);
+      coordsTemporaryStructure.set_xyz(ci->PES()[i].structure.cartesian);
       //Create temporary objects for current frame
 
       if (Config::get().alignment.traj_align_translational)
@@ -202,8 +314,7 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
       }
       if (!Config::get().alignment.align_external_file.empty() && Config::get().alignment.traj_align_translational)
       {
-        coords::Cartesian_Point cog_ref = coordsOriginalReferenceStructure.center_of_geometry();
-        coordsTemporaryStructure.move_all_by(cog_ref, true);
+        coordsTemporaryStructure.move_all_by(cogOriginalReferenceStructure);
       }
 
       if (Config::get().alignment.traj_print_bool)
@@ -240,18 +351,12 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
       }
       //Molecular distance measure calculation
 
-      std::stringstream hold_coords;
-      hold_coords << coordsTemporaryStructure;
-      hold_coords_str[i] = hold_coords.str();
-      //Formatted string-output
+      hold_xyz[i] = coordsTemporaryStructure.xyz();
     }
 
     else if (i == static_cast<std::ptrdiff_t>(Config::get().alignment.reference_frame_num))
     {
-      std::stringstream hold_coords;
-      hold_coords << coordsReferenceStructure;
-      hold_coords_str[i] = hold_coords.str();
-      //Formatted string-output (first to array because of OpenMP parallelization)
+      hold_xyz[i] = coordsReferenceStructure.xyz();
     }
   }
 
@@ -260,13 +365,16 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
 
   if (Config::get().general.verbosity > 2U) std::cout << "Alignment done. Writing structures to file.\n";
 
+  // the output formats need a complete Coordinates object so the structures are written one after another
+  coords::Coordinates outputStructure(coords);
   for (size_t i = 0; i < ci->size(); i++)
   {
     if (Config::get().alignment.traj_print_bool)
     {
       distance << hold_str[i];
     }
-    outputstream << hold_coords_str[i];
+    outputStructure.set_xyz(std::move(hold_xyz[i]), true);
+    outputstream << outputStructure;
   }
   distance << "\n";
   if (ci->size() > 1u)
@@ -274,8 +382,4 @@ void alignment(std::unique_ptr<coords::input::format>& ci, coords::Coordinates&
   else
     distance << "Value: " << mean_value << "\n";
   //Formatted string-output
-
-  delete[] hold_str;
-  delete[] hold_coords_str;
-  //Cleaning Up
 }
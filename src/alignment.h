@@ -34,6 +34,13 @@ namespace align
   * (this calls "centerOfGeoAlignment" function before actual alignment procedure)
   */
   void kabschAlignment(coords::Coordinates& input, coords::Coordinates const& reference);
+  void kabschAlignment(coords::Snapshot& input, coords::Snapshot const& reference);
+
+  /**
+  * Returns positions "input" rotated onto "reference" using Kabsch's-Algorithm
+  * (both have to be center-of-geometry aligned already, throws otherwise)
+  */
+  coords::Representation_3D kabschRotated(coords::Representation_3D const& input, coords::Representation_3D const& reference);
 
 
   /**
@@ -41,6 +48,7 @@ namespace align
   * ie.: translational alignment
   */
   void centerOfMassAlignment(coords::Coordinates& in);
+  void centerOfMassAlignment(coords::Snapshot& in);
   coords::Coordinates centerOfMassAligned(coords::Coordinates const& in);
 
   /**
@@ -48,6 +56,7 @@ namespace align
   * ie.: translational alignment
   */
   void centerOfGeometryAlignment(coords::Coordinates& in);
+  void centerOfGeometryAlignment(coords::Snapshot& in);
   coords::Coordinates centerOfGeometryAligned(coords::Coordinates const& in);
 
   /**
@@ -57,6 +66,8 @@ namespace align
   * @param ref: Reference Structure
   */
   float_type drmsd_calc(coords::Coordinates const& input, coords::Coordinates const& ref);
+  float_type drmsd_calc(coords::Snapshot const& input, coords::Snapshot const& ref);
+  float_type drmsd_calc(coords::Representation_3D const& input, coords::Representation_3D const& ref);
 
   /**
   * Calculates Holm&Sanders Distance of the structures
@@ -67,10 +78,18 @@ namespace align
   *
   */
   float_type holmsander_calc(coords::Coordinates const& input, coords::Coordinates const& ref, double holmAndSanderDistance = 20);
+  float_type holmsander_calc(coords::Snapshot const& input, coords::Snapshot const& ref, double holmAndSanderDistance = 20);
+  float_type holmsander_calc(coords::Representation_3D const& input, coords::Representation_3D const& ref, double holmAndSanderDistance = 20);
 
   /**calculating minimum RMSD value between two structures
   this means structures are aligned before calculating RMSD with Kabsch*/
   float_type rmsd_aligned(coords::Coordinates const& coords1, coords::Coordinates const& coords2);
+  /**same as above, snapshots are taken by value because they are aligned*/
+  float_type rmsd_aligned(coords::Snapshot coords1, coords::Snapshot coords2);
+  /**minimum RMSD value between two structures without aligning them explicitly
+  (quaternion characteristic polynomial method, Theobald, Acta Cryst. A61, 478 (2005))
+  gives the same value as rmsd_aligned but needs no matrix decomposition and no copies*/
+  float_type rmsd_qcp(coords::Representation_3D const& input, coords::Representation_3D const& ref);
 }
 
 
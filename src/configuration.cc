@@ -1,6 +1,8 @@
 #include "configuration.h"
 #include "helperfunctions.h"
 
+#include <cstring>
+
 #include "helperfunctions.h"
 
 /**
@@ -9,6 +11,11 @@
  */
 Config* Config::m_instance = nullptr;
 
+/**
+ * Configuration of the innermost Config::local_scope of every thread.
+ */
+thread_local Config* Config::m_local = nullptr;
+
 /**
 * Helper function that sorts numerical
 * integer type numbers into a vector. Every number
@@ -335,10 +342,55 @@ std::vector<unsigned> FEP_get_inout()
   return temp;
 }
 
+namespace
+{
+  /**options that don't change the result of an energy calculation, as they are dispatched in config::parse_option()
+  prefix entries stand for a whole section of the parser (e.g. every option starting with "MD" is handled by the MD branch),
+  so new options of these sections are covered automatically
+  (an option is only listed as prefix if no earlier branch of the parser handles options with the same start)*/
+  struct non_energy_option
+  {
+    char const* name;
+    bool is_prefix;
+  };
+
+  non_energy_option const non_energy_options[] = {
+    // general, output and bookkeeping
+    { "name", false }, { "outname", false }, { "verbosity", false }, { "task", false }, { "outputtype", false },
+    { "PROFILE", true }, { "QMSCRATCH", true }, { "CACHE", true }, { "QMGUESS", true },
+    // NEB and path optimization
+    { "NEB-PATHOPT", true },
+    // local optimization (including OPT++ and constraints)
+    { "OPT", true },
+    // global optimization and sampling
+    { "SOtype", false }, { "SOstructures", false }, { "Temperature", false }, { "Tempscale", false }, { "Iterations", false },
+    { "SA", true }, { "MD", true }, { "DIMER", true }, { "GO", true }, { "RS", true }, { "TS", true }, { "MC", true },
+    // umbrella sampling (bias potentials are added outside of the energy interface)
+    { "US", true },
+    // analysis of trajectories
+    { "traj_", true }, { "pca_", true }, { "proc_desired_", true }, { "entropy_", true },
+    { "amber_mdcrd", false }, { "amber_mdvel", false }, { "amber_trajectory_at_constant_pressure", false }
+  };
+}
+
+bool config::affects_energy(std::string const& option)
+{
+  for (auto const& o : non_energy_options)
+  {
+    if (o.is_prefix ? option.compare(0u, std::strlen(o.name), o.name) == 0 : option == o.name) return false;
+  }
+  return true;   // unknown options are part of the key (which only costs cache hits)
+}
+
 void config::parse_option(std::string const option, std::string const value_string)
 {
   std::istringstream cv(value_string);
 
+  if (affects_energy(option))
+  {
+    Config::set().energy.cache.settings += option + " " + value_string + "\n";
+  }
+
   /////////////////////
   //// Config::general
   ////////////////////
@@ -516,6 +568,28 @@ void config::parse_option(std::string const option, std::string const value_stri
 #endif
   }
 
+  //! Profiling of MD steps and energy interfaces
+  else if (option.substr(0, 7u) == "PROFILE")
+  {
+    if (option.substr(7u) == "use")
+    {
+      Config::set().profiling.use = bool_from_iss(cv);
+    }
+    else if (option.substr(7u) == "format")
+    {
+      if (value_string == "csv" || value_string == "CSV")
+        Config::set().profiling.format = config::profiling::formats::CSV;
+      else if (value_string == "json" || value_string == "JSON")
+        Config::set().profiling.format = config::profiling::formats::JSON;
+      else
+        throw std::runtime_error("Unknown format for PROFILEformat: " + value_string);
+    }
+    else if (option.substr(7u) == "report_offset")
+    {
+      cv >> Config::set().profiling.report_offset;
+    }
+  }
+
   else if (option == "MOVEmode")
   {
     Config::set().stuff.moving_mode = std::stoi(value_string);
@@ -585,6 +659,10 @@ void config::parse_option(std::string const option, std::string const value_stri
     {
       Config::set().energy.qmmm.cutoff = std::stod(value_string);
     }
+    else if (option.substr(4u) == "drop_far_charges")
+    {
+      Config::set().energy.qmmm.drop_far_charges = bool_from_iss(cv);
+    }
     else if (option.substr(4u) == "center")
     {
       Config::set().energy.qmmm.centers.emplace_back(std::stoi(value_string) - 1);
@@ -605,6 +683,10 @@ void config::parse_option(std::string const option, std::string const value_stri
     {
       Config::set().energy.qmmm.opt = bool_from_iss(cv);
     }
+    else if (option.substr(4u) == "optAdditive")
+    {
+      Config::set().energy.qmmm.opt_additive = bool_from_iss(cv);
+    }
     else if (option.substr(4u) == "conTol")
     {
       Config::set().energy.qmmm.tolerance = std::stod(value_string);
@@ -613,6 +695,10 @@ void config::parse_option(std::string const option, std::string const value_stri
     {
       Config::set().energy.qmmm.maxCycles = std::stoi(value_string);
     }
+    else if (option.substr(4u) == "qmSteps")
+    {
+      Config::set().energy.qmmm.qm_steps = std::stoi(value_string);
+    }
     else if (option.substr(4u) == "adjust")
     {
       Config::set().energy.qmmm.coulomb_adjust = std::stoi(value_string);
@@ -621,6 +707,10 @@ void config::parse_option(std::string const option, std::string const value_stri
     {
       Config::set().energy.qmmm.write_opt = bool_from_iss(cv);
     }
+    else if (option.substr(4u) == "async")
+    {
+      Config::set().energy.qmmm.async = bool_from_iss(cv);
+    }
   }
 
   //!SPACKMAN
@@ -681,6 +771,8 @@ void config::parse_option(std::string const option, std::string const value_stri
       cv >> Config::set().neb.INT_IT;
     else if (option.substr(11) == "-NEB-IDPP")
       cv >> Config::set().neb.IDPP;
+    else if (option.substr(11) == "-NEB-IDPP_CUTOFF")
+      cv >> Config::set().neb.IDPP_CUTOFF;
     else if (option.substr(11) == "-MAXFLUX")
       cv >> Config::set().neb.MAXFLUX;
     else if (option.substr(11) == "-MF_PATHOPT")
@@ -695,6 +787,8 @@ void config::parse_option(std::string const option, std::string const value_stri
       cv >> Config::set().neb.MCM_OPT;
     else if (option.substr(11) == "-NEB-MC_SAVE")
       cv >> Config::set().neb.MCM_SAVEITER;
+    else if (option.substr(11) == "-NEB-PARALLEL")
+      Config::set().neb.PARALLEL = bool_from_iss(cv);
     else if (option.substr(11) == "-CONN")
       cv >> Config::set().neb.CONN;
   }
@@ -803,6 +897,12 @@ void config::parse_option(std::string const option, std::string const value_stri
     else if (option.substr(5) == "fermi_temp") {
       Config::set().energy.dftb.fermi_temp = std::stod(value_string);
     }
+    else if (option.substr(5) == "socket_timeout") {
+      Config::set().energy.dftb.socket_timeout = std::stod(value_string);
+    }
+    else if (option.substr(5) == "socket") {
+      Config::set().energy.dftb.socket = bool_from_iss(cv);
+    }
   }
 
   // ORCA options
@@ -997,6 +1097,45 @@ void config::parse_option(std::string const option, std::string const value_stri
       Config::set().energy.psi4.threads = value_string;
     }
   }
+
+  // scratch directories of QM interfaces
+  else if (option.substr(0, 9) == "QMSCRATCH")
+  {
+    if (option.substr(9) == "use")
+      Config::set().energy.scratch.use = bool_from_iss(cv);
+    else if (option.substr(9) == "base")
+      Config::set().energy.scratch.base = value_string;
+    else if (option.substr(9) == "cleanup")
+    {
+      using cleanup_types = config::energy::scratch_conf::cleanup_types;
+      if (value_string == "always") Config::set().energy.scratch.cleanup = cleanup_types::ALWAYS;
+      else if (value_string == "keep_failed") Config::set().energy.scratch.cleanup = cleanup_types::KEEP_FAILED;
+      else if (value_string == "never") Config::set().energy.scratch.cleanup = cleanup_types::NEVER;
+      else throw std::runtime_error("Unknown option for QMSCRATCHcleanup: " + value_string);
+    }
+  }
+
+  // cache for results of QM interfaces
+  else if (option.substr(0, 5) == "CACHE")
+  {
+    if (option.substr(5) == "use")
+      Config::set().energy.cache.use = bool_from_iss(cv);
+    else if (option.substr(5) == "size")
+      Config::set().energy.cache.size = std::stoul(value_string);
+    else if (option.substr(5) == "file")
+      Config::set().energy.cache.file = value_string;
+    else if (option.substr(5) == "resolution")
+      cv >> Config::set().energy.cache.resolution;
+  }
+
+  // reuse of initial guess in QM interfaces
+  else if (option.substr(0, 7) == "QMGUESS")
+  {
+    if (option.substr(7) == "use")
+      Config::set().energy.guess.use = bool_from_iss(cv);
+    else if (option.substr(7) == "threshold")
+      cv >> Config::set().energy.guess.threshold;
+  }
   
   // stuff for local optimization
 
@@ -1015,6 +1154,30 @@ void config::parse_option(std::string const option, std::string const value_stri
   // which convergence criterion should be used?
   else if (option == "OPTconvergenceCriterion")
     Config::set().optimization.local.bfgs.use_different_convergence_criterion = bool_from_iss(cv);
+  // precondition with force field of preinterface?
+  else if (option == "OPTpreconditioner")
+    Config::set().optimization.local.bfgs.ff_preconditioner = bool_from_iss(cv);
+  else if (option == "OPTpreconditionerShift")
+    cv >> Config::set().optimization.local.bfgs.preconditioner_shift;
+
+  // options for FIRE
+  else if (option == "OPTfireDt")
+    cv >> Config::set().optimization.local.fire.dt;
+  else if (option == "OPTfireDtMax")
+    cv >> Config::set().optimization.local.fire.dt_max;
+  else if (option == "OPTfireMaxMove")
+    cv >> Config::set().optimization.local.fire.max_move;
+  // use FIRE for preoptimization?
+  else if (option == "OPTfirePreopt")
+    Config::set().optimization.local.fire.preoptimizer = bool_from_iss(cv);
+
+  // options for INTERNAL
+  // size from which on the back-transformation to cartesians is done iteratively
+  else if (option == "OPTiterativeBacktransformation")
+    cv >> Config::set().optimization.local.internals.iterative_backtransformation;
+  // number of stored steps for L-BFGS in internal coordinates
+  else if (option == "OPTlbfgsMemory")
+    cv >> Config::set().optimization.local.internals.lbfgs_memory;
 
   // options for OPT++
   else if (option.substr(0, 5) == "OPT++")
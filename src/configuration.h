@@ -703,19 +703,29 @@ namespace config
       std::vector<std::vector<int>> linkatom_sets;
       /**cutoff for electrostatic interaction*/
       double cutoff{ std::numeric_limits<double>::max() };
+      /**leave out external charges outside of cutoff instead of adding them with a charge of zero?*/
+      bool drop_far_charges{ false };
       /**central atom for cutoff (as atom index)
       one element for each QM system*/
       std::vector<std::size_t> centers;
-      /**use microiterations? (only for subtractive QM/MM)*/
+      /**use microiterations? (subtractive QM/MM, additive QM/MM only together with opt_additive)*/
       bool opt{ false };
+      /**use microiterations also in additive QM/MM? (only with L-BFGS)*/
+      bool opt_additive{ false };
       /**convergence tolerance for optimization with microiterations*/
       double tolerance{ 0.1 };
       /**maximum number of outer cycles*/
       std::size_t maxCycles{ 100 };
+      /**maximum number of L-BFGS steps of the QM region within one cycle (0 = until convergence)*/
+      std::size_t qm_steps{ 0 };
       /**use adjustment for coulomb interactions in MM calculation(0 = none, 1 = QM charges as parameters)*/
       std::size_t coulomb_adjust{ 0 };
       /**write structure for each microiteration cycle into file?*/
       bool write_opt{ false };
+      /**run MM calculations while the QM programme is running? (additive and subtractive QM/MM, not with periodic boundaries)
+      subtractive QM/MM: only with a forcefield as MM interface, or without electronic embedding if scratch directories are used
+      for THREE_LAYER: calculate all layers at the same time (needs scratch directories)*/
+      bool async{ false };
 
       // stuff for three-layer:
 
@@ -834,10 +844,14 @@ namespace config
       int max_steps_opt;
       /**temperature for fermi filling (in K)*/
       double fermi_temp;
+      /**keep DFTB+ alive between calculations and communicate via i-PI socket?*/
+      bool socket;
+      /**maximum time (in s) to wait for DFTB+ to connect to the socket*/
+      double socket_timeout;
       /**constructor*/
       dftb_conf(void) : verbosity(0), scctol(0.00001), max_steps(1000), charge(0),
         dftb3(false), d3{ false }, d3param{ std::numeric_limits<std::size_t>::max() }, range_sep{ false },
-        opt(2), max_steps_opt(5000), fermi_temp(0.0) {}
+        opt(2), max_steps_opt(5000), fermi_temp(0.0), socket(false), socket_timeout(60.0) {}
     } dftb;
 
     /**struct that contains all information necessary for ORCA calculation*/
@@ -990,6 +1004,43 @@ namespace config
       std::string threads = "";
     }psi4;
 
+    /**struct that contains information about the scratch directories of interfaces that call external programs*/
+    struct scratch_conf
+    {
+      /**what happens with a scratch directory when its interface is destroyed*/
+      struct cleanup_types { enum T { ALWAYS, KEEP_FAILED, NEVER }; };
+      /**should every interface instance work in its own directory? (otherwise working directory is used)*/
+      bool use{ false };
+      /**directory where the scratch directories are created (e.g. /dev/shm for tmpfs), empty: working directory*/
+      std::string base{ "" };
+      /**cleanup policy*/
+      cleanup_types::T cleanup{ cleanup_types::KEEP_FAILED };
+    } scratch;
+
+    /**struct that contains information about the reuse of the last wavefunction / density as initial guess of QM interfaces*/
+    struct guess_conf
+    {
+      /**should the result of the last calculation be used as initial guess?*/
+      bool use{ false };
+      /**maximum displacement of an atom (in angstrom) for which the old guess is still used*/
+      double threshold{ 0.5 };
+    } guess;
+
+    /**struct that contains information about the cache for energies and gradients of QM interfaces*/
+    struct cache_conf
+    {
+      /**should results of QM interfaces be stored and reused for the same geometry?*/
+      bool use{ false };
+      /**maximum number of results kept in memory (least recently used ones are removed)*/
+      std::size_t size{ 1000u };
+      /**file where results are stored so that they survive a restart (empty: only in memory)*/
+      std::string file{ "" };
+      /**coordinates are rounded to multiples of this value (in angstrom) before comparison*/
+      double resolution{ 1.0e-6 };
+      /**all options that might change energies (filled while parsing, part of the key of every result)*/
+      std::string settings{ "" };
+    } cache;
+
     /**default constructor for struct energy*/
     energy() :
       cutoff(std::numeric_limits<double>::max()), switchdist(cutoff - 4.0),
@@ -1237,7 +1288,7 @@ namespace config
   namespace optimization_conf
   {
     /**methods for local optimizations (LBFGS or internal where constraints are possible)*/
-    struct lo_types { enum T { LBFGS = 0, INTERNAL = 1, OPTPP = 2 }; };
+    struct lo_types { enum T { LBFGS = 0, INTERNAL = 1, OPTPP = 2, FIRE = 3 }; };
     /**methods for global optimizations (monte carlo with minimization, tabu-search)*/
     struct go_types { enum T { MCM, TABU }; };
 
@@ -1250,8 +1301,37 @@ namespace config
       std::size_t maxstep{10000};
       /**if set to true the same convergence criterion is used than for QM/MM optimizations*/
       bool use_different_convergence_criterion{ false };
+      /**precondition L-BFGS with the bonded terms of the force field given as preinterface
+      (the preinterface is then not used for a preoptimization)*/
+      bool ff_preconditioner{ false };
+      /**value added to the diagonal of the preconditioner (in kcal/mol/A^2)*/
+      double preconditioner_shift{ 10.0 };
     };
     
+    /**struct that contains configuration options for local optimisation via FIRE (fast inertial relaxation engine)
+    convergence threshold and maximum number of steps are the same as for bfgs*/
+    struct fire_options
+    {
+      /**initial time step (atoms have unit mass, so it only sets the scale of the first steps)*/
+      double dt{ 0.05 };
+      /**maximum time step*/
+      double dt_max{ 0.5 };
+      /**maximum displacement of an atom within one step (in angstrom)*/
+      double max_move{ 0.2 };
+      /**use FIRE instead of L-BFGS for the optimization with the preinterface*/
+      bool preoptimizer{ false };
+    };
+
+    /**struct that contains configuration options for local optimisation in internal coordinates*/
+    struct ic
+    {
+      /**number of internal coordinates from which on cartesian steps are calculated iteratively
+      instead of with the pseudo-inverse of the G-matrix (0 = never)*/
+      std::size_t iterative_backtransformation{ 500u };
+      /**number of steps kept for L-BFGS updates of the internal Hessian (0 = full BFGS-updated Hessian)*/
+      std::size_t lbfgs_memory{ 0u };
+    };
+
     /**information about a constraint bond in OPT++*/
     struct constraint_bond
     {
@@ -1398,6 +1478,10 @@ namespace config
       lo bfgs;
       /**contains options for OPT++*/
       opp optpp_conf;
+      /**contains options for optimisation in internal coordinates*/
+      ic internals;
+      /**contains options for FIRE*/
+      fire_options fire;
       /**should trace written into file?*/
       bool trace;
       /**constructor*/
@@ -1582,6 +1666,10 @@ namespace config
       CONNECT_NEB_NUMBER, NUMBER_OF_DIHEDRALS, MCM_SAVEITER;
     bool NEB_CONN, CONSTRAINT_GLOBAL, TAU, CONN,
       MIXED_MOVE, INT_PATH, CLIMBING, IDPP, MAXFLUX, MAXFLUX_PATHOPT, COMPLETE_PATH, MULTIPLE_POINTS, INTERNAL_INTERPOLATION, MCM_OPT;
+    /**calculate the images of the band (and search the PATHOPT hyperplanes) at the same time (external programs need QMSCRATCHuse)*/
+    bool PARALLEL;
+    /**only atom pairs closer than this in the start or final structure enter the IDPP (0: all pairs)*/
+    double IDPP_CUTOFF;
     neb() :
       FINAL_STRUCTURE{ "" }, OPTMODE("PROJECTED"),
       SPRINGCONSTANT(0.1), TEMPERATURE(298.15), MCSTEPSIZE(0.5),
@@ -1589,7 +1677,8 @@ namespace config
       BOND_PARAM(2.2), INT_IT(0.5), IMAGES(12), MCITERATION(100),
       GLOBALITERATION(1), CONNECT_NEB_NUMBER(3), NUMBER_OF_DIHEDRALS(1), MCM_SAVEITER(1),
       NEB_CONN(false), CONSTRAINT_GLOBAL(false), TAU(true), CONN(true), MIXED_MOVE(false),
-      INT_PATH(false), CLIMBING(true), IDPP(false), MAXFLUX(false), MAXFLUX_PATHOPT(false), COMPLETE_PATH(false), MULTIPLE_POINTS(false), INTERNAL_INTERPOLATION(false), MCM_OPT(true)
+      INT_PATH(false), CLIMBING(true), IDPP(false), MAXFLUX(false), MAXFLUX_PATHOPT(false), COMPLETE_PATH(false), MULTIPLE_POINTS(false), INTERNAL_INTERPOLATION(false), MCM_OPT(true),
+      PARALLEL(false), IDPP_CUTOFF(0.0)
     {}
   };
 
@@ -1688,6 +1777,19 @@ namespace config
     io(void) : amber_mdcrd(), amber_mdvel(), amber_inpcrd(), amber_restrt(), amber_trajectory_at_constant_pressure(false) {}
   };
 
+  /**struct for options of the profiler (timers and counters for MD steps and energy interfaces)*/
+  struct profiling
+  {
+    /**format of the summary file*/
+    struct formats { enum T { JSON, CSV }; };
+    /**collect timings and counters?*/
+    bool use{ false };
+    /**format of the summary file that is written at the end of the run*/
+    formats::T format{ formats::JSON };
+    /**print a report every ... MD steps (0 = only at the end)*/
+    std::size_t report_offset{ 0u };
+  };
+
   /*
   2DScan Struct
   */
@@ -1976,6 +2078,14 @@ namespace config
   */
   void parse_option(std::string const option, std::string const value);
 
+  /**
+  * Decides if an option might change the result of an energy calculation
+  * (only those are part of the keys in the energy cache, task options like MD or optimization settings are ignored)
+  *
+  * @param option: name of the configoption
+  */
+  bool affects_energy(std::string const& option);
+
   // Important function declarations end here...
 
   //... now some stream operators
@@ -2047,6 +2157,7 @@ public:
   config::layd                  layd;
   config::constrained_internals constrained_internals;
   config::stuff                 stuff;
+  config::profiling             profiling;
 
   /*! Constructor of Config object
    *
@@ -2075,6 +2186,7 @@ public:
    */
   static Config const& get()
   {
+    if (m_local) return *m_local;
     if (!m_instance) throw std::runtime_error("Configuration not loaded.");
     return *m_instance;
   }
@@ -2090,10 +2202,29 @@ public:
   */
   static Config& set()
   {
+    if (m_local) return *m_local;
     if (!m_instance) throw std::runtime_error("Configuration not loaded.");
     return *m_instance;
   }
 
+  /*! Immutable copy of the configuration
+   *
+   * Returns a copy of the configuration that is
+   * active in the calling thread. Drivers that run several
+   * tasks at the same time (NEB images, replicas, windows)
+   * take one snapshot per run and start every task with
+   * a local_scope created from it.
+   */
+  static std::shared_ptr<Config const> snapshot()
+  {
+    return std::shared_ptr<Config const>(new Config(get()));
+  }
+
+  /*! Thread-local configuration (see definition below) */
+  class local_scope;
+  /*! Configuration of the starting thread in OpenMP workers (see definition below) */
+  class worker_scope;
+
   /**
    * Helper function that matches a task
    * as string to the corresponding enum via
@@ -2145,6 +2276,77 @@ private:
    * If no object exists (yet), this will be a nullpointer.
    */
   static Config* m_instance;
+
+  /*! Pointer to the configuration of the innermost local_scope of this thread
+   *
+   * If no local_scope exists in the current thread this is a nullpointer
+   * and get() and set() refer to the global instance.
+   */
+  static thread_local Config* m_local;
+};
+
+/*! Thread-local configuration
+ *
+ * As long as an object of this class exists, Config::get() and
+ * Config::set() called from the creating thread refer to a private
+ * copy of the configuration. Changes made during the scope (e.g. periodic
+ * boundaries switched off for a QM calculation or the number of MD steps
+ * of one window) are invisible to other threads and are discarded at the
+ * end of the scope. Scopes can be nested and must be destroyed in reverse order.
+ *
+ * Note: OpenMP worker threads do not inherit the scope either. Inside a parallel
+ * region started from a scope they read the global configuration unless the
+ * region begins with a Config::worker_scope (as the force field and QM/MM loops do).
+ * Parallel tasks that change the configuration need their own local_scope (see NEB).
+ */
+class Config::local_scope
+{
+public:
+  /**copies the configuration that is currently active in this thread*/
+  local_scope() : local_scope(Config::get()) {}
+  /**copies the given configuration (e.g. a snapshot of the driver)*/
+  explicit local_scope(Config const& base) : m_config(base), m_previous(m_local)
+  {
+    m_local = &m_config;
+  }
+  ~local_scope()
+  {
+    m_local = m_previous;
+  }
+
+  local_scope(local_scope const&) = delete;
+  local_scope& operator= (local_scope const&) = delete;
+
+private:
+  Config m_config;
+  Config* m_previous;
+};
+
+/*! Configuration of the starting thread in OpenMP workers
+ *
+ * Created at the beginning of a parallel region with the configuration
+ * that is active in the thread starting the region (Config::get() before the region).
+ * Then Config::get() in every worker refers to that object, e.g. to a local_scope
+ * of a QM/MM calculation. The object is shared between the threads, so it must
+ * only be read inside the region.
+ */
+class Config::worker_scope
+{
+public:
+  explicit worker_scope(Config const& active) : m_previous(m_local)
+  {
+    m_local = const_cast<Config*>(&active);
+  }
+  ~worker_scope()
+  {
+    m_local = m_previous;
+  }
+
+  worker_scope(worker_scope const&) = delete;
+  worker_scope& operator= (worker_scope const&) = delete;
+
+private:
+  Config* m_previous;
 };
 
 #endif
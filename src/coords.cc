@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cmath>
 #include <stdexcept>
 #include "atomic.h"
@@ -5,8 +6,11 @@
 #include "configuration.h"
 #include "coords_io.h"
 #include "lbfgs.h"
+#include "fire.h"
+#include "ff_preconditioner.h"
 #include "optimization_dimer.h"
 #include "ic_exec.h"
+#include "Scon/scon_linkedcell.h"
 #ifdef USE_OPTPP
 #include "optimization_optpp.h"
 #endif
@@ -193,6 +197,7 @@ coords::Coordinates::Coordinates(Coordinates&& r) :
   m_preinterface(r.m_preinterface ? r.m_preinterface->move(this) : nullptr),
   energy_valid(r.energy_valid),
   atom_charges(r.atom_charges),
+  m_boxjump(std::move(r.m_boxjump)),
   m_representation(std::move(r.m_representation)),
   m_potentials(std::move(r.m_potentials)),
   fep(r.fep),
@@ -209,6 +214,7 @@ coords::Coordinates::Coordinates(Coordinates const& r) :
   m_preinterface(r.m_preinterface ? r.m_preinterface->clone(this) : nullptr),
   energy_valid(false),
   atom_charges(r.atom_charges),
+  m_boxjump(r.m_boxjump),
   m_representation(r.m_representation),
   m_potentials(r.m_potentials),
   fep(r.fep),
@@ -300,6 +306,7 @@ void coords::Coordinates::init_swap_in(Atoms& a, PES_Point& p, bool const update
   m_atoms.clear();
   a.swap(m_atoms);
   m_atoms.refine();
+  m_boxjump = boxjump_partition();   // molecules might have changed
   p.swap(m_representation);
   Stereo(m_atoms, m_representation.structure.cartesian).swap(m_stereo);
   m_representation.ia_matrix.resize(subsystems().size());
@@ -329,7 +336,7 @@ or by an optimizer integrated in the energy interface (available for most extern
 returns energy after optimization*/
 coords::float_type coords::Coordinates::o()
 {
-  if (preoptimize()) po();
+  if (preoptimize() && !ff_preconditioned()) po();
   energy_valid = true;
   if (m_interface->has_optimizer()
     && m_potentials.empty()                // no bias
@@ -345,6 +352,12 @@ coords::float_type coords::Coordinates::o()
       m_representation.energy = lbfgs_result.first;  // energy
       m_iter = lbfgs_result.second;                  // number of optmization steps
     }
+    else if (Config::get().optimization.local.method == config::optimization_conf::lo_types::FIRE)
+    {
+      auto fire_result = fire();
+      m_representation.energy = fire_result.first;  // energy
+      m_iter = fire_result.second;                  // number of optmization steps
+    }
     else if (Config::get().optimization.local.method == config::optimization_conf::lo_types::INTERNAL)    
     {
       ic_testing exec_obj;
@@ -368,6 +381,14 @@ coords::float_type coords::Coordinates::o()
   return m_representation.energy;
 }
 
+bool coords::Coordinates::ff_preconditioned() const
+{
+  if (!Config::get().optimization.local.bfgs.ff_preconditioner || !m_preinterface) return false;
+  if (Config::get().optimization.local.method != config::optimization_conf::lo_types::LBFGS) return false;
+  if (m_interface->has_optimizer() && m_potentials.empty() && !Config::get().periodics.periodic) return false;  // optimizer of interface is used
+  return !m_preinterface->model_hessian_terms().empty();   // same condition as in lbfgs()
+}
+
 std::pair<coords::float_type, std::size_t> coords::Coordinates::lbfgs()
 {
   using namespace  optimization::local;
@@ -384,6 +405,23 @@ std::pair<coords::float_type, std::size_t> coords::Coordinates::lbfgs()
     Config::get().optimization.local.bfgs.maxstep;
   optimizer.config.epsilon =
     (float)Config::get().optimization.local.bfgs.grad;
+  // precondition with the model Hessian of the force field (built once for the start structure)
+  if (Config::get().optimization.local.bfgs.ff_preconditioner && m_preinterface)
+  {
+    auto const terms = m_preinterface->model_hessian_terms();
+    if (!terms.empty())
+    {
+      std::vector<bool> fixed(size());
+      for (std::size_t i = 0u; i < size(); ++i) fixed[i] = atoms(i).fixed();
+      auto const preconditioner = std::make_shared<ff_preconditioner>(xyz(), terms,
+        Config::get().optimization.local.bfgs.preconditioner_shift, fixed);
+      optimizer.config.preconditioner = [preconditioner](op_type::grad_type& d) { (*preconditioner)(d); };
+    }
+    else if (Config::get().general.verbosity >= 1)
+    {
+      std::cout << "Preinterface has no force field terms, L-BFGS is not preconditioned.\n";
+    }
+  }
   optimizer(x);  // perform optimization
   m_representation.structure.cartesian =   // get optimized structure into coordobj
     coords::Representation_3D(optimizer.p().x.begin(), optimizer.p().x.end());
@@ -458,6 +496,65 @@ std::pair<coords::float_type, std::size_t> coords::Coordinates::prelbfgs()
   return std::pair<float_type, std::size_t> {m_representation.energy, optimizer.iter()};
 }
 
+namespace
+{
+  template<class CallbackT>
+  optimization::local::fire<CallbackT> make_configured_fire(CallbackT callback, coords::Representation_3D const& xyz,
+    bool const ignore_callback_stop)
+  {
+    auto optimizer = optimization::local::make_fire(std::move(callback));
+    optimizer.config.ignore_callback_stop = ignore_callback_stop;
+    auto const& conf = Config::get().optimization.local;
+    optimizer.config.dt_start = static_cast<float>(conf.fire.dt);
+    optimizer.config.dt_max = static_cast<float>(conf.fire.dt_max);
+    optimizer.config.max_move = static_cast<float>(conf.fire.max_move);
+    optimizer.config.max_iterations = conf.bfgs.maxstep;
+    optimizer.config.epsilon = static_cast<float>(conf.bfgs.grad);
+    typedef coords::Container<scon::c3<float>> nc3_type;
+    optimizer(typename decltype(optimizer)::point_type(nc3_type(xyz.begin(), xyz.end())));
+    return optimizer;
+  }
+}
+
+std::pair<coords::float_type, std::size_t> coords::Coordinates::fire()
+{
+  auto optimizer = make_configured_fire(Coords_3d_float_callback(*this), xyz(), true);
+  // get optimized structure and calculate energy and gradients there
+  m_representation.structure.cartesian =
+    coords::Representation_3D(optimizer.p().x.begin(), optimizer.p().x.end());
+  m_representation.energy = g();
+  m_representation.gradient.cartesian = g_xyz();
+  if (Config::get().general.verbosity >= 4 ||
+    (optimizer.state() < 0 && Config::get().general.verbosity >= 1))
+  {
+    std::cout << "FIRE optimization done (status " << optimizer.state();
+    if (optimizer.state() == optimization::local::status::ERR_CALLBACK_STOP)
+      std::cout << " ERROR: CALLBACK STOP.";
+    else if (optimizer.state() < 0)
+      std::cout << " ERROR: MAXIMUM ITERATIONS REACHED.";
+    else
+      std::cout << " SUCCESS!";
+    std::cout << "). Evaluations:" << optimizer.iter() << '\n';
+  }
+  return std::pair<float_type, std::size_t> {m_representation.energy, optimizer.iter()};
+}
+
+std::pair<coords::float_type, std::size_t> coords::Coordinates::prefire()
+{
+  auto optimizer = make_configured_fire(Coords_3d_float_pre_callback(*this), xyz(), false);
+  // get optimized structure and calculate energy and gradients with the main interface (as after prelbfgs)
+  m_representation.structure.cartesian =
+    coords::Representation_3D(optimizer.p().x.begin(), optimizer.p().x.end());
+  m_representation.energy = g();
+  m_representation.gradient.cartesian = g_xyz();
+  if (Config::get().general.verbosity >= 4)
+  {
+    std::cout << "FIRE preoptimization done (status " << optimizer.state() <<
+      "). Evaluations:" << optimizer.iter() << '\n';
+  }
+  return std::pair<float_type, std::size_t> {m_representation.energy, optimizer.iter()};
+}
+
 
 
 
@@ -473,6 +570,7 @@ void coords::Coordinates::swap(Coordinates& rhs) // object swap
   //m_sub_interaction.swap(rhs.m_sub_interaction);
   std::swap(energy_valid, rhs.energy_valid);
   std::swap(atom_charges, rhs.atom_charges);
+  std::swap(m_boxjump, rhs.m_boxjump);
   std::swap(this->fep, rhs.fep);
   std::swap(this->mult_struc_counter, rhs.mult_struc_counter);
   std::swap(this->NEB_control, rhs.NEB_control);
@@ -496,36 +594,116 @@ bool coords::Coordinates::check_structure()
 
 bool coords::Coordinates::check_for_crashes() const
 {
-  for (auto i = 0u; i < this->size(); ++i)
+  return find_crashes(true).empty();
+}
+
+bool coords::Coordinates::check_bond_preservation() const
+{
+  return find_broken_bonds(true).empty();
+}
+
+namespace
+{
+  /**sets value to the minimum of value and candidate (thread-safe)*/
+  void atomic_min(std::atomic<std::ptrdiff_t>& value, std::ptrdiff_t const candidate)
   {
-    for (auto j = 0u; j < i; j++)
+    auto current = value.load();
+    while (candidate < current && !value.compare_exchange_weak(current, candidate)) {}
+  }
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> coords::Coordinates::find_crashes(bool const stop_at_first) const
+{
+  using pair_list = std::vector<std::pair<std::size_t, std::size_t>>;
+  pair_list crashes;
+  std::ptrdiff_t const N(size());
+  if (N < 2) return crashes;
+
+  // two atoms can only crash if they are closer than 1.2 times twice the biggest covalent radius
+  double max_radius(0.0);
+  for (std::ptrdiff_t i = 0; i < N; ++i) max_radius = std::max(max_radius, atoms(i).cov_radius());
+  double const cutoff(std::max(2.4 * max_radius, 0.1));
+  bool const use_cells(scon::linked::pay_off(xyz(), cutoff));
+
+  using cells_type = scon::linked::Cells<coords::float_type, coords::Cartesian_Point, coords::Representation_3D>;
+  std::unique_ptr<cells_type> cells;
+  if (use_cells) cells = std::make_unique<cells_type>(xyz(), cutoff);
+
+  auto is_crash = [this](std::size_t const i, std::size_t const j)
+  {
+    auto const bonding_distance = 1.2 * (atoms(i).cov_radius() + atoms(j).cov_radius());
+    return dist(xyz(i), xyz(j)) < bonding_distance && atoms(i).is_bound_to(j) == false;
+  };
+
+  // smallest atom i with a crash found so far: rows with bigger i are skipped if stop_at_first is set,
+  // smaller ones are still searched, so the smallest pair is returned independent of the thread timing
+  std::atomic<std::ptrdiff_t> first_row(N);
+#pragma omp parallel
+  {
+    pair_list thread_crashes;
+#pragma omp for schedule(dynamic, 64)
+    for (std::ptrdiff_t i = 0; i < N; ++i)
     {
-      auto distance = dist(xyz(i), xyz(j));
-      auto bonding_distance = 1.2 * (atoms(i).cov_radius() + atoms(j).cov_radius());
-      if (distance < bonding_distance && atoms(i).is_bound_to(j) == false) return false;
+      if (stop_at_first && i > first_row) continue;
+      std::size_t const ui(i);
+      if (use_cells)
+      {
+        auto const box_of_i = cells->box_of_element(ui);   // must outlive the loop, adjacencies() only references it
+        for (auto j : box_of_i.adjacencies())              // atoms in the same and in neighbouring cells
+        {
+          if (j < 0 || static_cast<std::size_t>(j) >= ui) continue;
+          if (is_crash(ui, static_cast<std::size_t>(j))) thread_crashes.emplace_back(ui, static_cast<std::size_t>(j));
+        }
+      }
+      else
+      {
+        for (std::size_t j = 0u; j < ui; ++j)
+        {
+          if (is_crash(ui, j)) thread_crashes.emplace_back(ui, j);
+        }
+      }
+      if (!thread_crashes.empty() && thread_crashes.back().first == ui) atomic_min(first_row, i);
     }
+#pragma omp critical (crashes_merge)
+    crashes.insert(crashes.end(), thread_crashes.begin(), thread_crashes.end());
   }
-  return true;
+
+  std::sort(crashes.begin(), crashes.end());
+  if (stop_at_first && crashes.size() > 1u) crashes.resize(1u);
+  return crashes;
 }
 
-bool coords::Coordinates::check_bond_preservation() const
+std::vector<std::pair<std::size_t, std::size_t>> coords::Coordinates::find_broken_bonds(bool const stop_at_first) const
 {
-  std::size_t const N(size());
-  for (std::size_t i(0U); i < N; ++i)
-  { // cycle over all atoms i
-    if (!atoms(i).bonds().empty())
-    {
-      std::size_t const M(atoms(i).bonds().size());
-      for (std::size_t j(0U); j < M && atoms(i).bonds(j) < i; ++j)
+  using pair_list = std::vector<std::pair<std::size_t, std::size_t>>;
+  pair_list broken_bonds;
+  std::ptrdiff_t const N(size());
+  std::atomic<std::ptrdiff_t> first_row(N);   // see find_crashes()
+#pragma omp parallel
+  {
+    pair_list thread_broken_bonds;
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < N; ++i)
+    { // cycle over all atoms i
+      if (stop_at_first && i > first_row) continue;
+      std::size_t const ui(i);
+      for (auto const j : atoms(ui).bonds())
       { // cycle over all atoms bound to i
-        double const L(geometric_length(xyz(i) - xyz(atoms(i).bonds(j))));
-        double const max = 1.2 * (atoms(i).cov_radius() + atoms(atoms(i).bonds(j)).cov_radius());
+        if (j >= ui) continue;
+        double const L(geometric_length(xyz(ui) - xyz(j)));
+        double const max = 1.2 * (atoms(ui).cov_radius() + atoms(j).cov_radius());
         double const min = 0.3;
-        if (L > max || L < min) return false;
+        if (L > max || L < min) thread_broken_bonds.emplace_back(ui, j);
       }
+      if (!thread_broken_bonds.empty() && thread_broken_bonds.back().first == ui) atomic_min(first_row, i);
     }
+#pragma omp critical (broken_bonds_merge)
+    broken_bonds.insert(broken_bonds.end(), thread_broken_bonds.begin(), thread_broken_bonds.end());
   }
-  return true;
+
+  std::sort(broken_bonds.begin(), broken_bonds.end());
+  if (stop_at_first && broken_bonds.size() > 1u) broken_bonds.resize(1u);
+  return broken_bonds;
 }
 
 coords::Cartesian_Point coords::Coordinates::center_of_mass() const
@@ -556,6 +734,69 @@ coords::Cartesian_Point coords::Coordinates::center_of_geometry() const
 }
 
 
+coords::Snapshot::Snapshot(Coordinates const& source)
+  : m_source(&source), m_pes()
+{
+  // only positions and gradients, the rest of the PES point (e.g. hessian) isn't needed here
+  m_pes.structure.cartesian = source.xyz();
+  m_pes.gradient.cartesian = source.g_xyz();
+  m_pes.energy = source.pes().energy;
+  m_pes.integrity = source.pes().integrity;
+}
+
+coords::Snapshot::Snapshot(Coordinates const& source, PES_Point pes_point)
+  : m_source(&source), m_pes(std::move(pes_point))
+{
+  if (m_pes.structure.cartesian.size() != source.size())
+  {
+    throw std::logic_error("Wrong sized coordinates in Snapshot.");
+  }
+}
+
+void coords::Snapshot::set_xyz(Representation_3D const& new_xyz)
+{
+  if (new_xyz.size() != size()) throw std::logic_error("Wrong sized coordinates in set_xyz.");
+  m_pes.structure.cartesian = new_xyz;
+}
+
+void coords::Snapshot::set_xyz(Representation_3D&& new_xyz)
+{
+  if (new_xyz.size() != size()) throw std::logic_error("Wrong sized coordinates in set_xyz.");
+  m_pes.structure.cartesian = std::move(new_xyz);
+}
+
+void coords::Snapshot::move_all_by(Cartesian_Point const& p)
+{
+  for (auto& position : m_pes.structure.cartesian) position += p;
+}
+
+coords::Cartesian_Point coords::Snapshot::center_of_mass() const
+{
+  coords::Cartesian_Point COM;
+  coords::float_type M(0.0);
+  for (size_type i(0U); i < size(); ++i)
+  {
+    coords::float_type const mass(atoms(i).mass());
+    M += mass;
+    COM += xyz(i) * mass;
+  }
+  COM /= M;
+  return COM;
+}
+
+coords::Cartesian_Point coords::Snapshot::center_of_geometry() const
+{
+  coords::Cartesian_Point p(0);
+  for (auto const& position : xyz()) p += position;
+  p /= float_type(size());
+  return p;
+}
+
+void coords::Snapshot::apply_to(Coordinates& target) const
+{
+  target.set_xyz(xyz(), true);
+}
+
 double coords::Coordinates::weight() const
 {
   //A little too overkill
@@ -761,11 +1002,16 @@ void coords::Coordinates::periodic_boxjump(std::vector<std::vector<std::size_t>>
     }
   }
 
-  Cartesian_Point const halfbox(Config::get().periodics.pb_box / 2.0);
-  std::size_t const N(molecules.size());
+  Cartesian_Point const& box(Config::get().periodics.pb_box);
+  Cartesian_Point const halfbox(box / 2.0);
+  std::ptrdiff_t const N(molecules.size());
 
+  Representation_3D displacements(size(), Cartesian_Point());   // every atom is moved together with its molecule
+  std::vector<Cartesian_Point> shifts(N);
+  bool moved(false);
 
-  for (std::size_t i = 0; i < N; ++i)   // for every molecule
+#pragma omp parallel for reduction(||: moved) schedule(dynamic, 64)
+  for (std::ptrdiff_t i = 0; i < N; ++i)   // for every molecule
   {
     // calculate center of mass
     coords::Cartesian_Point current_center_of_mass;   // center of mass
@@ -780,42 +1026,26 @@ void coords::Coordinates::periodic_boxjump(std::vector<std::vector<std::size_t>>
 
     // calculate how the molecule will be moved
     Cartesian_Point tmp_com(-current_center_of_mass);  // vector by which the whole molecule will be moved
-    if (std::abs(tmp_com.x()) <= halfbox.x())
-    {
-      tmp_com.x() = 0;
-    }
-    else
-    {
-      tmp_com.x() = tmp_com.x() / Config::get().periodics.pb_box.x();
-      int tmp_x = std::round(tmp_com.x());
-      tmp_com.x() = tmp_x;
-    }
-    if (std::abs(tmp_com.y()) <= halfbox.y())
-    {
-      tmp_com.y() = 0;
-    }
-    else
-    {
-      tmp_com.y() = tmp_com.y() / Config::get().periodics.pb_box.y();
-      int tmp_y = std::round(tmp_com.y());
-      tmp_com.y() = tmp_y;
-    }
-    if (std::abs(tmp_com.z()) <= halfbox.z())
-    {
-      tmp_com.z() = 0;
-    }
-    else
+    tmp_com.x() = std::abs(tmp_com.x()) <= halfbox.x() ? 0.0 : static_cast<int>(std::round(tmp_com.x() / box.x()));
+    tmp_com.y() = std::abs(tmp_com.y()) <= halfbox.y() ? 0.0 : static_cast<int>(std::round(tmp_com.y() / box.y()));
+    tmp_com.z() = std::abs(tmp_com.z()) <= halfbox.z() ? 0.0 : static_cast<int>(std::round(tmp_com.z() / box.z()));
+    tmp_com *= box;
+    shifts[i] = tmp_com;
+
+    if (tmp_com.x() != 0.0 || tmp_com.y() != 0.0 || tmp_com.z() != 0.0)
     {
-      tmp_com.z() = tmp_com.z() / Config::get().periodics.pb_box.z();
-      int tmp_z = std::round(tmp_com.z());
-      tmp_com.z() = tmp_z;
+      moved = true;
+      for (auto const atom : molecules[i]) displacements[atom] = tmp_com;
     }
-    tmp_com *= Config::get().periodics.pb_box;
-    if (Config::get().general.verbosity > 4) std::cout << "molecule " << i << " is moved by " << tmp_com << "\n";
+  }
 
-    // move molecule
-    for (auto const atom : molecules[i]) move_atom_by(atom, tmp_com, true);
+  if (Config::get().general.verbosity > 4)
+  {
+    for (std::ptrdiff_t i = 0; i < N; ++i) std::cout << "molecule " << i << " is moved by " << shifts[i] << "\n";
   }
+
+  // move molecules (all at once, so stereo information is only updated once)
+  if (moved) move_atoms_by(displacements, true);
 }
 
 std::string coords::Coordinates::molecule_name(Container<std::size_t> const& molecule) const
@@ -829,93 +1059,70 @@ std::string coords::Coordinates::molecule_name(Container<std::size_t> const& mol
   return "XXX";    // anything else
 }
 
-void coords::Coordinates::periodic_boxjump_prep()
+std::vector<std::vector<std::size_t>> coords::Coordinates::boxjump_molecules(std::vector<std::vector<std::size_t>> const& qm_atoms) const
 {
-  if (Config::get().general.energy_interface == config::interface_types::QMMM_A || Config::get().general.energy_interface == config::interface_types::QMMM_S)
+  std::vector<std::size_t> molecule_of_atom(size(), 0u);   // index of molecule for every atom
+  for (std::size_t i = 0; i < molecules().size(); ++i)
   {
-    std::vector<std::vector<std::size_t>> indices_for_qm_molecules;                // track the indices of the molecules that are replaced by "QM molecules"
-    indices_for_qm_molecules.resize(Config::get().energy.qmmm.qm_systems.size());
-
-    for (auto q{ 0u }; q < Config::get().energy.qmmm.qm_systems.size(); ++q)   // for every QM system
-    {
-      auto const& qm_system = Config::get().energy.qmmm.qm_systems[q];
-      {
-        for (std::size_t i = 0; i < molecules().size(); ++i)   // for every molecule
-        {
-          for (auto atom = 0u; atom < molecules()[i].size(); ++atom)
-          {
-            if (is_in(molecules()[i][atom], qm_system))   // if any atom is in QM system: add whole molecule to "QM molecule"
-            {
-              indices_for_qm_molecules[q].push_back(i);
-              break;
-            }
-          }
-        }
-      }
-    }
-    indices_for_qm_molecules = combine_vectors(indices_for_qm_molecules);  // combine "QM molecules" which share atoms to one
-
-    std::vector<std::vector<std::size_t>> new_molecules;    // new molcules, i.e all without QM atoms and every "QM molecule" as one
-
-    for (std::size_t i = 0; i < molecules().size(); ++i)  // for every molecule
-    {
-      if (is_in_any(i, indices_for_qm_molecules) == false)    // if it's not part of any "QM molecule" add it to vector
-      {
-        std::vector<std::size_t> mol = molecules()[i];
-        new_molecules.emplace_back(mol);
-      }
-    }
+    for (auto atom : molecules()[i]) molecule_of_atom[atom] = i;
+  }
 
-    for (auto indices : indices_for_qm_molecules)   // add all the "QM molecules" to vector
+  std::vector<std::vector<std::size_t>> indices_for_qm_molecules;   // track the indices of the molecules that are replaced by "QM molecules"
+  for (auto const& qm_system : qm_atoms)   // for every QM system
+  {
+    std::vector<std::size_t> indices;
+    for (auto atom : qm_system)   // if any atom is in QM system: add whole molecule to "QM molecule"
     {
-      std::vector<std::size_t> mol;
-      for (auto const i : indices) mol = add_vectors(mol, molecules()[i]);
-      new_molecules.emplace_back(mol);
+      if (atom < molecule_of_atom.size()) scon::sorted::insert_unique(indices, molecule_of_atom[atom]);
     }
-
-    periodic_boxjump(new_molecules);                    // do boxjump
+    if (!indices.empty()) indices_for_qm_molecules.emplace_back(indices);
   }
+  indices_for_qm_molecules = combine_vectors(indices_for_qm_molecules);  // combine "QM molecules" which share atoms to one
 
-  else if (Config::get().general.energy_interface == config::interface_types::THREE_LAYER)
+  std::vector<bool> in_qm_molecule(molecules().size(), false);
+  for (auto const& indices : indices_for_qm_molecules)
   {
-    std::vector<std::size_t> new_qm_molecule;                 // create a molecule that consists of all molecules which contain QM or SE atoms
-    std::vector<std::size_t> qm_molecule_indices;             // track the indices of the molecules that are replaced by QM-SE molecule
-
-    for (std::size_t i = 0; i < molecules().size(); ++i)   // for every molecule
-    {
-      for (auto atom = 0u; atom < molecules()[i].size(); ++atom)
-      {
-        if (is_in(molecules()[i][atom], Config::get().energy.qmmm.qm_systems[0]) || is_in(molecules()[i][atom], Config::get().energy.qmmm.seatoms))
-        {
-          new_qm_molecule = add_vectors(new_qm_molecule, molecules()[i]);
-          qm_molecule_indices.push_back(i);
-          break;
-        }
-      }
-    }
+    for (auto i : indices) in_qm_molecule[i] = true;
+  }
 
-    std::vector<std::vector<std::size_t>> new_molecules;    // new molcules, i.e all without QM or SE atoms and the "QM-SE molecule" as one
+  std::vector<std::vector<std::size_t>> new_molecules;    // new molcules, i.e all without QM atoms and every "QM molecule" as one
+  for (std::size_t i = 0; i < molecules().size(); ++i)  // for every molecule
+  {
+    if (!in_qm_molecule[i]) new_molecules.emplace_back(molecules()[i].begin(), molecules()[i].end());   // if it's not part of any "QM molecule" add it to vector
+  }
+  for (auto const& indices : indices_for_qm_molecules)   // add all the "QM molecules" to vector
+  {
+    std::vector<std::size_t> mol;
+    for (auto const i : indices) mol.insert(mol.end(), molecules()[i].begin(), molecules()[i].end());
+    new_molecules.emplace_back(mol);
+  }
+  return new_molecules;
+}
 
-    for (std::size_t i = 0; i < molecules().size(); ++i)  // for every molecule
-    {
-      if (is_in(i, qm_molecule_indices) == false)    // if it's not part of "QM-SE molecule" add it to vector
-      {
-        std::vector<std::size_t> mol = molecules()[i];
-        new_molecules.emplace_back(mol);
-      }
-    }
-    new_molecules.emplace_back(new_qm_molecule);        // add QM molecule
+void coords::Coordinates::periodic_boxjump_prep()
+{
+  auto const energy_interface = Config::get().general.energy_interface;
 
-    periodic_boxjump(new_molecules);                    // do boxjump
+  std::vector<std::vector<std::size_t>> qm_atoms;   // atoms of which the molecules are combined
+  if (energy_interface == config::interface_types::QMMM_A || energy_interface == config::interface_types::QMMM_S)
+  {
+    qm_atoms = Config::get().energy.qmmm.qm_systems;     // every QM system is one molecule (unless they share molecules)
   }
-
-  else
+  else if (energy_interface == config::interface_types::THREE_LAYER)
   {
-    std::vector<std::vector<std::size_t>> new_molecules;      // convert molecules to a type which I can work with
-    for (auto m : molecules()) new_molecules.emplace_back(m);
+    qm_atoms.emplace_back(add_vectors(Config::get().energy.qmmm.qm_systems[0], Config::get().energy.qmmm.seatoms));   // QM and SE atoms are one molecule
+  }
 
-    periodic_boxjump(new_molecules);                          // do boxjump
+  // molecules only have to be determined again if topology or QM/MM partition has changed
+  if (!m_boxjump.valid || m_boxjump.energy_interface != energy_interface || m_boxjump.qm_atoms != qm_atoms)
+  {
+    m_boxjump.molecules = boxjump_molecules(qm_atoms);
+    m_boxjump.energy_interface = energy_interface;
+    m_boxjump.qm_atoms = qm_atoms;
+    m_boxjump.valid = true;
   }
+
+  periodic_boxjump(m_boxjump.molecules);                    // do boxjump
 }
 
 
@@ -180,12 +180,30 @@ namespace coords
     (filled if AMBER input is used or option chargefile is selected)*/
     std::vector<double>       atom_charges;
 
+    /**molecules that are moved as a whole by periodic_boxjump()
+    they only depend on topology and QM/MM partition so they are cached*/
+    struct boxjump_partition
+    {
+      /**molecules (for QM/MM interfaces all molecules with QM atoms are combined)*/
+      std::vector<std::vector<std::size_t>> molecules;
+      /**energy interface for which molecules were determined*/
+      config::interface_types::T energy_interface{ config::interface_types::ILLEGAL };
+      /**QM (and SE) atoms for which molecules were determined*/
+      std::vector<std::vector<std::size_t>> qm_atoms;
+      /**are molecules determined for current topology?*/
+      bool valid{ false };
+    }                         m_boxjump;
+
     /**number of iterations needed for last optimization*/
     std::size_t               m_iter{ 0u };
     /**lbfgs optimizer with preinterface, returns energy of optimized structure*/
     std::pair<coords::float_type, std::size_t> prelbfgs();
     /**lbfgs optimizer, returns energy of optimized structure and number of iterations*/
     std::pair<coords::float_type, std::size_t> lbfgs();
+    /**FIRE optimizer with preinterface, returns energy of optimized structure and number of iterations*/
+    std::pair<coords::float_type, std::size_t> prefire();
+    /**FIRE optimizer (one gradient per step), returns energy of optimized structure and number of iterations*/
+    std::pair<coords::float_type, std::size_t> fire();
 
     /**function to calculate energy*/
     coords::float_type m_e(energy::interface_base* const p)
@@ -315,6 +333,42 @@ namespace coords
       }
     }
 
+    /**move every atom by its own displacement vector
+    stereo information is updated only once for the whole structure
+    @param displacements: displacement of every atom (has to have size() entries)
+    @param force_move: if set to true also move fixed atoms; no fixation check is done at all then*/
+    void move_atoms_by(Representation_3D const& displacements, bool const force_move = false)
+    {
+      size_type const N(size());
+      if (displacements.size() != N)
+      {
+        throw std::logic_error("Number of displacements does not match number of atoms.");
+      }
+      if (force_move)
+      {
+        for (size_type i(0U); i < N; ++i) m_representation.structure.cartesian[i] += displacements[i];
+      }
+      else
+      {
+        for (size_type i(0U); i < N; ++i)
+        {
+          if (!atoms(i).fixed()) m_representation.structure.cartesian[i] += displacements[i];
+        }
+      }
+      energy_valid = false;
+      m_stereo.update(xyz());
+    }
+
+    /**is at least one atom fixed?*/
+    bool has_fixed_atoms() const
+    {
+      for (size_type i(0U); i < size(); ++i)
+      {
+        if (atoms(i).fixed()) return true;
+      }
+      return false;
+    }
+
 
     /**function to get bias potentials*/
     bias::Potentials& get_biases() { return m_potentials; }
@@ -354,7 +408,7 @@ namespace coords
           m_representation.energy = m_preinterface->o();
         }
         else {
-          auto lbfgs_result = prelbfgs();
+          auto lbfgs_result = Config::get().optimization.local.fire.preoptimizer ? prefire() : prelbfgs();
           m_representation.energy = lbfgs_result.first;  // energy
           m_iter = lbfgs_result.second;                  // number of optmization steps
         }
@@ -378,6 +432,9 @@ namespace coords
     }
 
     bool preoptimize() const { return m_preinterface ? true : false; }
+    /**is the next optimization a L-BFGS optimization preconditioned with the force field of the preinterface?
+    (preoptimization with the preinterface is skipped only then)*/
+    bool ff_preconditioned() const;
 
     /**returns the energy interface*/
     energy::interface_base* energyinterface() const { return m_interface; }
@@ -406,6 +463,15 @@ namespace coords
     bool check_for_crashes() const;
     /**checks if all bonds are still intact (bond length smaller than 1.2 sum of covalent radii but bigger than 0.3 Angstrom)*/
     bool check_bond_preservation() const;
+    /**finds non-bound atoms that are crashing (criterion see check_for_crashes())
+    linked cells are used so that only atoms close to each other are compared
+    @param stop_at_first: if true, search is stopped after the first crash (only the smallest pair is returned, also with several threads)
+    @return pairs of crashing atoms (j < i), sorted*/
+    std::vector<std::pair<std::size_t, std::size_t>> find_crashes(bool const stop_at_first = false) const;
+    /**finds bonds that are not intact any more (criterion see check_bond_preservation())
+    @param stop_at_first: if true, search is stopped after the first broken bond (only the smallest pair is returned, also with several threads)
+    @return pairs of bound atoms (j < i), sorted*/
+    std::vector<std::pair<std::size_t, std::size_t>> find_broken_bonds(bool const stop_at_first = false) const;
     /**looks if currently a valid z-matrix exists*/
     bool has_valid_internals() { return m_atoms.z_matrix_valid(); }
 
@@ -563,6 +629,10 @@ namespace coords
     (for QM/MM interfaces: whole QM part consists of one molecule)*/
     void periodic_boxjump_prep();
 
+    /**determines the molecules for periodic_boxjump()
+    @param qm_atoms: atoms of QM systems (all molecules that contain atoms of one QM system are combined, also those of QM systems with common molecules)*/
+    std::vector<std::vector<std::size_t>> boxjump_molecules(std::vector<std::vector<std::size_t>> const& qm_atoms) const;
+
     /**if periodic boundaries are activated:
     move molecules that are outside of the box into the box*/
     void periodic_boxjump(std::vector<std::vector<std::size_t>> const& molecules);
@@ -910,6 +980,62 @@ namespace coords
 
   std::ostream& operator<< (std::ostream& stream, Coordinates const& coord);
 
+  /**lightweight copy of a structure that owns only positions and gradients
+  atoms (and with them topology and internal coordinate definitions) are shared with the Coordinates object
+  the snapshot was taken from, the energy interface is not copied at all,
+  so the Coordinates object has to outlive the snapshot.
+  Meant for (thread-)private copies in analysis and geometry algorithms (alignment, distance measures, internal coordinates)
+  where copying a complete Coordinates object would dominate the runtime.*/
+  class Snapshot
+  {
+  public:
+    typedef PES_Point::size_type size_type;
+
+    /**takes positions and gradients of source*/
+    explicit Snapshot(Coordinates const& source);
+    /**takes positions and gradients from pes_point and all other information from source*/
+    Snapshot(Coordinates const& source, PES_Point pes_point);
+
+    /**Coordinates object that atoms and topology belong to*/
+    Coordinates const& source() const { return *m_source; }
+    /**atoms (shared with source)*/
+    Atoms const& atoms() const { return m_source->atoms(); }
+    /**atom with index i (shared with source)*/
+    Atom const& atoms(size_type const i) const { return m_source->atoms(i); }
+    /**number of atoms*/
+    size_type size() const { return m_pes.structure.cartesian.size(); }
+
+    /**positions and gradients*/
+    PES_Point const& pes() const { return m_pes; }
+    Representation_3D const& xyz() const { return m_pes.structure.cartesian; }
+    Cartesian_Point const& xyz(size_type const i) const { return m_pes.structure.cartesian[i]; }
+    Representation_Internal const& intern() const { return m_pes.structure.intern; }
+    internal_type const& intern(size_type const i) const { return m_pes.structure.intern[i]; }
+    Gradients_3D const& g_xyz() const { return m_pes.gradient.cartesian; }
+
+    /**set new positions (fixed atoms are not taken into account, there is nothing that could move them)*/
+    void set_xyz(Representation_3D const& new_xyz);
+    void set_xyz(Representation_3D&& new_xyz);
+    /**move all atoms by p*/
+    void move_all_by(Cartesian_Point const& p);
+
+    Cartesian_Point center_of_mass() const;
+    Cartesian_Point center_of_geometry() const;
+
+    /**calculate internal coordinates (and gradients) from cartesians with the z-matrix of source
+    (see Coordinates::to_internal()), returns false if the z-matrix is not valid for these positions*/
+    bool to_internal() { return m_source->atoms().c_to_i(m_pes); }
+    /**same as to_internal() but without gradients*/
+    bool to_internal_light() { return m_source->atoms().c_to_i_light(m_pes); }
+
+    /**write positions into a Coordinates object with the same atoms*/
+    void apply_to(Coordinates& target) const;
+
+  private:
+    Coordinates const* m_source;
+    PES_Point m_pes;
+  };
+
   struct internal_float_callback
   {
     coords::Coordinates* cp;
@@ -587,10 +587,9 @@ coords::Cartesian_Point coords::Atoms::rel_xyz(std::size_t const index,
   else throw std::logic_error("Wrong relative position requested. i > N + 2");
 }
 
-void coords::Atoms::c_to_i_light(PES_Point& p)
+bool coords::Atoms::c_to_i_light(PES_Point& p) const
 {
-  m_zmat_valid = true;
-
+  bool zmat_valid(true);
   using scon::dot;
   using scon::spherical;
   using scon::geometric_length;
@@ -622,7 +621,7 @@ void coords::Atoms::c_to_i_light(PES_Point& p)
     // if angle = 180° or angle = 0° return false (then it is not possible to define a proper dihedral angle)
     if (intern[i].inclination() == scon::ang<double>::from_deg(180.0) || intern[i].inclination() == scon::ang<double>::from_deg(0.0)) {
       if (Config::get().general.verbosity > 0) std::cout << "Warning! Issue in internal coordinates: angle that is either 0 or 180 degrees.\n";
-      m_zmat_valid = false;
+      zmat_valid = false;
     }
   }
   for (std::size_t j = 0; j < M; ++j)
@@ -631,12 +630,12 @@ void coords::Atoms::c_to_i_light(PES_Point& p)
     //std::cout << "Main Torsion " << j << " which is internal " << mti << " is " << intern[mti].azimuth() << '\n';
     p.structure.main[j] = intern[mti].azimuth();
   }
+  return zmat_valid;
 }
 
-void coords::Atoms::c_to_i(PES_Point& p)
+bool coords::Atoms::c_to_i(PES_Point& p) const
 {
-  m_zmat_valid = true;
-
+  bool zmat_valid(true);
   using scon::dot;
   using scon::spherical;
   using scon::geometric_length;
@@ -680,7 +679,7 @@ void coords::Atoms::c_to_i(PES_Point& p)
     // if angle = 180° or angle = 0° return false (then it is not possible to define a proper dihedral angle)
     if (intern[i].inclination() == scon::ang<double>::from_deg(180.0) || intern[i].inclination() == scon::ang<double>::from_deg(0.0)) {
       std::cout << "Warning! Issue in internal coordinates: angle that is either 0 or 180 degrees.\n";
-      m_zmat_valid = false;
+      zmat_valid = false;
     }
 
     auto j(i);
@@ -744,6 +743,7 @@ void coords::Atoms::c_to_i(PES_Point& p)
     }
 
   }
+  return zmat_valid;
 }
 
 void coords::Atoms::i_to_c(PES_Point& p) const
@@ -417,9 +417,13 @@ namespace coords
     /**convert internal to cartesian coordinates*/
     void i_to_c(PES_Point&) const;
     /**convert cartesian to internal coordinates*/
-    void c_to_i(PES_Point&);
+    void c_to_i(PES_Point& p) { m_zmat_valid = static_cast<Atoms const&>(*this).c_to_i(p); }
     /**convert cartesian to internal coordinates, but without gradients*/
-    void c_to_i_light(PES_Point&);
+    void c_to_i_light(PES_Point& p) { m_zmat_valid = static_cast<Atoms const&>(*this).c_to_i_light(p); }
+    /**same as above for positions that don't belong to this object (e.g. coords::Snapshot)
+    returns false if the z-matrix is not valid for these positions (angle of 0 or 180 degrees)*/
+    bool c_to_i(PES_Point&) const;
+    bool c_to_i_light(PES_Point&) const;
 
     // Helper
     size_t getNumberOfAtomsWithAtomicNumber(size_t searchedNumber) const;
@@ -16,6 +16,7 @@
 #include "energy_int_chemshell.h"
 #include "energy_int_psi4.h"
 #include "energy_int_orca.h"
+#include "energy_int_cache.h"
 #include "coords.h"
 #include "Scon/scon_utility.h"
 
@@ -169,13 +170,15 @@ static inline energy::interface_base* get_interface(coords::Coordinates* coordin
  */
 energy::interface_base* energy::new_interface(coords::Coordinates* coordinates)
 {
-  return get_interface(coordinates, Config::get().general.energy_interface);
+  auto const type = Config::get().general.energy_interface;
+  return energy::interfaces::cache::wrap(coordinates, get_interface(coordinates, type), type);
 }
 
 energy::interface_base* energy::pre_interface(coords::Coordinates* coordinates)
 {
   if (Config::get().general.preopt_interface == config::interface_types::T::ILLEGAL) { return nullptr; }
-  energy::interface_base* const r = get_interface(coordinates, Config::get().general.preopt_interface);
+  auto const type = Config::get().general.preopt_interface;
+  energy::interface_base* const r = energy::interfaces::cache::wrap(coordinates, get_interface(coordinates, type), type);
   return r;
 }
 
@@ -194,6 +197,7 @@ void energy::interface_base::swap(interface_base& other)
   std::swap(integrity, other.integrity);
   std::swap(optimizer, other.optimizer);
   std::swap(interactions, other.interactions);
+  std::swap(external_charges, other.external_charges);
 }
 
 void energy::interface_base::print_G_tinkerlike(std::ostream& S, bool const endline) const {
@@ -254,7 +258,3 @@ void energy::interface_base::boundary(coords::Cartesian_Point& r)
     r.z() += Config::get().periodics.pb_box.z();
   }
 }
-
-// definition of static variable, is necessary 
-// (see https://stackoverflow.com/questions/195207/unresolved-external-symbol-on-static-class-members)
-std::vector<energy::PointCharge> energy::interface_base::external_charges;
\ No newline at end of file
@@ -119,6 +119,19 @@ namespace energy
   };
 
 
+  /**harmonic term of a model Hessian (used to precondition optimizations with expensive interfaces)
+  the curvature 'force' is given for the internal coordinate defined by the atoms
+  (in kcal/mol/A^2 for bonds and kcal/mol/rad^2 for angles and dihedrals)*/
+  struct model_hessian_term
+  {
+    enum class kind { BOND, ANGLE, DIHEDRAL };
+    kind type;
+    /**atom indices (starting with 0), 2 for bonds, 3 for angles (middle atom second), 4 for dihedrals*/
+    std::vector<std::size_t> atoms;
+    coords::float_type force;
+  };
+
+
   /** Abstract  base class for interfaces,
   * parent class for all inrterface classes used
   * by CAST for example FF, MOPAC, terachem , gaussian etc.
@@ -128,8 +141,9 @@ namespace energy
   class interface_base
   {
   private:
-    /**vector of external charges (used in QM/MM methods)*/
-    static std::vector<PointCharge> external_charges;
+    /**external charges for the current calculation of this interface (used in QM/MM methods)
+    they are shared with the QM/MM interface that created them, so no copy is made for the subsystems*/
+    std::shared_ptr<std::vector<PointCharge> const> external_charges;
 
   protected:
 
@@ -142,16 +156,17 @@ namespace energy
     bool optimizer;
     bool interactions, internal_optimizer;
     /**function that returns external charges*/
-    static std::vector<PointCharge> const& get_external_charges() {
-      return external_charges;
+    std::vector<PointCharge> const& get_external_charges() const {
+      static std::vector<PointCharge> const no_charges;
+      return external_charges ? *external_charges : no_charges;
     }
-    /**function to set external charges*/
-    static void set_external_charges(std::vector<PointCharge> const& new_ext_charges) {
-      external_charges = new_ext_charges;
+    /**function that returns the shared external charges (nullptr if there are none)*/
+    std::shared_ptr<std::vector<PointCharge> const> const& shared_external_charges() const {
+      return external_charges;
     }
     /**function that deletes all external charges*/
-    static void clear_external_charges() {
-      external_charges.clear();
+    void clear_external_charges() {
+      external_charges.reset();
     }
     
   public:
@@ -164,9 +179,10 @@ namespace energy
       ss << (std::size_t(std::rand()) | (std::size_t(std::rand()) << 15));
       return output + "_tmp_" + ss.str();
     }
-    /**add an external point charge*/
-    static void add_external_charge(PointCharge const& p) {
-      external_charges.emplace_back(p);
+    /**sets the external charges for the following calculations of this interface
+    @param new_ext_charges: charges (not copied, nullptr for no charges)*/
+    void set_external_charges(std::shared_ptr<std::vector<PointCharge> const> new_ext_charges) {
+      external_charges = std::move(new_ext_charges);
     }
 
     /**total energy, in dftbaby interface this is called e_tot*/
@@ -225,8 +241,14 @@ namespace energy
 
     /** Return charges */
     virtual std::vector<coords::float_type> charges() const = 0;
+    /**returns bonded terms with their curvatures at the minimum,
+    empty for interfaces without a force field (default)*/
+    virtual std::vector<model_hessian_term> model_hessian_terms() const { return {}; }
     /**returns the coulomb gradients on external charges (used for QM/MM methods)*/
     virtual coords::Gradients_3D get_g_ext_chg() const = 0;
+    /**returns the directory in which the external programme of this interface runs,
+    empty if it uses the working directory (default)*/
+    virtual std::string working_directory() const { return std::string(); }
 
     /**This function is called in the non-bonding part of energy calculation with periodic boundaries.
     Before calling it the vector between two atoms whose interactions should be calculated is determined
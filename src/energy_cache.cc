@@ -0,0 +1,241 @@
+#include "energy_cache.h"
+
+#include <cmath>
+#include <stdexcept>
+#include "configuration.h"
+
+namespace
+{
+  // binary format of one result in the cache file:
+  // key, number of rounded coordinates, rounded coordinates, energy, integrity, has_gradients,
+  // gradients (if has_gradients), number of charges, charges, number of external gradients, external gradients
+
+  template<typename T>
+  void write_value(std::ostream& S, T const& value)
+  {
+    S.write(reinterpret_cast<char const*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  bool read_value(std::istream& S, T& value)
+  {
+    return static_cast<bool>(S.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  void write_points(std::ostream& S, coords::Gradients_3D const& points)
+  {
+    write_value(S, static_cast<std::uint64_t>(points.size()));
+    for (auto const& p : points)
+    {
+      write_value(S, static_cast<double>(p.x()));
+      write_value(S, static_cast<double>(p.y()));
+      write_value(S, static_cast<double>(p.z()));
+    }
+  }
+
+  bool read_points(std::istream& S, coords::Gradients_3D& points)
+  {
+    std::uint64_t n(0u);
+    if (!read_value(S, n)) return false;
+    points.resize(static_cast<std::size_t>(n));
+    for (auto& p : points)
+    {
+      double x, y, z;
+      if (!read_value(S, x) || !read_value(S, y) || !read_value(S, z)) return false;
+      p = coords::Cartesian_Point(x, y, z);
+    }
+    return true;
+  }
+
+  void write_entry(std::ostream& S, std::uint64_t const key, energy::cache_entry const& entry)
+  {
+    write_value(S, key);
+    write_value(S, static_cast<std::uint64_t>(entry.geometry.size()));
+    for (auto const q : entry.geometry) write_value(S, q);
+    write_value(S, static_cast<double>(entry.energy));
+    write_value(S, static_cast<std::uint8_t>(entry.integrity));
+    write_value(S, static_cast<std::uint8_t>(entry.has_gradients));
+    if (entry.has_gradients) write_points(S, entry.gradients);
+    write_value(S, static_cast<std::uint64_t>(entry.charges.size()));
+    for (auto const q : entry.charges) write_value(S, static_cast<double>(q));
+    write_points(S, entry.external_gradients);
+  }
+
+  bool read_entry(std::istream& S, std::uint64_t& key, energy::cache_entry& entry)
+  {
+    std::uint64_t n(0u);
+    if (!read_value(S, key) || !read_value(S, n)) return false;
+    entry.geometry.resize(static_cast<std::size_t>(n));
+    for (auto& q : entry.geometry)
+    {
+      if (!read_value(S, q)) return false;
+    }
+    double e(0.0);
+    std::uint8_t integrity(0u), has_gradients(0u);
+    if (!read_value(S, e) || !read_value(S, integrity) || !read_value(S, has_gradients)) return false;
+    entry.energy = e;
+    entry.integrity = integrity != 0u;
+    entry.has_gradients = has_gradients != 0u;
+    entry.gradients.clear();
+    if (entry.has_gradients && !read_points(S, entry.gradients)) return false;
+    if (!read_value(S, n)) return false;
+    entry.charges.resize(static_cast<std::size_t>(n));
+    for (auto& q : entry.charges)
+    {
+      double c(0.0);
+      if (!read_value(S, c)) return false;
+      q = c;
+    }
+    return read_points(S, entry.external_gradients);
+  }
+}
+
+energy::evaluation_cache::evaluation_cache()
+  : mtx(), lru(), index(), store(), n_hits(0u), n_misses(0u)
+{
+  if (!Config::get().energy.cache.file.empty()) open(Config::get().energy.cache.file);
+}
+
+energy::evaluation_cache& energy::evaluation_cache::get()
+{
+  static evaluation_cache instance;
+  return instance;
+}
+
+bool energy::evaluation_cache::active()
+{
+  return Config::get().energy.cache.use;
+}
+
+std::uint64_t energy::evaluation_cache::hash(std::uint64_t seed, void const* data, std::size_t const n)
+{
+  auto const* bytes = static_cast<unsigned char const*>(data);
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    seed ^= bytes[i];
+    seed *= 1099511628211ull;
+  }
+  return seed;
+}
+
+std::vector<std::int64_t> energy::evaluation_cache::quantize(coords::Representation_3D const& xyz)
+{
+  double const resolution = Config::get().energy.cache.resolution;
+  std::vector<std::int64_t> result;
+  result.reserve(xyz.size() * 3u);
+  for (auto const& p : xyz)
+  {
+    result.push_back(std::llround(p.x() / resolution));
+    result.push_back(std::llround(p.y() / resolution));
+    result.push_back(std::llround(p.z() / resolution));
+  }
+  return result;
+}
+
+bool energy::evaluation_cache::find(std::uint64_t const key, std::vector<std::int64_t> const& geometry, bool const gradients, cache_entry& result)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  auto const it = index.find(key);
+  if (it == index.end() || it->second->second.geometry != geometry || (gradients && !it->second->second.has_gradients))
+  {
+    ++n_misses;
+    return false;
+  }
+  lru.splice(lru.begin(), lru, it->second);   // most recently used
+  result = it->second->second;
+  ++n_hits;
+  return true;
+}
+
+void energy::evaluation_cache::insert_in_memory(std::uint64_t const key, cache_entry const& entry)
+{
+  auto const it = index.find(key);
+  if (it != index.end())
+  {
+    it->second->second = entry;
+    lru.splice(lru.begin(), lru, it->second);
+  }
+  else
+  {
+    lru.emplace_front(key, entry);
+    index[key] = lru.begin();
+  }
+  while (lru.size() > Config::get().energy.cache.size && !lru.empty())
+  {
+    index.erase(lru.back().first);
+    lru.pop_back();
+  }
+}
+
+void energy::evaluation_cache::insert(std::uint64_t const key, cache_entry const& entry)
+{
+  if (!entry.integrity) return;   // a failed calculation would be replayed forever
+  std::lock_guard<std::mutex> lock(mtx);
+  insert_in_memory(key, entry);
+  if (store.is_open())
+  {
+    write_entry(store, key, entry);
+    store.flush();   // results of a killed run should still be usable
+  }
+}
+
+void energy::evaluation_cache::open(std::string const& filename)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (store.is_open()) store.close();
+  std::size_t n_read(0u);
+  {
+    std::ifstream in(filename, std::ios::binary);
+    std::uint64_t key(0u);
+    cache_entry entry;
+    // an incomplete last record (run was killed while writing) is ignored
+    while (in && read_entry(in, key, entry))
+    {
+      if (!entry.integrity) continue;   // failed calculations written by older versions
+      insert_in_memory(key, entry);
+      ++n_read;
+    }
+  }
+  store.open(filename, std::ios::binary | std::ios::app);
+  if (!store) throw std::runtime_error("Could not open energy cache file '" + filename + "'.");
+  if (Config::get().general.verbosity > 1U && n_read > 0u)
+  {
+    std::cout << "Read " << n_read << " results from energy cache file '" << filename << "'.\n";
+  }
+}
+
+void energy::evaluation_cache::reset()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  lru.clear();
+  index.clear();
+  if (store.is_open()) store.close();
+  n_hits = n_misses = 0u;
+}
+
+std::size_t energy::evaluation_cache::hits() const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return n_hits;
+}
+
+std::size_t energy::evaluation_cache::misses() const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return n_misses;
+}
+
+std::size_t energy::evaluation_cache::size() const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return lru.size();
+}
+
+void energy::evaluation_cache::print_statistics(std::ostream& S) const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  auto const total = n_hits + n_misses;
+  S << "Energy cache: " << n_hits << " hits, " << n_misses << " misses";
+  if (total > 0u) S << " (hit rate " << 100.0 * static_cast<double>(n_hits) / static_cast<double>(total) << " %)";
+  S << ", " << lru.size() << " results in memory.\n";
+}
@@ -0,0 +1,112 @@
+/**
+CAST 3
+energy_cache.h
+Purpose: cache for results of expensive energy interfaces
+
+Results (energy, gradients, charges) are stored with a key that is built from the
+rounded coordinates, the external charges and all energy related options.
+If the same geometry is calculated again the stored result is returned.
+The most recently used results are kept in memory, optionally all results are
+also appended to a file so that a restarted run does not repeat finished calculations.
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "coords_rep.h"
+
+namespace energy
+{
+  /**result of one energy calculation*/
+  struct cache_entry
+  {
+    /**rounded coordinates (to tell apart different geometries with the same key)*/
+    std::vector<std::int64_t> geometry;
+    /**energy*/
+    coords::float_type energy{ 0.0 };
+    /**was the structure intact?*/
+    bool integrity{ true };
+    /**are gradients stored?*/
+    bool has_gradients{ false };
+    /**gradients (empty if has_gradients is false)*/
+    coords::Gradients_3D gradients;
+    /**partial charges*/
+    std::vector<coords::float_type> charges;
+    /**gradients on external charges*/
+    coords::Gradients_3D external_gradients;
+  };
+
+  /**global store for results of energy calculations
+  access is thread-safe so several interfaces can use it at the same time*/
+  class evaluation_cache
+  {
+  public:
+
+    /**returns the global cache (opens the file given by CACHEfile at first call)*/
+    static evaluation_cache& get();
+
+    /**is the cache switched on? (option CACHEuse)*/
+    static bool active();
+
+    /**FNV-1a hash of n bytes, continuing from seed*/
+    static std::uint64_t hash(std::uint64_t seed, void const* data, std::size_t const n);
+    /**start value for hash()*/
+    static std::uint64_t constexpr hash_seed{ 14695981039346656037ull };
+
+    /**rounds coordinates to multiples of CACHEresolution*/
+    static std::vector<std::int64_t> quantize(coords::Representation_3D const& xyz);
+
+    /**looks for a result
+    @param key: key of the calculation
+    @param geometry: rounded coordinates (must be equal to the stored ones)
+    @param gradients: are gradients needed?
+    @param result: is set to the stored result if one is found
+    @return true if a result was found*/
+    bool find(std::uint64_t const key, std::vector<std::int64_t> const& geometry, bool const gradients, cache_entry& result);
+
+    /**stores a result (and appends it to the file if one is opened)
+    results of failed calculations (integrity false) are not stored*/
+    void insert(std::uint64_t const key, cache_entry const& entry);
+
+    /**reads all results from file and appends new results to it
+    @param filename: name of the file (is created if it doesn't exist)*/
+    void open(std::string const& filename);
+
+    /**removes all results from memory and resets statistics (file is closed, not deleted)*/
+    void reset();
+
+    std::size_t hits() const;
+    std::size_t misses() const;
+    /**number of results in memory*/
+    std::size_t size() const;
+
+    /**print number of hits and misses*/
+    void print_statistics(std::ostream&) const;
+
+  private:
+
+    evaluation_cache();
+
+    /**store in memory without writing to file (lock has to be held)*/
+    void insert_in_memory(std::uint64_t const key, cache_entry const& entry);
+
+    mutable std::mutex mtx;
+    /**results, most recently used first*/
+    std::list<std::pair<std::uint64_t, cache_entry>> lru;
+    /**position of every key in lru*/
+    std::unordered_map<std::uint64_t, std::list<std::pair<std::uint64_t, cache_entry>>::iterator> index;
+    /**file where new results are appended*/
+    std::ofstream store;
+    std::size_t n_hits, n_misses;
+  };
+}
@@ -0,0 +1,79 @@
+#include "energy_guess.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include "configuration.h"
+#include "helperfunctions.h"
+
+namespace
+{
+  /**id of the instance that stored the last result in every guess file*/
+  std::map<std::string, std::size_t> guess_owners;
+  std::mutex guess_owners_mutex;
+}
+
+std::size_t energy::scf_guess::next_id()
+{
+  static std::atomic<std::size_t> counter{ 0u };
+  return ++counter;
+}
+
+energy::scf_guess& energy::scf_guess::operator= (scf_guess const&)
+{
+  m_xyz.clear();
+  m_valid = false;
+  m_in_use = false;
+  return *this;
+}
+
+bool energy::scf_guess::owns(std::string const& file) const
+{
+  std::lock_guard<std::mutex> lock(guess_owners_mutex);
+  auto const owner = guess_owners.find(file);
+  return owner != guess_owners.end() && owner->second == m_id;
+}
+
+bool energy::scf_guess::enabled()
+{
+  return Config::get().energy.guess.use;
+}
+
+coords::float_type energy::scf_guess::max_displacement(coords::Representation_3D const& a, coords::Representation_3D const& b)
+{
+  coords::float_type max_sq(0.0);
+  auto const n = std::min(a.size(), b.size());
+  for (std::size_t i = 0u; i < n; ++i)
+  {
+    auto const d = a[i] - b[i];
+    max_sq = std::max(max_sq, scon::dot(d, d));
+  }
+  return std::sqrt(max_sq);
+}
+
+bool energy::scf_guess::request(coords::Representation_3D const& xyz, std::string const& file)
+{
+  m_in_use = enabled() && m_valid && xyz.size() == m_xyz.size()
+    && max_displacement(xyz, m_xyz) < Config::get().energy.guess.threshold
+    && owns(file) && file_exists(file);
+  return m_in_use;
+}
+
+void energy::scf_guess::store(coords::Representation_3D const& xyz, std::string const& file)
+{
+  if (!enabled()) return;
+  {
+    std::lock_guard<std::mutex> lock(guess_owners_mutex);
+    guess_owners[file] = m_id;
+  }
+  m_xyz = xyz;
+  m_valid = true;
+}
+
+void energy::scf_guess::invalidate()
+{
+  m_valid = false;
+  m_in_use = false;
+}
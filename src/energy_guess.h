@@ -0,0 +1,70 @@
+/**
+CAST 3
+energy_guess.h
+Purpose: reuse of the converged wavefunction / density of the last QM calculation as initial guess
+
+The interfaces keep the file with the result of the last successful calculation
+(ORCA: .gbw, Gaussian: .chk, DFTB+: charges.bin, MOPAC: .den) and ask this class
+whether it may be read for the next calculation. This is only the case if the option
+QMGUESSuse is switched on and no atom moved further than QMGUESSthreshold.
+Every instance has its own id and the last instance that stored a result in a file owns it,
+so interfaces that share a guess file (no scratch directories) never read the result of another system.
+If the calculation with the old guess fails the interfaces invalidate it and start again from scratch.
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <string>
+#include "coords_rep.h"
+
+namespace energy
+{
+  /**bookkeeping for the initial guess of one interface instance*/
+  class scf_guess
+  {
+  public:
+
+    scf_guess() : m_xyz(), m_valid(false), m_in_use(false), m_id(next_id()) {}
+    /**a copy gets a new id and has no result yet (the guess file belongs to the original)*/
+    scf_guess(scf_guess const&) : scf_guess() {}
+    scf_guess& operator= (scf_guess const&);
+
+    /**is guess reuse switched on (option QMGUESSuse)?*/
+    static bool enabled();
+    /**largest distance between an atom in a and the same atom in b*/
+    static coords::float_type max_displacement(coords::Representation_3D const& a, coords::Representation_3D const& b);
+
+    /**decides if the guess file should be read for the next calculation and remembers the decision
+    @param xyz: geometry of the next calculation
+    @param file: path of the guess file (it has to exist and the last result in it has to be from this instance)
+    @return true if the guess should be used*/
+    bool request(coords::Representation_3D const& xyz, std::string const& file);
+    /**does the current calculation use the old guess? (i. e. result of last call to request())*/
+    bool in_use() const { return m_in_use; }
+
+    /**remember geometry of a successful calculation whose result can be used as next guess
+    @param xyz: geometry of the calculation
+    @param file: path of the guess file the result was written to*/
+    void store(coords::Representation_3D const& xyz, std::string const& file);
+    /**forget last result (e.g. because the SCF did not converge)*/
+    void invalidate();
+
+  private:
+
+    /**returns a new id for every instance*/
+    static std::size_t next_id();
+    /**was the last result in the file stored by this instance?*/
+    bool owns(std::string const& file) const;
+
+    /**geometry of the last successful calculation*/
+    coords::Representation_3D m_xyz;
+    /**is there a result of a successful calculation?*/
+    bool m_valid;
+    /**does the current calculation use the old guess?*/
+    bool m_in_use;
+    /**id of this instance*/
+    std::size_t m_id;
+  };
+}
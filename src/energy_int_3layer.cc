@@ -81,7 +81,8 @@ energy::interfaces::qmmm::THREE_LAYER::THREE_LAYER(THREE_LAYER const& rhs,
   coords::Coordinates* cobj) : interface_base(cobj),
   qm_indices(rhs.qm_indices), qmse_indices(rhs.qmse_indices),
   new_indices_qm(rhs.new_indices_qm), new_indices_qmse(rhs.new_indices_qmse), link_atoms_small(rhs.link_atoms_small),
-  link_atoms_medium(rhs.link_atoms_medium), qmc_small(rhs.qmc_small), sec_small(rhs.sec_small),
+  link_atoms_medium(rhs.link_atoms_medium), external_charges_medium(rhs.external_charges_medium),
+  external_charges_small_se(rhs.external_charges_small_se), external_charges_small_mm(rhs.external_charges_small_mm), qmc_small(rhs.qmc_small), sec_small(rhs.sec_small),
   sec_medium(rhs.sec_medium), mmc_medium(rhs.mmc_medium), mmc_big(rhs.mmc_big),
   index_of_medium_center(rhs.index_of_medium_center), index_of_small_center(rhs.index_of_small_center),
   qm_energy_small(rhs.qm_energy_small), se_energy_small(rhs.se_energy_small), se_energy_medium(rhs.se_energy_medium),
@@ -95,6 +96,8 @@ energy::interfaces::qmmm::THREE_LAYER::THREE_LAYER(THREE_LAYER&& rhs, coords::Co
   qm_indices(std::move(rhs.qm_indices)), qmse_indices(std::move(rhs.qmse_indices)),
   new_indices_qm(std::move(rhs.new_indices_qm)), new_indices_qmse(std::move(rhs.new_indices_qmse)),
   link_atoms_small(std::move(rhs.link_atoms_small)), link_atoms_medium(std::move(rhs.link_atoms_medium)),
+  external_charges_medium(std::move(rhs.external_charges_medium)), external_charges_small_se(std::move(rhs.external_charges_small_se)),
+  external_charges_small_mm(std::move(rhs.external_charges_small_mm)),
   qmc_small(std::move(rhs.qmc_small)), sec_small(std::move(rhs.sec_small)), sec_medium(std::move(rhs.sec_medium)),
   mmc_medium(std::move(rhs.mmc_medium)), mmc_big(std::move(rhs.mmc_big)),
   index_of_medium_center(std::move(rhs.index_of_medium_center)),
@@ -134,6 +137,9 @@ void energy::interfaces::qmmm::THREE_LAYER::swap(THREE_LAYER& rhs)
   new_indices_qmse.swap(rhs.new_indices_qmse);
   link_atoms_small.swap(rhs.link_atoms_small);
   link_atoms_medium.swap(rhs.link_atoms_medium);
+  std::swap(external_charges_medium, rhs.external_charges_medium);
+  std::swap(external_charges_small_se, rhs.external_charges_small_se);
+  std::swap(external_charges_small_mm, rhs.external_charges_small_mm);
   qmc_small.swap(rhs.qmc_small);
   sec_small.swap(rhs.sec_small);
   sec_medium.swap(rhs.sec_medium);
@@ -168,6 +174,15 @@ void energy::interfaces::qmmm::THREE_LAYER::initialization()
 
   // test if no atom is double in intermediate system (i. e. given both in QM and SE atoms)
   if (double_element(qmse_indices) == true) throw std::runtime_error("ERROR! You have at least one atom in QM as well as in SE atoms.");
+
+  // find atoms that give external charges
+  if (Config::get().energy.qmmm.zerocharge_bonds != 0)
+  {
+    auto all_indices = range(coords->size());
+    external_charges_medium = ExternalCharges(qmse_indices, all_indices, link_atoms_medium, coords);
+    external_charges_small_se = ExternalCharges(qm_indices, qmse_indices, link_atoms_small, coords);
+    external_charges_small_mm = ExternalCharges(qmse_indices, all_indices, link_atoms_small, coords);
+  }
 }
 
 // update structure (account for topology or rep change)
@@ -229,22 +244,8 @@ void energy::interfaces::qmmm::THREE_LAYER::update_representation()
   }
 }
 
-coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_gradient)
+bool energy::interfaces::qmmm::THREE_LAYER::calc_big(bool const if_gradient, coords::Gradients_3D& gradients)
 {
-  // ############ INITIALISATION AND UPDATE ##############################
-
-  update_representation(); // update positions of QM and MM subsystems to those of coordinates object
-
-  mm_energy_big = 0.0;     // set energies to zero
-  mm_energy_medium = 0.0;
-  se_energy_medium = 0.0;
-  se_energy_small = 0.0;
-  qm_energy_small = 0.0;
-  coords::Gradients_3D new_grads;  // save gradients in case of gradient calculation
-  bool periodic = Config::get().periodics.periodic;
-
-  // ############### MM ENERGY AND GRADIENTS FOR WHOLE SYSTEM ######################
-
   try {
     if (!if_gradient)
     {
@@ -253,39 +254,44 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
     else   // gradient calculation
     {
       mm_energy_big = mmc_big.g();
-      new_grads = mmc_big.g_xyz();
+      gradients = mmc_big.g_xyz();
     }
-    if (mm_energy_big == 0) integrity = false;
     if (Config::get().general.verbosity > 4)
     {
       std::cout << "MM energy of big system: \n";
       mmc_big.e_head_tostream_short(std::cout);
       mmc_big.e_tostream_short(std::cout);
     }
+    return mm_energy_big != 0;
   }
   catch (...)
   {
     std::cout << "MM programme (for big system) failed. Treating structure as broken.\n";
-    integrity = false;  // if MM programme fails: integrity is destroyed
+    return false;  // if MM programme fails: integrity is destroyed
   }
+}
 
-  // if program didn't calculate an energy: return zero-energy (otherwise CAST will break because it doesn't find charges)
-  if (integrity == false) return 0.0;
+bool energy::interfaces::qmmm::THREE_LAYER::calc_medium(bool const if_gradient, std::vector<double> const& mm_charges, coords::Gradients_3D& gradients)
+{
+  bool success = true;
+  bool const periodic = Config::get().periodics.periodic;
 
   // ############### CREATE EXTERNAL CHARGES FOR MEDIUM SYSTEM ######################
 
   std::vector<int> charge_indices;  // indizes of all atoms that are in charge_vector
-  charge_indices.clear();
+  auto point_charges = std::make_shared<std::vector<PointCharge>>();   // external charges of this layer
+  std::vector<PointCharge> const& ext_charges = *point_charges;
 
   if (Config::get().energy.qmmm.zerocharge_bonds != 0)
   {
-    auto mmc_big_charges = mmc_big.energyinterface()->charges();
-    if (mmc_big_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
-    auto all_indices = range(coords->size());
-    add_external_charges(qmse_indices, mmc_big_charges, all_indices, link_atoms_medium, charge_indices, coords, index_of_medium_center);
+    if (mm_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
+    external_charges_medium.add(mm_charges, charge_indices, coords, index_of_medium_center, *point_charges);
   }
 
-  Config::set().periodics.periodic = false;
+  sec_medium.energyinterface()->set_external_charges(point_charges);   // both subsystems of this layer see the same charges
+  mmc_medium.energyinterface()->set_external_charges(point_charges);
+
+  if (periodic) Config::set().periodics.periodic = false;
 
   // ############### SE ENERGY AND GRADIENTS FOR MEDIUM SYSTEM ######################
   try {
@@ -299,7 +305,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       auto g_se_medium = sec_medium.g_xyz();        // get gradients
       for (auto&& qsi : qmse_indices)
       {
-        new_grads[qsi] += g_se_medium[new_indices_qmse[qsi]];
+        gradients[qsi] += g_se_medium[new_indices_qmse[qsi]];
       }
 
       for (auto i = 0u; i < link_atoms_medium.size(); ++i)   // take into account link atoms
@@ -309,8 +315,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         coords::r3 g_qm, g_mm;        // divide link atom gradient to QM and MM atom
         auto link_atom_grad = g_se_medium[qmse_indices.size() + i];
         calc_link_atom_grad(l, link_atom_grad, coords, g_qm, g_mm);
-        new_grads[l.qm] += g_qm;
-        new_grads[l.mm] += g_mm;
+        gradients[l.qm] += g_qm;
+        gradients[l.mm] += g_mm;
 
         if (Config::get().general.verbosity > 4)
         {
@@ -319,7 +325,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         }
       }
     }
-    if (se_energy_medium == 0) integrity = false;
+    if (se_energy_medium == 0) success = false;
 
     if (Config::get().general.verbosity > 4)
     {
@@ -331,13 +337,13 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
   catch (...)
   {
     std::cout << "SE programme (for intermediate system) failed. Treating structure as broken.\n";
-    integrity = false;  // if SE programme fails: integrity is destroyed
+    success = false;  // if SE programme fails: integrity is destroyed
   }
 
   // ############### ONLY SINGE CHARGES: PREPARATION OF CHARGES FOR MEDIUM SYSTEM ################
 
   // set correct atom charges for medium system, can only be done after SE calculation because of link atoms
-  if (Config::get().general.single_charges && mmc_medium.get_atom_charges().empty())
+  if (success && Config::get().general.single_charges && mmc_medium.get_atom_charges().empty())
   {
     mmc_medium.set_atom_charges() = select_from_atomcharges(qmse_indices, coords); // only QM and SE charges in atom_charges
     for (auto i = 0u; i < link_atoms_medium.size(); ++i)                           // add charges of link atoms
@@ -347,10 +353,6 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
     }
   }
 
-  // ################ SAVE OUTPUT FOR BIG MM SYSTEM ########################################################
-
-  save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_big.energyinterface()->id, "big");
-
   // ############### MM ENERGY AND GRADIENTS FOR MEDIUM SYSTEM ######################
 
   try {
@@ -364,7 +366,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       auto g_mm_medium = mmc_medium.g_xyz(); // get gradients
       for (auto&& qsi : qmse_indices)
       {
-        new_grads[qsi] -= g_mm_medium[new_indices_qmse[qsi]];
+        gradients[qsi] -= g_mm_medium[new_indices_qmse[qsi]];
       }
 
       for (auto i = 0u; i < link_atoms_medium.size(); ++i)  // take into account link atoms
@@ -374,8 +376,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         coords::r3 g_qm, g_mm;             // divide link atom gradient to QM and MM atom
         auto link_atom_grad = g_mm_medium[qmse_indices.size() + i];
         calc_link_atom_grad(l, link_atom_grad, coords, g_qm, g_mm);
-        new_grads[l.qm] -= g_qm;
-        new_grads[l.mm] -= g_mm;
+        gradients[l.qm] -= g_qm;
+        gradients[l.mm] -= g_mm;
         if (Config::get().general.verbosity > 4)
         {
           std::cout << "Link atom between " << l.qm + 1 << " and " << l.mm + 1 << " has a gradient " << link_atom_grad << ".\n";
@@ -383,7 +385,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         }
       }
     }
-    if (mm_energy_medium == 0) integrity = false;
+    if (mm_energy_medium == 0) success = false;
 
     if (Config::get().general.verbosity > 4)
     {
@@ -395,12 +397,12 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
   catch (...)
   {
     std::cout << "MM programme (for intermediate system) failed. Treating structure as broken.\n";
-    integrity = false;  // if MM programme fails: integrity is destroyed
+    success = false;  // if MM programme fails: integrity is destroyed
   }
 
   // ############### GRADIENTS ON MM ATOMS DUE TO COULOMB INTERACTION WITH MEDIUM REGION ###
 
-  if (if_gradient && integrity == true && Config::get().energy.qmmm.zerocharge_bonds != 0)
+  if (if_gradient && success && Config::get().energy.qmmm.zerocharge_bonds != 0)
   {
     auto sec_medium_g_ext_charges = sec_medium.energyinterface()->get_g_ext_chg();
     auto mmc_medium_g_ext_charges = mmc_medium.energyinterface()->get_g_ext_chg();
@@ -417,8 +419,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       {
         double constexpr elec_factor = 332.06;
         double const& c = Config::get().energy.qmmm.cutoff;
-        double const& ext_chg = get_external_charges()[i].original_charge;
-        double const& scaling = get_external_charges()[i].scaled_charge / get_external_charges()[i].original_charge;
+        double const& ext_chg = ext_charges[i].original_charge;
+        double const& scaling = ext_charges[i].scaled_charge / ext_charges[i].original_charge;
         auto chargesSE = sec_medium.energyinterface()->charges();
         auto chargesMM = mmc_medium.energyinterface()->charges();
 
@@ -429,64 +431,75 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         {
           double const QMcharge_sec = chargesSE[j];
           double const QMcharge_mmc = chargesMM[j];
-          coords::r3 MMpos{ get_external_charges()[i].x,  get_external_charges()[i].y, get_external_charges()[i].z };
+          coords::r3 MMpos{ ext_charges[i].x,  ext_charges[i].y, ext_charges[i].z };
           double const dist = len(MMpos - coords->xyz(qmse_indices[j]));
           sum_of_QM_interactions_sec += (QMcharge_sec * ext_chg * elec_factor) / dist;
           sum_of_QM_interactions_mmc += (QMcharge_mmc * ext_chg * elec_factor) / dist;
         }
 
         // additional gradient on external charge due to interaction with SEC_medium
-        derivQ_sec.x() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).x() - get_external_charges()[i].x) * std::sqrt(scaling) / (c * c);
-        derivQ_sec.y() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).y() - get_external_charges()[i].y) * std::sqrt(scaling) / (c * c);
-        derivQ_sec.z() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).z() - get_external_charges()[i].z) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.x() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).x() - ext_charges[i].x) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.y() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).y() - ext_charges[i].y) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.z() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_medium_center).z() - ext_charges[i].z) * std::sqrt(scaling) / (c * c);
         grad_sec += derivQ_sec;
 
         // additional gradient on external charge due to interaction with MMC_medium
-        derivQ_mmc.x() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).x() - get_external_charges()[i].x) * std::sqrt(scaling) / (c * c);
-        derivQ_mmc.y() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).y() - get_external_charges()[i].y) * std::sqrt(scaling) / (c * c);
-        derivQ_mmc.z() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).z() - get_external_charges()[i].z) * std::sqrt(scaling) / (c * c);
+        derivQ_mmc.x() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).x() - ext_charges[i].x) * std::sqrt(scaling) / (c * c);
+        derivQ_mmc.y() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).y() - ext_charges[i].y) * std::sqrt(scaling) / (c * c);
+        derivQ_mmc.z() = sum_of_QM_interactions_mmc * 4 * (coords->xyz(index_of_medium_center).z() - ext_charges[i].z) * std::sqrt(scaling) / (c * c);
         grad_mmc += derivQ_mmc;
 
         // additional gradient on QM atom that defines distance
-        new_grads[index_of_medium_center] += (derivQ_mmc - derivQ_sec);
+        gradients[index_of_medium_center] += (derivQ_mmc - derivQ_sec);
       }
 
-      new_grads[mma] += grad_sec;
-      new_grads[mma] -= grad_mmc;
+      gradients[mma] += grad_sec;
+      gradients[mma] -= grad_mmc;
     }
   }
 
+  if (periodic) Config::set().periodics.periodic = periodic;   // switch back periodics
+  return success;
+}
+
+bool energy::interfaces::qmmm::THREE_LAYER::calc_small(bool const if_gradient, std::vector<double> const& mm_charges,
+  std::vector<double> const& se_charges, coords::Gradients_3D& gradients)
+{
+  bool success = true;
+  bool const periodic = Config::get().periodics.periodic;
+
   // ############### EXTERNAL CHARGES FOR SMALL SYSTEM ######################
 
-  Config::set().periodics.periodic = periodic;  // switch back periodics
+  std::vector<int> charge_indices;  // indizes of all atoms that are in charge_vector
+  auto point_charges = std::make_shared<std::vector<PointCharge>>();   // external charges of this layer
+  std::vector<PointCharge> const& ext_charges = *point_charges;
 
   if (Config::get().energy.qmmm.zerocharge_bonds != 0)
   {
-    if (Config::get().energy.qmmm.emb_small == 0)   // if EEx: no external charges for small system
+    if (Config::get().energy.qmmm.emb_small == 1)   // EE: same external charges as for medium system
     {
-      clear_external_charges();
+      if (mm_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
+      external_charges_medium.add(mm_charges, charge_indices, coords, index_of_medium_center, *point_charges);
     }
 
     else if (Config::get().energy.qmmm.emb_small > 1)  // EE+ and EE+X
     {
-      clear_external_charges();
-      charge_indices.clear();
-
       if (Config::get().energy.qmmm.emb_small == 3)    // only for EE+X
       {
-        auto sec_medium_charges = sec_medium.energyinterface()->charges();
-        if (sec_medium.size() == 0) throw std::runtime_error("no charges found in SE interface");
-        add_external_charges(qm_indices, sec_medium_charges, qmse_indices, link_atoms_small, charge_indices, coords, index_of_small_center);   // add charges from SE atoms
+        if (se_charges.size() == 0) throw std::runtime_error("no charges found in SE interface");
+        external_charges_small_se.add(se_charges, charge_indices, coords, index_of_small_center, *point_charges);   // add charges from SE atoms
       }
 
-      auto mmc_big_charges = mmc_big.energyinterface()->charges();
-      if (mmc_big_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
-      auto all_indices = range(coords->size());
-      add_external_charges(qmse_indices, mmc_big_charges, all_indices, link_atoms_small, charge_indices, coords, index_of_small_center);     // add charges from MM atoms
+      if (mm_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
+      external_charges_small_mm.add(mm_charges, charge_indices, coords, index_of_small_center, *point_charges);     // add charges from MM atoms
     }
+    // EEx: no external charges for small system
   }
 
-  Config::set().periodics.periodic = false;
+  qmc_small.energyinterface()->set_external_charges(point_charges);   // both subsystems of this layer see the same charges
+  sec_small.energyinterface()->set_external_charges(point_charges);
+
+  if (periodic) Config::set().periodics.periodic = false;
 
   // ############### QM ENERGY AND GRADIENTS FOR SMALL SYSTEM ######################
   try {
@@ -500,7 +513,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       auto g_qm_small = qmc_small.g_xyz();        // get gradients
       for (auto&& qmi : qm_indices)
       {
-        new_grads[qmi] += g_qm_small[new_indices_qm[qmi]];
+        gradients[qmi] += g_qm_small[new_indices_qm[qmi]];
       }
 
       for (auto i = 0u; i < link_atoms_small.size(); ++i)   // take into account link atoms
@@ -510,8 +523,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         coords::r3 g_qm, g_mm;        // divide link atom gradient to QM and MM atom
         auto link_atom_grad = g_qm_small[qm_indices.size() + i];
         calc_link_atom_grad(l, link_atom_grad, coords, g_qm, g_mm);
-        new_grads[l.qm] += g_qm;
-        new_grads[l.mm] += g_mm;
+        gradients[l.qm] += g_qm;
+        gradients[l.mm] += g_mm;
 
         if (Config::get().general.verbosity > 4)
         {
@@ -520,7 +533,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         }
       }
     }
-    if (qm_energy_small == 0) integrity = false;
+    if (qm_energy_small == 0) success = false;
 
     if (Config::get().general.verbosity > 4)
     {
@@ -532,13 +545,9 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
   catch (...)
   {
     std::cout << "QM programme (for small system) failed. Treating structure as broken.\n";
-    integrity = false;  // if QM programme fails: integrity is destroyed
+    success = false;  // if QM programme fails: integrity is destroyed
   }
 
-  // ################ SAVE OUTPUT FOR MEDIUM SE SYSTEM ########################################################
-
-  save_outputfiles(Config::get().energy.qmmm.seinterface, sec_medium.energyinterface()->id, "intermediate");
-
   // ############### SE ENERGY AND GRADIENTS FOR SMALL SYSTEM ######################
 
   try {
@@ -552,7 +561,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       auto g_se_small = sec_small.g_xyz(); // get gradients
       for (auto&& qmi : qm_indices)
       {
-        new_grads[qmi] -= g_se_small[new_indices_qm[qmi]];
+        gradients[qmi] -= g_se_small[new_indices_qm[qmi]];
       }
 
       for (auto i = 0u; i < link_atoms_small.size(); ++i)  // take into account link atoms
@@ -562,8 +571,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         coords::r3 g_qm, g_mm;             // divide link atom gradient to QM and MM atom
         auto link_atom_grad = g_se_small[qm_indices.size() + i];
         calc_link_atom_grad(l, link_atom_grad, coords, g_qm, g_mm);
-        new_grads[l.qm] -= g_qm;
-        new_grads[l.mm] -= g_mm;
+        gradients[l.qm] -= g_qm;
+        gradients[l.mm] -= g_mm;
         if (Config::get().general.verbosity > 4)
         {
           std::cout << "Link atom between " << l.qm + 1 << " and " << l.mm + 1 << " has a gradient " << link_atom_grad << ".\n";
@@ -571,7 +580,7 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         }
       }
     }
-    if (se_energy_small == 0) integrity = false;
+    if (se_energy_small == 0) success = false;
 
     if (Config::get().general.verbosity > 4)
     {
@@ -583,12 +592,12 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
   catch (...)
   {
     std::cout << "SE programme (for small system) failed. Treating structure as broken.\n";
-    integrity = false;  // if SE programme fails: integrity is destroyed
+    success = false;  // if SE programme fails: integrity is destroyed
   }
 
   // ############### GRADIENTS ON MM ATOMS DUE TO COULOMB INTERACTION WITH SMALL REGION ###
 
-  if (Config::get().energy.qmmm.emb_small != 0 && if_gradient && integrity == true && Config::get().energy.qmmm.zerocharge_bonds != 0)
+  if (Config::get().energy.qmmm.emb_small != 0 && if_gradient && success && Config::get().energy.qmmm.zerocharge_bonds != 0)
   {
     auto qmc_g_ext_charges = qmc_small.energyinterface()->get_g_ext_chg();
     auto sec_small_g_ext_charges = sec_small.energyinterface()->get_g_ext_chg();
@@ -605,8 +614,8 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
       {
         double constexpr elec_factor = 332.06;
         double const& c = Config::get().energy.qmmm.cutoff;
-        double const& ext_chg = get_external_charges()[i].original_charge;
-        double const& scaling = get_external_charges()[i].scaled_charge / get_external_charges()[i].original_charge;
+        double const& ext_chg = ext_charges[i].original_charge;
+        double const& scaling = ext_charges[i].scaled_charge / ext_charges[i].original_charge;
         auto chargesQM = qmc_small.energyinterface()->charges();
         auto chargesSE = sec_small.energyinterface()->charges();
 
@@ -617,43 +626,145 @@ coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_grad
         {
           double const QMcharge_qmc = chargesQM[j];
           double const QMcharge_sec = chargesSE[j];
-          coords::r3 MMpos{ get_external_charges()[i].x,  get_external_charges()[i].y,  get_external_charges()[i].z };
+          coords::r3 MMpos{ ext_charges[i].x,  ext_charges[i].y,  ext_charges[i].z };
           double const dist = len(MMpos - coords->xyz(qm_indices[j]));
           sum_of_QM_interactions_qmc += (QMcharge_qmc * ext_chg * elec_factor) / dist;
           sum_of_QM_interactions_sec += (QMcharge_sec * ext_chg * elec_factor) / dist;
         }
 
         // additional gradient on external charge due to interaction with QMC
-        derivQ_qmc.x() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).x() - get_external_charges()[i].x) * std::sqrt(scaling) / (c * c);
-        derivQ_qmc.y() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).y() - get_external_charges()[i].y) * std::sqrt(scaling) / (c * c);
-        derivQ_qmc.z() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).z() - get_external_charges()[i].z) * std::sqrt(scaling) / (c * c);
+        derivQ_qmc.x() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).x() - ext_charges[i].x) * std::sqrt(scaling) / (c * c);
+        derivQ_qmc.y() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).y() - ext_charges[i].y) * std::sqrt(scaling) / (c * c);
+        derivQ_qmc.z() = sum_of_QM_interactions_qmc * 4 * (coords->xyz(index_of_small_center).z() - ext_charges[i].z) * std::sqrt(scaling) / (c * c);
         grad_qmc += derivQ_qmc;
 
         // additional gradient on external charge due to interaction with SEC_SMALL
-        derivQ_sec.x() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).x() - get_external_charges()[i].x) * std::sqrt(scaling) / (c * c);
-        derivQ_sec.y() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).y() - get_external_charges()[i].y) * std::sqrt(scaling) / (c * c);
-        derivQ_sec.z() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).z() - get_external_charges()[i].z) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.x() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).x() - ext_charges[i].x) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.y() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).y() - ext_charges[i].y) * std::sqrt(scaling) / (c * c);
+        derivQ_sec.z() = sum_of_QM_interactions_sec * 4 * (coords->xyz(index_of_small_center).z() - ext_charges[i].z) * std::sqrt(scaling) / (c * c);
         grad_sec += derivQ_sec;
 
         // additional gradient on QM atom that defines distance
-        new_grads[index_of_small_center] += (derivQ_sec - derivQ_qmc);
+        gradients[index_of_small_center] += (derivQ_sec - derivQ_qmc);
       }
 
-      new_grads[mma] += grad_qmc;
-      new_grads[mma] -= grad_sec;
+      gradients[mma] += grad_qmc;
+      gradients[mma] -= grad_sec;
     }
   }
 
+  if (periodic) Config::set().periodics.periodic = periodic;   // switch back periodics
+  return success;
+}
+
+coords::float_type energy::interfaces::qmmm::THREE_LAYER::qmmm_calc(bool if_gradient)
+{
+  // ############ INITIALISATION AND UPDATE ##############################
+
+  update_representation(); // update positions of QM and MM subsystems to those of coordinates object
+
+  mm_energy_big = 0.0;     // set energies to zero
+  mm_energy_medium = 0.0;
+  se_energy_medium = 0.0;
+  se_energy_small = 0.0;
+  qm_energy_small = 0.0;
+  coords::Gradients_3D big_grads, medium_grads, small_grads;  // gradients of the three layers (in case of gradient calculation)
+  if (if_gradient)
+  {
+    big_grads.assign(coords->size(), coords::r3{});
+    medium_grads.assign(coords->size(), coords::r3{});
+    small_grads.assign(coords->size(), coords::r3{});
+  }
+
+  bool const ee = Config::get().energy.qmmm.zerocharge_bonds != 0;                   // electronic embedding?
+  bool const se_charges_needed = ee && Config::get().energy.qmmm.emb_small == 3;     // EE+X: small system needs charges of medium system
+  std::vector<double> mm_charges, se_charges;
+  bool big_ok{ false }, medium_ok{ false }, small_ok{ false };
+
+  // layers are calculated at the same time if every external programme has its own scratch directory
+  // (not with periodic boundaries as they are switched off globally during the QM and SE calculations)
+  bool const concurrent = Config::get().energy.qmmm.async && Config::get().energy.scratch.use && !Config::get().periodics.periodic;
+
+  if (concurrent)
+  {
+    // charges of a forcefield are known before the calculation, those of an external programme only afterwards
+    bool const mm_charges_known = !ee || Config::get().energy.qmmm.mminterface == config::interface_types::T::OPLSAA
+      || Config::get().energy.qmmm.mminterface == config::interface_types::T::AMBER;
+
+    std::future<bool> big_job;
+    if (mm_charges_known)
+    {
+      if (ee) mm_charges = mmc_big.energyinterface()->charges();
+      mmc_big.energyinterface()->set_external_charges(nullptr);   // every layer has its own charges, the big system none
+      big_job = run_in_background([this, if_gradient, &big_grads]() {
+        return calc_big(if_gradient, big_grads);
+      });
+    }
+    else if (calc_big(if_gradient, big_grads) == false)
+    {
+      // if program didn't calculate an energy: return zero-energy (otherwise CAST will break because it doesn't find charges)
+      integrity = false;
+      return 0.0;
+    }
+    else
+    {
+      big_ok = true;
+      mm_charges = mmc_big.energyinterface()->charges();
+    }
+
+    auto medium_job = run_in_background([this, if_gradient, &mm_charges, &medium_grads]() {
+      return calc_medium(if_gradient, mm_charges, medium_grads);
+    });
+    if (se_charges_needed)   // small system has to wait for medium system
+    {
+      medium_ok = medium_job.get();
+      if (medium_ok)
+      {
+        se_charges = sec_medium.energyinterface()->charges();
+        small_ok = calc_small(if_gradient, mm_charges, se_charges, small_grads);
+      }
+    }
+    else
+    {
+      small_ok = calc_small(if_gradient, mm_charges, se_charges, small_grads);
+      medium_ok = medium_job.get();
+    }
+    if (big_job.valid()) big_ok = big_job.get();
+    save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_big.energyinterface()->id, "big", mmc_big.energyinterface()->working_directory());
+    save_outputfiles(Config::get().energy.qmmm.seinterface, sec_medium.energyinterface()->id, "intermediate", sec_medium.energyinterface()->working_directory());
+  }
+  else   // one layer after the other
+  {
+    big_ok = calc_big(if_gradient, big_grads);
+    if (big_ok == false)
+    {
+      // if program didn't calculate an energy: return zero-energy (otherwise CAST will break because it doesn't find charges)
+      integrity = false;
+      return 0.0;
+    }
+    save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_big.energyinterface()->id, "big", mmc_big.energyinterface()->working_directory());
+
+    if (ee) mm_charges = mmc_big.energyinterface()->charges();
+    medium_ok = calc_medium(if_gradient, mm_charges, medium_grads);
+    save_outputfiles(Config::get().energy.qmmm.seinterface, sec_medium.energyinterface()->id, "intermediate", sec_medium.energyinterface()->working_directory());
+
+    if (se_charges_needed && medium_ok) se_charges = sec_medium.energyinterface()->charges();
+    if (medium_ok || !se_charges_needed) small_ok = calc_small(if_gradient, mm_charges, se_charges, small_grads);
+  }
+
   // ############### STUFF TO DO AT THE END OF CALCULATION ######################
 
-  clear_external_charges();                              // clear vector -> no point charges in calculation of mmc_big
-  Config::set().periodics.periodic = periodic;           // set back periodics
+  if (!big_ok || !medium_ok || !small_ok) integrity = false;
   if (file_exists("orca.gbw")) std::remove("orca.gbw");  // delete orca MOs for small system, otherwise orca will try to use them for medium system and fail
 
   if (coords->check_bond_preservation() == false) integrity = false;
   else if (coords->check_for_crashes() == false) integrity = false;
 
-  if (if_gradient) coords->swap_g_xyz(new_grads);     // swap gradients into coordobj
+  if (if_gradient)   // ONIOM combination of gradients, swap them into coordobj
+  {
+    coords::Gradients_3D new_grads = big_grads + medium_grads + small_grads;
+    coords->swap_g_xyz(new_grads);
+  }
   energy = mm_energy_big + se_energy_medium - mm_energy_medium + qm_energy_small - se_energy_small;
   return energy; // return total energy
 }
@@ -14,6 +14,7 @@ available interfaces: OPLSAA, AMBER, MOPAC, DFTB+, PSI4, GAUSSIAN, ORCA
 #include "coords.h"
 #include "coords_io.h"
 #include <vector>
+#include <future>
 #include "coords_atoms.h"
 #include "energy_int_aco.h"
 #include "energy_int_mopac.h"
@@ -97,6 +98,27 @@ namespace energy
         @param if_gradient: true if gradients should be calculated, false if not*/
         coords::float_type qmmm_calc(bool if_gradient);
 
+        /**calculates energy and gradients of big MM system
+        @param if_gradient: true if gradients should be calculated, false if not
+        @param gradients: is filled with the gradients of the big MM system
+        returns false if MM programme failed*/
+        bool calc_big(bool const if_gradient, coords::Gradients_3D& gradients);
+        /**calculates SE and MM energies and gradients of medium system
+        (external charges of this layer are only given to its own subsystems)
+        @param if_gradient: true if gradients should be calculated, false if not
+        @param mm_charges: charges of big MM system (only needed for electronic embedding)
+        @param gradients: contributions of medium system are added here
+        returns false if one of the programmes failed*/
+        bool calc_medium(bool const if_gradient, std::vector<double> const& mm_charges, coords::Gradients_3D& gradients);
+        /**calculates QM and SE energies and gradients of small system
+        (external charges of this layer are only given to its own subsystems)
+        @param if_gradient: true if gradients should be calculated, false if not
+        @param mm_charges: charges of big MM system (only needed for electronic embedding)
+        @param se_charges: charges of medium SE system (only needed for EE+X)
+        @param gradients: contributions of small system are added here
+        returns false if one of the programmes failed*/
+        bool calc_small(bool const if_gradient, std::vector<double> const& mm_charges, std::vector<double> const& se_charges, coords::Gradients_3D& gradients);
+
         /**fix all QM and SE atoms + M1 atoms
         @coordobj: coordinates object where atoms should be fixed*/
         void fix_qmse_atoms(coords::Coordinates& coordobj);
@@ -125,6 +147,13 @@ namespace energy
         /**vector with link atoms for medium system*/
         std::vector<LinkAtom> link_atoms_medium;
 
+        /**atoms that might give an external charge for medium system (prepared once per topology)*/
+        ExternalCharges external_charges_medium;
+        /**SE atoms that might give an external charge for small system (only EE+X)*/
+        ExternalCharges external_charges_small_se;
+        /**MM atoms that might give an external charge for small system (EE+ and EE+X)*/
+        ExternalCharges external_charges_small_mm;
+
         /**coordinates object for QM part*/
         coords::Coordinates qmc_small;
         /**SE coordinates object for QM part*/
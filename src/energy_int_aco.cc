@@ -3,9 +3,11 @@
 
 #include <sstream>
 #include <cstddef>
+#include <cmath>
 #include "energy_int_aco.h"
 #include "configuration.h"
 #include "Scon/scon_utility.h"
+#include "profiling.h"
 
 ::tinker::parameter::parameters energy::interfaces::aco::aco_ff::tp;
 
@@ -18,7 +20,7 @@
  * @param cobj: Pointer to coordinates object for which energy interface will perform
  */
 energy::interfaces::aco::aco_ff::aco_ff(coords::Coordinates* cobj)
-  : interface_base(cobj)
+  : interface_base(cobj), cparams(std::make_shared< ::tinker::parameter::parameters const>())
 {
   // tp are static tinker parameters envoked above 
   // (::tinker::parameter::parameters energy::interfaces::aco::aco_ff::tp;)
@@ -217,18 +219,20 @@ void energy::interfaces::aco::aco_ff::update(bool const skip_topology)
 {
   if (!skip_topology)
   {
+    profiling::scoped_timer topology_timer("FF topology setup");
     std::vector<std::size_t> types;
     for (auto&& atom : (*coords).atoms())
     {
       scon::sorted::insert_unique(types, atom.energy_type());
     }
-    cparams = tp.contract(types);
+    cparams = std::make_shared< ::tinker::parameter::parameters const>(tp.contract(types));
     refined = ::tinker::refine::refined((*coords), cparams);
     //restrainInternals(*coords, refined);
     //purge_nb_at_same_molecule(*coords, refined);
   }
   else
   {
+    profiling::scoped_timer pairlist_timer("FF pair-list build");
     refined.refine_nb(*coords);
   }
 }
@@ -270,6 +274,37 @@ std::vector<coords::float_type> energy::interfaces::aco::aco_ff::charges() const
   return c;
 }
 
+std::vector<energy::model_hessian_term> energy::interfaces::aco::aco_ff::model_hessian_terms() const
+{
+  std::vector<model_hessian_term> terms;
+  terms.reserve(refined.bonds().size() + refined.angles().size() + refined.torsions().size());
+  // E = k * r^2 for bonds and angles (in rad), i.e. curvature 2k
+  for (auto const& bond : refined.bonds())
+  {
+    terms.push_back({ model_hessian_term::kind::BOND, { bond.atoms[0], bond.atoms[1] }, 2.0 * bond.force });
+  }
+  for (auto const& angle : refined.angles())
+  {
+    terms.push_back({ model_hessian_term::kind::ANGLE, { angle.atoms[0], angle.atoms[1], angle.atoms[2] }, 2.0 * angle.force });
+  }
+  // E = F * (1 +- cos(n * phi)), curvature in the minimum is |F| * n^2
+  for (auto const& torsion : refined.torsions())
+  {
+    coords::float_type force(0.0);
+    for (std::size_t j(0U); j < torsion.p.number; ++j)
+    {
+      auto const n = static_cast<coords::float_type>(torsion.p.order[j]);
+      force += std::abs(torsion.p.force[j] * cparams->torsionunit()) * n * n;
+    }
+    if (force > 0.0)
+    {
+      terms.push_back({ model_hessian_term::kind::DIHEDRAL,
+        { torsion.atoms[0], torsion.atoms[1], torsion.atoms[2], torsion.atoms[3] }, force });
+    }
+  }
+  return terms;
+}
+
 // Output functions
 void energy::interfaces::aco::aco_ff::print_E(std::ostream&) const {}
 
@@ -327,7 +362,7 @@ void energy::interfaces::aco::aco_ff::print_E_head(std::ostream& S, bool const e
   }
   else
   {
-    S << std::right << std::setw(24) << (!cparams.charges().empty() ? ia : 0u);
+    S << std::right << std::setw(24) << (!cparams->charges().empty() ? ia : 0u);
   }
   S << std::right << std::setw(24) << "-";
   S << std::right << std::setw(24) << "-";
@@ -534,7 +569,7 @@ void energy::interfaces::aco::aco_ff::to_stream(std::ostream& S) const
   }
   for (auto en : part_energy) S << "Part energy: " << en << std::endl;
   S << "Params:" << std::endl;
-  S << cparams;
+  S << *cparams;
   S << "Refined:" << std::endl;
   S << refined;
 }
\ No newline at end of file
@@ -66,6 +66,8 @@ namespace energy
 
         /**get charges*/
         std::vector<coords::float_type> charges() const override;
+        /**bond, angle and torsion terms of the force field as model Hessian*/
+        std::vector<model_hessian_term> model_hessian_terms() const override;
         /**function to get coulomb gradients on external charges*/
         coords::Gradients_3D get_g_ext_chg() const override {
           return grad_ext_charges;
@@ -86,7 +88,7 @@ namespace energy
 
         ::tinker::parameter::parameters const& params() const
         {
-          return cparams;
+          return *cparams;
         }
 #ifdef GOOGLE_MOCK
       public:
@@ -104,9 +106,9 @@ namespace energy
 
         /** uncontracted arameters */
         static ::tinker::parameter::parameters tp;
-        /** contracted parameters */
-        ::tinker::parameter::parameters cparams;
-        /** refined parameters */
+        /** contracted parameters (shared by all clones, replaced and not changed on topology update) */
+        std::shared_ptr< ::tinker::parameter::parameters const> cparams;
+        /** refined parameters (topology dependent terms are shared by all clones, see tinker::refine::refined) */
         ::tinker::refine::refined refined;
         /**main function for calculating all non-bonding interactions:
         - selection of the correct nonbonded function
@@ -135,7 +137,7 @@ namespace energy
         ::tinker::parameter::combi::vdwc const& vdwcpar(std::size_t const ta, std::size_t const tb,
           scon::matrix< ::tinker::parameter::combi::vdwc, true> const& pm)
         {
-          return pm(cparams.contract_type(ta), cparams.contract_type(tb));
+          return pm(cparams->contract_type(ta), cparams->contract_type(tb));
         }
 
         /** 12-interactions (bonds)*/
@@ -9,6 +9,7 @@ This file contains the calculation of energy and gradients for amber, oplsaa and
 #include "energy_int_aco.h"
 #include "configuration.h"
 #include "Scon/scon_utility.h"
+#include "profiling.h"
 
 /****************************************
 *                                       *
@@ -47,24 +48,32 @@ coords::float_type energy::interfaces::aco::aco_ff::o(void)
 template<size_t DERIV>
 void energy::interfaces::aco::aco_ff::calc(void)
 {
-#pragma omp parallel sections
+  profiling::scoped_timer bonded_timer("FF bonded terms");
+  Config const& active_config = Config::get();   // workers do not inherit a Config::local_scope
+#pragma omp parallel
   {
+    Config::worker_scope config_scope(active_config);
+#pragma omp sections
+    {
 #pragma omp section
-    part_energy[types::BOND] = f_12<DERIV>();
+      part_energy[types::BOND] = f_12<DERIV>();
 #pragma omp section
-    part_energy[types::ANGLE] = f_13_a<DERIV>();
+      part_energy[types::ANGLE] = f_13_a<DERIV>();
 #pragma omp section
-    part_energy[types::UREY] = f_13_u<DERIV>();
+      part_energy[types::UREY] = f_13_u<DERIV>();
 #pragma omp section
-    part_energy[types::TORSION] = f_14<DERIV>();
+      part_energy[types::TORSION] = f_14<DERIV>();
 #pragma omp section
-    part_energy[types::IMPTORSION] = f_it<DERIV>();
+      part_energy[types::IMPTORSION] = f_it<DERIV>();
 #pragma omp section
-    part_energy[types::IMPROPER] = f_imp<DERIV>();
+      part_energy[types::IMPROPER] = f_imp<DERIV>();
+    }
   }
+  bonded_timer.stop();
 
+  profiling::scoped_timer nonbonded_timer("FF nonbonded terms");
   // fill part_energy[CHARGE], part_energy[VDW] and part_grad[VDW], part_grad[CHARGE]
-  if (cparams.radiustype() == ::tinker::parameter::radius_types::R_MIN)
+  if (cparams->radiustype() == ::tinker::parameter::radius_types::R_MIN)
   {
     g_nb< ::tinker::parameter::radius_types::R_MIN>();
   }
@@ -72,9 +81,11 @@ void energy::interfaces::aco::aco_ff::calc(void)
   {
     g_nb< ::tinker::parameter::radius_types::SIGMA>();
   }
+  nonbonded_timer.stop();
 
   if (get_external_charges().size() != 0)
   {
+    profiling::scoped_timer external_charges_timer("FF external charges");
     calc_ext_charges_interaction(DERIV);   // adds to part_energy[EXTERNAL_CHARGES] and part_grad[EXTERNAL_CHARGES]
   }
 }
@@ -425,7 +436,7 @@ namespace energy
           //cout << "Number?:  " << torsions[i].paramPtr->n << std::endl;
           for (std::size_t j(0U); j < torsion.p.number; ++j)
           {
-            coords::float_type const F = torsion.p.force[j] * cparams.torsionunit();
+            coords::float_type const F = torsion.p.force[j] * cparams->torsionunit();
             std::size_t const k = torsion.p.order[j];
             coords::float_type const l = std::abs(torsion.p.ideal[j]) > 0.0 ? -1.0 : 1.0;
             tE += F * (1.0 + cos[k] * l);
@@ -495,7 +506,7 @@ namespace energy
           //cout << "Number?:  " << torsions[i].paramPtr->n << std::endl;
           for (std::size_t j(0U); j < torsion.p.number; ++j)
           {
-            coords::float_type const F = torsion.p.force[j] * cparams.torsionunit();
+            coords::float_type const F = torsion.p.force[j] * cparams->torsionunit();
             std::size_t const k = torsion.p.order[j];
             coords::float_type const l = std::abs(torsion.p.ideal[j]) > 0.0 ? -1.0 : 1.0;
             tE += F * (1.0 + cos[k] * l);
@@ -1301,8 +1312,10 @@ namespace energy
       {
         std::ptrdiff_t const M(pairlist.size());
         coords::float_type e_c(0.0), e_v(0.0);
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
 #pragma omp for reduction (+: e_c, e_v)
@@ -1343,8 +1356,10 @@ namespace energy
       {
         std::ptrdiff_t const M(pairlist.size());
         coords::float_type e_c(0.0), e_v(0.0);
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
 #pragma omp for reduction (+: e_c, e_v)
@@ -1352,8 +1367,8 @@ namespace energy
           {
             double ca = coords->get_atom_charges()[pairlist[i].a];
             double cb = coords->get_atom_charges()[pairlist[i].b];
-            double current_c = ca * cb * cparams.general().electric;      // unit conversion
-            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams.general().chg_scale.value[3]; // 1,4 interactions are scaled down
+            double current_c = ca * cb * cparams->general().electric;      // unit conversion
+            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams->general().chg_scale.value[3]; // 1,4 interactions are scaled down
 
             coords::Cartesian_Point b(coords->xyz(pairlist[i].a) - coords->xyz(pairlist[i].b));
             coords::float_type const r = 1.0 / std::sqrt(dot(b, b));
@@ -1393,8 +1408,10 @@ namespace energy
         nb_cutoff cutob(Config::get().energy.cutoff, Config::get().energy.switchdist);
         coords::float_type e_c(0.0), e_v(0.0);
         std::ptrdiff_t const M(pairlist.size());
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
           coords::virial_t tempvir_vdw(coords::empty_virial());
@@ -1483,8 +1500,10 @@ namespace energy
         nb_cutoff cutob(Config::get().energy.cutoff, Config::get().energy.switchdist);
         coords::float_type e_c(0.0), e_v(0.0);
         std::ptrdiff_t const M(pairlist.size());
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
           coords::virial_t tempvir_vdw(coords::empty_virial());
@@ -1503,8 +1522,8 @@ namespace energy
             r = 1.0 / r;
             double ca = coords->get_atom_charges()[pairlist[i].a];
             double cb = coords->get_atom_charges()[pairlist[i].b];
-            double current_c = ca * cb * cparams.general().electric;  // unit conversion
-            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams.general().chg_scale.value[3]; // 1,4 interactions are scaled down
+            double current_c = ca * cb * cparams->general().electric;  // unit conversion
+            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams->general().chg_scale.value[3]; // 1,4 interactions are scaled down
             ::tinker::parameter::combi::vdwc const& p(params(refined.type(pairlist[i].a), refined.type(pairlist[i].b)));   // get parameters for current pair
 
             g_QV_cutoff<RT>(current_c, p.E, p.R, r, fQ, fV, e_c, e_v, dE_c, dE_v);  //calculate vdw and coulomb energy and gradients
@@ -1580,8 +1599,10 @@ namespace energy
         coords::float_type e_c(0.0), e_v(0.0), e_c_l(0.0), e_vdw_l(0.0), e_c_dl(0.0), e_vdw_dl(0.0), e_c_ml(0.0), e_vdw_ml(0.0);
         fepvar const& fep = coords->getFep().window[coords->getFep().window[0].step];
         std::ptrdiff_t const M(pairlist.size());
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
           coords::virial_t tempvir_vdw(coords::empty_virial());
@@ -1717,8 +1738,10 @@ namespace energy
         coords::float_type e_c(0.0), e_v(0.0), e_c_l(0.0), e_vdw_l(0.0), e_c_dl(0.0), e_vdw_dl(0.0), e_c_ml(0.0), e_vdw_ml(0.0);
         fepvar const& fep = coords->getFep().window[coords->getFep().window[0].step];
         std::ptrdiff_t const M(pairlist.size());
+        Config const& active_config = Config::get();
 #pragma omp parallel
         {
+          Config::worker_scope config_scope(active_config);
           coords::Representation_3D tmp_grad_vdw(grad_vdw.size());
           coords::Representation_3D tmp_grad_coul(grad_coulomb.size());
           coords::virial_t tempvir_vdw(coords::empty_virial());
@@ -1728,8 +1751,8 @@ namespace energy
           {
             double ca = coords->get_atom_charges()[pairlist[i].a];
             double cb = coords->get_atom_charges()[pairlist[i].b];
-            double current_c = ca * cb * cparams.general().electric;  // unit conversion
-            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams.general().chg_scale.value[3]; // 1,4 interactions are scaled down
+            double current_c = ca * cb * cparams->general().electric;  // unit conversion
+            if (refined.get_relation(pairlist[i].b, pairlist[i].a) == 3) current_c = current_c / cparams->general().chg_scale.value[3]; // 1,4 interactions are scaled down
             coords::Cartesian_Point b(coords->xyz(pairlist[i].a) - coords->xyz(pairlist[i].b));  //vector between atoms a and b
             if (PERIODIC) boundary(b);   // adjust vector to boundary conditions
             ::tinker::parameter::combi::vdwc const& p(params(refined.type(pairlist[i].a), refined.type(pairlist[i].b)));  // get parameters
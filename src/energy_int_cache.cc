@@ -0,0 +1,231 @@
+#include "energy_int_cache.h"
+
+#include <iomanip>
+#include <string>
+#include "coords.h"
+#include "profiling.h"
+
+energy::interfaces::cache::cached_interface::cached_interface(coords::Coordinates* cp, interface_base* wrapped, config::interface_types::T const type) :
+  energy::interface_base(cp), m_wrapped(wrapped), m_settings(energy::evaluation_cache::hash_seed), m_from_cache(false)
+{
+  auto const& settings = Config::get().energy.cache.settings;
+  int const interface_type = static_cast<int>(type);
+  m_settings = energy::evaluation_cache::hash(m_settings, &interface_type, sizeof(interface_type));
+  m_settings = energy::evaluation_cache::hash(m_settings, settings.data(), settings.size());
+  charge = m_wrapped->charge;
+  sync();
+}
+
+energy::interfaces::cache::cached_interface::cached_interface(cached_interface const& rhs, coords::Coordinates* cobj, interface_base* wrapped) :
+  interface_base(cobj), m_wrapped(wrapped), m_settings(rhs.m_settings), m_from_cache(rhs.m_from_cache),
+  m_charges(rhs.m_charges), m_external_gradients(rhs.m_external_gradients)
+{
+  charge = rhs.charge;
+  interface_base::operator=(rhs);
+}
+
+energy::interface_base* energy::interfaces::cache::cached_interface::clone(coords::Coordinates* coord_object) const
+{
+  return new cached_interface(*this, coord_object, m_wrapped->clone(coord_object));
+}
+
+energy::interface_base* energy::interfaces::cache::cached_interface::move(coords::Coordinates* coord_object)
+{
+  return new cached_interface(*this, coord_object, m_wrapped->move(coord_object));
+}
+
+void energy::interfaces::cache::cached_interface::swap(interface_base& rhs)
+{
+  swap(dynamic_cast<cached_interface&>(rhs));
+}
+
+void energy::interfaces::cache::cached_interface::swap(cached_interface& rhs)
+{
+  interface_base::swap(rhs);
+  m_wrapped->swap(*rhs.m_wrapped);
+  std::swap(m_settings, rhs.m_settings);
+  std::swap(m_from_cache, rhs.m_from_cache);
+  m_charges.swap(rhs.m_charges);
+  m_external_gradients.swap(rhs.m_external_gradients);
+}
+
+void energy::interfaces::cache::cached_interface::sync()
+{
+  energy = m_wrapped->energy;
+  integrity = m_wrapped->intact();
+  periodic = m_wrapped->has_periodics();
+  optimizer = m_wrapped->has_optimizer();
+  interactions = m_wrapped->has_interactions();
+  occMO = m_wrapped->occMO;
+  virtMO = m_wrapped->virtMO;
+  excitE = m_wrapped->excitE;
+  ex_ex_trans = m_wrapped->ex_ex_trans;
+  gz_ex_trans = m_wrapped->gz_ex_trans;
+  state_i = m_wrapped->state_i;
+  state_j = m_wrapped->state_j;
+  gz_i_state = m_wrapped->gz_i_state;
+}
+
+std::uint64_t energy::interfaces::cache::cached_interface::key(std::vector<std::int64_t> const& geometry) const
+{
+  using cache_type = energy::evaluation_cache;
+  std::uint64_t result = cache_type::hash(m_settings, &charge, sizeof(charge));
+  result = cache_type::hash(result, geometry.data(), sizeof(std::int64_t) * geometry.size());
+  // external charges (QM/MM) change the result as well
+  double const resolution = Config::get().energy.cache.resolution;
+  for (auto const& c : get_external_charges())
+  {
+    std::int64_t const q[4] = { std::llround(c.x / resolution), std::llround(c.y / resolution),
+      std::llround(c.z / resolution), std::llround(c.scaled_charge / resolution) };
+    result = cache_type::hash(result, q, sizeof(q));
+  }
+  return result;
+}
+
+coords::float_type energy::interfaces::cache::cached_interface::evaluate(bool const gradients)
+{
+  auto& store = energy::evaluation_cache::get();
+  auto geometry = energy::evaluation_cache::quantize(coords->xyz());
+  auto const k = key(geometry);
+
+  energy::cache_entry entry;
+  if (store.find(k, geometry, gradients, entry) && (!gradients || entry.gradients.size() == coords->size()))
+  {
+    profiling::count("energy cache hit");
+    energy = entry.energy;
+    integrity = entry.integrity;
+    if (gradients) coords->set_g_xyz(std::move(entry.gradients));
+    m_charges = std::move(entry.charges);
+    m_external_gradients = std::move(entry.external_gradients);
+    m_from_cache = true;
+    return energy;
+  }
+
+  profiling::count("energy cache miss");
+  m_wrapped->charge = charge;   // might have been changed from outside (e.g. THREE_LAYER)
+  m_wrapped->set_external_charges(shared_external_charges());
+  gradients ? m_wrapped->g() : m_wrapped->e();
+  sync();
+  m_from_cache = false;
+  if (!integrity) return energy;   // failed calculations (e.g. crashed QM programme) are not stored
+
+  entry.geometry = std::move(geometry);
+  entry.energy = energy;
+  entry.integrity = integrity;
+  entry.has_gradients = gradients;
+  if (gradients) entry.gradients = coords->g_xyz();
+  else entry.gradients.clear();
+  entry.charges = m_wrapped->charges();
+  entry.external_gradients = m_wrapped->get_g_ext_chg();
+  store.insert(k, entry);
+  return energy;
+}
+
+coords::float_type energy::interfaces::cache::cached_interface::e(void)
+{
+  return evaluate(false);
+}
+
+coords::float_type energy::interfaces::cache::cached_interface::g(void)
+{
+  return evaluate(true);
+}
+
+coords::float_type energy::interfaces::cache::cached_interface::h(void)
+{
+  m_wrapped->charge = charge;
+  m_wrapped->set_external_charges(shared_external_charges());
+  m_wrapped->h();
+  sync();
+  m_from_cache = false;
+  return energy;
+}
+
+coords::float_type energy::interfaces::cache::cached_interface::o(void)
+{
+  m_wrapped->charge = charge;
+  m_wrapped->set_external_charges(shared_external_charges());
+  m_wrapped->o();
+  sync();
+  m_from_cache = false;
+  return energy;
+}
+
+std::vector<coords::float_type> energy::interfaces::cache::cached_interface::charges() const
+{
+  return m_from_cache ? m_charges : m_wrapped->charges();
+}
+
+coords::Gradients_3D energy::interfaces::cache::cached_interface::get_g_ext_chg() const
+{
+  return m_from_cache ? m_external_gradients : m_wrapped->get_g_ext_chg();
+}
+
+void energy::interfaces::cache::cached_interface::update(bool const skip_topology)
+{
+  m_wrapped->update(skip_topology);
+}
+
+void energy::interfaces::cache::cached_interface::print_E(std::ostream& S) const
+{
+  if (!m_from_cache) m_wrapped->print_E(S);
+  else
+  {
+    S << "Total Energy (from cache): ";
+    S << std::right << std::setw(16) << std::fixed << std::setprecision(8) << energy;
+  }
+}
+
+void energy::interfaces::cache::cached_interface::print_E_head(std::ostream& S, bool const endline) const
+{
+  if (!m_from_cache) m_wrapped->print_E_head(S, endline);
+  else
+  {
+    S << "Energy (from cache, no partial energies)\n";
+    S << std::right << std::setw(24) << "SUM\n";
+    if (endline) S << '\n';
+  }
+}
+
+void energy::interfaces::cache::cached_interface::print_E_short(std::ostream& S, bool const endline) const
+{
+  if (!m_from_cache) m_wrapped->print_E_short(S, endline);
+  else
+  {
+    S << std::right << std::setw(24) << std::fixed << std::setprecision(8) << energy << '\n';
+    if (endline) S << '\n';
+  }
+}
+
+void energy::interfaces::cache::cached_interface::print_G_tinkerlike(std::ostream& S, bool const endline) const
+{
+  // gradients from the cache are in the coordinates object, the wrapped interface might have older ones
+  if (m_from_cache) interface_base::print_G_tinkerlike(S, endline);
+  else m_wrapped->print_G_tinkerlike(S, endline);
+}
+
+void energy::interfaces::cache::cached_interface::to_stream(std::ostream& S) const
+{
+  if (!m_from_cache) m_wrapped->to_stream(S);
+}
+
+energy::interface_base* energy::interfaces::cache::wrap(coords::Coordinates* cp, interface_base* wrapped, config::interface_types::T const type)
+{
+  if (wrapped == nullptr || energy::evaluation_cache::active() == false) return wrapped;
+  switch (type)
+  {
+    // force fields and QM/MM interfaces are not cached (the QM parts of QM/MM interfaces are)
+    case config::interface_types::T::AMBER:
+    case config::interface_types::T::AMOEBA:
+    case config::interface_types::T::CHARMM22:
+    case config::interface_types::T::OPLSAA:
+    case config::interface_types::T::QMMM_A:
+    case config::interface_types::T::QMMM_S:
+    case config::interface_types::T::THREE_LAYER:
+    case config::interface_types::T::FIXEDINTERNALSFF:
+    case config::interface_types::T::ILLEGAL:
+      return wrapped;
+    default:
+      return new cached_interface(cp, wrapped, type);
+  }
+}
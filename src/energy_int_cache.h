@@ -0,0 +1,104 @@
+/**
+CAST 3
+energy_int_cache.h
+Purpose: interface that wraps another interface and reuses stored results for known geometries
+
+Is put around every interface that calls an external program if CACHEuse is switched on.
+Energies and gradients of geometries that were already calculated (in this run or in an
+earlier run with the same CACHEfile) are taken from energy::evaluation_cache.
+Hessians and optimizations are always passed to the wrapped interface.
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "energy.h"
+#include "energy_cache.h"
+#include "configuration.h"
+
+namespace energy
+{
+  namespace interfaces
+  {
+    namespace cache
+    {
+      /**interface that takes results from energy::evaluation_cache if possible*/
+      class cached_interface
+        : public energy::interface_base
+      {
+
+      public:
+        /**constructor
+        @param cp: coordinates object
+        @param wrapped: interface that does the real calculations (ownership is taken, has to use cp)
+        @param type: type of the wrapped interface (part of the keys)*/
+        cached_interface(coords::Coordinates* cp, interface_base* wrapped, config::interface_types::T const type);
+
+        /*
+        Energy class functions that need to be overloaded (for documentation see also energy.h)
+        */
+
+        interface_base* clone(coords::Coordinates* coord_object) const;
+        interface_base* move(coords::Coordinates* coord_object);
+
+        void swap(interface_base&);
+        void swap(cached_interface&);
+
+        /** Energy function (cached)*/
+        coords::float_type e(void);
+        /** Energy+Gradient function (cached)*/
+        coords::float_type g(void);
+        /** Energy+Hessian function (not cached)*/
+        coords::float_type h(void);
+        /** Optimization in the wrapped interface (not cached)*/
+        coords::float_type o(void);
+
+        void print_E(std::ostream&) const;
+        void print_E_head(std::ostream&, bool const endline = true) const;
+        void print_E_short(std::ostream&, bool const endline = true) const;
+        void print_G_tinkerlike(std::ostream&, bool const endline = true) const;
+        void to_stream(std::ostream&) const;
+        void update(bool const skip_topology);
+
+        std::vector<coords::float_type> charges() const override;
+        coords::Gradients_3D get_g_ext_chg() const override;
+        std::string working_directory() const override { return m_wrapped->working_directory(); }
+
+        /**wrapped interface*/
+        interface_base const* wrapped() const { return m_wrapped.get(); }
+        /**was the result of the last calculation taken from the cache?*/
+        bool from_cache() const { return m_from_cache; }
+
+      private:
+
+        /**constructor for clone and move functions*/
+        cached_interface(cached_interface const& rhs, coords::Coordinates* cobj, interface_base* wrapped);
+
+        /**calculates energy (and gradients) or takes them from cache*/
+        coords::float_type evaluate(bool const gradients);
+        /**key for current coordinates, external charges and settings*/
+        std::uint64_t key(std::vector<std::int64_t> const& geometry) const;
+        /**take over energy, integrity and other public data from wrapped interface*/
+        void sync();
+
+        std::unique_ptr<interface_base> m_wrapped;
+        /**hash of interface type and all energy related options*/
+        std::uint64_t m_settings;
+        /**is the last result taken from the cache?*/
+        bool m_from_cache;
+        /**charges of the last result from the cache*/
+        std::vector<coords::float_type> m_charges;
+        /**gradients on external charges of the last result from the cache*/
+        coords::Gradients_3D m_external_gradients;
+      };
+
+      /**wraps interface into a cached_interface if CACHEuse is switched on and the interface calls an external program
+      (otherwise returns interface itself)*/
+      interface_base* wrap(coords::Coordinates* cp, interface_base* wrapped, config::interface_types::T const type);
+    }
+  }
+}
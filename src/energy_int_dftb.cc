@@ -1,7 +1,16 @@
 #include "energy_int_dftb.h"
+#include "profiling.h"
+#include <atomic>
+#if defined(_MSC_VER)
+#include <process.h>
+#define pid_func _getpid
+#else
+#include <unistd.h>
+#define pid_func getpid
+#endif
 
 energy::interfaces::dftb::sysCallInterface::sysCallInterface(coords::Coordinates* cp) :
-  energy::interface_base(cp), energy(0.0)
+  energy::interface_base(cp), energy(0.0), scratch("dftb"), client(), socket()
 {
   if (Config::get().energy.dftb.opt > 0) optimizer = true;
   else optimizer = false;
@@ -9,7 +18,7 @@ energy::interfaces::dftb::sysCallInterface::sysCallInterface(coords::Coordinates
 }
 
 energy::interfaces::dftb::sysCallInterface::sysCallInterface(sysCallInterface const& rhs, coords::Coordinates* cobj) :
-  interface_base(cobj), energy(rhs.energy)
+  interface_base(cobj), energy(rhs.energy), scratch(rhs.scratch), guess(rhs.guess), client(), socket()
 {
   optimizer = rhs.optimizer;
   charge = rhs.charge;
@@ -42,6 +51,7 @@ energy::interfaces::dftb::sysCallInterface::~sysCallInterface(void) {}
 
 void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
 {
+  profiling::scoped_timer write_timer("DFTB input write");
   // create a vector with all element symbols that are found in the structure
   // are needed for writing angular momenta into inputfile
   std::vector<std::string> elements;
@@ -56,7 +66,7 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
   // create a chargefile for external charges if desired (needed for QM/MM methods)
   if (get_external_charges().size() != 0)
   {
-    std::ofstream chargefile("charges.dat");
+    std::ofstream chargefile(scratch.path("charges.dat"));
     for (auto j = 0u; j < get_external_charges().size(); j++)
     {
       chargefile << get_external_charges()[j].x << " " << get_external_charges()[j].y << " " << get_external_charges()[j].z << "  " << get_external_charges()[j].scaled_charge << "\n";
@@ -66,7 +76,7 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
 
 
   // create inputfile
-  std::ofstream file("dftb_in.hsd");
+  std::ofstream file(scratch.path("dftb_in.hsd"));
 
   // write geometry
   file << "Geometry = GenFormat {\n";
@@ -88,6 +98,14 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
     file << "  MaxSteps = " << Config::get().energy.dftb.max_steps_opt << "\n";
     file << "}\n\n";
   }
+  else if (t == 4) // DFTB+ stays alive and gets new geometries via socket
+  {
+    file << "Driver = Socket {\n";
+    file << "  File = \"" << socket_name << "\"\n";
+    file << "  Protocol = i-PI {}\n";
+    file << "  MaxSteps = -1\n";
+    file << "}\n\n";
+  }
 
   // write information that is needed for SCC calculation
   file << "Hamiltonian = DFTB {\n";
@@ -95,8 +113,9 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
   file << "  SCCTolerance = " << std::scientific << Config::get().energy.dftb.scctol << "\n";
   file << "  MaxSCCIterations = " << Config::get().energy.dftb.max_steps << "\n";
   file << "  Charge = " << charge << "\n";
+  if (t < 2 && guess.request(coords->xyz(), scratch.path("charges.bin"))) file << "  ReadInitialCharges = Yes\n";  // charges of last calculation as initial guess
   file << "  SlaterKosterFiles = Type2FileNames {\n";
-  file << "    Prefix = '" << Config::get().energy.dftb.sk_files << "'\n";
+  file << "    Prefix = '" << scratch.resolve(Config::get().energy.dftb.sk_files) << "'\n";
   file << "    Separator = '-'\n";
   file << "    Suffix = '.skf'\n";
   file << "  }\n";
@@ -173,14 +192,14 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
   // which information will be saved after calculation?
   file << "Options {\n";
   file << "  WriteResultsTag = Yes\n";
-  if (t < 2) file << "  RestartFrequency = 0\n";   // does not work together with driver
+  if (t < 2 && energy::scf_guess::enabled() == false) file << "  RestartFrequency = 0\n";   // does not work together with driver, charges.bin is needed as next guess
   if (Config::get().energy.dftb.verbosity < 2) file << "  WriteDetailedOut = No\n";
   file << "}\n\n";
 
   // additional analysis that should be performed
   file << "Analysis = {\n";
   file << "  WriteBandOut = No\n";
-  if (t == 1) file << "  CalculateForces = Yes\n";
+  if (t == 1 || t == 4) file << "  CalculateForces = Yes\n";
   file << "}\n\n";
 
   // parser version (recommended so it is possible to use newer DFTB+ versions without adapting inputfile)
@@ -190,9 +209,26 @@ void energy::interfaces::dftb::sysCallInterface::write_inputfile(int t)
   file.close();
 }
 
+double energy::interfaces::dftb::sysCallInterface::calculate(int t)
+{
+  for (;;)
+  {
+    write_inputfile(t);
+    profiling::scoped_timer call_timer("DFTB external program");
+    scon::system_call(scratch.command(Config::get().energy.dftb.path + " > output_dftb.txt"));
+    call_timer.stop();
+    double const result = read_output(t);
+    if (integrity || guess.in_use() == false) return result;
+    std::cout << "SCC with charges of last step as initial guess failed. Starting from scratch.\n";
+    guess.invalidate();
+    integrity = true;
+  }
+}
+
 double energy::interfaces::dftb::sysCallInterface::read_output(int t)
 {
-  std::string res_filename{ "results.tag" };
+  profiling::scoped_timer parse_timer("DFTB output parse");
+  std::string res_filename{ scratch.path("results.tag") };
   if (file_is_empty(res_filename)) // if SCC does not converge this file is empty
   {
     std::cout << "DFTB+ produced an empty output file. Treating structure as broken.\n";
@@ -205,7 +241,7 @@ double energy::interfaces::dftb::sysCallInterface::read_output(int t)
   {
     int N = (*this->coords).size();
 
-    std::ifstream in_file("results.tag", std::ios_base::in);
+    std::ifstream in_file(scratch.path("results.tag"), std::ios_base::in);
     std::string line;
 
     while (!in_file.eof())
@@ -299,21 +335,21 @@ double energy::interfaces::dftb::sysCallInterface::read_output(int t)
         }
 
         coords->set_hessian(hess);  //set hessian
-        std::remove("hessian.out"); // delete file
+        std::remove(scratch.path("hessian.out").c_str()); // delete file
       }
     }
     in_file.close();
 
     if (t == 3)  // optimization
     {
-      if (file_exists("geo_end.gen") == false)  // sometimes happens when moving randomly (tasks MC and TS)
+      if (file_exists(scratch.path("geo_end.gen")) == false)  // sometimes happens when moving randomly (tasks MC and TS)
       {
         std::cout << "DFTB+ did not produce a geometry file. Treating structure as broken.\n";
         integrity = false;
       }
       else  // if optimized geometry present -> read geometry from gen-file
       {
-        std::ifstream geom_file("geo_end.gen", std::ios_base::in);
+        std::ifstream geom_file(scratch.path("geo_end.gen"), std::ios_base::in);
 
         std::getline(geom_file, line);
         std::getline(geom_file, line);
@@ -330,10 +366,10 @@ double energy::interfaces::dftb::sysCallInterface::read_output(int t)
         geom_file.close();
         coords->set_xyz(std::move(xyz_tmp));  // set new coordinates
 
-        std::remove("geo_end.gen"); // delete file
-        std::remove("geo_end.xyz"); // delete file
+        std::remove(scratch.path("geo_end.gen").c_str()); // delete file
+        std::remove(scratch.path("geo_end.xyz").c_str()); // delete file
 
-        std::ifstream file("output_dftb.txt");  // check for geometry convergence
+        std::ifstream file(scratch.path("output_dftb.txt"));  // check for geometry convergence
         bool converged = false;
         while (!file.eof())
         {
@@ -354,20 +390,88 @@ double energy::interfaces::dftb::sysCallInterface::read_output(int t)
   }
 
   // remove files
-  if (t > 1) std::remove("charges.bin");
+  if (t > 1) std::remove(scratch.path("charges.bin").c_str());
   if (Config::get().energy.dftb.verbosity < 2)
   {
-    std::remove("dftb_pin.hsd");
+    std::remove(scratch.path("dftb_pin.hsd").c_str());
     if (Config::get().energy.dftb.verbosity == 0)
     {
-      std::remove("dftb_in.hsd");
-      std::remove("output_dftb.txt");
+      std::remove(scratch.path("dftb_in.hsd").c_str());
+      std::remove(scratch.path("output_dftb.txt").c_str());
     }
   }
 
   return energy;
 }
 
+bool energy::interfaces::dftb::sysCallInterface::use_socket() const
+{
+  // external charges and atomic charges can't be exchanged via the socket protocol
+  return Config::get().energy.dftb.socket && Config::get().energy.qmmm.use == false && get_external_charges().empty();
+}
+
+void energy::interfaces::dftb::sysCallInterface::start_socket_session()
+{
+  // process id keeps sockets of several CAST runs apart, counter those of the interfaces in one run
+  static std::atomic<std::size_t> counter{ 0u };
+  std::stringstream name;
+  name << "cast_dftb_" << pid_func() << "_" << counter++;
+  socket_name = name.str();
+  socket = std::make_unique<energy::ipi_server>(socket_name);
+
+  write_inputfile(4);
+  client = std::make_unique<energy::ipi_client_process>(scratch.command(Config::get().energy.dftb.path + " > output_dftb.txt 2>&1"));
+  socket->wait_for_client(Config::get().energy.dftb.socket_timeout);
+  if (Config::get().general.verbosity > 2)
+  {
+    std::cout << "DFTB+ connected to socket " << socket->socket_path() << ".\n";
+  }
+}
+
+double energy::interfaces::dftb::sysCallInterface::socket_calculation(bool const gradients)
+{
+  profiling::scoped_timer call_timer("DFTB socket calculation");
+
+  std::size_t const N = coords->size();
+  std::vector<double> positions(3u * N), forces;
+  for (std::size_t i = 0u; i < N; ++i)
+  {
+    positions[3u * i] = coords->xyz(i).x() / energy::bohr2ang;
+    positions[3u * i + 1u] = coords->xyz(i).y() / energy::bohr2ang;
+    positions[3u * i + 2u] = coords->xyz(i).z() / energy::bohr2ang;
+  }
+  // cell is only used by DFTB+ for periodic geometries
+  auto const box = Config::get().periodics.periodic ? Config::get().periodics.pb_box / energy::bohr2ang : coords::Cartesian_Point(1000.0);
+  std::array<double, 9> const cell = { box.x(), 0.0, 0.0, 0.0, box.y(), 0.0, 0.0, 0.0, box.z() };
+
+  try
+  {
+    if (!socket) start_socket_session();
+    energy = socket->calculate(positions, cell, forces) * energy::au2kcal_mol;
+  }
+  catch (std::runtime_error const& e)
+  {
+    // DFTB+ might not have connected in time or crashed (e.g. SCC not converged), start a new session next time
+    std::cout << "DFTB+ socket calculation failed: " << e.what() << " Treating structure as broken.\n";
+    socket.reset();
+    if (client) client->terminate(0.0);   // e.g. still running after timeout or hanging
+    client.reset();
+    integrity = false;
+    return 0.0;
+  }
+
+  if (gradients)
+  {
+    coords::Representation_3D g_tmp(N);
+    for (std::size_t i = 0u; i < N; ++i)
+    {
+      g_tmp[i] = coords::Cartesian_Point(forces[3u * i], forces[3u * i + 1u], forces[3u * i + 2u]) * -energy::Hartree_Bohr2Kcal_MolAng;
+    }
+    coords->swap_g_xyz(g_tmp);
+  }
+  return energy;
+}
+
 /*
 Energy class functions that need to be overloaded
 */
@@ -378,9 +482,13 @@ double energy::interfaces::dftb::sysCallInterface::e(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(0);
-    scon::system_call(Config::get().energy.dftb.path + " > output_dftb.txt");
-    energy = read_output(0);
+    if (use_socket()) energy = socket_calculation(false);
+    else
+    {
+      energy = calculate(0);
+    }
+    if (integrity) { scratch.mark_success(); guess.store(coords->xyz(), scratch.path("charges.bin")); }
+    else { scratch.mark_failed(); guess.invalidate(); }
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -396,9 +504,13 @@ double energy::interfaces::dftb::sysCallInterface::g(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(1);
-    scon::system_call(Config::get().energy.dftb.path + " > output_dftb.txt");
-    energy = read_output(1);
+    if (use_socket()) energy = socket_calculation(true);
+    else
+    {
+      energy = calculate(1);
+    }
+    if (integrity) { scratch.mark_success(); guess.store(coords->xyz(), scratch.path("charges.bin")); }
+    else { scratch.mark_failed(); guess.invalidate(); }
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -414,9 +526,9 @@ double energy::interfaces::dftb::sysCallInterface::h(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(2);
-    scon::system_call(Config::get().energy.dftb.path + " > output_dftb.txt");
-    energy = read_output(2);
+    energy = calculate(2);
+    if (integrity) { scratch.mark_success(); guess.store(coords->xyz(), scratch.path("charges.bin")); }
+    else { scratch.mark_failed(); guess.invalidate(); }
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -432,9 +544,9 @@ double energy::interfaces::dftb::sysCallInterface::o(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(3);
-    scon::system_call(Config::get().energy.dftb.path + " > output_dftb.txt");
-    energy = read_output(3);  // also sets new geometry
+    energy = calculate(3);  // also sets new geometry
+    if (integrity) { scratch.mark_success(); guess.store(coords->xyz(), scratch.path("charges.bin")); }
+    else { scratch.mark_failed(); guess.invalidate(); }
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -26,6 +26,9 @@ Purpose: interface to DFTB+
 #include "coords.h"
 #include "coords_io.h"
 #include "modify_sk.h"
+#include "energy_scratch.h"
+#include "energy_guess.h"
+#include "energy_ipi.h"
 
 #if defined (_MSC_VER)
 #include "win_inc.h"
@@ -94,6 +97,8 @@ namespace energy
         std::vector<coords::float_type> charges() const override { return partial_charges; };
         /**returns gradients on external charges due to the molecular system (used for QM/MM)*/
         coords::Gradients_3D get_g_ext_chg() const override { return grad_ext_charges; };
+        /**scratch directory of this interface (empty if files are written into the working directory)*/
+        std::string working_directory() const override { return scratch.directory(); }
 
       private:
 
@@ -101,13 +106,17 @@ namespace energy
         sysCallInterface(sysCallInterface const& rhs, coords::Coordinates* cobj);
 
         /**writes dftb+ inputfile
-        @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)*/
+        @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize, 4 = socket driver)*/
         void write_inputfile(int t);
 
         /**reads dftb+ outputfile (results.tag)
         @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)*/
         double read_output(int t);
 
+        /**writes inputfile, calls dftb+ and reads output (again without old charges if the SCC with them fails)
+        @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)*/
+        double calculate(int t);
+
         /**total energy*/
         double energy;
 
@@ -116,6 +125,29 @@ namespace energy
 
         /**gradients of external charges*/
         coords::Gradients_3D grad_ext_charges;
+
+        /**directory where all DFTB+ files of this instance are written (own directory for every clone)*/
+        energy::scratch_directory scratch;
+
+        /**decides if charges of the last calculation (charges.bin) are read*/
+        energy::scf_guess guess;
+
+        // STUFF FOR SOCKET COMMUNICATION (DFTB+socket)
+
+        /**should energy and gradients be calculated by a DFTB+ process that stays alive?*/
+        bool use_socket() const;
+        /**starts DFTB+ in background and waits until it connects to the socket*/
+        void start_socket_session();
+        /**calculates energy (and gradients) via socket
+        @param gradients: should gradients be set?*/
+        double socket_calculation(bool const gradients);
+
+        /**name of the socket of this instance*/
+        std::string socket_name;
+        /**DFTB+ process of the socket session (declared before socket, so it is terminated after EXIT was sent)*/
+        std::unique_ptr<energy::ipi_client_process> client;
+        /**server the DFTB+ process is connected to (own process for every clone, started on first use)*/
+        std::unique_ptr<energy::ipi_server> socket;
       };
     }
   }
@@ -8,6 +8,7 @@
 #include <utility>
 #include "atomic.h"
 #include "energy_int_gaussian.h"
+#include "profiling.h"
 #include "configuration.h"
 #include "coords.h"
 #include "coords_io.h"
@@ -36,13 +37,14 @@ Gaussian sysCall functions
 energy::interfaces::gaussian::sysCallInterfaceGauss::sysCallInterfaceGauss(coords::Coordinates* cp) :
   energy::interface_base(cp),
   hof_kcal_mol(0.0), hof_kj_mol(0.0), e_total(0.0),
-  e_electron(0.0), e_core(0.0), failcounter(0u)
+  e_electron(0.0), e_core(0.0), failcounter(0u), scratch("gaussian")
 {
   id = Config::get().general.outputFilename;
   std::stringstream ss;
   std::srand(static_cast<unsigned>(std::time(0)));
   ss << (std::size_t(std::rand()) | (std::size_t(std::rand()) << 15));
   id.append("_tmp_").append(ss.str());
+  guess_chk = id + "_guess.chk";
   optimizer = Config::get().energy.gaussian.opt;
   charge = std::stoi(Config::get().energy.gaussian.charge);
 }
@@ -50,7 +52,7 @@ energy::interfaces::gaussian::sysCallInterfaceGauss::sysCallInterfaceGauss(coord
 energy::interfaces::gaussian::sysCallInterfaceGauss::sysCallInterfaceGauss(sysCallInterfaceGauss const& rhs, coords::Coordinates* cobj) :
   interface_base(cobj),
   hof_kcal_mol(rhs.hof_kcal_mol), hof_kj_mol(rhs.hof_kj_mol), e_total(rhs.e_total),
-  e_electron(rhs.e_electron), e_core(rhs.e_core), failcounter(rhs.failcounter)
+  e_electron(rhs.e_electron), e_core(rhs.e_core), failcounter(rhs.failcounter), scratch(rhs.scratch), guess(rhs.guess), guess_chk(rhs.guess_chk)
 {
   id = rhs.id;
   charge = rhs.charge;
@@ -85,15 +87,16 @@ energy::interfaces::gaussian::sysCallInterfaceGauss::~sysCallInterfaceGauss(void
   std::string rem_file(id);
   if (Config::get().energy.gaussian.delete_input)
   {
-    remove(std::string(id).append(".gjf").c_str());
-    remove(std::string(id).append(".log").c_str());
+    remove(scratch.path(id + ".gjf").c_str());
+    remove(scratch.path(id + ".log").c_str());
+    remove(scratch.path(guess_chk).c_str());
   }
 }
 
 void energy::interfaces::gaussian::sysCallInterfaceGauss::print_gaussianInput(char calc_type)
 {
-  std::string outstring(id);
-  outstring.append(".gjf");
+  profiling::scoped_timer write_timer("GAUSSIAN input write");
+  std::string outstring(scratch.path(id + ".gjf"));
 
   std::ofstream out_file(outstring.c_str(), std::ios_base::out);
 
@@ -117,11 +120,17 @@ void energy::interfaces::gaussian::sysCallInterfaceGauss::print_gaussianInput(ch
     if (Config::get().energy.gaussian.chk.length() != 0) {    // if checkpoint file specified
       out_file << "%chk=" << Config::get().energy.gaussian.chk << "\n";
     }
+    else if (energy::scf_guess::enabled()) {                  // otherwise own checkpoint file for initial guess
+      out_file << "%chk=" << guess_chk << "\n";
+    }
     out_file << "# " << Config::get().energy.gaussian.method << " " << Config::get().energy.gaussian.basisset;
     out_file << " " << Config::get().energy.gaussian.spec << " ";
     if (Config::get().energy.gaussian.cpcm == true) out_file << "scrf(cpcm,solvent=generic,read) ";
     if (get_external_charges().size() != 0) out_file << "Charge ";
     if (Config::get().energy.qmmm.use == true) out_file << "NoSymm ";
+    if (Config::get().energy.gaussian.chk.length() == 0 && guess.request(coords->xyz(), scratch.path(guess_chk))) {
+      out_file << "Guess=Read ";   // wavefunction of last calculation as initial guess
+    }
 
     switch (calc_type) {// to ensure the needed gaussian keywords are used in gausian inputfile for the specified calculation
     case 'o':
@@ -194,7 +203,7 @@ void energy::interfaces::gaussian::sysCallInterfaceGauss::print_gaussianInput(ch
         {
           throw std::runtime_error("ERROR! Slater Koster file " + filename + " does not exist. Please download it from dftb.org and convert it with the task MODIFY_SK_FILES!");
         }
-        out_file << "@./" << filename << " /N\n";
+        out_file << "@" << scratch.resolve("./" + filename) << " /N\n";
       }
       out_file << '\n';
     }
@@ -217,13 +226,14 @@ void energy::interfaces::gaussian::sysCallInterfaceGauss::print_gaussianInput(ch
 
 bool energy::interfaces::gaussian::sysCallInterfaceGauss::read_gaussianOutput(bool const grad, bool const opt, bool const qmmm)
 {
+  profiling::scoped_timer parse_timer("GAUSSIAN output parse");
   //std::ofstream mos("MOs.txt", std::ios_base::out); //ofstream for mo testoutput keep commented if not needed
 
   hof_kcal_mol = hof_kj_mol = energy = e_total = e_electron = e_core = 0.0;
   double mm_el_energy(0.0);
   std::size_t atoms(coords->size());
 
-  std::string in_string = id + ".log";
+  std::string in_string = scratch.path(id + ".log");
   std::ifstream in_file(in_string.c_str(), std::ios_base::in);
 
   bool test_lastMOs(false);//to controll if reading was successfull
@@ -421,11 +431,12 @@ bool energy::interfaces::gaussian::sysCallInterfaceGauss::read_gaussianOutput(bo
 
     if (normalGaussianTermination == false)
     {
+      scratch.mark_failed();
       if (Config::set().energy.gaussian.delete_input == false)
       {                                   // save logfile for failed gaussian calls
         failcounter++;
-        std::string oldname = id + ".log";
-        std::string newname = "failed_gaussian_call_" + std::to_string(failcounter) + ".log";
+        std::string oldname = scratch.path(id + ".log");
+        std::string newname = scratch.path("failed_gaussian_call_" + std::to_string(failcounter) + ".log");
         rename(oldname.c_str(), newname.c_str());
       }
       return false; // GAUSSIAN DID NOT TERMINATE PROPERLY
@@ -506,11 +517,14 @@ bool energy::interfaces::gaussian::sysCallInterfaceGauss::read_gaussianOutput(bo
 
 int energy::interfaces::gaussian::sysCallInterfaceGauss::callGaussian()
 {
-  std::string gaussian_call = "export GAUSS_SCRDIR=" + fs::current_path().string() + " && " + Config::get().energy.gaussian.path + " " + id + ".gjf";
+  profiling::scoped_timer call_timer("GAUSSIAN external program");
+  std::string const gaussian_scratch = scratch.active() ? scratch.directory() : fs::current_path().string();
+  std::string gaussian_call = scratch.command("export GAUSS_SCRDIR=" + gaussian_scratch + " && " + Config::get().energy.gaussian.path + " " + id + ".gjf");
 
   const int ret = scon::system_call(gaussian_call);
   if (ret != 0)
   {
+    scratch.mark_failed();
     ++failcounter;
     std::cout << "Warning Gaussian call to '" << gaussian_call
       << " ' did not return 0 and probably failed.\n( A total of "
@@ -519,8 +533,8 @@ int energy::interfaces::gaussian::sysCallInterfaceGauss::callGaussian()
 
     if (Config::set().energy.gaussian.delete_input == false)
     {                                   // save logfile for failed gaussian calls
-      std::string oldname = id + ".log";
-      std::string newname = "failed_gaussian_call_" + std::to_string(failcounter) + ".log";
+      std::string oldname = scratch.path(id + ".log");
+      std::string newname = scratch.path("failed_gaussian_call_" + std::to_string(failcounter) + ".log");
       rename(oldname.c_str(), newname.c_str());
     }
 
@@ -529,18 +543,29 @@ int energy::interfaces::gaussian::sysCallInterfaceGauss::callGaussian()
       throw std::runtime_error("More than " + std::to_string(Config::get().energy.gaussian.maxfail) + " Gaussian calls have failed.");
     }
   }
+  else scratch.mark_success();
   return ret;
 }
 
+int energy::interfaces::gaussian::sysCallInterfaceGauss::runGaussian(char calc_type)
+{
+  for (;;)
+  {
+    print_gaussianInput(calc_type);
+    int const ret = callGaussian();
+    if (ret == 0 || guess.in_use() == false) return ret;
+    std::cout << "Gaussian calculation with wavefunction of last step as initial guess failed. Starting from scratch.\n";
+    guess.invalidate();
+  }
+}
+
 //Energy functions
 double energy::interfaces::gaussian::sysCallInterfaceGauss::e(void)
 {
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    print_gaussianInput('e');
-
-    if (callGaussian() == 0)
+    if (runGaussian('e') == 0)
     {
       if (!read_gaussianOutput(false, false, Config::get().energy.qmmm.use))
       {
@@ -554,8 +579,10 @@ double energy::interfaces::gaussian::sysCallInterfaceGauss::e(void)
         std::cout << "Gaussian call (e) return value was not 0. Treating structure as broken.\n";
       }
       integrity = false;
+      guess.invalidate();
       return 0.0;
     }
+    guess.store(coords->xyz(), scratch.path(guess_chk));
     return energy;
   }
   else return 0;
@@ -571,8 +598,7 @@ double energy::interfaces::gaussian::sysCallInterfaceGauss::g(void)
     id = id + "_G_";
 
 
-    print_gaussianInput('g');
-    if (callGaussian() == 0)
+    if (runGaussian('g') == 0)
     {
       if (!read_gaussianOutput(true, false, Config::get().energy.qmmm.use))
       {
@@ -589,6 +615,8 @@ double energy::interfaces::gaussian::sysCallInterfaceGauss::g(void)
     }
 
     id = tmp_id;
+    if (integrity) guess.store(coords->xyz(), scratch.path(guess_chk));
+    else guess.invalidate();
 
     return energy;
   }
@@ -624,8 +652,7 @@ double energy::interfaces::gaussian::sysCallInterfaceGauss::o(void)
     id = id + "_O_";
 
 
-    print_gaussianInput('o');
-    if (callGaussian() == 0) read_gaussianOutput(true, true);
+    if (runGaussian('o') == 0) read_gaussianOutput(true, true);
     else
     {
       if (Config::get().general.verbosity >= 2)
@@ -636,6 +663,8 @@ double energy::interfaces::gaussian::sysCallInterfaceGauss::o(void)
     }
 
     id = tmp_id;
+    if (integrity) guess.store(coords->xyz(), scratch.path(guess_chk));
+    else guess.invalidate();
 
     return energy;
   }
@@ -9,6 +9,8 @@
 #include "energy.h"
 #include "helperfunctions.h"
 #include "modify_sk.h"
+#include "energy_scratch.h"
+#include "energy_guess.h"
 
 
 namespace energy
@@ -59,6 +61,8 @@ namespace energy
         /**returns gradients on external charges (calculated by electric field from GAUSSIAN)
         (is used for QM/MM)*/
         coords::Gradients_3D get_g_ext_chg() const override;
+        /**scratch directory of this interface (empty if files are written into the working directory)*/
+        std::string working_directory() const override { return scratch.directory(); }
 
       private:
 
@@ -85,11 +89,21 @@ namespace energy
         /**gradients of external charges*/
         coords::Gradients_3D grad_ext_charges;
 
+        /**directory where all Gaussian files of this instance are written (own directory for every clone)*/
+        energy::scratch_directory scratch;
+
+        /**decides if the wavefunction of the last calculation is read from the checkpoint file*/
+        energy::scf_guess guess;
+        /**checkpoint file that holds the last wavefunction (only used if no checkpoint file is given by the user)*/
+        std::string guess_chk;
+
         /*
         Gaussian sysCall funcntions
         */
 
         int callGaussian(void);
+        /**writes inputfile and calls gaussian (again without old wavefunction if the calculation with it fails)*/
+        int runGaussian(char calc_type);
         void print_gaussianInput(char);
         bool read_gaussianOutput(bool const grad = true, bool const opt = true, bool const qmmm = false);
 
@@ -10,6 +10,7 @@
 
 #include "atomic.h"
 #include "energy_int_mopac.h"
+#include "profiling.h"
 #include "configuration.h"
 #include "coords.h"
 #include "coords_io.h"
@@ -28,7 +29,7 @@ Mopac sysCall functions
 energy::interfaces::mopac::sysCallInterface::sysCallInterface(coords::Coordinates* cp) :
   energy::interface_base(cp),
   hof_kcal_mol(0.0), hof_kj_mol(0.0), e_total(0.0),
-  e_electron(0.0), e_core(0.0), failcounter(0u)
+  e_electron(0.0), e_core(0.0), failcounter(0u), scratch("mopac")
 {
   id = Config::get().general.outputFilename;
   std::stringstream ss;
@@ -42,7 +43,7 @@ energy::interfaces::mopac::sysCallInterface::sysCallInterface(coords::Coordinate
 energy::interfaces::mopac::sysCallInterface::sysCallInterface(sysCallInterface const& rhs, coords::Coordinates* cobj) :
   interface_base(cobj),
   hof_kcal_mol(rhs.hof_kcal_mol), hof_kj_mol(rhs.hof_kj_mol), e_total(rhs.e_total),
-  e_electron(rhs.e_electron), e_core(rhs.e_core), failcounter(rhs.failcounter)
+  e_electron(rhs.e_electron), e_core(rhs.e_core), failcounter(rhs.failcounter), scratch(rhs.scratch), guess(rhs.guess)
 {
   id = rhs.id;
   charge = rhs.charge;
@@ -77,16 +78,18 @@ energy::interfaces::mopac::sysCallInterface::~sysCallInterface(void)
   std::string rem_file(id);
   if (Config::get().energy.mopac.delete_input)
   {
-    std::remove(std::string(id).append(".xyz").c_str());
-    std::remove(std::string(id).append(".out").c_str());
-    std::remove(std::string(id).append(".arc").c_str());
-    std::remove(std::string(id).append("_sys.out").c_str());
-    std::remove(std::string(id).append(".xyz.out").c_str());
+    std::remove(scratch.path(id + ".xyz").c_str());
+    std::remove(scratch.path(id + ".out").c_str());
+    std::remove(scratch.path(id + ".arc").c_str());
+    std::remove(scratch.path(id + "_sys.out").c_str());
+    std::remove(scratch.path(id + ".xyz.out").c_str());
+    std::remove(scratch.path(id + ".den").c_str());
+    std::remove(scratch.path(id + ".xyz.den").c_str());
     if (Config::get().energy.mopac.version == config::mopac_ver_type::MOPAC7_HB)
     {
-      std::remove("FOR005");
-      std::remove("FOR006");
-      std::remove("FOR012");
+      std::remove(scratch.path("FOR005").c_str());
+      std::remove(scratch.path("FOR006").c_str());
+      std::remove(scratch.path("FOR012").c_str());
     }
 
   }
@@ -94,7 +97,7 @@ energy::interfaces::mopac::sysCallInterface::~sysCallInterface(void)
 
 void energy::interfaces::mopac::sysCallInterface::read_charges()
 {
-  auto file = id + ".xyz.aux";
+  auto file = scratch.path(id + ".xyz.aux");
   std::ifstream auxstream{ file };
   if (!auxstream)
   {
@@ -127,7 +130,7 @@ void energy::interfaces::mopac::sysCallInterface::write_mol_in()
   auto elec_factor = 332.0;
   std::cout << std::setprecision(6);
 
-  std::ofstream molstream{ "mol.in" };
+  std::ofstream molstream{ scratch.path("mol.in") };
   if (molstream)
   {
     auto const n_qm = coords->size() - Config::get().energy.mopac.link_atoms; // number of QM atoms
@@ -159,10 +162,10 @@ void energy::interfaces::mopac::sysCallInterface::write_mol_in()
 
 void energy::interfaces::mopac::sysCallInterface::print_mopacInput(bool const grad, bool const hess, bool const opt)
 {
+  profiling::scoped_timer write_timer("MOPAC input write");
   if (get_external_charges().size() != 0) write_mol_in();
 
-  std::string outstring(id);
-  outstring.append(".xyz");
+  std::string outstring(scratch.path(id + ".xyz"));
 
   /*! Special Input for modified MOPAC7
   *
@@ -171,7 +174,7 @@ void energy::interfaces::mopac::sysCallInterface::print_mopacInput(bool const gr
   */
   if (Config::get().energy.mopac.version == config::mopac_ver_type::MOPAC7_HB)
   {
-    outstring = "FOR005";
+    outstring = scratch.path("FOR005");
   }
 
   std::ofstream out_file(outstring.c_str(), std::ios_base::out);
@@ -217,6 +220,11 @@ void energy::interfaces::mopac::sysCallInterface::print_mopacInput(bool const gr
       out_file << (grad ? " GRADIENTS" : "") << (hess ? " HESSIAN" : "");
       if (charge != 0) out_file << " CHARGE=" << charge;
     }
+    if (Config::get().energy.mopac.version != config::mopac_ver_type::MOPAC7_HB && energy::scf_guess::enabled())
+    {
+      out_file << " DENOUT";   // density of this calculation is initial guess for the next one
+      if (guess.request(coords->xyz(), density_file())) out_file << " OLDENS";
+    }
     if (Config::get().energy.mopac.version == config::mopac_ver_type::MOPAC2012MT)
     {
 #if defined _OPENMP
@@ -257,17 +265,18 @@ void energy::interfaces::mopac::sysCallInterface::print_mopacInput(bool const gr
 
 void energy::interfaces::mopac::sysCallInterface::read_mopacOutput(bool const grad, bool const, bool const opt)
 {
+  profiling::scoped_timer parse_timer("MOPAC output parse");
   hof_kcal_mol = hof_kj_mol = energy = e_total = e_electron = e_core = 0.0;
-  std::string in_string = id + ".out";
-  if (Config::get().energy.mopac.version == config::mopac_ver_type::MOPAC7_HB) { in_string = "FOR006"; remove("FOR012"); }
+  std::string in_string = scratch.path(id + ".out");
+  if (Config::get().energy.mopac.version == config::mopac_ver_type::MOPAC7_HB) { in_string = scratch.path("FOR006"); remove(scratch.path("FOR012").c_str()); }
   std::ifstream in_file(in_string.c_str(), std::ios_base::in);
   //std::size_t fixcounter(0);
   // ...
 
   if (!in_file)
   {
-    std::string const alt_infile(std::string(id).append(".xyz.out"));
-    remove(std::string(id).append(".xyz.arc").c_str());
+    std::string const alt_infile(scratch.path(id + ".xyz.out"));
+    remove(scratch.path(id + ".xyz.arc").c_str());
     if (Config::get().general.verbosity > 4)
     {
       std::cout << "Input file '" << in_string << "' not found, trying '" << alt_infile << "'.\n";
@@ -277,7 +286,10 @@ void energy::interfaces::mopac::sysCallInterface::read_mopacOutput(bool const gr
     if (in_file)
       in_string = alt_infile;
     else
+    {
+      scratch.mark_failed();
       throw std::runtime_error(std::string("MOPAC OUTPUT NOT PRESENT; ID: ").append(id));
+    }
 
 
   }
@@ -586,6 +598,7 @@ void energy::interfaces::mopac::sysCallInterface::read_mopacOutput(bool const gr
   } // if open
   else
   {
+    scratch.mark_failed();
     throw std::runtime_error(std::string("MOPAC OUTPUT NOT PRESENT; ID: ").append(id));
   }
   auto bpv = true;
@@ -597,17 +610,21 @@ void energy::interfaces::mopac::sysCallInterface::read_mopacOutput(bool const gr
       " Current conformation will be treated as broken structure.\n";
   }
   integrity = bpv;
+  if (integrity) guess.store(coords->xyz(), density_file());
+  else guess.invalidate();
 }
 
 int energy::interfaces::mopac::sysCallInterface::callMopac()
 {
+  profiling::scoped_timer call_timer("MOPAC external program");
   auto mopac_call = Config::get().energy.mopac.path + " " + id + ".xyz";
   mopac_call.append(" > output_mopac.txt 2>&1");
-  auto ret = scon::system_call(mopac_call);
+  auto ret = scon::system_call(scratch.command(mopac_call));
   if (ret != 0)
   {
+    scratch.mark_failed();
     ++failcounter;
-    std::cout << "Warning: MOPAC call to '" << mopac_call <<
+    std::cout << "Warning: MOPAC call to '" << scratch.command(mopac_call) <<
       "' did not return 0 and probably failed.\n(A total of "
       << failcounter << " MOPAC call" << (failcounter != 1 ? "s have" : " has")
       << " failed so far.)\n";
@@ -616,9 +633,35 @@ int energy::interfaces::mopac::sysCallInterface::callMopac()
       throw std::runtime_error("More than 100 MOPAC calls have failed.");
     }
   }
+  else scratch.mark_success();
   return ret;
 }
 
+int energy::interfaces::mopac::sysCallInterface::runMopac(bool const grad, bool const hess, bool const opt)
+{
+  for (;;)
+  {
+    print_mopacInput(grad, hess, opt);
+    auto const ret = callMopac();
+    if (ret == 0) return ret;
+    if (guess.in_use() == false)
+    {
+      guess.invalidate();
+      return ret;
+    }
+    std::cout << "MOPAC calculation with density of last step as initial guess failed. Starting from scratch.\n";
+    guess.invalidate();
+  }
+}
+
+std::string energy::interfaces::mopac::sysCallInterface::density_file() const
+{
+  // some versions keep the extension of the inputfile
+  std::string const density(scratch.path(id + ".den"));
+  if (file_exists(density)) return density;
+  return scratch.path(id + ".xyz.den");
+}
+
 /*
 Energy class functions that need to be overloaded
 */
@@ -630,8 +673,7 @@ double energy::interfaces::mopac::sysCallInterface::e(void)
   grad_var = false;
   if (integrity == true)
   {
-    print_mopacInput(false, false, false);
-    if (callMopac() == 0) read_mopacOutput(false, false, false);
+    if (runMopac(false, false, false) == 0) read_mopacOutput(false, false, false);
     else
     {
       if (Config::get().general.verbosity >= 2)
@@ -652,8 +694,7 @@ double energy::interfaces::mopac::sysCallInterface::g(void)
   grad_var = true;
   if (integrity == true)
   {
-    print_mopacInput(true, false, false);
-    if (callMopac() == 0) read_mopacOutput(true, false, false);
+    if (runMopac(true, false, false) == 0) read_mopacOutput(true, false, false);
     else
     {
       ++failcounter;
@@ -676,8 +717,7 @@ double energy::interfaces::mopac::sysCallInterface::h(void)
   grad_var = false;
   if (integrity == true)
   {
-    print_mopacInput(true, true, false);
-    if (callMopac() == 0) read_mopacOutput(true, true, false);
+    if (runMopac(true, true, false) == 0) read_mopacOutput(true, true, false);
     else
     {
       ++failcounter;
@@ -700,8 +740,7 @@ double energy::interfaces::mopac::sysCallInterface::o(void)
   grad_var = false;
   if (integrity == true)
   {
-    print_mopacInput(true, false, true);
-    if (callMopac() == 0) read_mopacOutput(true, false, true);
+    if (runMopac(true, false, true) == 0) read_mopacOutput(true, false, true);
     else
     {
       ++failcounter;
@@ -8,6 +8,8 @@ MOPAC Interface
 #include <string>
 
 #include "energy.h"
+#include "energy_scratch.h"
+#include "energy_guess.h"
 
 
 namespace energy
@@ -53,6 +55,8 @@ namespace energy
         coords::Gradients_3D get_g_ext_chg() const override {
           return grad_ext_charges;
         }
+        /**scratch directory of this interface (empty if files are written into the working directory)*/
+        std::string working_directory() const override { return scratch.directory(); }
 
         //MOPAC7_HB VAR
         bool grad_var;
@@ -83,11 +87,21 @@ namespace energy
         // FAILCOUNTER
         size_t failcounter;
 
+        /**directory where all MOPAC files of this instance are written (own directory for every clone)*/
+        energy::scratch_directory scratch;
+
+        /**decides if the density of the last calculation (.den file) is read*/
+        energy::scf_guess guess;
+
         /*
         Mopac sysCall functions
         */
 
         int callMopac(void);
+        /**writes inputfile and calls mopac (again without old density if the calculation with it fails)*/
+        int runMopac(bool const grad, bool const hess, bool const opt);
+        /**name of the density file written by mopac (depends on mopac version)*/
+        std::string density_file() const;
         void print_mopacInput(bool const grad = true, bool const hess = false, bool const opt = true);
         void read_mopacOutput(bool const grad = true, bool const hess = false, bool const opt = true);
 
@@ -1,7 +1,8 @@
 #include "energy_int_orca.h"
+#include "profiling.h"
 
 energy::interfaces::orca::sysCallInterface::sysCallInterface(coords::Coordinates* cp) :
-  energy::interface_base(cp), energy(0.0), nuc_rep(0.0), elec_en(0.0), one_elec(0.0), two_elec(0.0)
+  energy::interface_base(cp), energy(0.0), nuc_rep(0.0), elec_en(0.0), one_elec(0.0), two_elec(0.0), scratch("orca")
 {
   if (Config::get().energy.orca.opt > 0) optimizer = true;
   else optimizer = false;
@@ -9,7 +10,8 @@ energy::interfaces::orca::sysCallInterface::sysCallInterface(coords::Coordinates
 }
 
 energy::interfaces::orca::sysCallInterface::sysCallInterface(sysCallInterface const& rhs, coords::Coordinates* cobj) :
-  interface_base(cobj), energy(rhs.energy), nuc_rep(rhs.nuc_rep), elec_en(rhs.elec_en), one_elec(rhs.one_elec), two_elec(rhs.two_elec)
+  interface_base(cobj), energy(rhs.energy), nuc_rep(rhs.nuc_rep), elec_en(rhs.elec_en), one_elec(rhs.one_elec), two_elec(rhs.two_elec),
+  scratch(rhs.scratch), guess(rhs.guess)
 {
   optimizer = rhs.optimizer;
   charge = rhs.charge;
@@ -56,10 +58,11 @@ void energy::interfaces::orca::sysCallInterface::write_external_pointcharges(std
 
 void energy::interfaces::orca::sysCallInterface::write_inputfile(int t)
 {
-  if (get_external_charges().size() != 0) write_external_pointcharges("pointcharges.pc");  // write external pointcharges into file
+  profiling::scoped_timer write_timer("ORCA input write");
+  if (get_external_charges().size() != 0) write_external_pointcharges(scratch.path("pointcharges.pc"));  // write external pointcharges into file
 
   std::ofstream inp;
-  inp.open("orca.inp");
+  inp.open(scratch.path("orca.inp"));
 
   inp << "! " << Config::get().energy.orca.method << " " << Config::get().energy.orca.basisset;                 // method and basisset
   inp << " " << Config::get().energy.orca.spec << "\n";                                                         // further specifications
@@ -100,6 +103,12 @@ void energy::interfaces::orca::sysCallInterface::write_inputfile(int t)
 
   if (get_external_charges().size() != 0) inp << "\n% pointcharges \"pointcharges.pc\"\n";     // tell orca that there are pointcharges in this file
 
+  if (guess.request(coords->xyz(), scratch.path("orca_guess.gbw")))   // orbitals of last calculation as initial guess
+  {
+    inp << "\n! MORead\n";
+    inp << "%moinp \"orca_guess.gbw\"\n";
+  }
+
   inp << "\n";  // empty line
   inp << "*xyz " << charge << " " << Config::get().energy.orca.multiplicity << "\n";  // headline for geometry input
   for (auto i{ 0u }; i < coords->atoms().size(); ++i)  // coordinates definition for every atom
@@ -112,9 +121,39 @@ void energy::interfaces::orca::sysCallInterface::write_inputfile(int t)
   inp.close();
 }
 
+int energy::interfaces::orca::sysCallInterface::call_orca(int t)
+{
+  for (;;)
+  {
+    write_inputfile(t);
+    profiling::scoped_timer call_timer("ORCA external program");
+    int const res = scon::system_call(scratch.command(Config::get().energy.orca.path + " orca.inp > output_orca.txt"));
+    if (res == 0 || guess.in_use() == false) return res;
+    if (Config::get().general.verbosity >= 2) {
+      std::cout << "Orca calculation with orbitals of last step as initial guess failed. Starting from scratch.\n";
+    }
+    guess.invalidate();
+  }
+}
+
+void energy::interfaces::orca::sysCallInterface::update_guess(bool const success)
+{
+  if (success && energy::scf_guess::enabled())
+  {
+    std::remove(scratch.path("orca_guess.gbw").c_str());   // rename does not overwrite on every platform
+    if (std::rename(scratch.path("orca.gbw").c_str(), scratch.path("orca_guess.gbw").c_str()) == 0)
+    {
+      guess.store(coords->xyz(), scratch.path("orca_guess.gbw"));
+      return;
+    }
+  }
+  guess.invalidate();
+}
+
 double energy::interfaces::orca::sysCallInterface::read_output(int t)
 {
-  if (file_exists("output_orca.txt") == false)   // if orca produced no outputfile
+  profiling::scoped_timer parse_timer("ORCA output parse");
+  if (file_exists(scratch.path("output_orca.txt")) == false)   // if orca produced no outputfile
   {
     std::cout << "ORCA output file not present. Integrity is broken\n";
     integrity = false;
@@ -124,7 +163,7 @@ double energy::interfaces::orca::sysCallInterface::read_output(int t)
   int N = (*this->coords).size();  // number of atoms
 
   std::ifstream out;
-  out.open("output_orca.txt");
+  out.open(scratch.path("output_orca.txt"));
 
   std::string line;
   std::vector<std::string> linevec;
@@ -205,13 +244,13 @@ double energy::interfaces::orca::sysCallInterface::read_output(int t)
 
   if (t == 2)
   {
-    if (file_exists("orca.hess") == true) read_hessian_from_file("orca.hess");
+    if (file_exists(scratch.path("orca.hess")) == true) read_hessian_from_file(scratch.path("orca.hess"));
     else std::cout << "ORCA hessian file not present\n";
   }
 
   if (t == 3)        // if optimization requested
   {
-    if (file_exists("orca.xyz") == false)
+    if (file_exists(scratch.path("orca.xyz")) == false)
     {
       std::cout << "Optimization produced no output file.\n";
       integrity = false;
@@ -219,7 +258,7 @@ double energy::interfaces::orca::sysCallInterface::read_output(int t)
     else
     {
       std::ifstream geom_file;
-      geom_file.open("orca.xyz");
+      geom_file.open(scratch.path("orca.xyz"));
 
       std::getline(geom_file, line);        // first line: number of atoms
       int number_of_atoms = std::stoi(line);
@@ -244,10 +283,10 @@ double energy::interfaces::orca::sysCallInterface::read_output(int t)
   {
     grad_ext_charges.clear();  // delete former gradients
 
-    if (file_exists("orca.pcgrad") == false) throw std::runtime_error("can't read gradients on external point charges from file 'orca.pcgrad'");
+    if (file_exists(scratch.path("orca.pcgrad")) == false) throw std::runtime_error("can't read gradients on external point charges from file 'orca.pcgrad'");
 
     std::ifstream pcgrad;
-    pcgrad.open("orca.pcgrad");
+    pcgrad.open(scratch.path("orca.pcgrad"));
 
     unsigned number_of_pointcharges;         // read number of point charges
     pcgrad >> number_of_pointcharges;
@@ -270,25 +309,25 @@ double energy::interfaces::orca::sysCallInterface::read_output(int t)
   // deleting files
   if (Config::get().energy.orca.verbose < 4)
   {
-    std::remove("orca.ges");
-    std::remove("orca.prop");
+    std::remove(scratch.path("orca.ges").c_str());
+    std::remove(scratch.path("orca.prop").c_str());
   }
   if (Config::get().energy.orca.verbose < 3)
   {
-    std::remove("orca.opt");
-    std::remove("orca.trj");
-    std::remove("orca.engrad");
-    std::remove("orca_property.txt");
+    std::remove(scratch.path("orca.opt").c_str());
+    std::remove(scratch.path("orca.trj").c_str());
+    std::remove(scratch.path("orca.engrad").c_str());
+    std::remove(scratch.path("orca_property.txt").c_str());
   }
   if (Config::get().energy.orca.verbose < 2)
   {
-    std::remove("orca.xyz");
-    std::remove("orca.hess");
+    std::remove(scratch.path("orca.xyz").c_str());
+    std::remove(scratch.path("orca.hess").c_str());
   }
   if (Config::get().energy.orca.verbose < 1)
   {
-    std::remove("output_orca.txt");
-    std::remove("orca.inp");
+    std::remove(scratch.path("output_orca.txt").c_str());
+    std::remove(scratch.path("orca.inp").c_str());
   }
 
   return energy;
@@ -372,8 +411,7 @@ double energy::interfaces::orca::sysCallInterface::e(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(0);
-    int res = scon::system_call(Config::get().energy.orca.path + " orca.inp > output_orca.txt");
+    int res = call_orca(0);
     if (res == 0) energy = read_output(0);
     else {
       if (Config::get().general.verbosity >= 2) {
@@ -381,6 +419,9 @@ double energy::interfaces::orca::sysCallInterface::e(void)
       }
       integrity = false;
     }
+    if (res == 0 && integrity) scratch.mark_success();
+    else scratch.mark_failed();
+    update_guess(res == 0 && integrity);
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -396,8 +437,7 @@ double energy::interfaces::orca::sysCallInterface::g(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(1);
-    int res = scon::system_call(Config::get().energy.orca.path + " orca.inp > output_orca.txt");
+    int res = call_orca(1);
     if (res == 0) energy = read_output(1);
     else {
       if (Config::get().general.verbosity >= 2) {
@@ -405,6 +445,9 @@ double energy::interfaces::orca::sysCallInterface::g(void)
       }
       integrity = false;
     }
+    if (res == 0 && integrity) scratch.mark_success();
+    else scratch.mark_failed();
+    update_guess(res == 0 && integrity);
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -420,8 +463,7 @@ double energy::interfaces::orca::sysCallInterface::h(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(2);
-    int res = scon::system_call(Config::get().energy.orca.path + " orca.inp > output_orca.txt");
+    int res = call_orca(2);
     if (res == 0) energy = read_output(2);
     else {
       if (Config::get().general.verbosity >= 2) {
@@ -429,6 +471,9 @@ double energy::interfaces::orca::sysCallInterface::h(void)
       }
       integrity = false;
     }
+    if (res == 0 && integrity) scratch.mark_success();
+    else scratch.mark_failed();
+    update_guess(res == 0 && integrity);
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -444,8 +489,7 @@ double energy::interfaces::orca::sysCallInterface::o(void)
   integrity = coords->check_structure();
   if (integrity == true)
   {
-    write_inputfile(3);
-    int res = scon::system_call(Config::get().energy.orca.path + " orca.inp > output_orca.txt");
+    int res = call_orca(3);
     if (res == 0) energy = read_output(3);  // also sets new geometry
     else {
       if (Config::get().general.verbosity >= 2) {
@@ -453,6 +497,9 @@ double energy::interfaces::orca::sysCallInterface::o(void)
       }
       integrity = false;
     }
+    if (res == 0 && integrity) scratch.mark_success();
+    else scratch.mark_failed();
+    update_guess(res == 0 && integrity);
     // check if geometry is still intact
     if (coords->check_bond_preservation() == false) integrity = false;
     else if (coords->check_for_crashes() == false) integrity = false;
@@ -27,6 +27,8 @@ Purpose: interface to ORCA
 #include "coords.h"
 #include "coords_io.h"
 #include "modify_sk.h"
+#include "energy_scratch.h"
+#include "energy_guess.h"
 
 #if defined (_MSC_VER)
 #include "win_inc.h"
@@ -86,6 +88,8 @@ namespace energy
         std::vector<coords::float_type> charges() const override { return mulliken_charges; };
         /**returns gradients on external charges due to the molecular system (used for QM/MM)*/
         coords::Gradients_3D get_g_ext_chg() const override { return grad_ext_charges; };
+        /**scratch directory of this interface (empty if files are written into the working directory)*/
+        std::string working_directory() const override { return scratch.directory(); }
 
       private:
 
@@ -96,6 +100,14 @@ namespace energy
         @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)*/
         void write_inputfile(int t);
 
+        /**writes inputfile and calls orca (again without old orbitals if the calculation with them fails)
+        @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)
+        @return return value of orca*/
+        int call_orca(int t);
+
+        /**moves orbitals of a successful calculation to the guess file or forgets them after a failed one*/
+        void update_guess(bool const success);
+
         /**reads orca outputfile (???)
         @param t: type of calculation (0 = energy, 1 = gradient, 2 = hessian, 3 = optimize)*/
         double read_output(int t);
@@ -130,6 +142,12 @@ namespace energy
 
         /**gradients of external charges*/
         coords::Gradients_3D grad_ext_charges;
+
+        /**directory where all ORCA files of this instance are written (own directory for every clone)*/
+        energy::scratch_directory scratch;
+
+        /**decides if orbitals of the last calculation (orca_guess.gbw) are read*/
+        energy::scf_guess guess;
       };
 
     }
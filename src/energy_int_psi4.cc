@@ -1,4 +1,5 @@
 #include "energy_int_psi4.h"
+#include "profiling.h"
 
 void energy::interfaces::psi4::sysCallInterface::swap(interface_base& other) {
   auto casted = dynamic_cast<sysCallInterface*>(&other);
@@ -80,7 +81,8 @@ void energy::interfaces::psi4::sysCallInterface::print_E_short(std::ostream& os,
 void energy::interfaces::psi4::sysCallInterface::to_stream(std::ostream&) const {}
 
 void energy::interfaces::psi4::sysCallInterface::write_input(energy::interfaces::psi4::sysCallInterface::Calc kind) const {
-  std::ofstream ofs(id + "_inp.dat");
+  profiling::scoped_timer write_timer("PSI4 input write");
+  std::ofstream ofs(scratch.path(id + "_inp.dat"));
   if (kind == Calc::energy) {
     write_energy_input(ofs);
   }
@@ -122,7 +124,7 @@ void energy::interfaces::psi4::sysCallInterface::write_ext_charges(std::ostream&
   os << "Chrgfield = QMMM()\n";
 
   std::ofstream gridfile;
-  gridfile.open("grid.dat");
+  gridfile.open(scratch.path("grid.dat"));
 
   for (auto c : get_external_charges())
   {
@@ -165,6 +167,7 @@ void energy::interfaces::psi4::sysCallInterface::write_optimize_input(std::ostre
 }
 
 void energy::interfaces::psi4::sysCallInterface::make_call()const {
+  profiling::scoped_timer call_timer("PSI4 external program");
   std::stringstream call_stream;
   auto const& path = Config::get().energy.psi4.path;
   call_stream << path << " -n " << Config::get().energy.psi4.threads << " "
@@ -173,8 +176,9 @@ void energy::interfaces::psi4::sysCallInterface::make_call()const {
 
   auto failcount = 0u;
   for (; failcount < 3u; ++failcount) {
-    auto ret = scon::system_call(call_stream.str());
+    auto ret = scon::system_call(scratch.command(call_stream.str()));
     if (ret == 0) {
+      scratch.mark_success();
       break;
     }
     else {
@@ -183,6 +187,7 @@ void energy::interfaces::psi4::sysCallInterface::make_call()const {
     }
   }
   if (failcount == 3) {
+    scratch.mark_failed();
     throw std::runtime_error("3 Psi4 calls failed!");
   }
 }
@@ -205,12 +210,12 @@ std::vector<std::string> energy::interfaces::psi4::sysCallInterface::parse_speci
 }
 
 coords::Representation_3D energy::interfaces::psi4::sysCallInterface::get_final_geometry() const {
-  std::ifstream ifs(id + "_out.dat");
+  std::ifstream ifs(scratch.path(id + "_out.dat"));
   return extract_Rep3D(parse_specific_position(ifs, "Final optimized geometry", 6));
 }
 
 std::vector<std::string> energy::interfaces::psi4::sysCallInterface::get_last_gradients()const {
-  std::ifstream ifs(id + "_out.dat");
+  std::ifstream ifs(scratch.path(id + "_out.dat"));
   std::vector<std::string> grads;
   for (auto tmp_grads = parse_specific_position(ifs, "Total Grad", 3);
     !tmp_grads.empty(); tmp_grads = parse_specific_position(ifs, "Total Grad", 3)) {
@@ -221,7 +226,8 @@ std::vector<std::string> energy::interfaces::psi4::sysCallInterface::get_last_gr
 
 coords::float_type energy::interfaces::psi4::sysCallInterface::parse_energy()
 {
-  std::ifstream ifs(id + "_out.dat");
+  profiling::scoped_timer parse_timer("PSI4 output parse");
+  std::ifstream ifs(scratch.path(id + "_out.dat"));
   energies.clear();
   std::vector<std::string> energy;
 
@@ -261,10 +267,10 @@ energy::interfaces::psi4::sysCallInterface::parse_geometry_and_gradients() {
 
 void energy::interfaces::psi4::sysCallInterface::read_charges()
 {
-  if (!file_exists(id + "_out.dat")) throw std::runtime_error("Didn't find Psi4 output file for getting charges.");
+  if (!file_exists(scratch.path(id + "_out.dat"))) throw std::runtime_error("Didn't find Psi4 output file for getting charges.");
 
   std::ifstream in_file;
-  in_file.open(id + "_out.dat");
+  in_file.open(scratch.path(id + "_out.dat"));
 
   std::string line;
   std::vector<std::string> linevec;
@@ -296,7 +302,7 @@ coords::Gradients_3D energy::interfaces::psi4::sysCallInterface::get_g_ext_chg()
   std::vector<coords::Cartesian_Point> electric_field;
 
   std::ifstream inputfile;
-  inputfile.open("grid_field.dat");
+  inputfile.open(scratch.path("grid_field.dat"));
 
   std::string line;
   double temp;
@@ -9,6 +9,7 @@
 #include"coords_io.h"
 #include"energy.h"
 #include"coords.h"
+#include"energy_scratch.h"
 
 namespace energy {
   namespace interfaces {
@@ -17,14 +18,14 @@ namespace energy {
       class sysCallInterface final : public interface_base {
       public:
         sysCallInterface(coords::Coordinates* coords_ptr)
-          : interface_base(coords_ptr)
+          : interface_base(coords_ptr), scratch("psi4")
         {
           id = create_random_file_name(Config::get().general.outputFilename);
           optimizer = true;
           charge = std::stoi(Config::get().energy.psi4.charge);
         }
         sysCallInterface(sysCallInterface const& other, coords::Coordinates* coord)
-          : interface_base(coord)
+          : interface_base(coord), scratch(other.scratch)
         {
           id = other.id;
           charge = other.charge;
@@ -66,6 +67,8 @@ namespace energy {
         /**calculates gradients on external charges
         uses coulomb potential between external charge and mulliken charges of atoms*/
         coords::Gradients_3D get_g_ext_chg() const override;
+        /**scratch directory of this interface (empty if files are written into the working directory)*/
+        std::string working_directory() const override { return scratch.directory(); }
 
       private:
 
@@ -127,6 +130,10 @@ namespace energy {
 
         /**gradients of external charges*/
         std::vector<coords::Cartesian_Point> grad_ext_charges;
+
+        /**directory where all Psi4 files of this instance are written (own directory for every clone)
+        mutable because the const call function marks failed jobs*/
+        mutable energy::scratch_directory scratch;
       };
     }
   }
@@ -1,4 +1,10 @@
 #include <cstddef>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
 
 #include "energy_int_qmmm_a.h"
 #include "Scon/scon_utility.h"
@@ -6,7 +12,7 @@
 ::tinker::parameter::parameters energy::interfaces::qmmm::QMMM_A::tp;
 
 energy::interfaces::qmmm::QMMM_A::QMMM_A(coords::Coordinates* cp) :
-  interface_base(cp),
+  interface_base(cp), cparams(std::make_shared< ::tinker::parameter::parameters const>()),
   qm_indices(Config::get().energy.qmmm.qm_systems[0]),
   mm_indices(get_mm_atoms(cp->size())),
   new_indices_qm(make_new_indices(qm_indices, cp->size())),
@@ -17,6 +23,9 @@ energy::interfaces::qmmm::QMMM_A::QMMM_A(coords::Coordinates* cp) :
   index_of_QM_center(get_index_of_QM_center(Config::get().energy.qmmm.centers[0], qm_indices, coords)),
   qm_energy(0.0), mm_energy(0.0), vdw_energy(0.0), bonded_energy(0.0), coulomb_energy(0.0)
 {
+  // should own optimizer (microiterations) be used?
+  optimizer = Config::get().energy.qmmm.opt && Config::get().energy.qmmm.opt_additive;
+
   // read force field parameter file if necessary
   if (!tp.valid()) tp.from_file(Config::get().general.paramFilename);
   
@@ -41,12 +50,15 @@ energy::interfaces::qmmm::QMMM_A::QMMM_A(coords::Coordinates* cp) :
 energy::interfaces::qmmm::QMMM_A::QMMM_A(QMMM_A const& rhs,
   coords::Coordinates* cobj) : interface_base(cobj),
   cparams(rhs.cparams), qm_indices(rhs.qm_indices), mm_indices(rhs.mm_indices), charge_indices(rhs.charge_indices),
+  external_charge_set(rhs.external_charge_set),
   new_indices_qm(rhs.new_indices_qm), new_indices_mm(rhs.new_indices_mm), link_atoms(rhs.link_atoms),
   qmc(rhs.qmc), mmc(rhs.mmc), qmmm_bonds(rhs.qmmm_bonds), qmmm_angles(rhs.qmmm_angles), qmmm_dihedrals(rhs.qmmm_dihedrals),
 	torsionunit(rhs.torsionunit), index_of_QM_center(rhs.index_of_QM_center), qm_energy(rhs.qm_energy), mm_energy(rhs.mm_energy),
   vdw_energy(rhs.vdw_energy), bonded_energy(rhs.bonded_energy), coulomb_energy(rhs.coulomb_energy),
   coulomb_gradient(rhs.coulomb_gradient), vdw_gradient(rhs.vdw_gradient), bonded_gradient(rhs.bonded_gradient),
-	g_coul_mm(rhs.g_coul_mm)
+  vdw_types_qm(rhs.vdw_types_qm), vdw_types_mm(rhs.vdw_types_mm), number_of_vdw_types_mm(rhs.number_of_vdw_types_mm),
+  vdw_pairs(rhs.vdw_pairs), vdw_exceptions(rhs.vdw_exceptions),
+	g_coul_mm(rhs.g_coul_mm), frozen_qm_charges(rhs.frozen_qm_charges)
 {
   interface_base::operator=(rhs);
 }
@@ -55,6 +67,7 @@ energy::interfaces::qmmm::QMMM_A::QMMM_A(QMMM_A&& rhs, coords::Coordinates* cobj
   : interface_base(cobj),
   cparams(std::move(rhs.cparams)),
   qm_indices(std::move(rhs.qm_indices)), mm_indices(std::move(rhs.mm_indices)), charge_indices(std::move(rhs.charge_indices)),
+  external_charge_set(std::move(rhs.external_charge_set)),
   new_indices_qm(std::move(rhs.new_indices_qm)), new_indices_mm(std::move(rhs.new_indices_mm)),
   link_atoms(std::move(rhs.link_atoms)), qmc(std::move(rhs.qmc)), mmc(std::move(rhs.mmc)),
 	qmmm_bonds(std::move(rhs.qmmm_bonds)), qmmm_angles(std::move(rhs.qmmm_angles)), qmmm_dihedrals(std::move(rhs.qmmm_dihedrals)),
@@ -62,7 +75,9 @@ energy::interfaces::qmmm::QMMM_A::QMMM_A(QMMM_A&& rhs, coords::Coordinates* cobj
   qm_energy(std::move(rhs.qm_energy)), mm_energy(std::move(rhs.mm_energy)), vdw_energy(std::move(rhs.vdw_energy)),
   bonded_energy(std::move(rhs.bonded_energy)), coulomb_energy(std::move(rhs.coulomb_energy)),
   coulomb_gradient(std::move(rhs.coulomb_gradient)), vdw_gradient(std::move(rhs.vdw_gradient)), bonded_gradient(std::move(rhs.bonded_gradient)),
-	g_coul_mm(std::move(rhs.g_coul_mm))
+  vdw_types_qm(std::move(rhs.vdw_types_qm)), vdw_types_mm(std::move(rhs.vdw_types_mm)), number_of_vdw_types_mm(rhs.number_of_vdw_types_mm),
+  vdw_pairs(std::move(rhs.vdw_pairs)), vdw_exceptions(std::move(rhs.vdw_exceptions)),
+	g_coul_mm(std::move(rhs.g_coul_mm)), frozen_qm_charges(std::move(rhs.frozen_qm_charges))
 {
   interface_base::operator=(rhs);
 }
@@ -73,9 +88,9 @@ void energy::interfaces::qmmm::QMMM_A::find_parameters()
   for (auto& b : qmmm_bonds)  // find bond parameters
   {
     bool found = false;
-    auto b_type_a = cparams.type(coords->atoms().atom(b.a).energy_type(), tinker::potential_keys::BOND);
-    auto b_type_b = cparams.type(coords->atoms().atom(b.b).energy_type(), tinker::potential_keys::BOND);
-    for (auto b_param : cparams.bonds())
+    auto b_type_a = cparams->type(coords->atoms().atom(b.a).energy_type(), tinker::potential_keys::BOND);
+    auto b_type_b = cparams->type(coords->atoms().atom(b.b).energy_type(), tinker::potential_keys::BOND);
+    for (auto b_param : cparams->bonds())
     {
       if (b_param.index[0] == b_type_a && b_param.index[1] == b_type_b)
       {
@@ -96,10 +111,10 @@ void energy::interfaces::qmmm::QMMM_A::find_parameters()
   for (auto& a : qmmm_angles)  // find angle parameters
   {
     bool found = false;
-    auto a_type_a = cparams.type(coords->atoms().atom(a.a).energy_type(), tinker::potential_keys::ANGLE);
-    auto a_type_b = cparams.type(coords->atoms().atom(a.b).energy_type(), tinker::potential_keys::ANGLE);
-    auto a_type_c = cparams.type(coords->atoms().atom(a.c).energy_type(), tinker::potential_keys::ANGLE);
-    for (auto a_param : cparams.angles())
+    auto a_type_a = cparams->type(coords->atoms().atom(a.a).energy_type(), tinker::potential_keys::ANGLE);
+    auto a_type_b = cparams->type(coords->atoms().atom(a.b).energy_type(), tinker::potential_keys::ANGLE);
+    auto a_type_c = cparams->type(coords->atoms().atom(a.c).energy_type(), tinker::potential_keys::ANGLE);
+    for (auto a_param : cparams->angles())
     {
       if (a_param.index[1] == a_type_c)
       {
@@ -123,11 +138,11 @@ void energy::interfaces::qmmm::QMMM_A::find_parameters()
   for (auto& d : qmmm_dihedrals)  // find parameters for dihedrals
   {
     bool found = false;
-    auto d_type_a = cparams.type(coords->atoms().atom(d.a).energy_type(), tinker::potential_keys::TORSION);
-    auto d_type_b = cparams.type(coords->atoms().atom(d.b).energy_type(), tinker::potential_keys::TORSION);
-    auto d_type_c1 = cparams.type(coords->atoms().atom(d.c1).energy_type(), tinker::potential_keys::TORSION);
-    auto d_type_c2 = cparams.type(coords->atoms().atom(d.c2).energy_type(), tinker::potential_keys::TORSION);
-    for (auto d_param : cparams.torsions())  // find parameters only with real atom types (no 0)
+    auto d_type_a = cparams->type(coords->atoms().atom(d.a).energy_type(), tinker::potential_keys::TORSION);
+    auto d_type_b = cparams->type(coords->atoms().atom(d.b).energy_type(), tinker::potential_keys::TORSION);
+    auto d_type_c1 = cparams->type(coords->atoms().atom(d.c1).energy_type(), tinker::potential_keys::TORSION);
+    auto d_type_c2 = cparams->type(coords->atoms().atom(d.c2).energy_type(), tinker::potential_keys::TORSION);
+    for (auto d_param : cparams->torsions())  // find parameters only with real atom types (no 0)
     {
       if (d_param.index[0] == d_type_a && d_param.index[1] == d_type_c1 && d_param.index[2] == d_type_c2 && d_param.index[3] == d_type_b)
       {
@@ -150,7 +165,7 @@ void energy::interfaces::qmmm::QMMM_A::find_parameters()
     }
     if (found == false)   // find parameters where one of the outer atoms is a 0 instead of the "real" atom type
     {
-      for (auto d_param : cparams.torsions())
+      for (auto d_param : cparams->torsions())
       {
         if (d_param.index[0] == 0 && d_param.index[1] == d_type_c1 && d_param.index[2] == d_type_c2 && d_param.index[3] == d_type_b)
         {
@@ -192,7 +207,7 @@ void energy::interfaces::qmmm::QMMM_A::find_parameters()
     }
     if (found == false)
     {
-      for (auto d_param : cparams.torsions())  // find parameters where both outer atoms are 0
+      for (auto d_param : cparams->torsions())  // find parameters where both outer atoms are 0
       {
         if (d_param.index[0] == 0 && d_param.index[1] == d_type_c1 && d_param.index[2] == d_type_c2 && d_param.index[3] == 0)
         {
@@ -350,7 +365,10 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::qmmm_calc(bool const if_gra
     std::vector<double> mm_charge_vector = mmc.energyinterface()->charges();
 
     charge_indices.clear();
-    add_external_charges(qm_indices, mm_charge_vector, mm_indices, link_atoms, charge_indices, coords, index_of_QM_center);
+    auto point_charges = std::make_shared<std::vector<PointCharge>>();
+    external_charge_set.add(mm_charge_vector, charge_indices, coords, index_of_QM_center, *point_charges);
+    set_external_charges(point_charges);                          // needed for coulomb interactions
+    qmc.energyinterface()->set_external_charges(point_charges);   // only QM programme sees them
   }
 
   // ################### DO CALCULATION ###########################################
@@ -365,7 +383,23 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::qmmm_calc(bool const if_gra
   else throw std::runtime_error("Chosen QM interface not implemented for QM/MM!");
 
   bool periodic = Config::get().periodics.periodic;   // switch off periodic boundaries for QM calculation
-  Config::set().periodics.periodic = false;
+  if (periodic) Config::set().periodics.periodic = false;   // (only written if necessary, MM thread might read it)
+
+  // MM part, bonded and vdW interactions don't depend on the QM calculation so they can run while the QM programme is running
+  // (not with periodic boundaries as they are switched off globally during the QM calculation)
+  bool const concurrent = Config::get().energy.qmmm.async && !periodic;
+  std::future<bool> mm_job;
+  if (concurrent)
+  {
+    // the MM system gets no charges: the embedding charges sit on its own atoms
+    // (passed explicitly so the MM thread doesn't depend on charges of other interfaces)
+    mmc.energyinterface()->set_external_charges(nullptr);
+    mm_job = run_in_background([this, if_gradient]() {
+      ww_calc_bonded_vdw(if_gradient);
+      mm_energy = if_gradient ? mmc.g() : mmc.e();
+      return true;
+    });
+  }
 
   try {
     if (if_gradient)
@@ -382,16 +416,25 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::qmmm_calc(bool const if_gra
     std::cout << "QM programme failed. Treating structure as broken.\n";
     integrity = false;  // if QM programme fails: integrity is destroyed
   }
-  clear_external_charges();  // no external charges for MM calculation
-  Config::set().periodics.periodic = periodic;   // reset periodic boundaries
+  if (periodic) Config::set().periodics.periodic = periodic;   // reset periodic boundaries
 
-  ww_calc(if_gradient);  // calculate interactions between QM and MM part
+  if (concurrent)
+  {
+    if (mm_job.get() == false)
+    {
+      std::cout << "MM programme failed. Treating structure as broken.\n";
+      integrity = false;
+    }
+    ww_calc_coulomb(if_gradient);  // only coulomb interactions need the QM result
+  }
+  else ww_calc(if_gradient);  // calculate interactions between QM and MM part
+  clear_external_charges();  // external charges are not needed any more (coulomb interactions with cutoff still need them)
 
   if (integrity == true)
   {
     if (if_gradient)  // if gradients should be calculated
     {
-      mm_energy = mmc.g(); // get energy for MM part
+      if (!concurrent) mm_energy = mmc.g(); // get energy for MM part
 
       // get gradients: QM + MM + vdW + Coulomb + bonded
       auto new_grads = vdw_gradient + coulomb_gradient + bonded_gradient;  // vdW + Coulomb + bonded
@@ -428,7 +471,7 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::qmmm_calc(bool const if_gra
       }
       coords->swap_g_xyz(new_grads);
     }
-    else  // only energy
+    else if (!concurrent)  // only energy
     {
       mm_energy = mmc.e();  // get energy for MM part
     }
@@ -441,6 +484,35 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::qmmm_calc(bool const if_gra
   return energy;
 }
 
+coords::float_type energy::interfaces::qmmm::QMMM_A::mm_environment_calc(bool const if_gradient)
+{
+  integrity = true;
+  update_representation();
+
+  ww_calc_bonded_vdw(if_gradient);
+  if (Config::get().energy.qmmm.zerocharge_bonds != 0) ww_calc_coulomb_frozen(if_gradient);
+  else ww_calc_coulomb(if_gradient);   // mechanical embedding doesn't need the QM calculation anyway
+  mm_energy = if_gradient ? mmc.g() : mmc.e();
+
+  if (if_gradient)  // gradients: MM + vdW + Coulomb + bonded (QM atoms are fixed)
+  {
+    auto new_grads = vdw_gradient + coulomb_gradient + bonded_gradient;
+    auto const& g_mm = mmc.g_xyz();
+    for (auto&& mmi : mm_indices)
+    {
+      new_grads[mmi] += g_mm[new_indices_mm[mmi]];
+    }
+    coords->swap_g_xyz(new_grads);
+  }
+
+  // energy of the MM environment (QM energy of the frozen QM region is left out)
+  qm_energy = 0.0;
+  energy = mm_energy + vdw_energy + bonded_energy + coulomb_energy;
+  if (coords->check_bond_preservation() == false) integrity = false;
+  else if (coords->check_for_crashes() == false) integrity = false;
+  return energy;
+}
+
 /**calculate bonded energy and gradients*/
 double energy::interfaces::qmmm::QMMM_A::calc_bonded(bool const if_gradient)
 {
@@ -484,164 +556,227 @@ int energy::interfaces::qmmm::QMMM_A::calc_vdw(unsigned const qm, unsigned const
   return 1;
 }
 
+void energy::interfaces::qmmm::QMMM_A::prepare_vdw_qmmm()
+{
+  auto const& vdw_params = cparams->vdws();  // get vdw parameters
+  auto const radiustype = cparams->general().radiustype.value;
+  if (radiustype != ::tinker::parameter::radius_types::T::SIGMA && radiustype != ::tinker::parameter::radius_types::T::R_MIN)
+  {
+    throw std::runtime_error("no valid radius_type");
+  }
+
+  // find indices of vdw parameters for every atom and give every different parameter a successive number
+  auto find_types = [this](coords::Coordinates const& subsystem, std::size_t const number_of_atoms, std::vector<std::size_t>& types)
+  {
+    std::vector<std::size_t> params, used_params;
+    for (auto i = 0u; i < number_of_atoms; ++i)
+    {
+      auto z = subsystem.atoms(i).energy_type();  // get atom type
+      params.emplace_back(cparams->type(z, tinker::potential_keys::VDW) - 1u);  // index of this atom type in vdw parameters
+      scon::sorted::insert_unique(used_params, params.back());
+    }
+    types.clear();
+    for (auto p : params) types.emplace_back(std::lower_bound(used_params.begin(), used_params.end(), p) - used_params.begin());
+    return used_params;
+  };
+  auto const params_qm = find_types(qmc, qm_indices.size(), vdw_types_qm);
+  auto const params_mm = find_types(mmc, mm_indices.size(), vdw_types_mm);
+  number_of_vdw_types_mm = params_mm.size();
+
+  // combine parameters for every pair of types
+  vdw_pairs.clear();
+  for (auto pi : params_qm)
+  {
+    for (auto pj : params_mm)
+    {
+      auto const& vparams_i = vdw_params[pi];
+      auto const& vparams_j = vdw_params[pj];
+      vdw_pair p;
+      if (radiustype == ::tinker::parameter::radius_types::T::SIGMA) p.R_0 = std::sqrt(vparams_i.r * vparams_j.r);  // sigma
+      else p.R_0 = vparams_i.r + vparams_j.r;  // r_min
+      p.epsilon = std::sqrt(vparams_i.e * vparams_j.e);  // epsilon
+      vdw_pairs.emplace_back(p);
+    }
+  }
+
+  // vdW is only excluded or scaled for atoms that are part of bonded QM/MM interactions
+  std::vector<std::size_t> partners;
+  for (auto const& b : qmmm_bonds) scon::sorted::insert_unique(partners, std::size_t(b.b));
+  for (auto const& a : qmmm_angles)
+  {
+    scon::sorted::insert_unique(partners, std::size_t(a.a));
+    scon::sorted::insert_unique(partners, std::size_t(a.b));
+  }
+  for (auto const& d : qmmm_dihedrals)
+  {
+    scon::sorted::insert_unique(partners, std::size_t(d.a));
+    scon::sorted::insert_unique(partners, std::size_t(d.b));
+  }
+  vdw_exceptions.assign(qm_indices.size(), {});
+  for (auto i2 = 0u; i2 < qm_indices.size(); ++i2)
+  {
+    for (auto j : partners)
+    {
+      int calc_modus = calc_vdw(qm_indices[i2], j);
+      if (calc_modus == 1) continue;
+      vdw_exceptions[i2].emplace_back(j, calc_modus);
+      if (Config::get().general.verbosity > 4)
+      {
+        std::cout << "VdW calc_modus between atoms " << qm_indices[i2] + 1 << " and " << j + 1 << " is " << calc_modus << ".\n";
+      }
+    }
+  }
+}
+
+int energy::interfaces::qmmm::QMMM_A::vdw_modus(std::size_t const qm, std::size_t const mm) const
+{
+  for (auto const& e : vdw_exceptions[qm])
+  {
+    if (e.first == mm) return e.second;
+  }
+  return 1;
+}
+
 /**calculates interaction between QM and MM part
 @param if_gradient: true if gradients should be calculated, false if not*/
 void energy::interfaces::qmmm::QMMM_A::ww_calc(bool const if_gradient)
+{
+  ww_calc_bonded_vdw(if_gradient);
+  ww_calc_coulomb(if_gradient);
+}
+
+/**calculates bonded and vdW interactions between QM and MM part (independent of QM calculation)
+@param if_gradient: true if gradients should be calculated, false if not*/
+void energy::interfaces::qmmm::QMMM_A::ww_calc_bonded_vdw(bool const if_gradient)
 {
   // bonded interactions
   bonded_gradient.assign(coords->size(), coords::r3{});
   bonded_energy = calc_bonded(if_gradient);
 
-  // preparation for calculation of non-bonded interactions
-  std::vector<double> qm_charge_vector;                                     // vector with all charges of QM atoms
-  std::vector<double> mm_charge_vector = mmc.energyinterface()->charges();  // vector with all charges of MM atoms
-  try {
-    qm_charge_vector = qmc.energyinterface()->charges(); // still link atoms in it
-    for (auto i = 0u; i < link_atoms.size(); ++i) {      // remove charges from link atoms
-      qm_charge_vector.pop_back();
-    }
-  }
-  catch (...) { integrity = false; }
+  //########## reset vdw gradients and energies #################################
 
-  if (integrity == true)
-  {
-    //########## reset vdw gradients and energies #################################
+  vdw_gradient.assign(coords->size(), coords::r3{});
+  vdw_energy = 0.0;
 
-    coulomb_gradient.assign(coords->size(), coords::r3{});
-    vdw_gradient.assign(coords->size(), coords::r3{});
-    vdw_energy = 0.0;
-    coulomb_energy = 0.0;
+  // ########## calculate vdw interactions ##########################################
 
-    // ########## calculate vdw interactions ##########################################
+  auto const& xyz = coords->xyz();
+  bool const periodic = Config::get().periodics.periodic;
+  bool const sigma = cparams->general().radiustype.value == ::tinker::parameter::radius_types::T::SIGMA;
+  double const scaling_14 = cparams->general().vdw_scale.factor(3);
+  double const c = Config::get().energy.cutoff;       // cutoff distance
+  double const s = Config::get().energy.switchdist;   // distance where cutoff starts to kick in (only vdW)
+  bool const use_cutoff = c < std::numeric_limits<double>::max();
 
-    auto vdw_params = cparams.vdws();  // get vdw parameters
+  // only MM atoms within cutoff of QM region (linked cells are not used with periodic boundaries)
+  std::vector<std::size_t> const mm_atoms = use_cutoff && !periodic ?
+    find_mm_atoms_near_qm(qm_indices, mm_indices, xyz, c) : range(mm_indices.size());
+
+  std::ptrdiff_t const M = static_cast<std::ptrdiff_t>(mm_atoms.size());
+  std::size_t const N = coords->size();
+  double energy_sum = 0.0;
+  Config const& active_config = Config::get();   // boundary() reads the box, workers do not inherit a Config::local_scope
+#pragma omp parallel
+  {
+    Config::worker_scope config_scope(active_config);
+    coords::Gradients_3D thread_gradient;   // every thread has its own gradients which are summed up in the end
+    if (if_gradient) thread_gradient.assign(N, coords::r3{});
 
-    std::size_t i2 = 0u;
-    for (auto i : qm_indices)  // for every QM atom
+#pragma omp for reduction(+: energy_sum) schedule(dynamic, 64)
+    for (std::ptrdiff_t m = 0; m < M; ++m)  // for every MM atom
     {
-      auto z = qmc.atoms(i2).energy_type();  // get atom type
-      std::size_t i_vdw = cparams.type(z, tinker::potential_keys::VDW);  // get index to find this atom type in vdw parameters
-      auto vparams_i = vdw_params[i_vdw - 1];  // get vdw parameters for QM atom
-      std::size_t j2 = 0u;
-      for (auto j : mm_indices)  // for every MM atom
+      std::size_t const j2 = mm_atoms[m];
+      std::size_t const j = mm_indices[j2];
+      vdw_pair const* const pairs_j = &vdw_pairs[vdw_types_mm[j2]];
+
+      for (std::size_t i2 = 0u; i2 < qm_indices.size(); ++i2)  // for every QM atom
       {
-        auto e_type = mmc.atoms(j2).energy_type();  // get atom type
-        std::size_t j_vdw = cparams.type(e_type, tinker::potential_keys::VDW); // get index to find this atom type in vdw parameters
-        auto vparams_j = vdw_params[j_vdw - 1];  // get vdw parameters for MM atom
+        std::size_t const i = qm_indices[i2];
+        auto r_ij = xyz[j] - xyz[i];            // distance between QM and MM atom
+        if (periodic) boundary(r_ij);           // if periodic boundaries: take shortest distance
+        double const d2 = dot(r_ij, r_ij);
+        if (use_cutoff && d2 > c * c) continue;   // interaction is zero outside of cutoff
 
-        auto r_ij = coords->xyz(j) - coords->xyz(i);            // distance between QM and MM atom
-        if (Config::get().periodics.periodic) boundary(r_ij);   // if periodic boundaries: take shortest distance
-        coords::float_type d = len(r_ij);
+        int const calc_modus = vdw_modus(i2, j);  // will the vdw interaction be calculated? if yes, will it be scaled down?
+        if (calc_modus == 0) continue;
 
+        double const d = std::sqrt(d2);
         double scaling = 1.0;     // determine scaling factor, default: no scaling
-        if (Config::get().energy.cutoff < std::numeric_limits<double>::max())
-        {
-          double const& c = Config::get().energy.cutoff;       // cutoff distance
-          double const& s = Config::get().energy.switchdist;   // distance where cutoff starts to kick in (only vdW)
+        if (use_cutoff && d > s) scaling = ((c * c - d2) * (c * c - d2) * (c * c + 2 * d2 - 3 * s * s)) / ((c * c - s * s) * (c * c - s * s) * (c * c - s * s));
 
-          if (d > c) scaling = 0.0;
-          else if (d > s) scaling = ((c * c - d * d) * (c * c - d * d) * (c * c + 2 * d * d - 3 * s * s)) / ((c * c - s * s) * (c * c - s * s) * (c * c - s * s));
-        }
-
-        double R_0;  // r_min or sigma
-        if (cparams.general().radiustype.value ==
-          ::tinker::parameter::radius_types::T::SIGMA)
-        {
-          R_0 = sqrt(vparams_i.r * vparams_j.r);  // sigma
-        }
-        else if (cparams.general().radiustype.value ==
-          ::tinker::parameter::radius_types::T::R_MIN)
-        {
-          R_0 = vparams_i.r + vparams_j.r;  // r_min
-        }
-        else throw std::runtime_error("no valid radius_type");
+        vdw_pair const& p = pairs_j[vdw_types_qm[i2] * number_of_vdw_types_mm];
+        double const R_r2 = p.R_0 * p.R_0 / d2;
+        double const R_r = R_r2 * R_r2 * R_r2;   // (R_0 / d)^6
 
-        double epsilon = sqrt(vparams_i.e * vparams_j.e);  // epsilon
-        auto R_r = std::pow(R_0 / d, 6);
+        double const E_unscaled = sigma ? 4 * R_r * p.epsilon * (R_r - 1.0) : R_r * p.epsilon * (R_r - 2.0);
+        double vdw = E_unscaled * scaling;  // vdw energy for current atom pair
+        if (calc_modus == 2) vdw = vdw * scaling_14;
+        energy_sum += vdw;
 
-        int calc_modus = calc_vdw(i, j);  // will the vdw interaction be calculated? if yes, will it be scaled down?
-        if (Config::get().general.verbosity > 4)
+        if (if_gradient)  // gradients
         {
-          std::cout << "VdW calc_modus between atoms " << i + 1 << " and " << j + 1 << " is " << calc_modus << ".\n";
-        }
+          double const V = sigma ? 4 * p.epsilon * R_r : p.epsilon * R_r;
+          double const vdw_r_grad = sigma ? (V / d) * (6.0 - 12.0 * R_r) : (V / d) * 12 * (1.0 - R_r);
+          auto vdw_gradient_ij = ((r_ij * vdw_r_grad) / d) * scaling;
 
-        double vdw;  // vdw energy for current atom pair
-        if (calc_modus != 0)  // calculate vdW interaction
-        {
-          if (cparams.general().radiustype.value ==
-            ::tinker::parameter::radius_types::T::SIGMA)
-          {
-            vdw = 4 * R_r * epsilon * (R_r - 1.0) * scaling;
-            if (calc_modus == 2) vdw = vdw * cparams.general().vdw_scale.factor(3);
-          }
-          else if (cparams.general().radiustype.value ==
-            ::tinker::parameter::radius_types::T::R_MIN)
-          {
-            vdw = R_r * epsilon * (R_r - 2.0) * scaling;
-            if (calc_modus == 2) vdw = vdw * cparams.general().vdw_scale.factor(3);
-          }
-          else
+          if (d > s && d <= c)  // additional gradient as charge changes with distance
           {
-            throw std::runtime_error("no valid radius_type");
+            auto deriv_S = (-12 * d * (c * c - d2) * (d2 - s * s)) / ((c * c - s * s) * (c * c - s * s) * (c * c - s * s));
+            auto abs_grad = E_unscaled * deriv_S;
+            vdw_gradient_ij += (r_ij / d) * abs_grad;  // give additional gradient a direction
           }
-          vdw_energy += vdw;
-        }
-
-        if (if_gradient)  // gradients
-        {
-          if (calc_modus != 0)  // gradients of vdW interaction
-          {
-            if (cparams.general().radiustype.value
-              == ::tinker::parameter::radius_types::T::SIGMA)
-            {
-              coords::float_type const V = 4 * epsilon * R_r;
-              auto vdw_r_grad_sigma = (V / d) * (6.0 - 12.0 * R_r);
-              auto vdw_gradient_ij_sigma = ((r_ij * vdw_r_grad_sigma) / d) * scaling;
-
-              if (d > Config::get().energy.switchdist && d <= Config::get().energy.cutoff)  // additional gradient as charge changes with distance
-              {
-                double const& c = Config::get().energy.cutoff;
-                double const& s = Config::get().energy.switchdist;
 
-                auto E_unscaled = 4 * R_r * epsilon * (R_r - 1.0);
-                auto deriv_S = (-12 * d * (c * c - d * d) * (d * d - s * s)) / ((c * c - s * s) * (c * c - s * s) * (c * c - s * s));
-                auto abs_grad = E_unscaled * deriv_S;
-
-                vdw_gradient_ij_sigma += (r_ij / d) * abs_grad;  // give additional gradient a direction
-              }
+          if (calc_modus == 2) vdw_gradient_ij = vdw_gradient_ij * scaling_14;
+          thread_gradient[i] -= vdw_gradient_ij;
+          thread_gradient[j] += vdw_gradient_ij;
+        }
+      }
+    }
 
-              if (calc_modus == 2) vdw_gradient_ij_sigma = vdw_gradient_ij_sigma * cparams.general().vdw_scale.factor(3);
-              vdw_gradient[i] -= vdw_gradient_ij_sigma;
-              vdw_gradient[j] += vdw_gradient_ij_sigma;
-            }
-            else
-            {
-              coords::float_type const V = epsilon * R_r;
-              auto vdw_r_grad_R_MIN = (V / d) * 12 * (1.0 - R_r);
-              auto vdw_gradient_ij_R_MIN = ((r_ij * vdw_r_grad_R_MIN) / d) * scaling;
+    if (if_gradient)
+    {
+#pragma omp critical (qmmm_vdw_g_sum)
+      for (std::size_t k = 0u; k < N; ++k) vdw_gradient[k] += thread_gradient[k];
+    }
+  }
+  vdw_energy = energy_sum;
+}
 
-              if (d > Config::get().energy.switchdist && d <= Config::get().energy.cutoff)  // additional gradient as charge changes with distance
-              {
-                double const& c = Config::get().energy.cutoff;
-                double const& s = Config::get().energy.switchdist;
+/**calculates coulomb interactions between QM and MM part with the frozen QM charges (no QM calculation)
+the MM charges are scaled as the QM programme would see them, including the derivative of the switching function
+@param if_gradient: true if gradients should be calculated, false if not*/
+void energy::interfaces::qmmm::QMMM_A::ww_calc_coulomb_frozen(bool const if_gradient)
+{
+  coulomb_gradient.assign(coords->size(), coords::r3{});
 
-                auto E_unscaled = R_r * epsilon * (R_r - 2.0);
-                auto deriv_S = (-12 * d * (c * c - d * d) * (d * d - s * s)) / ((c * c - s * s) * (c * c - s * s) * (c * c - s * s));
-                auto abs_grad = E_unscaled * deriv_S;
+  // external charges as the QM programme would see them (with the same scaling)
+  std::vector<PointCharge> point_charges;
+  charge_indices.clear();
+  external_charge_set.add(mmc.energyinterface()->charges(), charge_indices, coords, index_of_QM_center, point_charges);
 
-                vdw_gradient_ij_R_MIN += (r_ij / d) * abs_grad;  // give additional gradient a direction
-              }
+  coulomb_energy = frozen_coulomb(point_charges, charge_indices, qm_indices, frozen_qm_charges, coords, index_of_QM_center,
+    if_gradient ? &coulomb_gradient : nullptr);
+}
 
-              if (calc_modus == 2) vdw_gradient_ij_R_MIN = vdw_gradient_ij_R_MIN * cparams.general().vdw_scale.factor(3);
-              vdw_gradient[i] -= vdw_gradient_ij_R_MIN;
-              vdw_gradient[j] += vdw_gradient_ij_R_MIN;
-            }
-          }
-        }
-        ++j2;
-      }
-      ++i2;
+/**calculates coulomb interactions between QM and MM part (needs charges from QM calculation)
+@param if_gradient: true if gradients should be calculated, false if not*/
+void energy::interfaces::qmmm::QMMM_A::ww_calc_coulomb(bool const if_gradient)
+{
+  // preparation for calculation of non-bonded interactions
+  std::vector<double> qm_charge_vector;                                     // vector with all charges of QM atoms
+  std::vector<double> mm_charge_vector = mmc.energyinterface()->charges();  // vector with all charges of MM atoms
+  try {
+    qm_charge_vector = qmc.energyinterface()->charges(); // still link atoms in it
+    for (auto i = 0u; i < link_atoms.size(); ++i) {      // remove charges from link atoms
+      qm_charge_vector.pop_back();
     }
+  }
+  catch (...) { integrity = false; }
+
+  if (integrity == true)
+  {
+    coulomb_gradient.assign(coords->size(), coords::r3{});
+    coulomb_energy = 0.0;
 
     // ########## calculate coulomb interactions ##########################################
 
@@ -686,7 +821,7 @@ void energy::interfaces::qmmm::QMMM_A::ww_calc(bool const if_gradient)
 
     else if (Config::get().energy.qmmm.zerocharge_bonds == 0)  // mechanical embedding -> coulomb energy and gradients from MM interface
     {
-      auto c_params = cparams.charges();     // get forcefield parameters (charge)
+      auto c_params = cparams->charges();     // get forcefield parameters (charge)
       double current_coul_energy, current_coul_grad, qm_charge;  // some variables
 
       auto i2{ 0u };
@@ -699,7 +834,7 @@ void energy::interfaces::qmmm::QMMM_A::ww_calc(bool const if_gradient)
         else   // normally (i.e. OPLSAA)
         {
           auto z = qmc.atoms(i2).energy_type();  // get atom type
-          std::size_t i_coul = cparams.type(z, tinker::potential_keys::CHARGE);  // get index to find this atom type in charge parameters
+          std::size_t i_coul = cparams->type(z, tinker::potential_keys::CHARGE);  // get index to find this atom type in charge parameters
           qm_charge = c_params[i_coul - 1].c;  // get charge parameter for QM atom
         }
 
@@ -726,9 +861,9 @@ void energy::interfaces::qmmm::QMMM_A::ww_calc(bool const if_gradient)
               else scaling = (1 - (d / c) * (d / c)) * (1 - (d / c) * (d / c));
             }
 
-            current_coul_energy = ((qm_charge * mm_charge * cparams.general().electric) / d);   // calculate energy (unscaled)
+            current_coul_energy = ((qm_charge * mm_charge * cparams->general().electric) / d);   // calculate energy (unscaled)
             if (calc_modus == 2) {
-              current_coul_energy = current_coul_energy * cparams.general().chg_scale.factor(3);
+              current_coul_energy = current_coul_energy * cparams->general().chg_scale.factor(3);
             }
             auto scaled_energy = current_coul_energy * scaling;
             coulomb_energy += scaled_energy;
@@ -779,6 +914,7 @@ void energy::interfaces::qmmm::QMMM_A::swap(QMMM_A& rhs)
   std::swap(cparams, rhs.cparams);
   qm_indices.swap(rhs.qm_indices);
   mm_indices.swap(rhs.mm_indices);
+  std::swap(external_charge_set, rhs.external_charge_set);
   new_indices_mm.swap(rhs.new_indices_mm);
   new_indices_qm.swap(rhs.new_indices_qm);
   link_atoms.swap(rhs.link_atoms);
@@ -789,6 +925,12 @@ void energy::interfaces::qmmm::QMMM_A::swap(QMMM_A& rhs)
   std::swap(mm_energy, rhs.mm_energy);
   coulomb_gradient.swap(rhs.coulomb_gradient);
   vdw_gradient.swap(rhs.vdw_gradient);
+  vdw_types_qm.swap(rhs.vdw_types_qm);
+  vdw_types_mm.swap(rhs.vdw_types_mm);
+  std::swap(number_of_vdw_types_mm, rhs.number_of_vdw_types_mm);
+  vdw_pairs.swap(rhs.vdw_pairs);
+  vdw_exceptions.swap(rhs.vdw_exceptions);
+  frozen_qm_charges.swap(rhs.frozen_qm_charges);
 }
 
 void energy::interfaces::qmmm::QMMM_A::initialization()
@@ -796,13 +938,20 @@ void energy::interfaces::qmmm::QMMM_A::initialization()
   // get force field parameters
   std::vector<std::size_t> types;
   for (auto atom : coords->atoms()) scon::sorted::insert_unique(types, atom.energy_type());
-  cparams = tp.contract(types);
-  torsionunit = cparams.torsionunit();
+  cparams = std::make_shared< ::tinker::parameter::parameters const>(tp.contract(types));
+  torsionunit = cparams->torsionunit();
   // set atom charges for MM system to correct values
   mmc.set_atom_charges() = select_from_atomcharges(mm_indices, coords);
 
   // prepare bonded QM/MM
   prepare_bonded_qmmm();
+  prepare_vdw_qmmm();
+
+  // find atoms that give external charges
+  if (Config::get().energy.qmmm.zerocharge_bonds != 0)
+  {
+    external_charge_set = ExternalCharges(qm_indices, mm_indices, link_atoms, coords);
+  }
 
   // check if correct number of link atom types is given
   if (link_atoms.size() != Config::get().energy.qmmm.linkatom_sets[0].size())  // 
@@ -833,15 +982,15 @@ void energy::interfaces::qmmm::QMMM_A::update(bool const skip_topology)
 coords::float_type energy::interfaces::qmmm::QMMM_A::g()
 {
   integrity = coords->check_structure();
-  if (integrity == true) return qmmm_calc(true);
-  else return 0;
+  if (integrity == false) return 0;
+  return frozen_qm_charges.empty() ? qmmm_calc(true) : mm_environment_calc(true);
 }
 
 coords::float_type energy::interfaces::qmmm::QMMM_A::e()
 {
   integrity = coords->check_structure();
-  if (integrity == true) return qmmm_calc(false);
-  else return 0;
+  if (integrity == false) return 0;
+  return frozen_qm_charges.empty() ? qmmm_calc(false) : mm_environment_calc(false);
 }
 
 coords::float_type energy::interfaces::qmmm::QMMM_A::h()
@@ -849,9 +998,109 @@ coords::float_type energy::interfaces::qmmm::QMMM_A::h()
   throw std::runtime_error("no QMMM-function yet");
 }
 
+void energy::interfaces::qmmm::QMMM_A::fix_qm_atoms(coords::Coordinates& coordobj)
+{
+  for (auto const qmi : qm_indices) coordobj.set_fix(qmi, true);    // fix all QM atoms
+  for (auto const& link : link_atoms) coordobj.set_fix(link.mm, true);  // fix all M1 atoms (they determine the link atoms)
+}
+
+void energy::interfaces::qmmm::QMMM_A::fix_mm_atoms(coords::Coordinates& coordobj)
+{
+  for (auto const mmi : mm_indices) coordobj.set_fix(mmi, true);    // fix all MM atoms
+  for (auto const& link : link_atoms)   // M1 atoms are optimized with the QM region (unless they are fixed anyway)
+  {
+    if (!is_in(link.mm, Config::get().coords.fixed)) coordobj.set_fix(link.mm, false);
+  }
+}
+
 coords::float_type energy::interfaces::qmmm::QMMM_A::o()
 {
-  throw std::runtime_error("QMMM-cannot optimize");
+  // restores the interface if an optimization step throws, otherwise e() and g() would stay
+  // in the MM environment mode with frozen QM charges and atoms would stay fixed
+  struct microiteration_guard
+  {
+    QMMM_A& qmmm;
+    explicit microiteration_guard(QMMM_A& q) : qmmm(q) { qmmm.optimizer = false; }
+    ~microiteration_guard()
+    {
+      qmmm.frozen_qm_charges.clear();
+      qmmm.coords->reset_fixation();
+      qmmm.optimizer = true;
+    }
+  };
+
+  // set optimizer to false in order to go into general o() function of coordinates object
+  microiteration_guard guard(*this);
+
+  if (Config::get().optimization.local.method != config::optimization_conf::lo_types::LBFGS)
+  {
+    std::cout << "WARNING! Microiterations only work with L-BFGS optimizer. Whole system is optimized instead.\n";
+    return coords->o();
+  }
+
+  std::size_t cycle{ 0 };                   // count optimization cycles
+  std::vector<std::size_t> mm_iterations;   // number of MM optimization steps for each cycle
+  std::vector<std::size_t> qm_iterations;   // number of QM/MM optimization steps for each cycle
+  std::vector<double> energies;             // energy after each cycle
+  double rms_grad{ 0.0 };                   // rms of gradients
+  double max_grad{ 0.0 };                   // maximum component of gradients
+  std::ofstream trace("trace_microiterations.arc");
+
+  // QM charges are taken from the last QM calculation (do one if there is none yet)
+  bool have_qm_charges{ false };
+  try { have_qm_charges = qmc.energyinterface()->charges().size() == qm_indices.size() + link_atoms.size(); }
+  catch (...) {}
+  if (!have_qm_charges) coords->g();
+
+  do {    // microiterations
+    cycle += 1;
+
+    // relax MM environment with frozen QM atoms and QM charges (no QM calculation)
+    frozen_qm_charges = qmc.energyinterface()->charges();
+    frozen_qm_charges.resize(qm_indices.size());   // remove link atoms
+    fix_qm_atoms(*coords);
+    coords->o();
+    coords->reset_fixation();
+    frozen_qm_charges.clear();
+    mm_iterations.emplace_back(coords->get_opt_steps());
+    if (file_exists("trace.arc")) std::rename("trace.arc", ("trace_mm_" + std::to_string(cycle) + ".arc").c_str());
+    if (Config::get().energy.qmmm.write_opt && Config::get().general.verbosity > 3) trace << coords::output::formats::tinker(*coords);
+
+    // optimize QM region (and M1 atoms) with QM/MM interface
+    fix_mm_atoms(*coords);
+    {
+      Config::local_scope qm_scope;   // limit number of QM steps within one cycle
+      if (Config::get().energy.qmmm.qm_steps > 0) Config::set().optimization.local.bfgs.maxstep = Config::get().energy.qmmm.qm_steps;
+      coords->o();
+    }
+    coords->reset_fixation();
+    qm_iterations.emplace_back(coords->get_opt_steps());
+    if (file_exists("trace.arc")) std::rename("trace.arc", ("trace_qm_" + std::to_string(cycle) + ".arc").c_str());
+    if (Config::get().energy.qmmm.write_opt) trace << coords::output::formats::tinker(*coords);
+
+    // determine if convergence is reached (gradients on all atoms)
+    energies.emplace_back(coords->g());
+    rms_grad = std::sqrt((1.0 / (3 * coords->size())) * scon::dot(coords->g_xyz(), coords->g_xyz()));
+    max_grad = max_3D(coords->g_xyz());
+    if (Config::get().general.verbosity > 2) {
+      std::cout << "RMS of gradients for cycle " << cycle << " is " << std::setprecision(3) << rms_grad <<
+        " and maximum component of gradients is " << max_grad << ".\n";
+    }
+  } while ((max_grad > Config::get().energy.qmmm.tolerance || rms_grad > (2.0 / 3.0) * Config::get().energy.qmmm.tolerance)
+    && cycle < Config::get().energy.qmmm.maxCycles &&
+    (mm_iterations.back() != 0 || qm_iterations.back() != 0));
+
+  // writing information into microiterations.csv
+  std::ofstream out("microiterations.csv");
+  out << "It.,MM,QM/MM,Energy\n";
+  for (auto i{ 0u }; i < energies.size(); ++i)
+  {
+    out << i + 1 << "," << mm_iterations[i] << "," << qm_iterations[i] << "," << energies[i] << "\n";
+  }
+  out << "TOTAL," << std::accumulate(mm_iterations.begin(), mm_iterations.end(), std::size_t{ 0u }) << ","
+    << std::accumulate(qm_iterations.begin(), qm_iterations.end(), std::size_t{ 0u }) << "," << energy << ",";
+
+  return energy;
 }
 
 std::vector<coords::float_type> energy::interfaces::qmmm::QMMM_A::charges() const
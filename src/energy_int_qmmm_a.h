@@ -26,6 +26,7 @@ Attention: Problems occur if charged atoms are in MM part near QM part! This sit
 #include "coords.h"
 #include "coords_io.h"
 #include <vector>
+#include <future>
 #include "coords_atoms.h"
 #include "energy_int_aco.h"
 #include "energy_int_mopac.h"
@@ -147,8 +148,8 @@ namespace energy
 
         /**uncontracted forcefield parameters*/
         static ::tinker::parameter::parameters tp;
-        /**contracted forcefield parameters*/
-        ::tinker::parameter::parameters cparams;
+        /**contracted forcefield parameters (shared by all clones)*/
+        std::shared_ptr< ::tinker::parameter::parameters const> cparams;
 
       public:
 
@@ -181,7 +182,8 @@ namespace energy
         coords::float_type g() override;
         /** Energy+Hessian function*/
         coords::float_type h() override;
-        /** Optimization in the interface or interfaced program (not existent for this interface)*/
+        /** Optimization with microiterations (if QMMMopt and QMMMoptAdditive are set, falls back to the normal optimization without L-BFGS):
+        MM environment is relaxed with frozen QM region and QM charges, then the QM region is optimized, until convergence*/
         coords::float_type o() override;
 
         /** Return charges (for QM und MM atoms) */
@@ -211,6 +213,13 @@ namespace energy
 
         /**function where QM/MM calculation is prepared*/
         void prepare_bonded_qmmm();
+        /**finds vdW parameters for all pairs of QM and MM atom types and all QM/MM pairs with excluded or scaled vdW interaction
+        (has to be called after prepare_bonded_qmmm())*/
+        void prepare_vdw_qmmm();
+        /**returns if vdW interaction between a QM and a MM atom is calculated (see calc_vdw()) using prepared exclusions
+        @param qm: position of QM atom in qm_indices
+        @param mm: index of MM atom*/
+        int vdw_modus(std::size_t const qm, std::size_t const mm) const;
         /**function to find bonds, angles and so on between QM and MM system*/
         void find_bonds_etc();
         /**function to find force field parameters for bonds, angles and so on between QM and MM system*/
@@ -226,9 +235,28 @@ namespace energy
         energy is only vdW interactions, gradients are coulomb and vdW
         @param if_gradient: true if gradients should be calculated, false if not*/
         void ww_calc(bool const if_gradient);
+        /**calculates bonded and vdW interactions between QM and MM part
+        (they don't depend on the QM calculation and can be done while it is running)
+        @param if_gradient: true if gradients should be calculated, false if not*/
+        void ww_calc_bonded_vdw(bool const if_gradient);
+        /**calculates coulomb interactions between QM and MM part (needs charges from QM calculation)
+        @param if_gradient: true if gradients should be calculated, false if not*/
+        void ww_calc_coulomb(bool const if_gradient);
+        /**calculates coulomb interactions between the MM charges and the frozen QM charges (electrostatic embedding, no QM calculation)
+        @param if_gradient: true if gradients should be calculated, false if not*/
+        void ww_calc_coulomb_frozen(bool const if_gradient);
         /**calculates energies and gradients
         @param if_gradient: true if gradients should be calculated, false if not*/
         coords::float_type qmmm_calc(bool const if_gradient);
+        /**calculates energy and gradients of the MM environment for microiterations:
+        MM system + vdW + bonded + coulomb with frozen QM charges (no QM calculation)
+        @param if_gradient: true if gradients should be calculated, false if not*/
+        coords::float_type mm_environment_calc(bool const if_gradient);
+
+        /**fixes QM atoms and MM atoms bound to them (for relaxation of the MM environment)*/
+        void fix_qm_atoms(coords::Coordinates& coordobj);
+        /**fixes all MM atoms except those bound to QM atoms (for optimization of the QM region)*/
+        void fix_mm_atoms(coords::Coordinates& coordobj);
         /**calculates bonded energy and gradients
         @param if_gradient: true if gradients should be calculated, false if not*/
         double calc_bonded(bool const if_gradient);
@@ -239,6 +267,8 @@ namespace energy
         std::vector<size_t> mm_indices;
         /**indizes of MM atoms that are taken into acoount for electrostatic interaction with QM region*/
         std::vector<int> charge_indices;
+        /**MM atoms that might give an external charge for the QM calculation (prepared once per topology)*/
+        ExternalCharges external_charge_set;
 
         /**vector of length total number of atoms
         only those elements are filled whose position corresponds to QM atoms
@@ -291,10 +321,33 @@ namespace energy
         /**gradients of bonded interactions energy between QM and MM atoms*/
         coords::Gradients_3D bonded_gradient;
 
+        /**combined vdW parameters of a QM and a MM atom type*/
+        struct vdw_pair
+        {
+          /**r_min or sigma*/
+          double R_0;
+          /**epsilon*/
+          double epsilon;
+        };
+        /**for every QM atom: index of its vdW type in the QM dimension of vdw_pairs*/
+        std::vector<std::size_t> vdw_types_qm;
+        /**for every MM atom: index of its vdW type in the MM dimension of vdw_pairs*/
+        std::vector<std::size_t> vdw_types_mm;
+        /**number of different vdW types of MM atoms*/
+        std::size_t number_of_vdw_types_mm{ 0u };
+        /**combined vdW parameters for every pair of QM and MM vdW types (index: QM type * number_of_vdw_types_mm + MM type)*/
+        std::vector<vdw_pair> vdw_pairs;
+        /**for every QM atom: MM atoms with excluded (0) or scaled (2) vdW interaction, see calc_vdw()*/
+        std::vector<std::vector<std::pair<std::size_t, int>>> vdw_exceptions;
+
         /**gradients on external charges due to QM atoms 
         (only used for electrostatic embedding)
         from this the variable coulomb_gradient will be filled*/
         coords::Gradients_3D g_coul_mm;
+
+        /**charges of the QM atoms (without link atoms) from the last QM calculation
+        only filled while the MM environment is relaxed in microiterations, then e() and g() call mm_environment_calc()*/
+        std::vector<coords::float_type> frozen_qm_charges;
       };
     }
   }
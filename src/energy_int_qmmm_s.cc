@@ -69,7 +69,7 @@ energy::interfaces::qmmm::QMMM_S::QMMM_S(coords::Coordinates* cp) :
 energy::interfaces::qmmm::QMMM_S::QMMM_S(QMMM_S const& rhs,
   coords::Coordinates* cobj) : interface_base(cobj),
   qm_indices(rhs.qm_indices),
-  new_indices_qm(rhs.new_indices_qm), link_atoms(rhs.link_atoms),
+  new_indices_qm(rhs.new_indices_qm), link_atoms(rhs.link_atoms), external_charge_sets(rhs.external_charge_sets),
   qmc_vec(rhs.qmc_vec), mmc_small_vec(rhs.mmc_small_vec), mmc_big(rhs.mmc_big), QMcenter_indices(rhs.QMcenter_indices),
   qm_energy(rhs.qm_energy), mm_energy_small(rhs.mm_energy_small), mm_energy_big(rhs.mm_energy_big), number_of_qm_systems(rhs.number_of_qm_systems)
 {
@@ -79,6 +79,7 @@ energy::interfaces::qmmm::QMMM_S::QMMM_S(QMMM_S const& rhs,
 energy::interfaces::qmmm::QMMM_S::QMMM_S(QMMM_S&& rhs, coords::Coordinates* cobj)
   : interface_base(cobj),
   qm_indices(std::move(rhs.qm_indices)), new_indices_qm(std::move(rhs.new_indices_qm)), link_atoms(std::move(rhs.link_atoms)),
+  external_charge_sets(std::move(rhs.external_charge_sets)),
   qmc_vec(std::move(rhs.qmc_vec)), mmc_small_vec(std::move(rhs.mmc_small_vec)), mmc_big(std::move(rhs.mmc_big)), QMcenter_indices(std::move(rhs.QMcenter_indices)),
   qm_energy(std::move(rhs.qm_energy)), mm_energy_small(std::move(rhs.mm_energy_small)), mm_energy_big(std::move(rhs.mm_energy_big)),
   number_of_qm_systems(std::move(rhs.number_of_qm_systems))
@@ -111,6 +112,7 @@ void energy::interfaces::qmmm::QMMM_S::swap(QMMM_S& rhs)
   qm_indices.swap(rhs.qm_indices);
   new_indices_qm.swap(rhs.new_indices_qm);
   link_atoms.swap(rhs.link_atoms);
+  external_charge_sets.swap(rhs.external_charge_sets);
   qmc_vec.swap(rhs.qmc_vec);
   mmc_small_vec.swap(rhs.mmc_small_vec);
   mmc_big.swap(rhs.mmc_big);
@@ -142,6 +144,17 @@ void energy::interfaces::qmmm::QMMM_S::initialization()
       throw std::runtime_error("wrong number of link atom types");
     }
   }
+
+  // find atoms that give external charges for every QM system
+  external_charge_sets.clear();
+  if (Config::get().energy.qmmm.zerocharge_bonds != 0)
+  {
+    auto all_indices = range(coords->size());
+    for (auto j{ 0u }; j < number_of_qm_systems; ++j)
+    {
+      external_charge_sets.emplace_back(qm_indices[j], all_indices, link_atoms[j], coords);
+    }
+  }
 }
 
 // update structure (account for topology or rep change)
@@ -198,20 +211,12 @@ void energy::interfaces::qmmm::QMMM_S::update_representation()
 
 }
 
-coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
+/**calculates energy and gradients of big MM system
+@param if_gradient: true if gradients should be calculated, false if not
+@param gradients: is filled with the gradients of the big MM system
+returns false if MM programme failed*/
+bool energy::interfaces::qmmm::QMMM_S::calc_mm_big(bool const if_gradient, coords::Gradients_3D& gradients)
 {
-  // ############ INITIALISATION AND UPDATE ##############################
-
-  update_representation(); // update positions of QM and MM subsystems to those of coordinates object 
-
-  mm_energy_big = 0.0;     // set energies to zero
-  mm_energy_small = 0.0;
-  qm_energy = 0.0;
-  coords::Gradients_3D new_grads;  // save gradients in case of gradient calculation
-  bool periodic = Config::get().periodics.periodic;
-
-  // ############### MM ENERGY AND GRADIENTS FOR WHOLE SYSTEM ######################
-
   try {
     if (!if_gradient)
     {
@@ -220,24 +225,67 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
     else   // gradient calculation
     {
       mm_energy_big = mmc_big.g();
-      new_grads = mmc_big.g_xyz();
+      gradients = mmc_big.g_xyz();
     }
-    if (mm_energy_big == 0) integrity = false;
     if (Config::get().general.verbosity > 4)
     {
       std::cout << "Energy of big MM system: \n";
       mmc_big.e_head_tostream_short(std::cout);
       mmc_big.e_tostream_short(std::cout);
     }
+    return mm_energy_big != 0;
   }
   catch (...)
   {
     std::cout << "MM programme (for big system) failed. Treating structure as broken.\n";
-    integrity = false;  // if MM programme fails: integrity is destroyed
+    return false;  // if MM programme fails: integrity is destroyed
   }
+}
+
+coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
+{
+  // ############ INITIALISATION AND UPDATE ##############################
 
-  // if program didn't calculate an energy: return zero-energy (otherwise CAST will break because it doesn't find charges)
-  if (integrity == false) return 0.0;
+  update_representation(); // update positions of QM and MM subsystems to those of coordinates object 
+
+  mm_energy_big = 0.0;     // set energies to zero
+  mm_energy_small = 0.0;
+  qm_energy = 0.0;
+  coords::Gradients_3D new_grads;  // save gradients in case of gradient calculation
+  coords::Gradients_3D big_grads;  // gradients of big MM system
+  if (if_gradient) new_grads.assign(coords->size(), coords::r3{});
+  bool periodic = Config::get().periodics.periodic;
+
+  // ############### MM ENERGY AND GRADIENTS FOR WHOLE SYSTEM ######################
+
+  bool const ee = Config::get().energy.qmmm.zerocharge_bonds != 0;   // electronic embedding?
+  bool const mm_forcefield = Config::get().energy.qmmm.mminterface == config::interface_types::T::OPLSAA
+    || Config::get().energy.qmmm.mminterface == config::interface_types::T::AMBER;
+  std::vector<double> mm_charges;
+
+  // the big MM system doesn't depend on the QM calculations so it can run while the QM programme is running if
+  // - its charges are known beforehand (forcefield, or no electronic embedding)
+  // - it doesn't share the working directory with the QM programme (forcefield, or every programme has its own scratch directory)
+  // - there are no periodic boundaries (they are switched off globally during the QM calculations)
+  bool const concurrent = Config::get().energy.qmmm.async && !periodic
+    && (mm_forcefield || (!ee && Config::get().energy.scratch.use));
+  std::future<bool> mm_big_job;
+  if (concurrent)
+  {
+    if (ee) mm_charges = mmc_big.energyinterface()->charges();   // read before the MM thread starts
+    // the big MM system gets no charges (passed explicitly so the MM thread doesn't depend on charges of other interfaces)
+    mmc_big.energyinterface()->set_external_charges(nullptr);
+    mm_big_job = run_in_background([this, if_gradient, &big_grads]() {
+      return calc_mm_big(if_gradient, big_grads);
+    });
+  }
+  else if (calc_mm_big(if_gradient, big_grads) == false)
+  {
+    // if program didn't calculate an energy: return zero-energy (otherwise CAST will break because it doesn't find charges)
+    integrity = false;
+    return 0.0;
+  }
+  else if (ee) mm_charges = mmc_big.energyinterface()->charges();
 
   for (auto j{ 0u }; j < number_of_qm_systems; ++j)
   {
@@ -246,6 +294,10 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
 
     double current_energy{ 0.0 };
 
+    // settings written for the QM calculation (MOPAC link atoms, periodics) stay private to this thread
+    // (the big MM system might be calculated at the same time and reads the configuration)
+    Config::local_scope qm_settings_scope;
+
     if (Config::get().energy.qmmm.qminterface == config::interface_types::T::MOPAC) {
       Config::set().energy.mopac.link_atoms = link_atoms[j].size();   // set number of link atoms for MOPAC
     }
@@ -253,17 +305,19 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
     // ############### CREATE MM CHARGES ######################
 
     std::vector<int> charge_indices;                  // indizes of all atoms that are in charge_vector
-    if (Config::get().energy.qmmm.zerocharge_bonds != 0)
+    if (ee)
     {
-      std::vector<double> charge_vector = mmc_big.energyinterface()->charges();
-      if (charge_vector.size() == 0) throw std::runtime_error("no charges found in MM interface");
-      auto all_indices = range(coords->size());
+      if (mm_charges.size() == 0) throw std::runtime_error("no charges found in MM interface");
 
       charge_indices.clear();
-      add_external_charges(qm_indices[j], charge_vector, all_indices, link_atoms[j], charge_indices, coords, QMcenter_indices[j]);
+      auto point_charges = std::make_shared<std::vector<PointCharge>>();
+      external_charge_sets[j].add(mm_charges, charge_indices, coords, QMcenter_indices[j], *point_charges);
+      set_external_charges(point_charges);                                // needed for gradients of external charges
+      qmc.energyinterface()->set_external_charges(point_charges);         // QM system and small MM system see them, big MM system doesn't
+      mmc_small.energyinterface()->set_external_charges(point_charges);
     }
 
-    Config::set().periodics.periodic = false;        // deactivate periodic boundaries
+    if (periodic) Config::set().periodics.periodic = false;   // deactivate periodic boundaries
 
     // ############### QM ENERGY AND GRADIENTS FOR QM SYSTEM ######################
     try {
@@ -326,10 +380,6 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
       }
     }
 
-    // ################ SAVE OUTPUT FOR BIG MM SYSTEM ########################################################
-
-    if (j == 0) save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_big.energyinterface()->id, "big");
-
     // ############### MM ENERGY AND GRADIENTS FOR SMALL MM SYSTEM ######################
 
     try {
@@ -439,13 +489,24 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::qmmm_calc(bool if_gradient)
     // ############### STUFF TO DO AT THE END OF CALCULATION ######################
 
     clear_external_charges();                                // clear vector -> no point charges in calculation of mmc_big
-    Config::set().periodics.periodic = periodic;             // set back periodics
+    if (periodic) Config::set().periodics.periodic = periodic;   // set back periodics
     if (file_exists("orca.gbw")) std::remove("orca.gbw");    // delete orca MOs for small system, otherwise orca will try to use them for big system and fail
 
-    save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_small.energyinterface()->id, std::to_string(j + 1));
-    save_outputfiles(Config::get().energy.qmmm.qminterface, qmc.energyinterface()->id, std::to_string(j + 1));
+    save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_small.energyinterface()->id, std::to_string(j + 1), mmc_small.energyinterface()->working_directory());
+    save_outputfiles(Config::get().energy.qmmm.qminterface, qmc.energyinterface()->id, std::to_string(j + 1), qmc.energyinterface()->working_directory());
   }  // end of the loop over all QM systems
 
+  if (concurrent && mm_big_job.get() == false)
+  {
+    integrity = false;
+    return 0.0;
+  }
+
+  // ################ SAVE OUTPUT FOR BIG MM SYSTEM ########################################################
+
+  save_outputfiles(Config::get().energy.qmmm.mminterface, mmc_big.energyinterface()->id, "big", mmc_big.energyinterface()->working_directory());
+  if (if_gradient) new_grads += big_grads;
+
   if (coords->check_bond_preservation() == false) integrity = false;
   else if (coords->check_for_crashes() == false) integrity = false;
 
@@ -555,7 +616,11 @@ coords::float_type energy::interfaces::qmmm::QMMM_S::o()
 
     // optimize QM atoms with QM/MM interface
     fix_mm_atoms(*coords);
-    coords->o();
+    {
+      Config::local_scope qm_scope;   // limit number of QM steps within one cycle
+      if (Config::get().energy.qmmm.qm_steps > 0) Config::set().optimization.local.bfgs.maxstep = Config::get().energy.qmmm.qm_steps;
+      coords->o();
+    }
     coords->reset_fixation();
     qm_iterations.emplace_back(coords->get_opt_steps());
     total_qm_iterations += coords->get_opt_steps();
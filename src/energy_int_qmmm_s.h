@@ -13,6 +13,7 @@ This is a subtractive QM/MM interface between the interfaces OPLSAA, AMBER, MOPA
 #include "coords.h"
 #include "coords_io.h"
 #include <vector>
+#include <future>
 #include "coords_atoms.h"
 #include "energy_int_aco.h"
 #include "energy_int_mopac.h"
@@ -95,6 +96,11 @@ namespace energy
         /**calculates energies and gradients
         @param if_gradient: true if gradients should be calculated, false if not*/
         coords::float_type qmmm_calc(bool if_gradient);
+        /**calculates energy and gradients of big MM system
+        @param if_gradient: true if gradients should be calculated, false if not
+        @param gradients: is filled with the gradients of the big MM system
+        returns false if MM programme failed*/
+        bool calc_mm_big(bool const if_gradient, coords::Gradients_3D& gradients);
 
         /**fix all QM atoms and M1 atoms
         @coordobj: coordinates object where atoms should be fixed*/
@@ -114,6 +120,8 @@ namespace energy
 
         /**vector with link atoms (one set of link atoms for every QM system)*/
         std::vector < std::vector<LinkAtom>> link_atoms;
+        /**atoms that might give an external charge (one set for every QM system, prepared once per topology)*/
+        std::vector<ExternalCharges> external_charge_sets;
 
         /**coordinates objects for QM parts*/
         std::vector < coords::Coordinates> qmc_vec;
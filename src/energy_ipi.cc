@@ -0,0 +1,249 @@
+#include "energy_ipi.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+// i-PI sockets are only implemented for POSIX systems
+energy::ipi_server::ipi_server(std::string const&, std::string const&)
+  : m_path(), m_listener(-1), m_client(-1)
+{
+  throw std::runtime_error("Socket communication with QM programs is not available on Windows.");
+}
+energy::ipi_server::~ipi_server() {}
+void energy::ipi_server::wait_for_client(double const) {}
+double energy::ipi_server::calculate(std::vector<double> const&, std::array<double, 9> const&, std::vector<double>&) { return 0.0; }
+void energy::ipi_server::send_header(std::string const&) {}
+std::string energy::ipi_server::receive_header() { return ""; }
+void energy::ipi_server::send_bytes(void const*, std::size_t const) {}
+void energy::ipi_server::receive_bytes(void*, std::size_t const) {}
+std::string energy::ipi_server::status() { return ""; }
+energy::ipi_client_process::ipi_client_process(std::string const&) : m_pid(-1)
+{
+  throw std::runtime_error("Socket communication with QM programs is not available on Windows.");
+}
+energy::ipi_client_process::~ipi_client_process() {}
+bool energy::ipi_client_process::running() { return false; }
+void energy::ipi_client_process::terminate(double const) {}
+bool energy::ipi_client_process::wait_for_exit(double const) { return true; }
+
+#else
+
+energy::ipi_server::ipi_server(std::string const& name, std::string const& prefix)
+  : m_path(prefix + name), m_listener(-1), m_client(-1)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  if (m_path.size() >= sizeof(address.sun_path))
+  {
+    throw std::runtime_error("Name of socket '" + m_path + "' is too long.");
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, m_path.c_str(), sizeof(address.sun_path) - 1);
+
+  m_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_listener < 0) throw std::runtime_error("Could not create socket '" + m_path + "'.");
+  ::unlink(m_path.c_str());   // remove leftovers of crashed runs
+  if (::bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_listener, 1) < 0)
+  {
+    ::close(m_listener);
+    m_listener = -1;
+    throw std::runtime_error("Could not listen on socket '" + m_path + "'.");
+  }
+}
+
+energy::ipi_server::~ipi_server()
+{
+  if (m_client >= 0)
+  {
+    try { send_header("EXIT"); }
+    catch (std::exception const&) {}   // client might be gone already
+    ::close(m_client);
+  }
+  if (m_listener >= 0)
+  {
+    ::close(m_listener);
+    ::unlink(m_path.c_str());
+  }
+}
+
+void energy::ipi_server::wait_for_client(double const timeout)
+{
+  if (m_client >= 0) return;
+  pollfd p;
+  p.fd = m_listener;
+  p.events = POLLIN;
+  p.revents = 0;
+  int const ready = ::poll(&p, 1, static_cast<int>(timeout * 1000.0));
+  if (ready <= 0)
+  {
+    throw std::runtime_error("No client connected to socket '" + m_path + "' within " + std::to_string(timeout) + " seconds.");
+  }
+  m_client = ::accept(m_listener, nullptr, nullptr);
+  if (m_client < 0) throw std::runtime_error("Accepting client on socket '" + m_path + "' failed.");
+}
+
+void energy::ipi_server::send_bytes(void const* data, std::size_t const n)
+{
+  auto const* bytes = static_cast<char const*>(data);
+  std::size_t sent = 0u;
+  while (sent < n)
+  {
+    auto const res = ::send(m_client, bytes + sent, n - sent, MSG_NOSIGNAL);
+    if (res <= 0) throw std::runtime_error("Connection to client on socket '" + m_path + "' lost.");
+    sent += static_cast<std::size_t>(res);
+  }
+}
+
+void energy::ipi_server::receive_bytes(void* data, std::size_t const n)
+{
+  auto* bytes = static_cast<char*>(data);
+  std::size_t received = 0u;
+  while (received < n)
+  {
+    auto const res = ::recv(m_client, bytes + received, n - received, 0);
+    if (res <= 0) throw std::runtime_error("Connection to client on socket '" + m_path + "' lost.");
+    received += static_cast<std::size_t>(res);
+  }
+}
+
+void energy::ipi_server::send_header(std::string const& message)
+{
+  std::string header(message);
+  header.resize(header_length, ' ');
+  send_bytes(header.data(), header_length);
+}
+
+std::string energy::ipi_server::receive_header()
+{
+  std::string header(header_length, ' ');
+  receive_bytes(&header[0], header_length);
+  header.erase(header.find_last_not_of(' ') + 1u);
+  return header;
+}
+
+std::string energy::ipi_server::status()
+{
+  send_header("STATUS");
+  return receive_header();
+}
+
+double energy::ipi_server::calculate(std::vector<double> const& positions, std::array<double, 9> const& cell, std::vector<double>& forces)
+{
+  if (m_client < 0) throw std::runtime_error("No client connected to socket '" + m_path + "'.");
+  std::int32_t const N = static_cast<std::int32_t>(positions.size() / 3u);
+
+  auto answer = status();
+  if (answer == "NEEDINIT")
+  {
+    std::int32_t const bead = 0, length = 1;
+    send_header("INIT");
+    send_bytes(&bead, sizeof(bead));
+    send_bytes(&length, sizeof(length));
+    send_bytes(" ", 1u);
+    answer = status();
+  }
+  if (answer != "READY") throw std::runtime_error("i-PI client is not ready, answer was '" + answer + "'.");
+
+  // cell vectors are sent one after another (i.e. transposed cell matrix of i-PI), the same holds for the inverse
+  std::array<double, 9> const& h = cell;
+  std::array<double, 9> h_inv;
+  double const det = h[0] * (h[4] * h[8] - h[5] * h[7]) - h[1] * (h[3] * h[8] - h[5] * h[6]) + h[2] * (h[3] * h[7] - h[4] * h[6]);
+  if (det == 0.0) throw std::runtime_error("Cell matrix for i-PI client is singular.");
+  h_inv = { (h[4] * h[8] - h[5] * h[7]) / det, (h[2] * h[7] - h[1] * h[8]) / det, (h[1] * h[5] - h[2] * h[4]) / det,
+            (h[5] * h[6] - h[3] * h[8]) / det, (h[0] * h[8] - h[2] * h[6]) / det, (h[2] * h[3] - h[0] * h[5]) / det,
+            (h[3] * h[7] - h[4] * h[6]) / det, (h[1] * h[6] - h[0] * h[7]) / det, (h[0] * h[4] - h[1] * h[3]) / det };
+
+  send_header("POSDATA");
+  send_bytes(h.data(), sizeof(double) * 9u);
+  send_bytes(h_inv.data(), sizeof(double) * 9u);
+  send_bytes(&N, sizeof(N));
+  send_bytes(positions.data(), sizeof(double) * positions.size());
+
+  answer = status();
+  if (answer != "HAVEDATA") throw std::runtime_error("i-PI client did not calculate, answer was '" + answer + "'.");
+
+  send_header("GETFORCE");
+  answer = receive_header();
+  if (answer != "FORCEREADY") throw std::runtime_error("i-PI client did not send forces, answer was '" + answer + "'.");
+
+  double energy(0.0);
+  std::int32_t n_received(0);
+  receive_bytes(&energy, sizeof(energy));
+  receive_bytes(&n_received, sizeof(n_received));
+  if (n_received != N) throw std::runtime_error("i-PI client sent forces for wrong number of atoms.");
+  forces.resize(positions.size());
+  receive_bytes(forces.data(), sizeof(double) * forces.size());
+  std::array<double, 9> virial;
+  receive_bytes(virial.data(), sizeof(double) * 9u);
+  std::int32_t extra_length(0);
+  receive_bytes(&extra_length, sizeof(extra_length));
+  if (extra_length > 0)
+  {
+    std::string extra(static_cast<std::size_t>(extra_length), ' ');
+    receive_bytes(&extra[0], extra.size());
+  }
+  return energy;
+}
+
+energy::ipi_client_process::ipi_client_process(std::string const& command_line) : m_pid(-1)
+{
+  m_pid = ::fork();
+  if (m_pid < 0) throw std::runtime_error("Could not start '" + command_line + "'.");
+  if (m_pid == 0)
+  {
+    // child: own process group, so that the shell and the program started by it can be terminated together
+    ::setpgid(0, 0);
+    ::execl("/bin/sh", "sh", "-c", command_line.c_str(), static_cast<char*>(nullptr));
+    ::_exit(127);
+  }
+  ::setpgid(m_pid, m_pid);   // also in parent, otherwise there is a race with terminate()
+}
+
+energy::ipi_client_process::~ipi_client_process()
+{
+  terminate();
+}
+
+bool energy::ipi_client_process::running()
+{
+  if (m_pid <= 0) return false;
+  if (::waitpid(m_pid, nullptr, WNOHANG) == 0) return true;
+  m_pid = -1;   // exited and reaped (or not our child anymore)
+  return false;
+}
+
+bool energy::ipi_client_process::wait_for_exit(double const timeout)
+{
+  auto const end = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+  while (running())
+  {
+    if (std::chrono::steady_clock::now() >= end) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+void energy::ipi_client_process::terminate(double const grace)
+{
+  if (wait_for_exit(grace)) return;
+  ::kill(-m_pid, SIGTERM);
+  if (wait_for_exit(2.0)) return;
+  ::kill(-m_pid, SIGKILL);
+  ::waitpid(m_pid, nullptr, 0);
+  m_pid = -1;
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+CAST 3
+energy_ipi.h
+Purpose: server side of the i-PI socket protocol
+
+Programs that support the i-PI driver mode (e.g. DFTB+ with "Driver = Socket")
+connect to this server once and then stay alive between calculations.
+For every calculation positions are sent and energy and forces are received,
+so the costs for program start, setup and initial guess are only paid once.
+
+All quantities are in atomic units (positions in bohr, energy in hartree, forces in hartree/bohr)
+as required by the protocol.
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace energy
+{
+  /**server that sends positions to one i-PI client and receives energies and forces*/
+  class ipi_server
+  {
+  public:
+
+    /**length of a message header in the i-PI protocol*/
+    static std::size_t constexpr header_length{ 12u };
+
+    /**creates a UNIX socket at prefix + name and starts listening
+    @param name: name of the socket (has to be the same for the client)
+    @param prefix: directory prefix of the socket file (default of i-PI and DFTB+)*/
+    explicit ipi_server(std::string const& name, std::string const& prefix = "/tmp/ipi_");
+    /**sends EXIT to the client, closes the connection and removes the socket file*/
+    ~ipi_server();
+
+    ipi_server(ipi_server const&) = delete;
+    ipi_server& operator= (ipi_server const&) = delete;
+
+    /**waits until a client connects
+    @param timeout: maximum waiting time in seconds (throws if no client connects)*/
+    void wait_for_client(double const timeout);
+    /**is a client connected?*/
+    bool connected() const { return m_client >= 0; }
+    /**path of the socket file*/
+    std::string const& socket_path() const { return m_path; }
+
+    /**sends positions to the client and receives energy and forces
+    @param positions: x, y and z of every atom (in bohr)
+    @param cell: cell vectors as rows of a 3x3 matrix (in bohr)
+    @param forces: is filled with the forces on every atom (in hartree/bohr)
+    @return energy (in hartree)*/
+    double calculate(std::vector<double> const& positions, std::array<double, 9> const& cell, std::vector<double>& forces);
+
+  private:
+
+    /**sends a message header (padded with spaces)*/
+    void send_header(std::string const& message);
+    /**receives a message header (trailing spaces removed)*/
+    std::string receive_header();
+    /**sends exactly n bytes*/
+    void send_bytes(void const* data, std::size_t const n);
+    /**receives exactly n bytes*/
+    void receive_bytes(void* data, std::size_t const n);
+    /**asks for the status of the client*/
+    std::string status();
+
+    std::string m_path;
+    int m_listener;
+    int m_client;
+  };
+
+  /**program in i-PI driver mode that runs in the background as long as the session
+  (terminated and waited for on destruction, so no orphaned processes stay alive after timeouts or errors)*/
+  class ipi_client_process
+  {
+  public:
+
+    /**starts the command line with /bin/sh in the background (in its own process group)
+    @param command_line: shell command that starts the client*/
+    explicit ipi_client_process(std::string const& command_line);
+    /**calls terminate()*/
+    ~ipi_client_process();
+
+    ipi_client_process(ipi_client_process const&) = delete;
+    ipi_client_process& operator= (ipi_client_process const&) = delete;
+
+    /**is the process still running?*/
+    bool running();
+    /**gives the process some time to exit by itself (e.g. after EXIT was sent),
+    then sends SIGTERM and finally SIGKILL to its process group and waits for it
+    @param grace: seconds the process gets to exit by itself*/
+    void terminate(double const grace = 1.0);
+    /**process id (-1 if the process is not running anymore)*/
+    int pid() const { return m_pid; }
+
+  private:
+
+    /**waits up to the given time for the process to exit, returns true if it did*/
+    bool wait_for_exit(double const timeout);
+
+    int m_pid;
+  };
+}
@@ -0,0 +1,110 @@
+#include "energy_scratch.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "configuration.h"
+
+#if(defined(_MSC_VER) || (defined(__GNUC__) && (7 <= __GNUC_MAJOR__)))
+#include<filesystem>
+namespace fs = std::filesystem;
+#else
+#include<experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+energy::scratch_directory::scratch_directory(std::string const& prefix)
+  : m_prefix(prefix), m_directory(), m_failed(false)
+{
+  create();
+}
+
+energy::scratch_directory::scratch_directory(scratch_directory const& rhs)
+  : m_prefix(rhs.m_prefix), m_directory(), m_failed(false)
+{
+  create();
+}
+
+energy::scratch_directory& energy::scratch_directory::operator= (scratch_directory const& rhs)
+{
+  // keep own directory, only take over the name for new directories
+  m_prefix = rhs.m_prefix;
+  return *this;
+}
+
+energy::scratch_directory::~scratch_directory()
+{
+  cleanup();
+}
+
+void energy::scratch_directory::swap(scratch_directory& rhs)
+{
+  std::swap(m_prefix, rhs.m_prefix);
+  std::swap(m_directory, rhs.m_directory);
+  std::swap(m_failed, rhs.m_failed);
+}
+
+std::string energy::scratch_directory::path(std::string const& filename) const
+{
+  if (!active()) return filename;
+  return (fs::path(m_directory) / filename).string();
+}
+
+std::string energy::scratch_directory::resolve(std::string const& outside_path) const
+{
+  if (!active() || outside_path.empty() || fs::path(outside_path).is_absolute()) return outside_path;
+  return fs::absolute(outside_path).string();
+}
+
+std::string energy::scratch_directory::command(std::string const& command) const
+{
+  if (!active()) return command;
+  return "cd \"" + m_directory + "\" && " + command;
+}
+
+void energy::scratch_directory::create()
+{
+  auto const& conf = Config::get().energy.scratch;
+  if (!conf.use) return;
+
+  // counter makes names unique inside this process, random number between different processes
+  static std::atomic<std::size_t> counter{ 0u };
+  std::mt19937_64 engine(static_cast<std::mt19937_64::result_type>(
+    std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+  fs::path const base = conf.base.empty() ? fs::current_path() : fs::absolute(conf.base);
+  fs::create_directories(base);
+  for (std::size_t attempt = 0u; attempt < 100u; ++attempt)
+  {
+    std::stringstream name;
+    name << m_prefix << "_scratch_" << counter++ << "_" << (engine() % 1000000u);
+    fs::path const candidate = base / name.str();
+    if (fs::create_directory(candidate))
+    {
+      m_directory = candidate.string();
+      return;
+    }
+  }
+  throw std::runtime_error("Could not create a scratch directory in " + base.string() + ".");
+}
+
+void energy::scratch_directory::cleanup()
+{
+  if (!active()) return;
+  using cleanup_types = config::energy::scratch_conf::cleanup_types;
+  auto const policy = Config::get().energy.scratch.cleanup;
+  if (policy == cleanup_types::NEVER || (policy == cleanup_types::KEEP_FAILED && m_failed))
+  {
+    if (m_failed && Config::get().general.verbosity > 1U)
+    {
+      std::cout << "Keeping scratch directory " << m_directory << " of failed job.\n";
+    }
+    return;
+  }
+  std::error_code ec;   // never throw from a destructor
+  fs::remove_all(m_directory, ec);
+  m_directory.clear();
+}
@@ -0,0 +1,73 @@
+/**
+CAST 3
+energy_scratch.h
+Purpose: isolated working directories for interfaces that call external programs
+
+Every interface instance (and every clone of it) gets its own directory so that
+several evaluations can run at the same time in one process.
+If QMSCRATCHuse is switched off all filenames stay relative to the working directory (old behaviour).
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <string>
+
+namespace energy
+{
+  /**scratch directory of one interface instance*/
+  class scratch_directory
+  {
+  public:
+
+    /**creates a new unique directory if scratch directories are switched on
+    @param prefix: start of the directory name (e.g. name of the interface)*/
+    explicit scratch_directory(std::string const& prefix);
+    /**copying creates a new directory (with the same prefix) instead of sharing the old one*/
+    scratch_directory(scratch_directory const& rhs);
+    scratch_directory& operator= (scratch_directory const& rhs);
+    /**removes the directory according to QMSCRATCHcleanup*/
+    ~scratch_directory();
+
+    /**returns the path of a file inside the scratch directory (or the filename itself if switched off)
+    @param filename: name of the file*/
+    std::string path(std::string const& filename) const;
+    /**returns a path to a file outside of the scratch directory that is also valid inside it
+    (relative paths are made absolute if scratch directories are used)
+    @param outside_path: path relative to the working directory or absolute path*/
+    std::string resolve(std::string const& outside_path) const;
+    /**returns a shell command that runs the given command inside the scratch directory
+    @param command: command line of the external program*/
+    std::string command(std::string const& command) const;
+    /**directory (empty if switched off)*/
+    std::string const& directory() const { return m_directory; }
+    /**are files written into a separate directory?*/
+    bool active() const { return !m_directory.empty(); }
+
+    /**mark the current job as failed (directory is kept if QMSCRATCHcleanup is keep_failed)*/
+    void mark_failed() { m_failed = true; }
+    /**mark the current job as successful again*/
+    void mark_success() { m_failed = false; }
+    /**has the last job failed?*/
+    bool failed() const { return m_failed; }
+
+    void swap(scratch_directory& rhs);
+
+  private:
+
+    /**create new unique directory*/
+    void create();
+    /**delete directory according to cleanup policy*/
+    void cleanup();
+
+    std::string m_prefix;
+    std::string m_directory;
+    bool m_failed;
+  };
+
+  inline void swap(scratch_directory& a, scratch_directory& b)
+  {
+    a.swap(b);
+  }
+}
@@ -0,0 +1,148 @@
+#include "ff_preconditioner.h"
+
+#include <cmath>
+#include <map>
+#include <string>
+#include "InternalCoordinates/InternalCoordinates.h"
+
+namespace
+{
+  /**minimal atom for the constructors of the internal coordinates*/
+  struct indexed_atom
+  {
+    std::size_t atom_serial;
+    std::string element;
+    explicit indexed_atom(std::size_t const index) : atom_serial(index + 1u), element() {}
+  };
+
+  /**derivatives of the internal coordinate of a term with respect to the cartesians of its atoms*/
+  std::vector<coords::r3> term_derivatives(energy::model_hessian_term const& term, coords::Representation_3D const& xyz)
+  {
+    auto const& a = term.atoms;
+    switch (term.type)
+    {
+    case energy::model_hessian_term::kind::BOND:
+    {
+      auto const d = InternalCoordinates::BondDistance(indexed_atom(a[0]), indexed_atom(a[1])).der(xyz);
+      return { d.first, d.second };
+    }
+    case energy::model_hessian_term::kind::ANGLE:
+    {
+      auto const d = InternalCoordinates::BondAngle(indexed_atom(a[0]), indexed_atom(a[1]), indexed_atom(a[2])).der(xyz);
+      return { std::get<0>(d), std::get<1>(d), std::get<2>(d) };
+    }
+    default:
+    {
+      auto const d = InternalCoordinates::DihedralAngle(indexed_atom(a[0]), indexed_atom(a[1]),
+        indexed_atom(a[2]), indexed_atom(a[3])).der(xyz);
+      return { std::get<0>(d), std::get<1>(d), std::get<2>(d), std::get<3>(d) };
+    }
+    }
+  }
+
+  coords::float_type dot(std::vector<coords::float_type> const& a, std::vector<coords::float_type> const& b)
+  {
+    coords::float_type result(0.0);
+    for (std::size_t i = 0u; i < a.size(); ++i) result += a[i] * b[i];
+    return result;
+  }
+}
+
+optimization::local::ff_preconditioner::ff_preconditioner(coords::Representation_3D const& xyz,
+  std::vector<energy::model_hessian_term> const& terms, coords::float_type const shift, std::vector<bool> const& fixed)
+  : m_rows(xyz.size()), m_inverse_diagonal(3u * xyz.size())
+{
+  auto const is_fixed = [&fixed](std::size_t const i) { return i < fixed.size() && fixed[i]; };
+  std::vector<std::map<std::size_t, block>> blocks(xyz.size());
+  for (std::size_t i = 0u; i < xyz.size(); ++i)
+  {
+    // shift for free atoms, identity for fixed atoms
+    auto& diagonal = blocks[i][i];
+    diagonal.fill(0.0);
+    diagonal[0] = diagonal[4] = diagonal[8] = is_fixed(i) ? 1.0 : shift;
+  }
+
+  // k * b * b^T for every term, couplings to fixed atoms are left out
+  for (auto const& term : terms)
+  {
+    std::vector<std::array<coords::float_type, 3u>> b;
+    for (auto const& d : term_derivatives(term, xyz)) b.push_back({ d.x(), d.y(), d.z() });
+    for (std::size_t m = 0u; m < term.atoms.size(); ++m)
+    {
+      if (is_fixed(term.atoms[m])) continue;
+      for (std::size_t n = 0u; n < term.atoms.size(); ++n)
+      {
+        if (is_fixed(term.atoms[n])) continue;
+        auto it = blocks[term.atoms[m]].find(term.atoms[n]);
+        if (it == blocks[term.atoms[m]].end())
+        {
+          it = blocks[term.atoms[m]].emplace(term.atoms[n], block()).first;
+          it->second.fill(0.0);
+        }
+        for (std::size_t k = 0u; k < 3u; ++k)
+        {
+          for (std::size_t l = 0u; l < 3u; ++l)
+          {
+            it->second[3u * k + l] += term.force * b[m][k] * b[n][l];
+          }
+        }
+      }
+    }
+  }
+
+  for (std::size_t i = 0u; i < xyz.size(); ++i)
+  {
+    m_rows[i].assign(blocks[i].begin(), blocks[i].end());
+    auto const& diagonal = blocks[i][i];
+    for (std::size_t k = 0u; k < 3u; ++k)
+    {
+      m_inverse_diagonal[3u * i + k] = 1.0 / diagonal[4u * k];
+    }
+  }
+}
+
+std::vector<coords::float_type> optimization::local::ff_preconditioner::times(std::vector<coords::float_type> const& v) const
+{
+  std::vector<coords::float_type> result(v.size(), 0.0);
+  for (std::size_t i = 0u; i < m_rows.size(); ++i)
+  {
+    for (auto const& column : m_rows[i])
+    {
+      auto const j = column.first;
+      auto const& p = column.second;
+      for (std::size_t k = 0u; k < 3u; ++k)
+      {
+        result[3u * i + k] += p[3u * k] * v[3u * j] + p[3u * k + 1u] * v[3u * j + 1u] + p[3u * k + 2u] * v[3u * j + 2u];
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<coords::float_type> optimization::local::ff_preconditioner::solve(std::vector<coords::float_type> const& r) const
+{
+  auto const N = r.size();
+  std::vector<coords::float_type> z(N, 0.0), residual(r), h(N), p(N);
+  for (std::size_t i = 0u; i < N; ++i) h[i] = m_inverse_diagonal[i] * residual[i];
+  p = h;
+  auto rh = dot(residual, h);
+  auto const threshold = 1.e-10 * dot(r, r);
+  for (std::size_t iteration = 0u; iteration < N && dot(residual, residual) > threshold; ++iteration)
+  {
+    auto const Pp = times(p);
+    auto const pPp = dot(p, Pp);
+    if (pPp <= 0.0) break;
+    auto const alpha = rh / pPp;
+    for (std::size_t i = 0u; i < N; ++i)
+    {
+      z[i] += alpha * p[i];
+      residual[i] -= alpha * Pp[i];
+      h[i] = m_inverse_diagonal[i] * residual[i];
+    }
+    auto const rh_new = dot(residual, h);
+    auto const beta = rh_new / rh;
+    rh = rh_new;
+    for (std::size_t i = 0u; i < N; ++i) p[i] = h[i] + beta * p[i];
+  }
+  return z;
+}
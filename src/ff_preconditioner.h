@@ -0,0 +1,79 @@
+/**
+CAST 3
+ff_preconditioner.h
+Purpose: sparse preconditioner for cartesian optimizations built from the model Hessian of a force field
+
+P = sum_t k_t * b_t * b_t^T + shift * I
+where b_t are the Wilson B-vectors of the bond, angle and dihedral terms of a cheap interface
+and k_t their curvatures. The shift makes P positive definite (translations, rotations and
+atoms without bonded terms). Preconditioned steps P^-1 * g are calculated by conjugate gradients,
+so only the non-zero 3x3 blocks of P are stored.
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "energy.h"
+
+namespace optimization
+{
+  namespace local
+  {
+    class ff_preconditioner
+    {
+    public:
+
+      /**builds P for the given structure
+      @param xyz: cartesian coordinates
+      @param terms: bonded terms of the model Hessian
+      @param shift: value added to the diagonal (in kcal/mol/A^2)
+      @param fixed: fixed atoms (no coupling, P^-1 * g is zero for them), may be empty*/
+      ff_preconditioner(coords::Representation_3D const& xyz, std::vector<energy::model_hessian_term> const& terms,
+        coords::float_type const shift, std::vector<bool> const& fixed = {});
+
+      /**number of atoms*/
+      std::size_t size() const { return m_rows.size(); }
+
+      /**P * v (3 entries per atom)*/
+      std::vector<coords::float_type> times(std::vector<coords::float_type> const& v) const;
+      /**solves P * z = r by conjugate gradients with Jacobi preconditioning (3 entries per atom)*/
+      std::vector<coords::float_type> solve(std::vector<coords::float_type> const& r) const;
+
+      /**replaces d by P^-1 * d, works for all containers of cartesian points (e.g. gradients of L-BFGS)*/
+      template<class ContainerT>
+      void operator() (ContainerT& d) const
+      {
+        std::vector<coords::float_type> r(3u * d.size());
+        for (std::size_t i = 0u; i < d.size(); ++i)
+        {
+          r[3u * i] = d[i].x();
+          r[3u * i + 1u] = d[i].y();
+          r[3u * i + 2u] = d[i].z();
+        }
+        auto const z = solve(r);
+        for (std::size_t i = 0u; i < d.size(); ++i)
+        {
+          using value_type = typename std::decay<decltype(d[i].x())>::type;
+          d[i] = typename ContainerT::value_type(static_cast<value_type>(z[3u * i]),
+            static_cast<value_type>(z[3u * i + 1u]), static_cast<value_type>(z[3u * i + 2u]));
+        }
+      }
+
+    private:
+
+      /**3x3 block of P (row-major)*/
+      using block = std::array<coords::float_type, 9u>;
+
+      /**non-zero blocks of every block row, as (column atom, block)*/
+      std::vector<std::vector<std::pair<std::size_t, block>>> m_rows;
+      /**inverse diagonal of P (for Jacobi preconditioning of the CG iterations)*/
+      std::vector<coords::float_type> m_inverse_diagonal;
+    };
+  }
+}
@@ -0,0 +1,198 @@
+#ifndef fire_header
+
+#define fire_header
+
+/*
+
+ * FIRE - Fast Inertial Relaxation Engine
+ *
+ * E. Bitzek, P. Koskinen, F. Gaehler, M. Moseler, P. Gumbsch,
+ * Phys. Rev. Lett. 97, 170201 (2006)
+ *
+ * Damped molecular dynamics with unit masses where the velocities are turned
+ * towards the forces while the power F*v is positive and set to zero as soon as it
+ * becomes negative. Needs exactly one gradient per step and no history.
+
+*/
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include "ls.h"
+#include "helperfunctions.h"
+
+
+namespace optimization
+{
+  namespace local
+  {
+
+    template<class CallbackT>
+    class fire
+    {
+
+    public:
+
+      using callback_type = CallbackT;
+      using rep_type = function_trait_detail::decayed_argument_type<callback_type, 0U>;
+      using grad_type = function_trait_detail::decayed_argument_type<callback_type, 1U>;
+      using float_type = typename std::decay<function_trait_detail::return_type<callback_type>>::type;
+      using point_type = Point < rep_type, grad_type, float_type >;
+
+      callback_type callback;
+
+      struct configuration
+      {
+        // initial time step
+        float_type dt_start;
+        // maximum time step
+        float_type dt_max;
+        // maximum displacement of one atom within one step
+        float_type max_move;
+        // number of steps with positive power before the time step is increased
+        std::size_t n_min;
+        // factors for increasing and decreasing the time step
+        float_type f_inc, f_dec;
+        // mixing of velocities and forces
+        float_type alpha_start, f_alpha;
+        // maximum number of iterations
+        std::size_t max_iterations;
+        // Convergence epsilon
+        float_type epsilon;
+        // continue if the callback reports a broken structure
+        bool ignore_callback_stop;
+        configuration() :
+          dt_start(F(0.05)), dt_max(F(0.5)), max_move(F(0.2)), n_min(5u),
+          f_inc(F(1.1)), f_dec(F(0.5)), alpha_start(F(0.1)), f_alpha(F(0.99)),
+          max_iterations(500u), epsilon(F(1.e-4)), ignore_callback_stop(false)
+        { }
+      } config;
+
+    private:
+
+      using F = float_type;
+
+      point_type xg;
+      grad_type v;
+      std::size_t iteration;
+      status rstate;
+
+      static F length(typename rep_type::value_type const& a)
+      {
+        return static_cast<F>(std::sqrt(dot(a, a)));
+      }
+
+      bool convergence() const
+      {
+        if (Config::get().optimization.local.bfgs.use_different_convergence_criterion == false) {
+          return (std::sqrt(dot(xg.g, xg.g)) / std::max(F(std::sqrt(dot(xg.x, xg.x))), F(1)))
+            < config.epsilon;
+        }
+        else   // convergence evaluated analogously to QM/MM optimization with microiterations
+        {
+          auto rms_grad = std::sqrt((1.0 / (3 * xg.g.size())) * scon::dot(xg.g, xg.g));
+          auto max_grad = max_3D(xg.g);
+          return max_grad < Config::get().optimization.local.bfgs.grad &&
+            rms_grad < (2.0 / 3.0) * Config::get().optimization.local.bfgs.grad;
+        }
+      }
+
+      status optimize()
+      {
+        using std::sqrt;
+        std::size_t const N = xg.x.size();
+        v.assign(N, typename grad_type::value_type());
+        F dt(config.dt_start), alpha(config.alpha_start);
+        std::size_t n_positive(0u);
+        bool go_on(true);
+        for (std::size_t i(1U); i <= config.max_iterations; ++i)
+        {
+          if (convergence()) return status::SUCCESS;
+
+          // power P = F * v with forces F = -g
+          // (not checked in the first step where v is still the zero start vector)
+          if (i > 1U)
+          {
+            F const power = -static_cast<F>(dot(xg.g, v));
+            if (power > F(0))
+            {
+              F const vnorm = static_cast<F>(sqrt(dot(v, v))),
+                fnorm = static_cast<F>(sqrt(dot(xg.g, xg.g)));
+              F const mix = fnorm > F(0) ? alpha * vnorm / fnorm : F(0);
+              for (std::size_t j(0U); j < N; ++j)
+              {
+                v[j] = v[j] * (F(1) - alpha) - xg.g[j] * mix;
+              }
+              if (++n_positive > config.n_min)
+              {
+                dt = std::min(dt * config.f_inc, config.dt_max);
+                alpha *= config.f_alpha;
+              }
+            }
+            else
+            {
+              v.assign(N, typename grad_type::value_type());
+              dt *= config.f_dec;
+              alpha = config.alpha_start;
+              n_positive = 0u;
+            }
+          }
+
+          // semi-implicit euler step, no atom moves further than max_move
+          F max_displacement(0);
+          for (std::size_t j(0U); j < N; ++j)
+          {
+            v[j] = v[j] - xg.g[j] * dt;
+            max_displacement = std::max(max_displacement, length(v[j]) * dt);
+          }
+          F const scale = max_displacement > config.max_move ? config.max_move / max_displacement : F(1);
+          for (std::size_t j(0U); j < N; ++j)
+          {
+            xg.x[j] += v[j] * (dt * scale);
+          }
+
+          xg.f = callback(xg.x, xg.g, i, go_on);
+          ++iteration;
+          if (!go_on && !config.ignore_callback_stop) return status::ERR_CALLBACK_STOP;
+        }
+        return convergence() ? status::SUCCESS : status::ERR_MAX_ITERATIONS;
+      }
+
+    public:
+
+      fire(callback_type callback_object)
+        : callback(std::move(callback_object)), config(),
+        xg(), v(), iteration(), rstate(status::UNDEFINED)
+      { }
+
+      point_type const& p() const { return xg; }
+      point_type& p() { return xg; }
+
+      status state() const { return rstate; }
+      std::size_t iter() const { return iteration; }
+
+      void operator() (point_type const& p)
+      {
+        bool go_on(true);
+        xg = p;
+        iteration = 0u;
+        xg.f = callback(xg.x, xg.g, iteration, go_on);
+        rstate = (!go_on && !config.ignore_callback_stop) ? status::ERR_CALLBACK_STOP : optimize();
+      }
+
+    };
+
+    template<class CallbackT>
+    inline fire<typename std::remove_reference<CallbackT>::type>
+      make_fire(CallbackT&& callback)
+    {
+      return fire<typename std::remove_reference<CallbackT>::type>
+        (std::forward<CallbackT>(callback));
+    }
+
+  }
+
+}
+
+#endif
@@ -36,6 +36,7 @@
 
 */
 
+#include <functional>
 #include <utility>
 #include <vector>
 #include <cmath>
@@ -100,10 +101,13 @@ namespace optimization
         float_type delta;
         // Convergence epsilon
         float_type epsilon;
+        // Replaces a gradient-like vector by H0 * vector (initial inverse Hessian),
+        // if empty H0 is a scalar obtained from the latest correction
+        std::function<void(grad_type&)> preconditioner;
         // Constructor with initializer list for default values
         configuration() :
           m(6u), k(), max_iterations(500u),
-          delta(), epsilon(F(1.e-4))
+          delta(), epsilon(F(1.e-4)), preconditioner()
         { }
       } config;
 
@@ -170,7 +174,9 @@ namespace optimization
           return rstate = status::SUCCESS;
         }
         last_hess = 0U;
-        step = float_type(1) / sqrt(dot(d, d));  // d = forces 
+        // d = forces, preconditioned forces are already a step (that is limited to unit length)
+        step = config.preconditioner ? std::min(F(1), F(1) / F(sqrt(dot(d, d))))
+          : float_type(1) / sqrt(dot(d, d));
         log(xg.p);
         for (std::size_t i(1U); i <= config.max_iterations; ++i)
         {
@@ -241,7 +247,8 @@ namespace optimization
           correctH[j].alpha = dot(correctH[j].d.x, d) / correctH[j].dXdG;
           d += correctH[j].d.g * (-correctH[j].alpha);
         }
-        d *= dXdG / dGdG;
+        if (config.preconditioner) config.preconditioner(d);
+        else d *= dXdG / dGdG;
         for (std::size_t i(0U); i < M; ++i)
         {
           float_type const beta(correctH[j].alpha
@@ -276,6 +283,7 @@ namespace optimization
         iteration = 0u;
         xg.update(ls.callback, iteration, go_on);
         d = -xg.p.g;
+        if (config.preconditioner) config.preconditioner(d);
       }
 
       point_type const& p() const { return xg.p; }
@@ -63,6 +63,8 @@
 #include "optimization.h"
 #include "find_as.h"
 #include "pmf_ic_prep.h"
+#include "profiling.h"
+#include "energy_cache.h"
 
 //////////////////////////
 //                      //
@@ -233,7 +235,8 @@ int main(int argc, char** argv)
     //                      //
     //////////////////////////
 
-    if (coords.preoptimize())
+    // a preconditioned local optimization replaces the preoptimization, every other task still needs it
+    if (coords.preoptimize() && !(Config::get().general.task == config::tasks::LOCOPT && coords.ff_preconditioned()))
     {
       if (Config::get().general.verbosity > 1U)
       {
@@ -496,9 +499,11 @@ int main(int argc, char** argv)
         //std::cout << "PostSet.\n";
         gstream << coords;
       }
-      if (coords.check_for_crashes() == false)
+      auto const crashes = coords.find_crashes();
+      if (!crashes.empty())
       {
         std::cout << "WARNING! Atoms are crashed. You probably don't want to use the output structure!\n";
+        for (auto const& c : crashes) std::cout << "Atoms " << c.second + 1 << " and " << c.first + 1 << " are crashed.\n";
       }
       break;
     }
@@ -1228,6 +1233,24 @@ int main(int argc, char** argv)
     Py_Finalize(); //  close python
 #endif 
 
+    // hits and misses of the energy cache
+    if (energy::evaluation_cache::active() && Config::get().general.verbosity > 1U)
+    {
+      energy::evaluation_cache::get().print_statistics(std::cout);
+    }
+
+    // write timings and counters of the profiler
+    if (profiling::profiler::active())
+    {
+      if (Config::get().general.verbosity > 1U)
+      {
+        std::cout << "-------------------------------------------------\n";
+        std::cout << "Profile:\n";
+        profiling::profiler::get().print_report(std::cout);
+      }
+      profiling::profiler::get().write_summary();
+    }
+
     // stop and print task and execution time
     std::cout << '\n' << "Task " << config::task_strings[Config::get().general.task];
     std::cout << " took " << task_timer << " to complete.\n";
@@ -263,18 +263,26 @@ void md::simulation::init(void)
 // can also be performed at the end of every MD step
 void md::simulation::removeTranslationalAndRotationalMomentumOfWholeSystem(void)
 {
-  std::size_t const N = coordobj.size();
+  std::ptrdiff_t const N(coordobj.size());
   coords::Cartesian_Point momentum_linear, momentum_angular, mass_vector, velocity_angular;
   // 3x3 Matrix (moment of inertia tensor)
   scon::c3<scon::c3<coords::float_type>> InertiaTensor;
   // calculate system movement
-  for (std::size_t i = 0; i < N; ++i)
+  double mx = 0, my = 0, mz = 0, plx = 0, ply = 0, plz = 0, pax = 0, pay = 0, paz = 0;
+#pragma omp parallel for reduction (+: mx, my, mz, plx, ply, plz, pax, pay, paz)
+  for (std::ptrdiff_t i = 0; i < N; ++i)
   {
     // center of mass and linear and angular momentum
-    mass_vector += coordobj.xyz(i) * M[i];
-    momentum_linear += V[i] * M[i];
-    momentum_angular += cross(coordobj.xyz(i), V[i]) * M[i];
+    coords::Cartesian_Point const r(coordobj.xyz(i) * M[i]);
+    coords::Cartesian_Point const p(V[i] * M[i]);
+    coords::Cartesian_Point const l(cross(coordobj.xyz(i), V[i]) * M[i]);
+    mx += r.x(); my += r.y(); mz += r.z();
+    plx += p.x(); ply += p.y(); plz += p.z();
+    pax += l.x(); pay += l.y(); paz += l.z();
   }
+  mass_vector = coords::Cartesian_Point(mx, my, mz);
+  momentum_linear = coords::Cartesian_Point(plx, ply, plz);
+  momentum_angular = coords::Cartesian_Point(pax, pay, paz);
   // scale by total mass
   momentum_linear /= M_total;
   mass_vector /= M_total;
@@ -282,7 +290,8 @@ void md::simulation::removeTranslationalAndRotationalMomentumOfWholeSystem(void)
   momentum_angular -= cross(mass_vector, momentum_linear) * M_total;
   // momentum of inertia from each component
   double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
-  for (std::size_t i = 0; i < N; ++i)
+#pragma omp parallel for reduction (+: xx, xy, xz, yy, yz, zz)
+  for (std::ptrdiff_t i = 0; i < N; ++i)
   {
     coords::Cartesian_Point r(coordobj.xyz(i) - mass_vector);
     xx += r.x() * r.x() * M[i];
@@ -303,7 +312,8 @@ void md::simulation::removeTranslationalAndRotationalMomentumOfWholeSystem(void)
   velocity_angular.y() = (dot(InertiaTensor.y(), momentum_angular));
   velocity_angular.z() = (dot(InertiaTensor.z(), momentum_angular));
   // remove angular and linear momentum
-  for (std::size_t i = 0; i < N; ++i)
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < N; ++i)
   {
     V[i] -= momentum_linear;
     coords::Cartesian_Point r(coordobj.xyz(i) - mass_vector);
@@ -315,31 +325,30 @@ void md::simulation::removeTranslationalAndRotationalMomentumOfWholeSystem(void)
 // Calculates current kinetic energy from velocities
 coords::float_type md::simulation::getEkin(std::vector<std::size_t> atom_list) const
 {
-  // initialize tensor to zero
-  using TenVal = coords::Tensor::value_type;
-  const TenVal z = { 0.0,0.0,0.0 };
-  coords::Tensor cE_kin_tensor = coords::Tensor(this->E_kin_tensor);
-  cE_kin_tensor.fill(z);
+  // only the diagonal of the kinetic energy tensor is needed for the total kinetic energy
+  std::ptrdiff_t const n(atom_list.size());
+  coords::float_type xx = 0, yy = 0, zz = 0;
   // calculate contribution to kinetic energy for each atom
-  for (auto i : atom_list)
+#pragma omp parallel for reduction (+: xx, yy, zz)
+  for (std::ptrdiff_t j = 0; j < n; ++j)
   {
+    auto const i = atom_list[j];
     auto const fact = 0.5 * M[i] / convert;
-    cE_kin_tensor[0][0] += fact * V[i].x() * V[i].x();
-    cE_kin_tensor[1][0] += fact * V[i].x() * V[i].y();
-    cE_kin_tensor[2][0] += fact * V[i].x() * V[i].z();
-    cE_kin_tensor[0][1] += fact * V[i].y() * V[i].x();
-    cE_kin_tensor[1][1] += fact * V[i].y() * V[i].y();
-    cE_kin_tensor[2][1] += fact * V[i].y() * V[i].z();
-    cE_kin_tensor[0][2] += fact * V[i].z() * V[i].x();
-    cE_kin_tensor[1][2] += fact * V[i].z() * V[i].y();
-    cE_kin_tensor[2][2] += fact * V[i].z() * V[i].z();
+    xx += fact * V[i].x() * V[i].x();
+    yy += fact * V[i].y() * V[i].y();
+    zz += fact * V[i].z() * V[i].z();
   }
-  // calculate total kinetic energy by the trace of the tensor
-  coords::float_type cE_kin = cE_kin_tensor[0][0] + cE_kin_tensor[1][1] + cE_kin_tensor[2][2];
+  return reportEkin(xx, yy, zz);
+}
+
+// Calculates total kinetic energy by the trace of the tensor
+coords::float_type md::simulation::reportEkin(coords::float_type const xx, coords::float_type const yy, coords::float_type const zz) const
+{
+  coords::float_type const cE_kin = xx + yy + zz;
   if (Config::get().general.verbosity > 4u)
   {
-    std::cout << "New kinetic Energy is " << cE_kin << "kcal/mol with E_kin(x), (y), (z) = " << cE_kin_tensor[0][0] << ", "
-      << cE_kin_tensor[1][1] << ", " << cE_kin_tensor[2][2] << "." << '\n';
+    std::cout << "New kinetic Energy is " << cE_kin << "kcal/mol with E_kin(x), (y), (z) = " << xx << ", "
+      << yy << ", " << zz << "." << '\n';
   }
   return cE_kin;
 }
@@ -350,6 +359,24 @@ void md::simulation::updateEkin(std::vector<std::size_t> atom_list)
   this->E_kin = getEkin(atom_list);
 }
 
+// Scales velocities and calculates kinetic energy from the new velocities in one pass
+void md::simulation::scaleVelocitiesAndUpdateEkin(std::vector<std::size_t> const& atom_list, double const factor)
+{
+  std::ptrdiff_t const n(atom_list.size());
+  coords::float_type xx = 0, yy = 0, zz = 0;
+#pragma omp parallel for reduction (+: xx, yy, zz)
+  for (std::ptrdiff_t j = 0; j < n; ++j)
+  {
+    auto const i = atom_list[j];
+    V[i] *= factor;
+    auto const fact = 0.5 * M[i] / convert;
+    xx += fact * V[i].x() * V[i].x();
+    yy += fact * V[i].y() * V[i].y();
+    zz += fact * V[i].z() * V[i].z();
+  }
+  this->E_kin = reportEkin(xx, yy, zz);
+}
+
 // apply pressure corrections if constant pressure simulation is performed
 void md::simulation::berendsen(double const time)
 {
@@ -471,6 +498,16 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
     //velofactor(-0.5*dt*md::convert),
     dt_2(0.5 * dt);
 
+  // per-atom factors and work arrays of the kick and drift kernels
+  std::ptrdiff_t const N_movable(movable_atoms.size());
+  acceleration_factor.resize(N);
+  for (std::size_t i = 0u; i < N; ++i) acceleration_factor[i] = md::negconvert / M[i];
+  displacement.assign(N, coords::Cartesian_Point(0.));
+  // no fixation checks are required in the position update if nothing is fixed
+  bool const no_fixed_atoms = !coordobj.has_fixed_atoms();
+  // kinetic energy can be accumulated in the second kick if all atoms are moved and no one modifies velocities afterwards
+  bool const fusable_ekin = movable_atoms.size() == N && !CONFIG.rattle.use;
+
   if (Config::get().general.verbosity > 0U)
   {
     std::cout << "Saving " << std::size_t(snapGap > 0 ? (CONFIG.num_steps - k_init) / snapGap : 0);
@@ -482,10 +519,7 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
   {
     if (k == 0 && beeman == true)    // set F(t-dt) for first step to F(t)
     {
-      for (size_t i = 0u; i < N; ++i)
-      {
-        F_old.push_back(coordobj.g_xyz(i));
-      }
+      F_old.insert(F_old.end(), coordobj.g_xyz().begin(), coordobj.g_xyz().end());
     }
 
     if (Config::get().general.verbosity > 3u)
@@ -504,40 +538,45 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
       if (CONFIG.thermostat_algorithm == config::molecular_dynamics::thermostat_algorithms::ARBITRARY_CHAIN_LENGTH_NOSE_HOOVER
         || CONFIG.thermostat_algorithm == config::molecular_dynamics::thermostat_algorithms::TWO_NOSE_HOOVER_CHAINS)
       {
+        profiling::scoped_timer thermostat_timer("MD thermostat and kinetic energy");
         this->instantaneous_temp = tempcontrol(CONFIG.thermostat_algorithm, true);
       }
     }
 
+    profiling::count("MD steps");
+    profiling::scoped_timer integration_kick_timer("MD integration (kick/drift)");
     // save old coordinates
     P_old = coordobj.xyz();
-    // Calculate new positions and half step velocities
-    for (auto i : movable_atoms)
+    // Calculate half step velocities and displacements (kick and drift in one pass)
+#pragma omp parallel for
+    for (std::ptrdiff_t j = 0; j < N_movable; ++j)
     {
-      coords::Cartesian_Point acceleration;
+      auto const i = movable_atoms[j];
       if (beeman == false)  //velocity-verlet
       {
-        acceleration = coordobj.g_xyz(i) * md::negconvert / M[i];
-        V[i] += acceleration * dt_2;
+        V[i] += coordobj.g_xyz(i) * (acceleration_factor[i] * dt_2);
       }
       else  //beeman
       {
-        acceleration = coordobj.g_xyz(i) * md::negconvert / M[i];
-        coords::Cartesian_Point const acceleration_old(F_old[i] * md::negconvert / M[i]);
-        V[i] += acceleration * (2.0 / 3.0) * dt - acceleration_old * (1.0 / 6.0) * dt;
+        V[i] += coordobj.g_xyz(i) * (acceleration_factor[i] * (2.0 / 3.0) * dt) - F_old[i] * (acceleration_factor[i] * (1.0 / 6.0) * dt);
       }
+      displacement[i] = V[i] * dt;
+    }
 
-      if (Config::get().general.verbosity > 4)
+    if (Config::get().general.verbosity > 4)
+    {
+      for (auto i : movable_atoms)
       {
-        std::cout << "Move " << i << " by " << (V[i] * dt)
+        std::cout << "Move " << i << " by " << displacement[i]
           << " with g " << coordobj.g_xyz(i) << ", V: " << V[i] << std::endl;
       }
     }
 
-    for (auto i : movable_atoms)
-    {  // update coordinates
-      coordobj.move_atom_by(i, V[i] * dt);
-    }
+    // update coordinates
+    coordobj.move_atoms_by(displacement, no_fixed_atoms);
+    integration_kick_timer.stop();
 
+    profiling::scoped_timer bond_validation_timer("MD bond validation");
     if (coordobj.validate_bonds() == false)  // look if all bonds are okay and save those which aren't 
     {
       if (Config::get().general.verbosity > 1U)
@@ -550,26 +589,33 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
       }
       if (Config::get().md.broken_restart == 1)
       {
+        profiling::count("MD broken restarts");
         restart_broken();   // if desired: set simulation to original positions and random velocities
       }
     }
+    bond_validation_timer.stop();
     // Apply first part of RATTLE constraints if requested
-    if (CONFIG.rattle.use) rattle_pre();
+    if (CONFIG.rattle.use)
+    {
+      profiling::scoped_timer rattle_timer("MD RATTLE");
+      rattle_pre();
+    }
 
     if (beeman == true)
     {
-      for (size_t i = 0u; i < N; ++i)   // save F(t) as F_old
-      {
-        F_old[i] = coordobj.g_xyz(i);
-      }
+      F_old = coordobj.g_xyz();   // save F(t) as F_old
     }
 
     // calculate new energy & gradients
-    coordobj.g();
+    {
+      profiling::scoped_timer gradient_timer("MD energy and gradients");
+      coordobj.g();
+    }
 
     // Apply umbrella potential if umbrella sampling is used
     if (CONFIG.umbrella == true)
     {
+      profiling::scoped_timer umbrella_timer("MD umbrella bias");
       // apply biases and fill udatacontainer with values for restrained coordinates
       coordobj.ubias(udatacontainer, *umbrella_spline);
     }
@@ -578,28 +624,45 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
     {
       if (Config::get().general.verbosity > 3U)
         std::cout << "Refining structure/nonbondeds.\n";
+      profiling::scoped_timer refine_timer("MD nonbonded refine");
       coordobj.energy_update(true);
     }
     // add new acceleration and calculate full step velocities
-    for (auto i : movable_atoms)
-    {
+    // (kinetic energy is accumulated in the same pass if nothing touches the velocities afterwards)
+    integration_kick_timer.restart();
+    bool const ekin_in_kick = fusable_ekin && !(CONFIG.temp_control == true && is_not_microcanonical);
+    coords::float_type ekin_xx = 0, ekin_yy = 0, ekin_zz = 0;
+#pragma omp parallel for reduction (+: ekin_xx, ekin_yy, ekin_zz)
+    for (std::ptrdiff_t j = 0; j < N_movable; ++j)
+    {
+      auto const i = movable_atoms[j];
       if (beeman == false)  // velocity verlet
       {
-        coords::Cartesian_Point const acceleration(coordobj.g_xyz(i) * md::negconvert / M[i]);
-        V[i] += acceleration * dt_2;
+        V[i] += coordobj.g_xyz(i) * (acceleration_factor[i] * dt_2);
       }
       else  // beeman
       {
-        coords::Cartesian_Point const acceleration_new(coordobj.g_xyz(i) * md::negconvert / M[i]);
-        coords::Cartesian_Point const acceleration(F_old[i] * md::negconvert / M[i]);
-        V[i] += acceleration_new * (1.0 / 3.0) * dt + acceleration * (1.0 / 6.0) * dt;
+        V[i] += coordobj.g_xyz(i) * (acceleration_factor[i] * (1.0 / 3.0) * dt) + F_old[i] * (acceleration_factor[i] * (1.0 / 6.0) * dt);
+      }
+      if (ekin_in_kick)
+      {
+        auto const fact = 0.5 * M[i] / convert;
+        ekin_xx += fact * V[i].x() * V[i].x();
+        ekin_yy += fact * V[i].y() * V[i].y();
+        ekin_zz += fact * V[i].z() * V[i].z();
       }
     }
+    integration_kick_timer.stop();
 
     // Apply full step RATTLE constraints
-    if (CONFIG.rattle.use) rattle_post();
+    if (CONFIG.rattle.use)
+    {
+      profiling::scoped_timer rattle_timer("MD RATTLE");
+      rattle_post();
+    }
 
     // Apply full step temperature adjustments
+    profiling::scoped_timer thermostat_timer("MD thermostat and kinetic energy");
     if (CONFIG.temp_control == true && is_not_microcanonical)
     {
       this->instantaneous_temp = tempcontrol(CONFIG.thermostat_algorithm, false);
@@ -607,13 +670,16 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
     else  // calculate E_kin and T if no temperature control is active (switched off by MDtemp_control)
     {
       const double tempfactor(2.0 / (freedom * md::R));
-      updateEkin(range(N));            // kinetic energy
+      if (ekin_in_kick) E_kin = reportEkin(ekin_xx, ekin_yy, ekin_zz);
+      else updateEkin(range(N));            // kinetic energy
       this->instantaneous_temp = E_kin * tempfactor;
     }
+    thermostat_timer.stop();
 
     // Apply pressure adjustments
     if (CONFIG.pressure)
     {
+      profiling::scoped_timer pressure_timer("MD pressure coupling");
       berendsen(dt);
     }
     // save temperature for FEP
@@ -622,12 +688,17 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
       coordobj.getFep().fepdata.back().T = this->instantaneous_temp;
     }
     // if requested remove translation and rotation of the system
-    if (Config::get().md.veloScale) removeTranslationalAndRotationalMomentumOfWholeSystem();
+    if (Config::get().md.veloScale)
+    {
+      profiling::scoped_timer momentum_timer("MD momentum removal");
+      removeTranslationalAndRotationalMomentumOfWholeSystem();
+    }
 
     // Logging / Traces
 
     if (CONFIG.track)
     {
+      profiling::scoped_timer logging_timer("MD logging");
       std::vector<coords::float_type> iae;
       if (coordobj.interactions().size() > 1)
       {
@@ -640,13 +711,25 @@ void md::simulation::integrator(bool fep, std::size_t k_init, bool beeman)
     // Serialize to binary file if required.
     if (k > 0 && Config::get().md.restart_offset > 0 && k % Config::get().md.restart_offset == 0)
     {
+      profiling::scoped_timer restart_timer("MD restart file");
       write_restartfile(k);
     }
     // add up pressure value
     p_average += press;
 
     // get info for analysis
-    md_analysis::add_analysis_info(this);
+    {
+      profiling::scoped_timer analysis_timer("MD analysis");
+      md_analysis::add_analysis_info(this);
+    }
+
+    // periodic report of the profiler
+    if (profiling::profiler::active() && Config::get().profiling.report_offset > 0
+      && (k + 1U) % Config::get().profiling.report_offset == 0)
+    {
+      std::cout << "Profile after " << k + 1U << " MD steps:\n";
+      profiling::profiler::get().print_report(std::cout);
+    }
   }
 
   // log analysis info
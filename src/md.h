@@ -39,6 +39,7 @@ Purpose: header for molecular dynamics simulation
 #include "md_thermostat.h"
 #include "md_umbrella.h"
 #include "md_FEP.h"
+#include "profiling.h"
 #include "spline.h"
 
 /**
@@ -119,6 +120,12 @@ namespace md
     /**atoms that move*/
     std::vector<std::size_t> movable_atoms; 
 
+    // integrator work arrays (rebuilt at the start of integrator(), not serialized)
+    /**negconvert / M for every atom (converts gradient into acceleration)*/
+    std::vector<double> acceleration_factor;
+    /**displacement of every atom in the current step (zero for atoms that don't move)*/
+    coords::Representation_3D displacement;
+
     /** vector with lambda-values for every FEP window */
     std::vector<fepvar> window;
     /** Umbrella sampling vectors */
@@ -181,6 +188,12 @@ namespace md
     /** Get new kinetic energy from current velocities of atoms
     @param atom_list: vector of atom numbers whose energy should be calculated*/
     void updateEkin(std::vector<std::size_t> atom_list);
+    /** Scale velocities of some atoms and calculate their kinetic energy in the same pass
+    @param atom_list: vector of atom numbers whose velocities are scaled
+    @param factor: velocity scaling factor*/
+    void scaleVelocitiesAndUpdateEkin(std::vector<std::size_t> const& atom_list, double const factor);
+    /** Returns sum of diagonal elements of kinetic energy tensor (and prints them if verbosity is high enough)*/
+    coords::float_type reportEkin(coords::float_type const xx, coords::float_type const yy, coords::float_type const zz) const;
 
     /** Berendsen pressure coupling (doesn't work */
     void berendsen(double const);
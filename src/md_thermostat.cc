@@ -261,14 +261,9 @@ double md::simulation::tempcontrol(config::molecular_dynamics::thermostat_algori
       }
     }
   }
-  for (auto i : movable_atoms)
-  {
-    V[i] *= scaling_factor;   // new velocities (for all atoms that have a velocity)
-  }
-  if (Config::get().coords.fixed.size() != 0)
-    updateEkin(movable_atoms);
-  else
-    updateEkin(range(N));
+  // new velocities (for all atoms that have a velocity) and new kinetic energy
+  // if no atoms are fixed movable_atoms contains all atoms
+  scaleVelocitiesAndUpdateEkin(movable_atoms, scaling_factor);
   temp_after_scaling = this->E_kin * T_factor;
   if (Config::get().general.verbosity > 3 && half)
   {
@@ -11,11 +11,13 @@
 #include <iterator>
 #include <algorithm>
 #include <utility>
+#include <exception>
 #include "ls.h"
 #include "lbfgs.h"
 #include "coords.h"
 #include "optimization_global.h"
 #include "Matrix_Class.h"
+#include "Scon/scon_linkedcell.h"
 
 /**
 * NEB constructor
@@ -32,6 +34,21 @@ neb::neb(coords::Coordinates* cptr)
   num_images = Config::get().neb.IMAGES;
   ClimbingImage = Config::get().neb.CLIMBING;
   springconstant = Config::get().neb.SPRINGCONSTANT;
+  images_intact = true;
+
+  // forcefields are calculated inside of CAST, external programs need a scratch directory for every image
+  // (only interfaces that write all their files into their scratch directory, QM/MM interfaces share file names)
+  auto const iface = Config::get().general.energy_interface;
+  bool const in_process = iface == config::interface_types::AMBER || iface == config::interface_types::AMOEBA
+    || iface == config::interface_types::CHARMM22 || iface == config::interface_types::OPLSAA;
+  bool const has_scratch = iface == config::interface_types::ORCA || iface == config::interface_types::DFTB
+    || iface == config::interface_types::MOPAC || iface == config::interface_types::GAUSSIAN || iface == config::interface_types::PSI4;
+  parallel_images = Config::get().neb.PARALLEL && (in_process || (has_scratch && Config::get().energy.scratch.use));
+  if (Config::get().neb.PARALLEL && !parallel_images)
+  {
+    if (has_scratch) std::cout << "Images of NEB are calculated one after another as QMSCRATCHuse is switched off.\n";
+    else std::cout << "Images of NEB are calculated one after another as the interface has no scratch directories.\n";
+  }
 }
 
 /**
@@ -440,16 +457,70 @@ void neb::run(ptrdiff_t& count, std::vector<size_t>&, std::vector<std::vector<si
 
 void neb::get_energies(void)
 {
-  for (size_t i = 0; i < num_images; i++)
-  {
-    cPtr->set_xyz(imagi[i]);
-    energies[i] = cPtr->g();
-  }
+  evaluate_images(0u, num_images, energies);
 
   if (Config::get().general.verbosity > 4)
     std::cout << "maximum energy image is: " << CIMaximum << "\n";
 }
 
+/**
+* Energy and gradient calculation of the images, the images are independent of each other
+* so they are calculated at the same time if NEB-PATHOPT-NEB-PARALLEL is switched on
+*/
+
+void neb::evaluate_images(std::size_t const first, std::size_t const last, std::vector<double>& image_energies)
+{
+  image_gradients.resize(num_images);
+  image_positions.resize(num_images);
+  images_intact = true;
+  if (!parallel_images)
+  {
+    for (size_t i = first; i < last; i++)
+    {
+      cPtr->set_xyz(imagi[i]);
+      image_energies[i] = cPtr->g();
+      image_gradients[i] = cPtr->g_xyz();
+      image_positions[i] = cPtr->xyz();
+      images_intact = images_intact && cPtr->integrity();
+    }
+    return;
+  }
+
+  // copies are made once per optimization so that they know about fixed atoms etc.
+  if (image_coords.size() != num_images)
+  {
+    image_coords.clear();
+    image_coords.reserve(num_images);
+    for (size_t i = 0; i < num_images; i++) image_coords.emplace_back(*cPtr);
+  }
+
+  auto const config = Config::snapshot();
+  std::exception_ptr error;
+  bool intact = true;
+  auto const n_omp = static_cast<std::ptrdiff_t>(last);
+#pragma omp parallel for schedule(dynamic, 1) reduction(&&:intact)
+  for (std::ptrdiff_t i = static_cast<std::ptrdiff_t>(first); i < n_omp; ++i)
+  {
+    Config::local_scope scope(*config);
+    auto& image = image_coords[i];
+    try
+    {
+      image.set_xyz(imagi[i]);
+      image_energies[i] = image.g();
+      image_gradients[i] = image.g_xyz();
+      image_positions[i] = image.xyz();
+      intact = intact && image.integrity();
+    }
+    catch (...)
+    {
+#pragma omp critical (neb_image_error)
+      if (!error) error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+  images_intact = intact;
+}
+
 /**
 * Calculation of the band defining vectors tau --> standard / improved tangent estimate
 */
@@ -571,123 +642,111 @@ void neb::calc_tau(void)
 /**
 * IDPP start
 */
-void neb::idpp_prep()
-{
-  start_structure = cPtr->xyz();
-  final_structure = imagi.back();
-  bond_st = bond_dir(start_structure);
-  eu_st = euclid_dist<double>(start_structure);
-  eu_fi = euclid_dist<double>(final_structure);
-}
 
-template<typename ContainerIt, typename Result>
-void neb::concatenate(ContainerIt st, ContainerIt fi, Result res)
+namespace
 {
-  while (st != fi)
+  /**atom pairs (i > j) of a structure that are closer than cutoff (all pairs if cutoff <= 0)*/
+  std::vector<std::pair<std::size_t, std::size_t>> pairs_within(coords::Representation_3D const& xyz, double const cutoff)
   {
-    res = std::move(st->begin(), st->end(), res);
-    ++st;
-  }
-}
+    auto const N = static_cast<std::ptrdiff_t>(xyz.size());
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    if (N == 0) return pairs;
 
-template<typename T>
-dist_T<T> euclid_dist(coords::Representation_3D const& struc)
-{
-  dist_T<T> result;
-  std::vector<T> dist;
-  for (auto& i : struc)
-  {
-    dist.clear();
-    for (auto& s : struc)
+    bool const use_cells(scon::linked::pay_off(xyz, cutoff));
+
+    using cells_type = scon::linked::Cells<coords::float_type, coords::Cartesian_Point, coords::Representation_3D>;
+    std::unique_ptr<cells_type> cells;
+    if (use_cells) cells = std::make_unique<cells_type>(xyz, cutoff);
+
+    auto is_close = [&xyz, cutoff](std::size_t const i, std::size_t const j)
     {
-      auto f{ (i - s) * (i - s) };
-      auto d(std::sqrt(f.x() + f.y() + f.z()));
-      if (d != 0.0) dist.push_back(d);
-      else continue;
+      return cutoff <= 0.0 || dist(xyz[i], xyz[j]) < cutoff;
+    };
+
+#pragma omp parallel
+    {
+      std::vector<std::pair<std::size_t, std::size_t>> thread_pairs;
+#pragma omp for schedule(dynamic, 64)
+      for (std::ptrdiff_t i = 0; i < N; ++i)
+      {
+        std::size_t const ui(i);
+        if (use_cells)
+        {
+          auto const box_of_i = cells->box_of_element(ui);   // must outlive the loop, adjacencies() only references it
+          for (auto j : box_of_i.adjacencies())              // atoms in the same and in neighbouring cells
+          {
+            if (j < 0 || static_cast<std::size_t>(j) >= ui) continue;
+            if (is_close(ui, static_cast<std::size_t>(j))) thread_pairs.emplace_back(ui, static_cast<std::size_t>(j));
+          }
+        }
+        else
+        {
+          for (std::size_t j = 0u; j < ui; ++j)
+          {
+            if (is_close(ui, j)) thread_pairs.emplace_back(ui, j);
+          }
+        }
+      }
+#pragma omp critical (idpp_pairs_merge)
+      pairs.insert(pairs.end(), thread_pairs.begin(), thread_pairs.end());
     }
-    result.push_back(dist);
+    return pairs;
   }
-  return result;
 }
 
-std::vector<coords::Representation_3D> neb::bond_dir(coords::Representation_3D const& struc)
+void neb::idpp_prep()
 {
-  coords::Representation_3D direction;
-  std::vector<coords::Representation_3D> all_directions;
-  for (auto& i : struc)
+  start_structure = cPtr->xyz();
+  final_structure = imagi.back();
+
+  // a pair is needed if it is close in at least one of the endpoints
+  double const cutoff = Config::get().neb.IDPP_CUTOFF;
+  auto pairs = pairs_within(start_structure, cutoff);
+  if (cutoff > 0.0)
   {
-    direction.clear();
-    for (auto& s : struc)
-    {
-      auto f{ s - i };
-      auto d{ f.x() + f.y() + f.z() };
-      if (d != 0.0) direction.push_back(f);
-      else continue;
-    }
-    all_directions.push_back(direction);
+    auto const final_pairs = pairs_within(final_structure, cutoff);
+    pairs.insert(pairs.end(), final_pairs.begin(), final_pairs.end());
   }
-  return all_directions;
-}
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
 
-template<typename T, typename Euclid>
-std::vector<T> neb::interpol_dist(Euclid& st, Euclid& fi, size_t const img_no)
-{
-  /*if (!std::all_of(st.cbegin(), st.cend(),
-  [&](auto const& x) {return x.size() == st.front().size(); }))
-  throw ("Size error!");
-
-  if (!std::all_of(fi.cbegin(), fi.cend(),
-  [&](auto const& x) {return x.size() == fi.front().size(); }))
-  throw ("Size error!");*/
-
-  std::vector<T> di_st, di_fi;
-  di_st.reserve(st.size() * (st.size() - 1));
-  di_fi.reserve(fi.size() * (fi.size() - 1));
-  concatenate(st.begin(), st.end(), std::back_inserter(di_st));
-  concatenate(fi.begin(), fi.end(), std::back_inserter(di_fi));
-  auto st_it{ di_st.cbegin() };
-  auto fi_it{ di_fi.cbegin() };
-  std::vector<T> result;
-  for (; st_it != di_st.cend() && fi_it != di_fi.cend(); ++st_it, ++fi_it)
-  {
-    auto s{ *st_it + ((double)img_no / (num_images - 1)) * (*fi_it - *st_it) };
-    result.push_back(s);
-  }
-  return result;
+  idpp_pairs.clear();
+  idpp_pairs.reserve(pairs.size());
+  for (auto const& p : pairs)
+  {
+    idpp_pairs.push_back({ p.first, p.second,
+      dist(start_structure[p.first], start_structure[p.second]),
+      dist(final_structure[p.first], final_structure[p.second]) });
+  }
+  if (Config::get().general.verbosity > 3)
+  {
+    std::cout << "Number of atom pairs in IDPP: " << idpp_pairs.size() << "\n";
+  }
 }
 
-template<typename T, typename Euclid>
-coords::Representation_3D neb::idpp_gradients(std::vector<coords::Representation_3D> const& bond_st,
-  Euclid& start, Euclid& st, Euclid& fi, size_t const im_no)
+coords::Representation_3D neb::idpp_gradients(coords::Representation_3D const& image, size_t const im_no) const
 {
-  auto interp_di{ interpol_dist<double, dist_T<double>>(start, fi, im_no) };
-  coords::Representation_3D all_grad;
-  auto bond_it{ bond_st.cbegin() };
-  auto euclid_it{ st.cbegin() };
-  auto interp_it{ interp_di.cbegin() };
-  std::vector<scon::c3<coords::float_type>> dummy;
-  for (; bond_it != bond_st.cend() && euclid_it != st.cend()
-    && interp_it != interp_di.cend(); ++bond_it, ++euclid_it, ++interp_it)
-  {
-    dummy.clear();
-    scon::c3<coords::float_type> dummy_sum{ 0.0, 0.0, 0.0 };
-    std::vector<scon::c3<coords::float_type>> bonds{ *bond_it };
-    std::vector<T> eu_dist{ *euclid_it };
-    std::vector<T> interp_dist{ *interp_it };
-    auto b_it{ bonds.cbegin() };
-    auto eu_it{ eu_dist.cbegin() };
-    auto ip_it{ interp_dist.cbegin() };
-    for (; b_it != bonds.cend() && eu_it != eu_dist.cend()
-      && ip_it != interp_dist.cend(); ++b_it, ++eu_it, ++ip_it)
+  double const fraction = static_cast<double>(im_no) / static_cast<double>(num_images - 1);
+  auto const n_pairs = static_cast<std::ptrdiff_t>(idpp_pairs.size());
+  coords::Representation_3D all_grad(image.size(), coords::Cartesian_Point(0.0, 0.0, 0.0));
+#pragma omp parallel
+  {
+    coords::Representation_3D thread_grad(image.size(), coords::Cartesian_Point(0.0, 0.0, 0.0));
+#pragma omp for schedule(static)
+    for (std::ptrdiff_t p = 0; p < n_pairs; ++p)
     {
-      auto s{ (*b_it / *eu_it) * (((*ip_it - 2.0 * *eu_it)
-        * (*ip_it - *eu_it)) / std::pow(*eu_it, 5.0)) };
-      dummy.push_back(s);
-    }
-    for (auto i : dummy) { dummy_sum += i; }
-    scon::c3<coords::float_type> dummy_sum_mult{ (-2.0) * dummy_sum.x(),
-      (-2.0) * dummy_sum.y(), (-2.0) * dummy_sum.z() };
-    all_grad.push_back(dummy_sum_mult);
+      auto const& pair = idpp_pairs[p];
+      auto const bond = image[pair.j] - image[pair.i];
+      double const d = geometric_length(bond);
+      if (d == 0.0) continue;
+      // target distance is interpolated linearly between start and final structure
+      double const interp = pair.d_start + fraction * (pair.d_final - pair.d_start);
+      auto const s = (bond / d) * (((interp - 2.0 * d) * (interp - d)) / std::pow(d, 5.0));
+      thread_grad[pair.i] -= s * 2.0;
+      thread_grad[pair.j] += s * 2.0;
+    }
+#pragma omp critical (idpp_gradients_merge)
+    for (std::size_t i = 0; i < all_grad.size(); ++i) all_grad[i] += thread_grad[i];
   }
   return all_grad;
 }
@@ -840,6 +899,7 @@ double neb::lbfgs()
 
   using namespace  optimization::local;
   energies_NEB.resize(num_images);
+  image_coords.clear();
   //typedef coords::Container<scon::c3<float>> nc3_type;
   // Create optimizer
   coords::Cartesian_Point g;
@@ -869,6 +929,7 @@ double neb::lbfgs_maxflux()
 
   using namespace  optimization::local;
   energies_NEB.resize(num_images);
+  image_coords.clear();
   //typedef coords::Container<scon::c3<float>> nc3_type;
   // Create optimizer
   coords::Cartesian_Point g;
@@ -912,22 +973,30 @@ double neb::g_new()
 
     imagi[im].clear();
     for (size_t kk = (im - 1) * cPtr->size(); kk < im * cPtr->size(); kk++)  imagi[im].push_back(images_initial[kk]);
+  }
+  evaluate_images(1u, num_images - 1u, energies_NEB);
 
-    cPtr->set_xyz(imagi[im]);
-    energies_NEB[im] = energytemp = this->cPtr->g();
+  // spring forces and projections need the gradients of all images
+  for (size_t im = 1; im < num_images - 1; im++)
+  {
+    auto& image_g = image_gradients[im];
+    energytemp = energies_NEB[im];
     energytemp += energytemp;
     if (ClimbingImage == true && num_images == static_cast<decltype(num_images)>(CIMaximum))
     {
       double magni = 0.0;
-      magni = dot_uneq(cPtr->g_xyz(), tau[im]);
+      magni = dot_uneq(image_g, tau[im]);
       if (len(tau[im]) == 0.0) { magni = 0.0; }
       else { magni = magni / len(tau[im]); }
-      for (size_t i = 0; i < cPtr->size(); i++) cPtr->update_g_xyz(i, cPtr->g_xyz(i) - tau[im][i] * magni * 2.0);
+      for (size_t i = 0; i < cPtr->size(); i++)
+      {
+        if (!cPtr->atoms(i).fixed()) image_g[i] = image_g[i] - tau[im][i] * magni * 2.0;
+      }
     }
     else
     {
 
-      tauderiv = dot_uneq(cPtr->g_xyz(), tau[im]);
+      tauderiv = dot_uneq(image_g, tau[im]);
 
       if (len(tau[im]) == 0.0) { tauderiv = 0.0; }
       else { tauderiv /= len(tau[im]); }
@@ -950,9 +1019,9 @@ double neb::g_new()
       if (Rp1mag != Rp1mag) Rp1mag = 0.0;
       for (size_t i = 0; i < cPtr->size(); i++)
       {
-        Fvertical[i].x() = cPtr->g_xyz(i).x() - tauderiv * tau[im][i].x();
-        Fvertical[i].y() = cPtr->g_xyz(i).y() - tauderiv * tau[im][i].y();
-        Fvertical[i].z() = cPtr->g_xyz(i).z() - tauderiv * tau[im][i].z();
+        Fvertical[i].x() = image_g[i].x() - tauderiv * tau[im][i].x();
+        Fvertical[i].y() = image_g[i].y() - tauderiv * tau[im][i].y();
+        Fvertical[i].z() = image_g[i].z() - tauderiv * tau[im][i].z();
 
         Fpar[i].x() = springconstant * (Rp1mag - Rm1mag) * tau[im][i].x();
         Fpar[i].y() = springconstant * (Rp1mag - Rm1mag) * tau[im][i].y();
@@ -961,9 +1030,7 @@ double neb::g_new()
       }
       if (Config::get().neb.IDPP)
       {
-        auto bond_dummy{ bond_dir(imagi[im]) };
-        auto eu_dummy{ euclid_dist<double>(imagi[im]) };
-        Fidpp = idpp_gradients<double, dist_T<double>>(bond_dummy, eu_st, eu_dummy, eu_fi, im);
+        Fidpp = idpp_gradients(imagi[im], im);
       }
     }
 
@@ -972,13 +1039,13 @@ double neb::g_new()
       if (Config::get().neb.IDPP)
       {
         auto const g = Fvertical[j] + Fpar[j] + Fidpp[j];
-        cPtr->update_g_xyz(j, g);
+        if (!cPtr->atoms(j).fixed()) image_g[j] = g;
         grad_tot.push_back(g);
       }
       else
       {
         auto const g = Fvertical[j] + Fpar[j];
-        cPtr->update_g_xyz(j, g);
+        if (!cPtr->atoms(j).fixed()) image_g[j] = g;
         grad_tot.push_back(g);
 
       }
@@ -986,6 +1053,7 @@ double neb::g_new()
     }
 
   }
+  store_last_image();
 
   return energytemp;
 }
@@ -1004,22 +1072,30 @@ double neb::g_new_maxflux()
   {
     imagi[im].clear();
     for (size_t kk = (im - 1) * cPtr->size(); kk < im * cPtr->size(); kk++)  imagi[im].push_back(images_initial[kk]);
+  }
+  evaluate_images(1u, num_images - 1u, energies_NEB);
 
-    cPtr->set_xyz(imagi[im]);
-    energies_NEB[im] = energytemp = this->cPtr->g();
+  // spring forces and projections need the gradients of all images
+  for (size_t im = 1; im < num_images - 1; im++)
+  {
+    auto& image_g = image_gradients[im];
+    energytemp = energies_NEB[im];
     energytemp += energytemp;
     if (ClimbingImage == true && num_images == static_cast<decltype(num_images)>(CIMaximum))
     {
       double magni = 0.0;
-      magni = dot_uneq(cPtr->g_xyz(), tau[im]);
+      magni = dot_uneq(image_g, tau[im]);
 
       if (len(tau[im]) == 0.0) { magni = 0.0; }
       else { magni = magni / len(tau[im]); }
-      for (size_t i = 0; i < cPtr->size(); i++) cPtr->update_g_xyz(i, cPtr->g_xyz(i) - tau[im][i] * magni * 2.0);
+      for (size_t i = 0; i < cPtr->size(); i++)
+      {
+        if (!cPtr->atoms(i).fixed()) image_g[i] = image_g[i] - tau[im][i] * magni * 2.0;
+      }
     }
     else
     {
-      tauderiv = dot_uneq(cPtr->g_xyz(), tau[im]);
+      tauderiv = dot_uneq(image_g, tau[im]);
       if (len(tau[im]) == 0.0) { tauderiv = 0.0; }
       else { tauderiv /= len(tau[im]); }
       if (tauderiv != tauderiv) tauderiv = 0.0;
@@ -1040,9 +1116,9 @@ double neb::g_new_maxflux()
       if (Rp1mag != Rp1mag) Rp1mag = 0.0;
       for (size_t i = 0; i < cPtr->size(); i++)
       {
-        Fvertical[i].x() = cPtr->g_xyz(i).x() - tauderiv * tau[im][i].x();
-        Fvertical[i].y() = cPtr->g_xyz(i).y() - tauderiv * tau[im][i].y();
-        Fvertical[i].z() = cPtr->g_xyz(i).z() - tauderiv * tau[im][i].z();
+        Fvertical[i].x() = image_g[i].x() - tauderiv * tau[im][i].x();
+        Fvertical[i].y() = image_g[i].y() - tauderiv * tau[im][i].y();
+        Fvertical[i].z() = image_g[i].z() - tauderiv * tau[im][i].z();
 
         Fpar[i].x() = springconstant * (Rp1mag - Rm1mag) * tau[im][i].x();
         Fpar[i].y() = springconstant * (Rp1mag - Rm1mag) * tau[im][i].y();
@@ -1055,19 +1131,20 @@ double neb::g_new_maxflux()
 
     for (size_t i = 0; i < cPtr->size(); i++)
     {
+      auto const& xyz = image_positions[im][i];   // fixed atoms stay where the coordinates object keeps them
       auto L = scon::geometric_length(tau[im][i]);
       if (L != 0.0)
       {
-        cosi2 = (cPtr->xyz(i).x() * tau[im][i].x() + cPtr->xyz(i).y() * tau[im][i].y() + cPtr->xyz(i).z() * tau[im][i].z()) / (L * L);
+        cosi2 = (xyz.x() * tau[im][i].x() + xyz.y() * tau[im][i].y() + xyz.z() * tau[im][i].z()) / (L * L);
       }
       else
       {
         cosi2 = 0.0;
       }
       if (cosi2 != cosi2)cosi2 = 0.0;
-      rv_n.x() = cPtr->xyz(i).x() - (cosi2 * tau[im][i].x());
-      rv_n.y() = cPtr->xyz(i).y() - (cosi2 * tau[im][i].y());
-      rv_n.z() = cPtr->xyz(i).z() - (cosi2 * tau[im][i].z());
+      rv_n.x() = xyz.x() - (cosi2 * tau[im][i].x());
+      rv_n.y() = xyz.y() - (cosi2 * tau[im][i].y());
+      rv_n.z() = xyz.z() - (cosi2 * tau[im][i].z());
 
       kappa = acos(dot(tau[im - 1][i], tau[im + 1][i])) / (len(imagi[im][i] - imagi[im - 1][i]) + len(imagi[im + 1][i] - imagi[im][i]));
       if (kappa != kappa)kappa = 0.0;
@@ -1076,15 +1153,28 @@ double neb::g_new_maxflux()
       rv_p.z() = (kappa / _KT_) * rv_n.z();
 
       auto const g = Fpar[i] + Fvertical[i] - rv_p;
-      cPtr->update_g_xyz(i, g);
+      if (!cPtr->atoms(i).fixed()) image_g[i] = g;
       grad_tot.push_back(g);
     }
 
   }
+  store_last_image();
 
   return energytemp;
 }
 
+/**
+* The coordinates object ends with the last image and its gradients including spring forces and projections
+* (as it did when the images were calculated in it one after another)
+*/
+
+void neb::store_last_image()
+{
+  if (num_images < 3u) return;
+  cPtr->set_xyz(imagi[num_images - 2u]);
+  cPtr->set_g_xyz(image_gradients[num_images - 2u], true);
+}
+
 void neb::calc_shift(void)
 {
   std::ptrdiff_t laf{ 0 };
@@ -27,9 +27,6 @@
 #include <iomanip>
 #include "interpolation.h"
 
-template<typename T>
-using dist_T = std::vector<std::vector<T>>;
-
 
 class neb
 {
@@ -54,17 +51,10 @@ public:
 
   void idpp_prep();
 
-  template<typename ContainerIt, typename Result>
-  void concatenate(ContainerIt, ContainerIt, Result);
-
-  std::vector<coords::Representation_3D> bond_dir(coords::Representation_3D const&);
-
-  template<typename T, typename Euclid>
-  std::vector<T> interpol_dist(Euclid&, Euclid&, size_t const);
-
-  template<typename T, typename Euclid>
-  coords::Representation_3D idpp_gradients(std::vector<coords::Representation_3D> const&,
-    Euclid&, Euclid&, Euclid&, size_t const);
+  /**gradients of the image dependent pair potential
+  @param image: structure of the image
+  @param im_no: number of the image (determines the interpolated target distances)*/
+  coords::Representation_3D idpp_gradients(coords::Representation_3D const& image, size_t const im_no) const;
 
 
 
@@ -125,6 +115,14 @@ public:
   void defix_all(void);
   void opt_internals(ptrdiff_t& count, const std::vector<std::vector<size_t> >& atoms_remember);
 
+  /**energies (and gradients) of the images first, ..., last-1 at the positions in imagi
+  (concurrently on copies of the coordinates object if NEB-PATHOPT-NEB-PARALLEL is switched on)*/
+  void evaluate_images(std::size_t const first, std::size_t const last, std::vector<double>& image_energies);
+  /**are images calculated at the same time? (NEB-PATHOPT-NEB-PARALLEL and supported by the interface)*/
+  bool images_in_parallel() const { return parallel_images; }
+  /**puts the last image and its projected gradients into the coordinates object*/
+  void store_last_image();
+
   double lbfgs();
   double lbfgs_int(std::vector <scon::c3 <float> > t);
   double lbfgs_maxflux();
@@ -142,7 +140,7 @@ public:
       //p->cPtr->set_xyz(std::move(scon::explicit_transform<ct>(x)));
       p->images_initial = scon::explicit_transform<ct>(x);
       float E = static_cast<float>(p->g_new());
-      go_on = p->cPtr->integrity();
+      go_on = p->images_intact;
       g = scon::explicit_transform<ot>(p->grad_tot);
       return E;
     }
@@ -161,7 +159,7 @@ public:
       //p->cPtr->set_xyz(std::move(scon::explicit_transform<ct>(x)));
       p->images_initial = scon::explicit_transform<ct>(x);
       float E = static_cast<float>(p->g_new_maxflux());
-      go_on = p->cPtr->integrity();
+      go_on = p->images_intact;
       g = scon::explicit_transform<ot>(p->grad_tot);
       return E;
     }
@@ -188,11 +186,30 @@ public:
 
 private:
 
-  std::vector<coords::Representation_3D> bond_st;
+  /**atom pair of the IDPP with its distances in the start and the final structure*/
+  struct idpp_pair
+  {
+    std::size_t i, j;
+    double d_start, d_final;
+  };
+  /**pairs that are closer than NEB-PATHOPT-NEB-IDPP_CUTOFF in the start or the final structure*/
+  std::vector<idpp_pair> idpp_pairs;
   coords::Representation_3D Fidpp;
-  std::vector<std::vector<double>> eu_st, eu_fi;
   // IDPP end
 
+  // image evaluation
+  /**are images evaluated at the same time?*/
+  bool parallel_images;
+  /**did all images of the last evaluation have a valid structure?*/
+  bool images_intact;
+  /**one copy of the coordinates object (and its interface) per image for parallel evaluation*/
+  std::vector<coords::Coordinates> image_coords;
+  /**gradients of the last evaluation of every image
+  (after g_new() and g_new_maxflux() with spring forces and projections for atoms that are not fixed)*/
+  std::vector<coords::Representation_3D> image_gradients;
+  /**positions of every image as the coordinates object has them (fixed atoms are not moved)*/
+  std::vector<coords::Representation_3D> image_positions;
+
   double springconstant;
   double tauderiv;
   double EnergyPml, EnergyPpl;
@@ -207,7 +224,4 @@ private:
 
 };
 
-enum { DIST = 0, ANGLE, DIHEDRAL }; //Juli
-
-template<typename T>
-dist_T<T> euclid_dist(coords::Representation_3D const&);
\ No newline at end of file
+enum { DIST = 0, ANGLE, DIHEDRAL }; //Juli
\ No newline at end of file
@@ -31,7 +31,8 @@
 /**
 * CONSTRUCTOR OF PATHX-CLASS AND INITIALIZATION OF GLOBAL VARIABLES
 */
-pathx::pathx(neb* NEB, coords::Coordinates* c) :_KT_(1 / (0.0019872966 * Config::get().neb.TEMPERATURE))
+pathx::pathx(neb* NEB, coords::Coordinates* c) :_KT_(1 / (0.0019872966 * Config::get().neb.TEMPERATURE)),
+  m_random_engine(static_cast<std::mt19937::result_type>(time(NULL) + pid_func()))
 {
   N = NEB;
   cPtr = c;
@@ -52,7 +53,54 @@ void pathx::pathx_ini()
   global_minima.resize(this->N->num_images);
   ptrdiff_t temp_image;
   temp_image = N->num_images;
-  for (ptrdiff_t i = 1; i < temp_image - 1; i++)
+  if (N->images_in_parallel())
+  {
+    /**
+    * the hyperplanes are independent of each other, so they are searched at the same time,
+    * every one with its own copy of the coordinates and of this object (counters, random numbers)
+    */
+    global_path_minima.resize(N->num_images);
+    global_path_minima_temp.resize(N->num_images);
+    global_path_minima_energy.resize(N->num_images);
+    std::vector<coords::Coordinates> image_coords(static_cast<std::size_t>(temp_image), *cPtr);
+    std::vector<pathx> image_paths(static_cast<std::size_t>(temp_image), *this);
+    for (ptrdiff_t i = 1; i < temp_image - 1; i++)
+    {
+      image_coords[i].set_xyz(N->imagi[i]);
+      image_paths[i].cPtr = &image_coords[i];
+      image_paths[i].m_random_engine.seed(m_random_engine());
+    }
+    auto const config = Config::snapshot();
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1)
+    for (ptrdiff_t i = 1; i < temp_image - 1; i++)
+    {
+      Config::local_scope scope(*config);
+      try
+      {
+        if (Config::get().neb.MCM_OPT) image_paths[i].MCM_PO(i);
+        else image_paths[i].MC_PO(i);
+        global_path_minima[i] = std::move(image_paths[i].global_path_minima[i]);
+        global_path_minima_temp[i] = std::move(image_paths[i].global_path_minima_temp[i]);
+        global_path_minima_energy[i] = std::move(image_paths[i].global_path_minima_energy[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical (pathopt_image_error)
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+    // endpoints are not searched, their lists get the same size as in a serial run
+    auto const n_minima = static_cast<std::size_t>(mciteration) * Config::get().neb.GLOBALITERATION;
+    for (auto i : { std::size_t(0u), static_cast<std::size_t>(temp_image - 1) })
+    {
+      global_path_minima[i].resize(n_minima);
+      global_path_minima_temp[i].resize(n_minima);
+      global_path_minima_energy[i].resize(n_minima);
+    }
+  }
+  else for (ptrdiff_t i = 1; i < temp_image - 1; i++)
   {
 
     N->num_images = temp_image;
@@ -97,7 +145,7 @@ void pathx::MCM_PO(ptrdiff_t opt)
   /**
   * initialize Boltzman and trial number generation
   */
-  double boltzman{ 0.0 }, trial = (double)rand() / (double)RAND_MAX;
+  double boltzman{ 0.0 }, trial = random_fraction();
   ptrdiff_t nancounter(0), nbad(0), status(0);
   bool  nanstatus(false);
   global_image = 0;
@@ -152,7 +200,7 @@ void pathx::MCM_PO(ptrdiff_t opt)
         for (size_t j = 0; j < cPtr->size(); j++)
         {
           randvect();
-          factor = mcstepsize * (double)rand() / (double)RAND_MAX;
+          factor = mcstepsize * random_fraction();
           scon::c3 <double> rv_p{ 3 };
           coords::Cartesian_Point RV;
           double abs = 0.0;
@@ -182,7 +230,7 @@ void pathx::MCM_PO(ptrdiff_t opt)
         for (size_t j = 0; j < cPtr->size(); j++)
         {
           randvect();
-          factor = mcstepsize * (double)rand() / (double)RAND_MAX;
+          factor = mcstepsize * random_fraction();
           scon::c3 <double> rv_p{ 3 };
           coords::Cartesian_Point RV;
           double abs = 0.0;
@@ -255,7 +303,7 @@ void pathx::MCM_PO(ptrdiff_t opt)
       {
         nbad = 0;
         boltzman = exp(-_KT_ * (MCmin - MCpmin_vec[mcstep]));
-        trial = (double)rand() / (double)RAND_MAX;
+        trial = random_fraction();
         if (boltzman < trial)
         {
           status = 0;
@@ -301,7 +349,8 @@ void pathx::MCM_PO(ptrdiff_t opt)
         global_image = opt;
         std::ostringstream struc_opt;
         struc_opt << "PATHOPT_STRUCTURES_" << cPtr->mult_struc_counter << "_" << opt << ".arc";
-        output << mcstep << "    " << opt << "    " << std::right << std::fixed << std::setprecision(6) << MCEN << "\n";
+#pragma omp critical (pathopt_energies_output)
+        output << mcstep << "    " << opt << "    " << std::right << std::fixed << std::setprecision(6) << MCEN << std::endl;
         counter++;
         global_path_minima_energy[opt][counter] = MCEN;
         for (size_t i = 0; i < cPtr->size(); i++)
@@ -323,7 +372,7 @@ void pathx::MC_PO(ptrdiff_t opt)
   /**
   * initialize Boltzman and trial number generation
   */
-  double boltzman{ 0.0 }, trial = (double)rand() / (double)RAND_MAX, start_image_energy{ 0.0 };
+  double boltzman{ 0.0 }, trial = random_fraction(), start_image_energy{ 0.0 };
   ptrdiff_t nancounter(0), nbad(0), status(0), same_counter(0);
   bool  nanstatus(false);
   global_image = 0;
@@ -343,7 +392,6 @@ void pathx::MC_PO(ptrdiff_t opt)
   for (size_t t = 0; t < Config::get().neb.GLOBALITERATION; t++)
   {
     std::cout << "global iterator: " << t << "\n";
-    srand((unsigned int)time(NULL) + pid_func());
     for (size_t i = 0; i < global_path_minima.size(); i++)
     {
       global_path_minima[i].resize(mciteration * (t + 1));
@@ -386,7 +434,7 @@ void pathx::MC_PO(ptrdiff_t opt)
         for (size_t j = 0; j < cPtr->size(); j++)
         {
           randvect();
-          factor = mcstepsize * (double)rand() / (double)RAND_MAX;
+          factor = mcstepsize * random_fraction();
           scon::c3 <double> rv_p{ 3 };
           coords::Cartesian_Point RV;
           double abs = 0.0;
@@ -416,7 +464,7 @@ void pathx::MC_PO(ptrdiff_t opt)
         for (size_t j = 0; j < cPtr->size(); j++)
         {
           randvect();
-          factor = mcstepsize * (double)rand() / (double)RAND_MAX;
+          factor = mcstepsize * random_fraction();
           scon::c3 <double> rv_p{ 3 };
           coords::Cartesian_Point RV;
           double abs = 0.0;
@@ -487,7 +535,7 @@ void pathx::MC_PO(ptrdiff_t opt)
       {
         nbad = 0;
         boltzman = exp(-_KT_ * (MCmin - start_image_energy));
-        trial = (double)rand() / (double)RAND_MAX;
+        trial = random_fraction();
         if (boltzman < trial)
         {
           status = 0;
@@ -564,7 +612,8 @@ void pathx::MC_PO(ptrdiff_t opt)
         global_image = opt;
         std::ostringstream struc_opt;
         struc_opt << "PATHOPT_STRUCTURES_" << cPtr->mult_struc_counter << "_" << opt << ".arc";
-        output << mcstep << "    " << opt << "    " << std::right << std::fixed << std::setprecision(6) << MCEN << "\n";
+#pragma omp critical (pathopt_energies_output)
+        output << mcstep << "    " << opt << "    " << std::right << std::fixed << std::setprecision(6) << MCEN << std::endl;
         counter++;
         global_path_minima_energy[opt][counter] = MCEN;
         for (size_t i = 0; i < cPtr->size(); i++)
@@ -621,19 +670,28 @@ void pathx::proof_connect()
 
     }
   }
-  ///caclulating the rmsd value starting from hyperplane n to n+1
+  ///caclulating the rmsd value starting from hyperplane n to n+1 (minimum RMSD via QCP, every row on its own)
+  std::vector<std::pair<ptrdiff_t, size_t>> rmsd_rows;
   for (ptrdiff_t i = 1; i < temp_image - 1; i++)
   {
-    N->num_images = temp_image;
     for (size_t j = 0; j < global_path_minima[i].size(); j++)
     {
-      for (size_t n = 0; n < global_path_minima[i].size(); n++)
-      {
-        if (global_path_minima[i][j].empty())continue;
-        auto rmsd1 = root_mean_square_deviation(global_path_minima[i][j], global_path_minima[i + 1][n]);
-        if (rmsd1 == 0.0 || rmsd1 != rmsd1)continue;
-        RMSD[i][j].push_back(rmsd1);
-      }
+      if (!global_path_minima[i][j].empty()) rmsd_rows.emplace_back(i, j);
+    }
+  }
+  auto const n_rows = static_cast<ptrdiff_t>(rmsd_rows.size());
+#pragma omp parallel for schedule(dynamic, 4)
+  for (ptrdiff_t r = 0; r < n_rows; r++)
+  {
+    auto const i = rmsd_rows[r].first;
+    auto const j = rmsd_rows[r].second;
+    for (size_t n = 0; n < global_path_minima[i].size(); n++)
+    {
+      auto const& partner = global_path_minima[i + 1][n];
+      if (partner.size() != global_path_minima[i][j].size()) continue;
+      auto rmsd1 = align::rmsd_qcp(global_path_minima[i][j], partner);
+      if (rmsd1 == 0.0 || rmsd1 != rmsd1)continue;
+      RMSD[i][j].push_back(rmsd1);
     }
   }
   /// loop over the first next up to the third nearest neighbors
@@ -796,8 +854,8 @@ void pathx::randvect(void)
   double x(0.0), y(0.0), s(0.0);
   s = 2.0;
   while (s >= 1.0) {
-    x = 2.0 * (double)rand() / (double)RAND_MAX - 1.0;
-    y = 2.0 * (double)rand() / (double)RAND_MAX - 1.0;
+    x = 2.0 * random_fraction() - 1.0;
+    y = 2.0 * random_fraction() - 1.0;
     s = x * x + y * y;
   }
   randvec[2] = 1.0 - 2.0 * s;
@@ -951,14 +1009,14 @@ void pathx::move_main(perp_point& direction)
   coords::Representation_Main main_tors(NUM), bla(NUM);
   /// choose number of torsions to modify
   coords::float_type const NUM_MAINS(static_cast<coords::float_type>(NUM));
-  size_t const NUM_MOD(std::min((static_cast<size_t>(-std::log(scon::rand<coords::float_type>(0.0, 1.0))) + 1U), NUM));
+  size_t const NUM_MOD(std::min((static_cast<size_t>(-std::log(random_fraction())) + 1U), NUM));
   /// apply those torsions
   if (Config::get().general.verbosity > 4) std::cout << "Changing " << NUM_MOD << " of " << NUM << " mains.\n";
   for (size_t i(0U); i < NUM_MOD; ++i)
   {
-    size_t const K(static_cast<size_t>(NUM_MAINS * scon::rand<coords::float_type>(0.0, 1.0)));
-    coords::float_type const F = scon::rand<coords::float_type>(-Config::get().optimization.global.montecarlo.dihedral_max_rot,
-      Config::get().optimization.global.montecarlo.dihedral_max_rot);
+    size_t const K(static_cast<size_t>(NUM_MAINS * random_fraction()));
+    coords::float_type const F = std::uniform_real_distribution<coords::float_type>(-Config::get().optimization.global.montecarlo.dihedral_max_rot,
+      Config::get().optimization.global.montecarlo.dihedral_max_rot)(m_random_engine);
     if (Config::get().general.verbosity > 4) std::cout << "Changing main " << K << " by " << F << '\n';
     main_tors[K] = coords::main_type::from_deg(F);
   }
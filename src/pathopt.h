@@ -19,6 +19,7 @@
 #include "neb.h"
 #include <cstdlib>
 #include <iomanip>
+#include <random>
 
 
 
@@ -31,6 +32,10 @@ private:
   double STARTENERGY, ENDENERGY, MCEN;
   std::vector<double>  MCcoordglob, MCcoordlast, MCcoordin;
   const double _KT_;
+  /**random numbers of the MC search (every hyperplane has its own engine if they are searched at the same time)*/
+  std::mt19937 m_random_engine;
+  /**uniformly distributed random number in [0, 1)*/
+  double random_fraction() { return std::uniform_real_distribution<double>(0.0, 1.0)(m_random_engine); }
   std::vector <std::vector <double> > global_path_minima_energy;
   std::vector < std::vector <coords::Representation_3D> >  global_path_minima, global_path_minima_temp;
 
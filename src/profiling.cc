@@ -0,0 +1,113 @@
+#include "profiling.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "configuration.h"
+
+profiling::profiler& profiling::profiler::get()
+{
+  static profiler instance;
+  return instance;
+}
+
+bool profiling::profiler::active()
+{
+  return Config::get().profiling.use;
+}
+
+void profiling::profiler::add_time(std::string const& name, double const seconds)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  auto& p = data[name];
+  ++p.calls;
+  p.total += seconds;
+  p.min = std::min(p.min, seconds);
+  p.max = std::max(p.max, seconds);
+}
+
+void profiling::profiler::count(std::string const& name, std::size_t const n)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  data[name].count += n;
+}
+
+std::map<std::string, profiling::phase> profiling::profiler::phases() const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return data;
+}
+
+void profiling::profiler::reset()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  data.clear();
+}
+
+void profiling::profiler::print_report(std::ostream& S) const
+{
+  auto const current = phases();
+  S << std::left << std::setw(40) << "Phase";
+  S << std::right << std::setw(12) << "Calls";
+  S << std::right << std::setw(16) << "Total [s]";
+  S << std::right << std::setw(16) << "Average [s]";
+  S << std::right << std::setw(16) << "Max [s]";
+  S << std::right << std::setw(12) << "Count" << '\n';
+  for (auto const& p : current)
+  {
+    S << std::left << std::setw(40) << p.first;
+    S << std::right << std::setw(12) << p.second.calls;
+    S << std::right << std::setw(16) << std::fixed << std::setprecision(6) << p.second.total;
+    S << std::right << std::setw(16) << p.second.average();
+    S << std::right << std::setw(16) << p.second.max;
+    S << std::right << std::setw(12) << p.second.count << '\n';
+  }
+  S.unsetf(std::ios_base::floatfield);
+}
+
+void profiling::profiler::write_json(std::ostream& S) const
+{
+  auto const current = phases();
+  S << "{\n  \"phases\": [";
+  bool first = true;
+  for (auto const& p : current)
+  {
+    S << (first ? "\n" : ",\n");
+    first = false;
+    S << "    { \"name\": \"" << p.first << "\"";
+    S << ", \"calls\": " << p.second.calls;
+    S << ", \"total\": " << std::setprecision(9) << p.second.total;
+    S << ", \"average\": " << p.second.average();
+    S << ", \"min\": " << (p.second.calls > 0u ? p.second.min : 0.0);
+    S << ", \"max\": " << p.second.max;
+    S << ", \"count\": " << p.second.count << " }";
+  }
+  S << "\n  ]\n}\n";
+}
+
+void profiling::profiler::write_csv(std::ostream& S) const
+{
+  auto const current = phases();
+  S << "name,calls,total,average,min,max,count\n";
+  for (auto const& p : current)
+  {
+    S << p.first << "," << p.second.calls << "," << std::setprecision(9) << p.second.total << ",";
+    S << p.second.average() << "," << (p.second.calls > 0u ? p.second.min : 0.0) << ",";
+    S << p.second.max << "," << p.second.count << "\n";
+  }
+}
+
+void profiling::profiler::write_summary() const
+{
+  auto const& conf = Config::get().profiling;
+  if (conf.format == config::profiling::formats::CSV)
+  {
+    std::ofstream summary(Config::get().general.outputFilename + "_PROFILE.csv");
+    write_csv(summary);
+  }
+  else
+  {
+    std::ofstream summary(Config::get().general.outputFilename + "_PROFILE.json");
+    write_json(summary);
+  }
+}
@@ -0,0 +1,134 @@
+/**
+CAST 3
+profiling.h
+Purpose: scoped timers and counters to find out where the time of an MD step,
+         a force field evaluation or a QM call is spent
+
+@version 1.0
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include "Scon/scon_chrono.h"
+
+/**namespace for performance measurements*/
+namespace profiling
+{
+  /**accumulated data of one named phase*/
+  struct phase
+  {
+    /**number of timed calls*/
+    std::size_t calls{ 0u };
+    /**total wall time in seconds*/
+    double total{ 0.0 };
+    /**shortest call in seconds*/
+    double min{ std::numeric_limits<double>::max() };
+    /**longest call in seconds*/
+    double max{ 0.0 };
+    /**value of event counter (see profiler::count())*/
+    std::size_t count{ 0u };
+
+    /**average wall time per call in seconds*/
+    double average() const { return calls > 0u ? total / static_cast<double>(calls) : 0.0; }
+  };
+
+  /**global collection of all phases
+  access is thread-safe so timers can be used inside OpenMP regions*/
+  class profiler
+  {
+  public:
+
+    /**returns the global profiler*/
+    static profiler& get();
+
+    /**are timings collected in this run? (option PROFILEuse)*/
+    static bool active();
+
+    /**add one timed call to phase
+    @param name: name of the phase
+    @param seconds: wall time of the call*/
+    void add_time(std::string const& name, double const seconds);
+
+    /**increment event counter of phase
+    @param name: name of the phase
+    @param n: increment*/
+    void count(std::string const& name, std::size_t const n = 1u);
+
+    /**returns a copy of all phases collected so far*/
+    std::map<std::string, phase> phases() const;
+
+    /**delete all collected data*/
+    void reset();
+
+    /**print a human readable table of all phases*/
+    void print_report(std::ostream&) const;
+    /**write all phases as JSON object*/
+    void write_json(std::ostream&) const;
+    /**write all phases as CSV table (one line per phase)*/
+    void write_csv(std::ostream&) const;
+    /**write summary file in the format given by PROFILEformat
+    filename is outputFilename + "_PROFILE.json" or "_PROFILE.csv"*/
+    void write_summary() const;
+
+  private:
+
+    profiler() = default;
+
+    mutable std::mutex mtx;
+    std::map<std::string, phase> data;
+  };
+
+  /**timer that adds the lifetime of its scope to a phase
+  does not even read the clock if profiling is switched off*/
+  class scoped_timer
+  {
+  public:
+
+    /**start timer
+    @param phase_name: name of the phase (has to outlive the timer, normally a string literal)*/
+    explicit scoped_timer(char const* phase_name)
+      : name(phase_name), running(profiler::active()), start()
+    {
+      if (running) start = scon::chrono::high_resolution_clock::now();
+    }
+
+    ~scoped_timer() { stop(); }
+
+    scoped_timer(scoped_timer const&) = delete;
+    scoped_timer& operator= (scoped_timer const&) = delete;
+
+    /**stop timer before the end of the scope*/
+    void stop()
+    {
+      if (!running) return;
+      running = false;
+      auto const elapsed = scon::chrono::high_resolution_clock::now() - start;
+      profiler::get().add_time(name, scon::chrono::to_seconds<double>(elapsed));
+    }
+
+    /**start the timer again (the next stop() adds another call to the phase)*/
+    void restart()
+    {
+      stop();
+      running = profiler::active();
+      if (running) start = scon::chrono::high_resolution_clock::now();
+    }
+
+  private:
+    char const* name;
+    bool running;
+    scon::chrono::high_resolution_clock::time_point start;
+  };
+
+  /**increment event counter of a phase if profiling is switched on*/
+  inline void count(char const* name, std::size_t const n = 1u)
+  {
+    if (profiler::active()) profiler::get().count(name, n);
+  }
+}
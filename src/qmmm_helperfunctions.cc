@@ -1,4 +1,7 @@
+#include<cmath>
+#include<limits>
 #include"qmmm_helperfunctions.h"
+#include"Scon/scon_linkedcell.h"
 
 /**constructor for LinkAtom*/
 LinkAtom::LinkAtom(unsigned int b, unsigned int a, int atomtype, coords::Coordinates* coords, tinker::parameter::parameters const& tp) : qm(b), mm(a), energy_type(atomtype)
@@ -250,6 +253,48 @@ std::vector<coords::float_type> energy::interfaces::qmmm::select_from_atomcharge
   return charges_temp;
 }
 
+std::vector<std::size_t> energy::interfaces::qmmm::find_mm_atoms_near_qm(std::vector<std::size_t> const& qm_indices, std::vector<std::size_t> const& mm_indices,
+  coords::Representation_3D const& xyz, double const cutoff)
+{
+  std::vector<std::size_t> near_atoms;
+  if (qm_indices.empty()) return near_atoms;
+
+  coords::Representation_3D qm_positions;
+  qm_positions.reserve(qm_indices.size());
+  for (auto i : qm_indices) qm_positions.push_back(xyz[i]);
+
+  // cells only contain QM atoms, space around them is extended by cutoff so every MM atom outside of the cells can be skipped
+  using cells_type = scon::linked::Cells<coords::float_type, coords::Cartesian_Point, coords::Representation_3D>;
+  cells_type cells(qm_positions, cutoff, false, {}, cutoff);
+
+  double const cutoff2 = cutoff * cutoff;
+  std::vector<char> is_near(mm_indices.size(), 0);
+  std::ptrdiff_t const M = static_cast<std::ptrdiff_t>(mm_indices.size());
+#pragma omp parallel for schedule(dynamic, 256)
+  for (std::ptrdiff_t j = 0; j < M; ++j)
+  {
+    auto const& p = xyz[mm_indices[j]];
+    if (!cells.is_in_cells(p)) continue;
+    auto const box_of_p = cells.box_of_point(p);   // adjacencies() keeps a reference to the box, so it must not be a temporary
+    for (auto q : box_of_p.adjacencies())          // QM atoms in the same and in neighbouring cells
+    {
+      if (q < 0) continue;
+      auto const r = p - qm_positions[static_cast<std::size_t>(q)];
+      if (dot(r, r) <= cutoff2)
+      {
+        is_near[j] = 1;
+        break;
+      }
+    }
+  }
+
+  for (auto j = 0u; j < is_near.size(); ++j)
+  {
+    if (is_near[j]) near_atoms.emplace_back(j);
+  }
+  return near_atoms;
+}
+
 void energy::interfaces::qmmm::move_periodics(coords::Cartesian_Point& current_coords, coords::Cartesian_Point const& center_of_QM)
 {
   // determine vector to QM system
@@ -338,130 +383,184 @@ std::vector<std::size_t> energy::interfaces::qmmm::get_indices_of_several_QMcent
   return result;
 }
 
-void energy::interfaces::qmmm::add_external_charges(std::vector<size_t> const& ignore_indizes,
-  std::vector<double> const& charges, std::vector<size_t> const& indizes_of_charges,
-  std::vector<LinkAtom> const& link_atoms, std::vector<int>& charge_indizes, coords::Coordinates* coords, std::size_t const QMcenter)
+energy::interfaces::qmmm::ExternalCharges::ExternalCharges(std::vector<size_t> const& ignore_indizes, std::vector<size_t> const& indizes_of_charges,
+  std::vector<LinkAtom> const& link_atoms, coords::Coordinates const* coords)
 {
-  auto center_of_QM = coords->xyz(QMcenter);   // center from where cutoff is defined
+  std::vector<char> ignore(coords->size(), 0);
+  for (auto i : ignore_indizes) ignore[i] = 1;   // ignore atoms which are destined to be ignored...
 
-  for (auto i : indizes_of_charges)  // go through all atoms from which charges are looked at
+  for (auto& l : link_atoms)  // ...and those that are connected to an atom of the "QM system"
   {
-    bool use_charge = true;       // should current charge be added at all?
-    double scaling_factor = 1.0;  // scaling factor
-    double dist{ 0.0 };           // distance to QM center
-
-    for (auto& l : link_atoms)      // look at every link atom
+    ignore[l.mm] = 1;
+    if (Config::get().energy.qmmm.zerocharge_bonds > 1)   // if desired: also ignore atoms that are two bonds away from "QM system"
     {
-      if (l.mm == i) use_charge = false;   // ignore those atoms that are connected to an atom to the "QM system"...
-      else
+      for (auto b : coords->atoms(l.mm).bonds())
       {
-        if (Config::get().energy.qmmm.zerocharge_bonds > 1)   // if desired: also ignore atoms that are two bonds away from "QM system"
+        ignore[b] = 1;
+        if (Config::get().energy.qmmm.zerocharge_bonds > 2)  // if desired: also ignore atoms that are three bonds away from "QM system"
         {
-          for (auto b : coords->atoms(i).bonds())
-          {
-            if (b == l.mm) use_charge = false;
-
-            else
-            {
-              if (Config::get().energy.qmmm.zerocharge_bonds > 2)  // if desired: also ignore atoms that are three bonds away from "QM system"
-              {
-                for (auto b2 : coords->atoms(b).bonds())
-                {
-                  if (b2 == l.mm) use_charge = false;
-                }
-              }
-            }
-          }
+          for (auto b2 : coords->atoms(b).bonds()) ignore[b2] = 1;
         }
       }
     }
-    for (auto& qs : ignore_indizes) // ...and those which are destined to be ignored
-    {
-      if (qs == i) use_charge = false;
-    }
+  }
+
+  for (auto k = 0u; k < indizes_of_charges.size(); ++k)
+  {
+    if (ignore[indizes_of_charges[k]]) continue;
+    atoms.emplace_back(indizes_of_charges[k]);
+    charge_positions.emplace_back(k);
+  }
+}
+
+void energy::interfaces::qmmm::ExternalCharges::add(std::vector<double> const& charges, std::vector<int>& charge_indizes,
+  coords::Coordinates const* coords, std::size_t const QMcenter, std::vector<PointCharge>& point_charges) const
+{
+  auto center_of_QM = coords->xyz(QMcenter);   // center from where cutoff is defined
+  double const& cutoff = Config::get().energy.qmmm.cutoff;
+  bool const drop_far_charges = Config::get().energy.qmmm.drop_far_charges && cutoff != 0.0;
+
+  for (auto k = 0u; k < atoms.size(); ++k)
+  {
+    auto const i = atoms[k];
+    auto current_xyz = coords->xyz(i);                                         // coordinates of current charge
+    if (Config::get().periodics.periodic) move_periodics(current_xyz, center_of_QM);  // if periodics: move charge next to QM
 
-    if (use_charge)  // for the other 
+    double scaling_factor = 1.0;  // scaling factor
+    if (cutoff != 0.0)  // if cutoff given: test if central QM atom is nearer than cutoff
     {
-      if (Config::get().energy.qmmm.cutoff != 0.0)  // if cutoff given: test if central QM atom is nearer than cutoff
+      double const dist = len(current_xyz - center_of_QM);   // apply cutoff (with switching)
+      if (dist < cutoff)
       {
-        auto current_coords = coords->xyz(i);                                        // coordinates of current charge
+        scaling_factor = (1 - (dist * dist) / (cutoff * cutoff)) * (1 - (dist * dist) / (cutoff * cutoff)); // scaling factor, see https://doi.org/10.1002/jcc.540150702, equation 6
+      }
+      else if (drop_far_charges) continue;   // charge doesn't contribute anyway
+      else scaling_factor = 0.0;   // if dist > cutoff -> create zero charge (but original charge is still saved)
+    }
 
-        if (Config::get().periodics.periodic)    // if periodic boundaries -> move current_coords next to QM 
-        {
-          move_periodics(current_coords, center_of_QM);
-        }
+    PointCharge new_charge;
+    new_charge.original_charge = charges[charge_positions[k]];
+    new_charge.scaled_charge = new_charge.original_charge * scaling_factor;
+    new_charge.set_xyz(current_xyz.x(), current_xyz.y(), current_xyz.z());
+    point_charges.emplace_back(new_charge);
 
-        dist = len(current_coords - center_of_QM);   // apply cutoff (with switching)
-        if (dist < Config::get().energy.qmmm.cutoff)
-        {
-          double const& cutoff = Config::get().energy.qmmm.cutoff;
-          scaling_factor = (1 - (dist * dist) / (cutoff * cutoff)) * (1 - (dist * dist) / (cutoff * cutoff)); // scaling factor, see https://doi.org/10.1002/jcc.540150702, equation 6
-        }
-        else scaling_factor = 0.0;   // if dist > cutoff -> create zero charge (but original charge is still saved)
+    charge_indizes.push_back(static_cast<int>(i));  // add index to charge_indices
+  }
+}
+
+std::vector<energy::PointCharge> energy::interfaces::qmmm::add_external_charges(std::vector<size_t> const& ignore_indizes,
+  std::vector<double> const& charges, std::vector<size_t> const& indizes_of_charges,
+  std::vector<LinkAtom> const& link_atoms, std::vector<int>& charge_indizes, coords::Coordinates* coords, std::size_t const QMcenter)
+{
+  std::vector<PointCharge> point_charges;
+  ExternalCharges(ignore_indizes, indizes_of_charges, link_atoms, coords).add(charges, charge_indizes, coords, QMcenter, point_charges);
+  return point_charges;
+}
+
+double energy::interfaces::qmmm::frozen_coulomb(std::vector<PointCharge> const& point_charges, std::vector<int> const& charge_indizes,
+  std::vector<std::size_t> const& qm_indizes, std::vector<double> const& qm_charges, coords::Coordinates const* coords,
+  std::size_t const QMcenter, coords::Gradients_3D* gradients)
+{
+  double constexpr elec_factor = 332.06;
+  double const c = Config::get().energy.qmmm.cutoff;
+  bool const switched = c != 0.0 && c != std::numeric_limits<double>::max();
+  auto const& center = coords->xyz(QMcenter);
+
+  double energy{ 0.0 };
+  for (std::size_t k = 0u; k < point_charges.size(); ++k)
+  {
+    auto const& charge = point_charges[k];
+    if (charge.scaled_charge == 0.0) continue;
+    coords::r3 const position(charge.x, charge.y, charge.z);
+    double const scaling = charge.scaled_charge / charge.original_charge;
+
+    double U{ 0.0 };   // sum(Q_qm * Q_ext / r) with unscaled external charge
+    coords::r3 dU{ 0.0, 0.0, 0.0 };
+    for (std::size_t i = 0u; i < qm_indizes.size(); ++i)
+    {
+      auto const r = position - coords->xyz(qm_indizes[i]);
+      double const d = len(r);
+      double const e = qm_charges[i] * charge.original_charge * elec_factor / d;
+      U += e;
+      if (gradients)
+      {
+        auto const g = r * (-e * scaling / (d * d));
+        dU += g;
+        (*gradients)[qm_indizes[i]] -= g;
       }
+    }
+    energy += scaling * U;
 
-      if (use_charge)  // if yes create a PointCharge and add it to vector
+    if (gradients)
+    {
+      if (switched)   // scaling factor (1 - d^2/c^2)^2 depends on distance to center of QM region
       {
-        PointCharge new_charge;
-        new_charge.scaled_charge = charges[find_index(i, indizes_of_charges)] * scaling_factor;
-        new_charge.original_charge = charges[find_index(i, indizes_of_charges)];
-        auto current_xyz = coords->xyz(i);
-        if (Config::get().periodics.periodic) move_periodics(current_xyz, center_of_QM);  // if periodics: move charge next to QM
-        new_charge.set_xyz(current_xyz.x(), current_xyz.y(), current_xyz.z());
-        interface_base::add_external_charge(new_charge);
-
-        charge_indizes.push_back(i);  // add index to charge_indices
+        auto const deriv_S = (position - center) * (-4.0 * std::sqrt(scaling) / (c * c) * U);
+        dU += deriv_S;
+        (*gradients)[QMcenter] -= deriv_S;
       }
+      (*gradients)[charge_indizes[k]] += dU;
     }
   }
+  return energy;
 }
 
-void energy::interfaces::qmmm::save_outputfiles(config::interface_types::T const& interface, std::string const& id, std::string const& systemname)
+void energy::interfaces::qmmm::save_outputfiles(config::interface_types::T const& interface, std::string const& id, std::string const& systemname,
+  std::string const& directory)
 {
+  // files inside a scratch directory are moved into the working directory
+  auto in_dir = [&directory](std::string const& filename) {
+    return directory.empty() ? filename : directory + "/" + filename;
+  };
+  auto keep = [&in_dir](std::string const& filename, std::string const& new_name) {
+    if (file_exists(in_dir(filename))) rename(in_dir(filename).c_str(), new_name.c_str());
+  };
+
   if (interface == config::interface_types::T::DFTB && Config::get().energy.dftb.verbosity > 0)
   {
-    if (file_exists("dftb_in.hsd")) rename("dftb_in.hsd", ("dftb_in_" + systemname + ".hsd").c_str());
-    if (file_exists("output_dftb.txt")) rename("output_dftb.txt", ("output_dftb_" + systemname + ".txt").c_str());
-    if (file_exists("charges.dat")) rename("charges.dat", ("charges_" + systemname + ".dat").c_str());
-    if (file_exists("results.tag")) rename("results.tag", ("results_" + systemname + ".tag").c_str());
+    keep("dftb_in.hsd", "dftb_in_" + systemname + ".hsd");
+    keep("output_dftb.txt", "output_dftb_" + systemname + ".txt");
+    keep("charges.dat", "charges_" + systemname + ".dat");
+    keep("results.tag", "results_" + systemname + ".tag");
   }
   if (interface == config::interface_types::T::MOPAC && Config::get().energy.mopac.delete_input == false)
   {
-    if (file_exists(id + ".xyz")) rename((id + ".xyz").c_str(), (id + "_" + systemname + ".xyz").c_str());
-    if (file_exists(id + ".out")) rename((id + ".out").c_str(), (id + "_" + systemname + ".out").c_str());
-    if (file_exists(id + ".arc")) rename((id + ".arc").c_str(), (id + "_" + systemname + ".arc").c_str());
-    if (file_exists(id + "_sys.out")) rename((id + "_sys.out").c_str(), (id + "_" + systemname + "_sys.out").c_str());
-    if (file_exists(id + ".xyz.out")) rename((id + ".xyz.out").c_str(), (id + "_" + systemname + ".xyz.out").c_str());
-    if (file_exists(id + ".xyz.aux")) rename((id + ".xyz.aux").c_str(), (id + "_" + systemname + ".xyz.aux").c_str());
-    if (file_exists("mol.in")) rename("mol.in", ("mol_" + systemname + ".in").c_str());
+    keep(id + ".xyz", id + "_" + systemname + ".xyz");
+    keep(id + ".out", id + "_" + systemname + ".out");
+    keep(id + ".arc", id + "_" + systemname + ".arc");
+    keep(id + "_sys.out", id + "_" + systemname + "_sys.out");
+    keep(id + ".xyz.out", id + "_" + systemname + ".xyz.out");
+    keep(id + ".xyz.aux", id + "_" + systemname + ".xyz.aux");
+    keep("mol.in", "mol_" + systemname + ".in");
   }
   if (interface == config::interface_types::T::GAUSSIAN && Config::get().energy.gaussian.delete_input == false)
   {
-    if (file_exists(id + ".gjf")) rename((id + ".gjf").c_str(), (id + "_" + systemname + ".gjf").c_str());
-    if (file_exists(id + ".log")) rename((id + ".log").c_str(), (id + "_" + systemname + ".log").c_str());
-    if (file_exists(id + "_G_.gjf")) rename((id + "_G_.gjf").c_str(), (id + "_G_" + systemname + ".gjf").c_str());
-    if (file_exists(id + "_G_.log")) rename((id + "_G_.log").c_str(), (id + "_G_" + systemname + ".log").c_str());
+    keep(id + ".gjf", id + "_" + systemname + ".gjf");
+    keep(id + ".log", id + "_" + systemname + ".log");
+    keep(id + "_G_.gjf", id + "_G_" + systemname + ".gjf");
+    keep(id + "_G_.log", id + "_G_" + systemname + ".log");
   }
   if (interface == config::interface_types::T::PSI4)
   {
-    if (file_exists(id + "_inp.dat")) rename((id + "_inp.dat").c_str(), (id + "_" + systemname + "_inp.dat").c_str());
-    if (file_exists(id + "_out.dat")) rename((id + "_out.dat").c_str(), (id + "_" + systemname + "_out.dat").c_str());
-    if (file_exists("grid.dat")) rename("grid.dat", ("grid_" + systemname + ".dat").c_str());
-    if (file_exists("grid_field.dat")) rename("grid_field.dat", ("grid_field_" + systemname + ".dat").c_str());
+    keep(id + "_inp.dat", id + "_" + systemname + "_inp.dat");
+    keep(id + "_out.dat", id + "_" + systemname + "_out.dat");
+    keep("grid.dat", "grid_" + systemname + ".dat");
+    keep("grid_field.dat", "grid_field_" + systemname + ".dat");
   }
   if (interface == config::interface_types::T::ORCA)
   {
-    if (file_exists("orca.ges")) rename("orca.ges", ("orca_" + systemname + ".ges").c_str());
-    if (file_exists("orca.prop")) rename("orca.prop", ("orca_" + systemname + ".prop").c_str());
-    if (file_exists("orca.opt")) rename("orca.opt", ("orca_" + systemname + ".opt").c_str());
-    if (file_exists("orca.trj")) rename("orca.trj", ("orca_" + systemname + ".trj").c_str());
-    if (file_exists("orca.engrad")) rename("orca.engrad", ("orca_" + systemname + ".engrad").c_str());
-    if (file_exists("orca_property.txt")) rename("orca_property.txt", ("orca_property_" + systemname + ".txt").c_str());
-    if (file_exists("orca.xyz")) rename("orca.xyz", ("orca_" + systemname + ".xyz").c_str());
-    if (file_exists("orca.hess")) rename("orca.hess", ("orca_" + systemname + ".hess").c_str());
-    if (file_exists("orca.inp")) rename("orca.inp", ("orca_" + systemname + ".inp").c_str());
-    if (file_exists("pointcharges.pc")) rename("pointcharges.pc", ("pointcharges_" + systemname + ".pc").c_str());
-    if (file_exists("output_orca.txt")) rename("output_orca.txt", ("output_orca_" + systemname + ".txt").c_str());
-    if (file_exists("orca.gbw")) std::remove("orca.gbw");       // this is important because otherwise orca will try to read MOs from other system
+    keep("orca.ges", "orca_" + systemname + ".ges");
+    keep("orca.prop", "orca_" + systemname + ".prop");
+    keep("orca.opt", "orca_" + systemname + ".opt");
+    keep("orca.trj", "orca_" + systemname + ".trj");
+    keep("orca.engrad", "orca_" + systemname + ".engrad");
+    keep("orca_property.txt", "orca_property_" + systemname + ".txt");
+    keep("orca.xyz", "orca_" + systemname + ".xyz");
+    keep("orca.hess", "orca_" + systemname + ".hess");
+    keep("orca.inp", "orca_" + systemname + ".inp");
+    keep("pointcharges.pc", "pointcharges_" + systemname + ".pc");
+    keep("output_orca.txt", "output_orca_" + systemname + ".txt");
+    // this is important because otherwise orca will try to read MOs from other system (not needed if every system has its own directory)
+    if (directory.empty() && file_exists("orca.gbw")) std::remove("orca.gbw");
   }
 }
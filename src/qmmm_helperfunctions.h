@@ -10,6 +10,7 @@ Purpose: some stuff that is used by all QM/MM interfaces, i. e. additive and sub
 #ifndef QMMM_HELPERFUNCTIONS_H
 #define QMMM_HELPERFUNCTIONS_H
 
+#include<future>
 #include<vector>
 #include"atomic.h"
 #include"configuration.h"
@@ -129,6 +130,16 @@ namespace energy
       all other charges are removed*/
       std::vector<coords::float_type> select_from_atomcharges(std::vector<std::size_t> const& indices, coords::Coordinates const* cp);
 
+      /**finds all MM atoms that are closer than a cutoff to at least one QM atom
+      (linked cells with the cutoff as edge length are built around the QM region, periodic boundaries are not taken into account)
+      @param qm_indices: indizes of QM atoms
+      @param mm_indices: indizes of MM atoms
+      @param xyz: positions of all atoms
+      @param cutoff: cutoff distance
+      returns the positions of these atoms in mm_indices (sorted)*/
+      std::vector<std::size_t> find_mm_atoms_near_qm(std::vector<std::size_t> const& qm_indices, std::vector<std::size_t> const& mm_indices,
+        coords::Representation_3D const& xyz, double const cutoff);
+
       /**This function modifies the coordinates of the current charge in case of periodic boundaries:
       The distance between the center of the QM system and the position of the charge is determined.
       If any of the components (x, y or z) of the connecting vector is longer than half the box size,
@@ -147,22 +158,94 @@ namespace energy
       std::vector<std::size_t> get_indices_of_several_QMcenters(std::vector<std::size_t> const default_indices, std::vector<std::vector<std::size_t>> const& qm_indices,
         coords::Coordinates* coords);
 
-      /**adds external charges to the following calculations
+      /**atoms whose charges are used as external charges for one "QM system"
+      which atoms these are only depends on the topology so they are determined once (see add_external_charges() for the rules)
+      and in every step only positions, charges and cutoff scaling are updated*/
+      class ExternalCharges
+      {
+      public:
+
+        ExternalCharges() = default;
+        /**constructor
+        @param ignore_indizes: indizes of atoms that should be ignored
+        @param indizes_of_charges: indizes of the charges in the overall coordinates object
+        @param link_atoms: vector of link atoms for the current "QM system"
+        @param coords: pointer to original coordobject*/
+        ExternalCharges(std::vector<size_t> const& ignore_indizes, std::vector<size_t> const& indizes_of_charges,
+          std::vector<LinkAtom> const& link_atoms, coords::Coordinates const* coords);
+
+        /**adds external charges with current positions to a vector of point charges
+        if QMMMdrop_far_charges is set charges outside of QMMMcutoff are left out, otherwise they are added with a charge of zero
+        @param charges: vector of charge values (in the order of indizes_of_charges given to the constructor)
+        @param charge_indizes: reference to a vector where the indizes of the atoms whose charges are taken into account are added
+        @param coords: pointer to original coordobject
+        @param QMcenter: index of atom that defines center of QM region
+        @param point_charges: vector the external charges are added to (given to the QM interfaces afterwards)*/
+        void add(std::vector<double> const& charges, std::vector<int>& charge_indizes, coords::Coordinates const* coords, std::size_t const QMcenter,
+          std::vector<PointCharge>& point_charges) const;
+
+        /**number of atoms that might give an external charge*/
+        std::size_t size() const { return atoms.size(); }
+
+      private:
+
+        /**indizes of atoms in overall coordinates object*/
+        std::vector<std::size_t> atoms;
+        /**for every atom: position of its charge in the vector of charge values*/
+        std::vector<std::size_t> charge_positions;
+      };
+
+      /**creates external charges
+      (if this is done in every step better create an ExternalCharges object once)
       @param ignore_indizes: indizes of atoms that should be ignored
       @param charges: vector of charge values that might be added to the calculation
       @param indizes_of_charges: indizes of the charges in the overall coordinates object
       @param link_atoms: vector of link atoms for the current "QM system"
       @param charge_indizes: reference to a vector where the indizes of the atoms whose charges are taken into account are added
       @param coords: pointer to original coordobject
-      @param QMcenter: index of atom that defines center of QM region*/
-      void add_external_charges(std::vector<size_t> const& ignore_indizes, std::vector<double> const& charges, std::vector<size_t> const& indizes_of_charges,
+      @param QMcenter: index of atom that defines center of QM region
+      returns the external charges*/
+      std::vector<PointCharge> add_external_charges(std::vector<size_t> const& ignore_indizes, std::vector<double> const& charges, std::vector<size_t> const& indizes_of_charges,
         std::vector<LinkAtom> const& link_atoms, std::vector<int>& charge_indizes, coords::Coordinates* coords, std::size_t const QMcenter);
 
+      /**calculates the coulomb interaction between QM atoms with fixed charges and external charges
+      (used to relax the MM environment without QM calculation)
+      if QMMMcutoff is given the derivative of the switching function is added to the gradients
+      @param point_charges: external charges (as created by ExternalCharges::add())
+      @param charge_indizes: indizes of the atoms of the external charges
+      @param qm_indizes: indizes of the QM atoms
+      @param qm_charges: charges of the QM atoms (in the order of qm_indizes)
+      @param coords: pointer to original coordobject
+      @param QMcenter: index of atom that defines center of QM region
+      @param gradients: pointer to vector (one entry per atom) the gradients are added to, nullptr if no gradients should be calculated
+      returns the coulomb energy*/
+      double frozen_coulomb(std::vector<PointCharge> const& point_charges, std::vector<int> const& charge_indizes,
+        std::vector<std::size_t> const& qm_indizes, std::vector<double> const& qm_charges, coords::Coordinates const* coords,
+        std::size_t const QMcenter, coords::Gradients_3D* gradients);
+
       /**renames outputfiles for calculations with external energyinterfaces to prevent them from being overwritten
       @param interface: energy interface for which files should be renamed (can be DFTB, MOPAC, ORCA, GAUSSIAN or PSI4)
       @param id: id from which filesnames in that interface are created (should be member of energy interface)
-      @param systemname: string which is inserted in filenames*/
-      void save_outputfiles(config::interface_types::T const& interface, std::string const& id, std::string const& systemname);
+      @param systemname: string which is inserted in filenames
+      @param directory: scratch directory of the interface (files are moved from there into the working directory, empty if none)*/
+      void save_outputfiles(config::interface_types::T const& interface, std::string const& id, std::string const& systemname,
+        std::string const& directory = "");
+
+      /**starts a calculation (e.g. of the MM system) in a second thread while the calling thread runs the QM programme (option QMMMasync)
+      the thread sees the configuration of the calling thread (e.g. a Config::local_scope of microiterations),
+      so the returned future has to be finished before that configuration goes out of scope
+      @param job: function that returns false if the calculation failed (an exception also counts as failure)
+      returns future with the result of job*/
+      template<typename Job>
+      std::future<bool> run_in_background(Job job)
+      {
+        Config const& active_config = Config::get();
+        return std::async(std::launch::async, [&active_config, job]() {
+          Config::worker_scope config_scope(active_config);
+          try { return static_cast<bool>(job()); }
+          catch (...) { return false; }
+        });
+      }
     }
   }
 }
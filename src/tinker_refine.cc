@@ -10,11 +10,17 @@
 #include "Scon/scon_chrono.h"
 
 tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parameter::parameters const& pobj)
-  : m_cparams(pobj)
+  : refined(cobj, std::make_shared<tinker::parameter::parameters const>(pobj))
+{}
+
+tinker::refine::refined::refined(coords::Coordinates const& cobj, std::shared_ptr<tinker::parameter::parameters const> shared_pobj)
+  : m_topology(std::make_shared<topology>())
 {
+  m_topology->cparams = std::move(shared_pobj);
+  tinker::parameter::parameters const& pobj = cparams();
 
   // get nonbonded parameter matrices
-  this->m_vdwc_matrices = pobj.vdwc_matrices();
+  m_topology->vdwc_matrices = pobj.vdwc_matrices();
   std::size_t const N_atoms(cobj.size());
 
   using namespace tinker::refine;
@@ -23,14 +29,14 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
   // 5u -> (-11- -12- -13- -14- -15-)
   for (std::size_t i(0u); i < 5u; ++i)
   {
-    this->m_relations[i].resize(N_atoms);
+    m_topology->relations[i].resize(N_atoms);
   }
 
   // removed relations
   //vector_size_2d m_removes;
-  this->m_removes.resize(N_atoms);
+  m_topology->removes.resize(N_atoms);
   //vector_size_1d m_red_types;
-  this->m_red_types.resize(N_atoms);
+  m_topology->red_types.resize(N_atoms);
 
 
   /* ------------
@@ -44,13 +50,13 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
   for (std::size_t a(0u); a < N_atoms; ++a)
   {
     // stuff with a
-    this->m_red_types[a] = pobj.contract_type(cobj.atoms(a).energy_type());
+    m_topology->red_types[a] = pobj.contract_type(cobj.atoms(a).energy_type());
     std::size_t N_b(cobj.atoms(a).bonds().size());
     if (N_b == 3)
     {
       std::pair<vector_imptors, vector_improper> returns = refine_imptor_improper_of_atom(cobj, pobj, a);
-      this->m_impropers.insert(std::end(m_impropers), std::begin(std::get< vector_improper>(returns)), std::end(std::get< vector_improper>(returns)));
-      this->m_imptors.insert(std::end(m_imptors), std::begin(std::get< vector_imptors>(returns)), std::end(std::get< vector_imptors>(returns)));
+      m_topology->impropers.insert(std::end(m_topology->impropers), std::begin(std::get< vector_improper>(returns)), std::end(std::get< vector_improper>(returns)));
+      m_topology->imptors.insert(std::end(m_topology->imptors), std::begin(std::get< vector_imptors>(returns)), std::end(std::get< vector_imptors>(returns)));
     }
 
     for (std::size_t b1(0u); b1 < N_b; ++b1)
@@ -70,7 +76,7 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
         }
         else
         {
-          this->m_bonds.emplace_back(bondsFound.get());
+          m_topology->bonds.emplace_back(bondsFound.get());
         }
       }
       std::size_t N_c(cobj.atoms(b).bonds().size());
@@ -95,17 +101,17 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
             }
             else
             {
-              this->m_angles.emplace_back(anglesFound.get());
+              m_topology->angles.emplace_back(anglesFound.get());
             }
             auto ureyFound = find_urey(cobj, pobj, a, b, c);
             if (ureyFound != boost::none)
             {
-              m_ureys.emplace_back(ureyFound.get());
+              m_topology->ureys.emplace_back(ureyFound.get());
             }
             auto strbendFound = find_strbend(cobj, pobj, a, b, c);
             if (strbendFound != boost::none)
             {
-              m_strbends.emplace_back(strbendFound.get());
+              m_topology->strbends.emplace_back(strbendFound.get());
             }
           }
 
@@ -124,14 +130,14 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
               auto torsionFound = find_torsion(cobj, pobj, a, b, c, d);
               if (torsionFound != boost::none)
               {
-                m_torsions.emplace_back(torsionFound.get());
+                m_topology->torsions.emplace_back(torsionFound.get());
               }
             }
             // todo find_opbend()
             auto opbendFound = find_opbend(cobj, pobj, a, b, c, d);
             if (opbendFound != boost::none)
             {
-              this->m_opbends.emplace_back(opbendFound.get());
+              m_topology->opbends.emplace_back(opbendFound.get());
             }
           }
           std::size_t N_e(cobj.atoms(d).bonds().size());
@@ -148,9 +154,9 @@ tinker::refine::refined::refined(coords::Coordinates const& cobj, tinker::parame
   }
 
   if (!pobj.multipoles().empty())
-    this->m_multipole_vec.emplace_back(refine_mp(cobj, pobj));
+    m_topology->multipole_vec.emplace_back(refine_mp(cobj, pobj));
   if (!pobj.polarizes().empty())
-    this->m_polarize_vec.emplace_back(refine_pol(cobj, pobj));
+    m_topology->polarize_vec.emplace_back(refine_pol(cobj, pobj));
   refine_nb(cobj);
 }
 
@@ -159,10 +165,10 @@ void tinker::refine::refined::add_relation(tinker::parameter::parameters const&
 {
   if (!has_tighter_relation(atom, related, relation))
   {  // check whether we have a tighter relation than the specified one betweem atom and related
-    scon::sorted::insert_unique(m_relations[relation][atom], related);
+    scon::sorted::insert_unique(m_topology->relations[relation][atom], related);
     if (!pobj.vdwc_used(relation))
     {
-      scon::sorted::insert_unique(m_removes[atom], related);
+      scon::sorted::insert_unique(m_topology->removes[atom], related);
     }
     // make sure this relation is the tightest
     remove_loose_relations(atom, related, relation);
@@ -174,7 +180,7 @@ bool tinker::refine::refined::has_tighter_relation(std::size_t const atom,
 {
   for (std::size_t i(0u); i < relation_to_check; ++i)
   {
-    if (scon::sorted::exists(m_relations[i][atom], related)) return true;
+    if (scon::sorted::exists(m_topology->relations[i][atom], related)) return true;
   }
   return false;
 }
@@ -182,14 +188,14 @@ bool tinker::refine::refined::has_tighter_relation(std::size_t const atom,
 void tinker::refine::refined::remove_loose_relations(std::size_t const atom,
   std::size_t const related, std::size_t const relation_to_check)
 {
-  for (std::size_t i(relation_to_check + 1); i < m_relations.size(); ++i)
+  for (std::size_t i(relation_to_check + 1); i < m_topology->relations.size(); ++i)
   {
-    if (!m_relations[i][atom].empty())
+    if (!m_topology->relations[i][atom].empty())
     {
-      if ((m_relations[i][atom].back() < related) || (related < m_relations[i][atom].front())) continue;
-      std::size_t find_index = scon::sorted::find(m_relations[i][atom], related);
-      if (find_index == m_relations[i][atom].size() || related < m_relations[i][atom][find_index]) continue;
-      m_relations[i][atom].erase(m_relations[i][atom].begin() + static_cast<std::ptrdiff_t>(find_index));
+      if ((m_topology->relations[i][atom].back() < related) || (related < m_topology->relations[i][atom].front())) continue;
+      std::size_t find_index = scon::sorted::find(m_topology->relations[i][atom], related);
+      if (find_index == m_topology->relations[i][atom].size() || related < m_topology->relations[i][atom][find_index]) continue;
+      m_topology->relations[i][atom].erase(m_topology->relations[i][atom].begin() + static_cast<std::ptrdiff_t>(find_index));
     }
   }
 }
@@ -549,7 +555,7 @@ std::size_t tinker::refine::refined::get_relation(std::size_t const atom_1, std:
 {
   std::size_t rel = 0;
   while (rel < 5) {
-    if (scon::sorted::exists(m_relations[rel][atom_1], atom_2)) return rel;
+    if (scon::sorted::exists(m_topology->relations[rel][atom_1], atom_2)) return rel;
     ++rel;
   }
   return 5;
@@ -557,20 +563,20 @@ std::size_t tinker::refine::refined::get_relation(std::size_t const atom_1, std:
 
 void tinker::refine::refined::refine_nb(coords::Coordinates const& coords)
 {
-  if (m_cparams.vdwc_used(R12)) build_pairs_direct<R12>(coords);
-  else if (m_cparams.vdwc_used(R13)) build_pairs_direct<R13>(coords);
-  else if (m_cparams.vdwc_used(R14)) build_pairs_direct<R14>(coords);
-  else if (m_cparams.vdwc_used(R15)) build_pairs_direct<R15>(coords);
+  if (cparams().vdwc_used(R12)) build_pairs_direct<R12>(coords);
+  else if (cparams().vdwc_used(R13)) build_pairs_direct<R13>(coords);
+  else if (cparams().vdwc_used(R14)) build_pairs_direct<R14>(coords);
+  else if (cparams().vdwc_used(R15)) build_pairs_direct<R15>(coords);
   else build_pairs_direct<R1N>(coords);
 }
 
 template<tinker::refine::refined::rel RELATION>
 bool tinker::refine::refined::add_pair(coords::Coordinates const& coords, std::size_t const row, std::size_t const col, std::array<std::size_t, 5u> const& to_matrix_id)
 {
-  ::tinker::parameter::parameters const* params = &m_cparams;
+  ::tinker::parameter::parameters const* params = &cparams();
   if (
     (!coords.atoms().sub_io() || !coords.atoms().sub_io_transition(row, col))
-    && !scon::sorted::exists(m_removes[col], row)
+    && !scon::sorted::exists(m_topology->removes[col], row)
     && !(
       Config::get().energy.remove_fixed
       && coords.atoms(row).fixed()
@@ -579,28 +585,28 @@ bool tinker::refine::refined::add_pair(coords::Coordinates const& coords, std::s
     )
   {
     types::nbpair pair(row, col);
-    if (RELATION == R12 && to_matrix_id[R12] > 0 && scon::sorted::exists(m_relations[R12][col], row))
+    if (RELATION == R12 && to_matrix_id[R12] > 0 && scon::sorted::exists(m_topology->relations[R12][col], row))
     {
       if (params->vdwc_used(R12))
       {
         m_pair_matrices[to_matrix_id[R12]].pair_matrix(coords.atoms(row).system(), coords.atoms(col).system()).push_back(pair);
       }
     }
-    else if ((RELATION == R12 || RELATION == R13) && to_matrix_id[R13] > 0 && scon::sorted::exists(m_relations[R13][col], row))
+    else if ((RELATION == R12 || RELATION == R13) && to_matrix_id[R13] > 0 && scon::sorted::exists(m_topology->relations[R13][col], row))
     {
       if (params->vdwc_used(R13))
       {
         m_pair_matrices[to_matrix_id[R13]].pair_matrix(coords.atoms(row).system(), coords.atoms(col).system()).push_back(pair);
       }
     }
-    else if ((RELATION == R12 || RELATION == R13 || RELATION == R14) && to_matrix_id[R14] > 0 && scon::sorted::exists(m_relations[R14][col], row))
+    else if ((RELATION == R12 || RELATION == R13 || RELATION == R14) && to_matrix_id[R14] > 0 && scon::sorted::exists(m_topology->relations[R14][col], row))
     {
       if (params->vdwc_used(R14))
       {
         m_pair_matrices[to_matrix_id[R14]].pair_matrix(coords.atoms(row).system(), coords.atoms(col).system()).push_back(pair);
       }
     }
-    else if ((RELATION == R12 || RELATION == R13 || RELATION == R14 || RELATION == R15) && to_matrix_id[R15] > 0 && scon::sorted::exists(m_relations[R15][col], row))
+    else if ((RELATION == R12 || RELATION == R13 || RELATION == R14 || RELATION == R15) && to_matrix_id[R15] > 0 && scon::sorted::exists(m_topology->relations[R15][col], row))
     {
       if (params->vdwc_used(R15))
       {
@@ -627,11 +633,11 @@ void tinker::refine::refined::build_pairs_direct(coords::Coordinates const& coor
   // determine the pair matrices to be applied
   for (std::size_t i(RELATION); i < 5u; ++i)
   {
-    bool const bool1 = m_cparams.vdwc_used(i);
-    bool const bool2 = !m_vdwc_matrices[i].empty();
+    bool const bool1 = cparams().vdwc_used(i);
+    bool const bool2 = !m_topology->vdwc_matrices[i].empty();
     if (bool1 && bool2)
     {
-      if (!m_cparams.vdwc_scaled(i) && (i != 3U || !m_cparams.has_vdw14s()))
+      if (!cparams().vdwc_scaled(i) && (i != 3U || !cparams().has_vdw14s()))
       {
         to_matrix_id[i] = 0u;
       }
@@ -641,7 +647,7 @@ void tinker::refine::refined::build_pairs_direct(coords::Coordinates const& coor
         std::size_t const mpms(m_pair_matrices.size());
         for (std::size_t m_id(0u); m_id < mpms; ++m_id)
         {
-          if (m_pair_matrices[m_id].param_matrix_id < 5u && m_cparams.vdwc_same(i, m_pair_matrices[m_id].param_matrix_id))
+          if (m_pair_matrices[m_id].param_matrix_id < 5u && cparams().vdwc_same(i, m_pair_matrices[m_id].param_matrix_id))
           { // if the same scaling is applied as for another existing matrix we do not create a new one
             create_matrix = false;
             to_matrix_id[i] = m_id;
@@ -1038,36 +1044,27 @@ tinker::refine::vector_polarize tinker::refine::refine_pol(coords::Coordinates c
 
 void tinker::refine::refined::clear(void)
 {
-  m_angles.clear();
-  m_bonds.clear();
-  m_impropers.clear();
-  m_imptors.clear();
-  m_torsions.clear();
-  m_ureys.clear();
-  m_multipole_vec.clear();
-  m_polarize_vec.clear();
+  // the old topology may be shared with copies, so it is replaced instead of copied and emptied
+  auto empty_topology = std::make_shared<topology>();
+  empty_topology->cparams = m_topology->cparams;
+  m_topology = std::move(empty_topology);
   m_pair_matrices.clear();
-  for (auto& relation : m_relations) relation.clear();
-  for (auto& vdwc_matrix : m_vdwc_matrices) vdwc_matrix.clear();
 }
 
 void tinker::refine::refined::swap_data(refined& rhs)
 {
-  std::swap(m_cparams, rhs.m_cparams);
-  m_angles.swap(rhs.m_angles);
-  m_bonds.swap(rhs.m_bonds);
-  m_impropers.swap(rhs.m_impropers);
-  m_imptors.swap(rhs.m_imptors);
-  m_torsions.swap(rhs.m_torsions);
-  m_ureys.swap(rhs.m_ureys);
+  m_topology.swap(rhs.m_topology);
   m_pair_matrices.swap(rhs.m_pair_matrices);
-  for (std::size_t i(0u); i < 5u; ++i) m_relations[i].swap(rhs.m_relations[i]);
-  m_removes.swap(rhs.m_removes);
-  m_red_types.swap(rhs.m_red_types);
-  m_multipole_vec.swap(rhs.m_multipole_vec);
-  m_polarize_vec.swap(rhs.m_polarize_vec);
+}
 
-  for (std::size_t i(0u); i < 6u; ++i) m_vdwc_matrices[i].swap(rhs.m_vdwc_matrices[i]);
+tinker::refine::refined::topology& tinker::refine::refined::set_topology(void)
+{
+  // topology data of copies is shared, so it has to be copied before it is changed
+  if (m_topology.use_count() > 1)
+  {
+    m_topology = std::make_shared<topology>(*m_topology);
+  }
+  return *m_topology;
 }
 
 // output operators 
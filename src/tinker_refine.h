@@ -1,5 +1,6 @@
 #pragma once
 #include <array>
+#include <memory>
 #include <vector>
 #include <ostream>
 #include "tinker_parameters.h"
@@ -161,51 +162,62 @@ namespace tinker
     typedef std::vector<std::size_t>               vector_size_1d;
     typedef std::vector<vector_size_1d>            vector_size_2d;
 
+    /**topology dependent force field terms of a structure
+    Everything that only depends on the topology and the parameters (term lists, relations, vdW matrices)
+    is kept in a reference counted object that is shared by all copies, so copying (e.g. when an
+    interface is cloned) only copies the nonbonded pair lists which depend on the current positions.
+    The set_...() functions make a private copy of the shared data before it is changed (copy on write).*/
     class refined
     {
     public:
       enum rel { R11, R12, R13, R14, R15, R1N };
 
-      refined() {};
+      refined() : m_topology(std::make_shared<topology>()) {};
       refined(coords::Coordinates const& cobj, tinker::parameter::parameters const& pobj);
+      /**same as above but the contracted parameters are shared with the caller instead of copied*/
+      refined(coords::Coordinates const& cobj, std::shared_ptr<tinker::parameter::parameters const> pobj);
 
 
+      /**removes all terms and pairs (the parameters are kept)*/
       void clear(void);
       void swap_data(refined&);
 
 
 
-      vector_biquad const& bonds(void) const { return m_bonds; }
-      vector_triquad const& angles(void) const { return m_angles; }
-      vector_improper const& impropers(void) const { return m_impropers; }
-      vector_imptors const& imptors(void) const { return m_imptors; }
-      vector_opbend const& opbends(void) const { return m_opbends; }
-      vector_strbend const& strbends(void) const { return m_strbends; }
-      vector_tors const& torsions(void) const { return m_torsions; }
-      vector_biquad const& ureys(void) const { return m_ureys; }
+      vector_biquad const& bonds(void) const { return m_topology->bonds; }
+      vector_triquad const& angles(void) const { return m_topology->angles; }
+      vector_improper const& impropers(void) const { return m_topology->impropers; }
+      vector_imptors const& imptors(void) const { return m_topology->imptors; }
+      vector_opbend const& opbends(void) const { return m_topology->opbends; }
+      vector_strbend const& strbends(void) const { return m_topology->strbends; }
+      vector_tors const& torsions(void) const { return m_topology->torsions; }
+      vector_biquad const& ureys(void) const { return m_topology->ureys; }
       std::vector<types::nbpm> const& pair_matrices(void) const { return m_pair_matrices; };
-      vector_size_1d const& remove_relations(std::size_t const index) { return m_removes[index]; }
-      std::vector<vector_multipole> const& multipole_vecs(void) const { return m_multipole_vec; };
-      std::vector<vector_polarize> const& polarize_vecs(void) const { return m_polarize_vec; };
-
-      vector_biquad& set_bonds(void) { return m_bonds; }
-      vector_triquad& set_angles(void) { return m_angles; }
-      vector_improper& set_impropers(void) { return m_impropers; }
-      vector_imptors& set_imptors(void) { return m_imptors; }
-      vector_opbend& set_opbends(void) { return m_opbends; }
-      vector_strbend& set_strbends(void) { return m_strbends; }
-      vector_tors& set_torsions(void) { return m_torsions; }
-      vector_biquad& set_ureys(void) { return m_ureys; }
+      vector_size_1d const& remove_relations(std::size_t const index) const { return m_topology->removes[index]; }
+      std::vector<vector_multipole> const& multipole_vecs(void) const { return m_topology->multipole_vec; };
+      std::vector<vector_polarize> const& polarize_vecs(void) const { return m_topology->polarize_vec; };
+
+      vector_biquad& set_bonds(void) { return set_topology().bonds; }
+      vector_triquad& set_angles(void) { return set_topology().angles; }
+      vector_improper& set_impropers(void) { return set_topology().impropers; }
+      vector_imptors& set_imptors(void) { return set_topology().imptors; }
+      vector_opbend& set_opbends(void) { return set_topology().opbends; }
+      vector_strbend& set_strbends(void) { return set_topology().strbends; }
+      vector_tors& set_torsions(void) { return set_topology().torsions; }
+      vector_biquad& set_ureys(void) { return set_topology().ureys; }
       std::vector<types::nbpm>& set_pair_matrices(void) { return m_pair_matrices; };
-      vector_size_1d& set_remove_relations(std::size_t const index) { return m_removes[index]; }
-      std::vector<vector_multipole>& set_multipole_vecs(void) { return m_multipole_vec; };
-      std::vector<vector_polarize>& set_polarize_vecs(void) { return m_polarize_vec; };
+      vector_size_1d& set_remove_relations(std::size_t const index) { return set_topology().removes[index]; }
+      std::vector<vector_multipole>& set_multipole_vecs(void) { return set_topology().multipole_vec; };
+      std::vector<vector_polarize>& set_polarize_vecs(void) { return set_topology().polarize_vec; };
 
 
-      scon::matrix<parameter::combi::vdwc, true> const& vdwcm(std::size_t index) const { return m_vdwc_matrices[index]; }
-      std::array<scon::matrix<parameter::combi::vdwc, true>, 6u> const& vdwcm(void) const { return m_vdwc_matrices; }
+      scon::matrix<parameter::combi::vdwc, true> const& vdwcm(std::size_t index) const { return m_topology->vdwc_matrices[index]; }
+      std::array<scon::matrix<parameter::combi::vdwc, true>, 6u> const& vdwcm(void) const { return m_topology->vdwc_matrices; }
 
-      std::size_t const& type(std::size_t const index) const { return m_red_types[index]; }
+      std::size_t const& type(std::size_t const index) const { return m_topology->red_types[index]; }
+
+      /**is the topology data shared with another refined object?*/
+      bool shares_topology(refined const& other) const { return m_topology == other.m_topology; }
 
       std::size_t ia_count(void) const
       {
@@ -236,9 +248,38 @@ namespace tinker
       void refine_nb(coords::Coordinates const& cobj);
 
     private:   
-      //
-      ::tinker::parameter::parameters m_cparams;
-      //
+
+      /**data that doesn't change after construction (shared between copies)*/
+      struct topology
+      {
+        // contracted parameters
+        std::shared_ptr<::tinker::parameter::parameters const>        cparams = std::make_shared<::tinker::parameter::parameters const>();
+        // Standard Types
+        vector_triquad                                                angles;
+        vector_biquad                                                 bonds;
+        vector_improper                                               impropers;
+        vector_imptors                                                imptors;
+        vector_tors                                                   torsions;
+        vector_biquad                                                 ureys;
+        vector_opbend                                                 opbends;
+        vector_strbend                                                strbends;
+        std::vector<vector_multipole>                                 multipole_vec;
+        std::vector<vector_polarize>                                  polarize_vec;
+        // Refined relations 
+        // 5u -> (-11- -12- -13- -14- -15-)
+        std::array<vector_size_2d, 5u>                                relations;
+        // removed relations
+        vector_size_2d                                                removes;
+        vector_size_1d                                                red_types;
+        // Refined vdw matrices
+        // 6u -> (-11- -12- -13- -14- -15- -1n-)
+        std::array<scon::matrix<parameter::combi::vdwc, true>, 6u>    vdwc_matrices;
+      };
+
+      /**returns topology data that is not shared with other objects (copies it if necessary)*/
+      topology& set_topology(void);
+      ::tinker::parameter::parameters const& cparams(void) const { return *m_topology->cparams; }
+
       bool has_tighter_relation(std::size_t const atom, std::size_t const related, std::size_t const relation_to_check);
       void remove_loose_relations(std::size_t const atom, std::size_t const related, std::size_t const relation_to_check);
       void add_relation(tinker::parameter::parameters const& pobj, std::size_t const atom, std::size_t const related, std::size_t const relation);
@@ -249,30 +290,11 @@ namespace tinker
       //void refine_pol(void);
 
 
-
-      // Standard Types
-      vector_triquad                                                m_angles;
-      vector_biquad                                                 m_bonds;
-      vector_improper                                               m_impropers;
-      vector_imptors                                                m_imptors;
-      vector_tors                                                   m_torsions;
-      vector_biquad                                                 m_ureys;
-      vector_opbend                                                 m_opbends;
-      vector_strbend                                                m_strbends;
+      std::shared_ptr<topology>                                     m_topology;
+      // Nonbonded pairs (depend on positions, so every copy has its own)
       std::vector<types::nbpm>                                      m_pair_matrices;
-      std::vector<vector_multipole>                                 m_multipole_vec;
-      std::vector<vector_polarize>                                  m_polarize_vec;
       vector_pairs_1d                                               m_1d_nbpairs;
       std::vector<vector_pairs_1d>                                  m_1d_nbpairs_vec;
-      // Refined relations 
-      // 5u -> (-11- -12- -13- -14- -15-)
-      std::array<vector_size_2d, 5u>                                m_relations;
-      // removed relations
-      vector_size_2d                                                m_removes;
-      vector_size_1d                                                m_red_types;
-      // Refined vdw matrices
-      // 6u -> (-11- -12- -13- -14- -15- -1n-)
-      std::array<scon::matrix<parameter::combi::vdwc, true>, 6u>    m_vdwc_matrices;
     };
 
     //Re-Implemented as Free Function, much better code design! Dustin 07/2019